@@ -0,0 +1,335 @@
+/* 
+ * This file is part of Vulture.
+ *
+ * Vulture finite-difference time-domain electromagnetic solver.
+ * Copyright (C) 2011-2016 Ian David Flintoft
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ *
+ * Author: Ian Flintoft <ian.flintoft@googlemail.com>
+ *
+ */
+
+/* For sched_setaffinity and sched_getcpu. */
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#ifdef WITH_OPENMP
+  #include <omp.h>
+#endif
+
+#if defined( WITH_OPENMP ) && defined( __linux__ )
+  #include <sched.h>
+  #define HAVE_THREAD_AFFINITY
+#endif
+
+#include "affinity.h"
+#include "fdtd_types.h"
+#include "message.h"
+
+/* 
+ * Private data.
+ */
+
+/* Policy names. */
+static char AFFINITY_POLICY[][TAG_SIZE] = { "NONE" , "COMPACT" , "SCATTER" , "UNDEFINED" };
+
+/* OpenMP processor binding names. */
+#if defined( WITH_OPENMP ) && _OPENMP >= 201307
+static char PROC_BIND[][TAG_SIZE] = { "false" , "true" , "master" , "close" , "spread" };
+#endif
+
+/* Policy used. */
+static AffinityPolicy affinityPolicy = AP_NONE;
+
+/* 
+ * Private method interfaces. 
+ */
+
+#ifdef HAVE_THREAD_AFFINITY
+int getCpuPackage( int cpu );
+int compareCpus( const void *a , const void *b );
+int getOrderedCpus( int **cpus , int **packages , int *numPackages );
+void bindThreads( void );
+#endif
+void reportThreadPlacement( void );
+
+/*
+ * Method Implementations.
+ */
+
+/* Set thread affinity policy by name. */
+bool setThreadAffinity( char *name )
+{
+
+  for( AffinityPolicy policy = AP_NONE ; policy < AP_UNDEFINED ; policy++ )
+  {
+    if( strcasecmp( name , AFFINITY_POLICY[policy] ) == 0 )
+    {
+      affinityPolicy = policy;
+      return true;
+    }
+  }
+
+  return false;
+
+}
+
+/* 
+ * Bind the OpenMP threads to processors according to the policy and report
+ * where they are running. This must be done after the number of threads is
+ * set and before the grid arrays are first touched so that each thread's
+ * part of the arrays is placed in memory local to it.
+ */
+void initThreadAffinity( void )
+{
+
+  message( MSG_LOG , 0 , "\nInitialising thread affinity...\n\n" );
+
+#ifdef HAVE_THREAD_AFFINITY
+  if( affinityPolicy != AP_NONE )
+    bindThreads();
+#else
+  if( affinityPolicy != AP_NONE )
+    message( MSG_WARN , 0 , "*** Warning: Thread affinity is not supported on this platform - policy %s ignored\n" , 
+             AFFINITY_POLICY[affinityPolicy] );
+#endif
+
+  reportThreadPlacement();
+
+  return;
+
+}
+
+#ifdef HAVE_THREAD_AFFINITY
+
+/* Get the processor package (socket) of a CPU, zero if unknown. */
+int getCpuPackage( int cpu )
+{
+
+  char fileName[PATH_SIZE];
+  FILE *fp;
+  int package = 0;
+
+  snprintf( fileName , PATH_SIZE , "/sys/devices/system/cpu/cpu%d/topology/physical_package_id" , cpu );
+  fp = fopen( fileName , "r" );
+  if( fp != NULL )
+  {
+    if( fscanf( fp , "%d" , &package ) != 1 || package < 0 )
+      package = 0;
+    fclose( fp );
+  }
+
+  return package;
+
+}
+
+/* Order CPUs by package then number - entries are (package,cpu) pairs. */
+int compareCpus( const void *a , const void *b )
+{
+
+  const int *p = a;
+  const int *q = b;
+
+  if( p[0] != q[0] )
+    return p[0] - q[0];
+  else
+    return p[1] - q[1];
+
+}
+
+/* 
+ * Get the CPUs available to the process ordered by package and their packages.
+ * Returns the number of CPUs. The arrays must be free'd by the caller.
+ */
+int getOrderedCpus( int **cpus , int **packages , int *numPackages )
+{
+
+  cpu_set_t mask;
+  int *pairs;
+  int numCpus = 0;
+
+  CPU_ZERO( &mask );
+  if( sched_getaffinity( 0 , sizeof( mask ) , &mask ) != 0 )
+    return 0;
+
+  pairs = (int *) malloc( 2 * CPU_SETSIZE * sizeof( int ) );
+  *cpus = (int *) malloc( CPU_SETSIZE * sizeof( int ) );
+  *packages = (int *) malloc( CPU_SETSIZE * sizeof( int ) );
+  if( pairs == NULL || *cpus == NULL || *packages == NULL )
+    message( MSG_ERROR , 0 , "*** Error: Failed to allocate CPU list\n" );
+
+  for( int cpu = 0 ; cpu < CPU_SETSIZE ; cpu++ )
+  {
+    if( CPU_ISSET( cpu , &mask ) )
+    {
+      pairs[2*numCpus] = getCpuPackage( cpu );
+      pairs[2*numCpus+1] = cpu;
+      numCpus++;
+    }
+  }
+
+  qsort( pairs , numCpus , 2 * sizeof( int ) , compareCpus );
+
+  *numPackages = 0;
+  for( int n = 0 ; n < numCpus ; n++ )
+  {
+    (*packages)[n] = pairs[2*n];
+    (*cpus)[n] = pairs[2*n+1];
+    if( n == 0 || pairs[2*n] != pairs[2*n-2] )
+      (*numPackages)++;
+  }
+
+  free( pairs );
+
+  return numCpus;
+
+}
+
+/* 
+ * Bind each thread to a single CPU. COMPACT fills the CPUs of one package 
+ * before moving to the next; SCATTER deals the threads round-robin across the 
+ * packages so that each gets an equal share of the threads and memory bandwidth.
+ */
+void bindThreads( void )
+{
+
+  int *cpus = NULL;
+  int *packages = NULL;
+  int *first;
+  int numCpus;
+  int numPackages;
+  int numThreads;
+  int numFailed = 0;
+
+  numCpus = getOrderedCpus( &cpus , &packages , &numPackages );
+  if( numCpus == 0 )
+  {
+    message( MSG_WARN , 0 , "*** Warning: Cannot determine available CPUs - thread affinity not set\n" );
+    return;
+  }
+
+  numThreads = omp_get_max_threads();
+  if( numThreads > numCpus )
+    message( MSG_WARN , 0 , "*** Warning: %d threads for %d CPUs - some CPUs will run more than one thread\n" , 
+             numThreads , numCpus );
+
+  /* Index of the first CPU of each package. */
+  first = (int *) malloc( ( numPackages + 1 ) * sizeof( int ) );
+  if( first == NULL )
+    message( MSG_ERROR , 0 , "*** Error: Failed to allocate CPU list\n" );
+  for( int n = 0 , p = 0 ; n < numCpus ; n++ )
+    if( n == 0 || packages[n] != packages[n-1] )
+      first[p++] = n;
+  first[numPackages] = numCpus;
+
+  message( MSG_LOG , 0 , "  Binding %d threads to %d CPUs in %d packages using %s policy\n" , 
+           numThreads , numCpus , numPackages , AFFINITY_POLICY[affinityPolicy] );
+
+  #pragma omp parallel
+  {
+    int thread = omp_get_thread_num();
+    int index;
+    int package;
+    int numPackageCpus;
+    cpu_set_t mask;
+
+    if( affinityPolicy == AP_SCATTER )
+    {
+      package = thread % numPackages;
+      numPackageCpus = first[package+1] - first[package];
+      index = first[package] + ( thread / numPackages ) % numPackageCpus;
+    }
+    else
+    {
+      index = thread % numCpus;
+    }
+
+    CPU_ZERO( &mask );
+    CPU_SET( cpus[index] , &mask );
+    if( sched_setaffinity( 0 , sizeof( mask ) , &mask ) != 0 )
+    {
+      #pragma omp atomic
+      numFailed++;
+    }
+  }
+
+  if( numFailed > 0 )
+    message( MSG_WARN , 0 , "*** Warning: Failed to bind %d of %d threads\n" , numFailed , numThreads );
+
+  free( first );
+  free( cpus );
+  free( packages );
+
+  return;
+
+}
+
+#endif
+
+/* Report the CPU each thread is running on. */
+void reportThreadPlacement( void )
+{
+
+#ifdef WITH_OPENMP
+
+  int numThreads = omp_get_max_threads();
+  int *placement;
+
+  message( MSG_LOG , 0 , "  Thread affinity policy: %s\n" , AFFINITY_POLICY[affinityPolicy] );
+#if _OPENMP >= 201307
+  message( MSG_LOG , 0 , "  OpenMP processor binding: %s\n" , 
+           (unsigned int) omp_get_proc_bind() < 5 ? PROC_BIND[omp_get_proc_bind()] : "unknown" );
+#endif
+
+  placement = (int *) malloc( numThreads * sizeof( int ) );
+  if( placement == NULL )
+    message( MSG_ERROR , 0 , "*** Error: Failed to allocate thread placement list\n" );
+
+  for( int thread = 0 ; thread < numThreads ; thread++ )
+    placement[thread] = -1;
+
+  #pragma omp parallel
+  {
+#ifdef HAVE_THREAD_AFFINITY
+    placement[omp_get_thread_num()] = sched_getcpu();
+#endif
+  }
+
+  for( int thread = 0 ; thread < numThreads ; thread++ )
+  {
+#ifdef HAVE_THREAD_AFFINITY
+    message( MSG_LOG , 0 , "  Thread %d on CPU %d (package %d)\n" , thread , placement[thread] , 
+             placement[thread] >= 0 ? getCpuPackage( placement[thread] ) : -1 );
+#else
+    message( MSG_LOG , 0 , "  Thread %d placement unknown\n" , thread );
+#endif
+  }
+
+  free( placement );
+
+#else
+
+  message( MSG_LOG , 0 , "  Single threaded - no thread affinity\n" );
+
+#endif
+
+  return;
+
+}
@@ -22,18 +22,34 @@
  *
  */
 
+/* For posix_memalign. */
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdlib.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 
 #include "message.h"
+#include "alloc_array.h"
 
 #define EXTENTSIZE 12
 
+/* Row and plane strides that are multiples of this number of bytes are padded. */
+#define FIELD_CONFLICT_BYTES 4096
+
+/* Rows are only padded to whole cache lines if this adds less than 1/FIELD_MAX_PAD_RATIO to their length. */
+#define FIELD_MAX_PAD_RATIO 32
+
+/* Number of different cache line offsets used to stagger field array data. */
+#define FIELD_NUM_STAGGERS 16
+
 /* Total memory allocated. */
 static unsigned long totalMemory = 0UL;
 
+/* Number of field arrays allocated. */
+static unsigned long numFieldArrays = 0UL;
+
 /* 
  * Allocate an array of objects of given dimension and extents.
  * Extents are zero based.
@@ -51,7 +67,7 @@ static unsigned long totalMemory = 0UL;
  * The array is contiguous, hence column based offsets work. 
  * The number of bytes allocated is returned in variable bytes.
 */
-void *allocArray( unsigned long *bytes , size_t size , int dimension , ... )
+void *allocArray( unsigned long *bytes , size_t size , unsigned int dimension , ... )
 {
 
   void ***retval, ***currentPointer, **destinationPointer;
@@ -141,7 +157,7 @@ void *allocArray( unsigned long *bytes , size_t size , int dimension , ... )
 }
 
 /* Deallocate array. */
-void deallocArray( void *array , int dimension , ... )
+void deallocArray( void *array , unsigned int dimension , ... )
 {
 
   free( array );
@@ -150,6 +166,153 @@ void deallocArray( void *array , int dimension , ... )
 
 }
 
+/*
+ * Get the strides, in elements, of a field array with nj x nk elements in
+ * each plane. Long rows are padded to a whole number of FIELD_ALIGNMENT byte
+ * cache lines so that every row is aligned; short rows are left unpadded since
+ * the extra memory traffic costs more than the alignment gains. Rows and
+ * planes whose lengths are multiples of FIELD_CONFLICT_BYTES are padded by a 
+ * further cache line so that neighbouring rows and planes do not map to the
+ * same cache sets.
+ */
+void getFieldArrayStrides( size_t size , int nj , int nk , size_t *strideI , size_t *strideJ )
+{
+
+  size_t rowBytes;
+  size_t paddedBytes;
+  size_t planeBytes;
+
+  rowBytes = (size_t)nk * size;
+  paddedBytes = ( ( rowBytes + FIELD_ALIGNMENT - 1 ) / FIELD_ALIGNMENT ) * FIELD_ALIGNMENT;
+  if( ( paddedBytes - rowBytes ) * FIELD_MAX_PAD_RATIO <= rowBytes )
+    rowBytes = paddedBytes;
+
+  if( rowBytes % FIELD_CONFLICT_BYTES == 0 )
+    rowBytes += FIELD_ALIGNMENT;
+
+  planeBytes = (size_t)nj * rowBytes;
+  if( planeBytes % FIELD_CONFLICT_BYTES == 0 )
+    planeBytes += FIELD_ALIGNMENT;
+
+  *strideJ = rowBytes / size;
+  *strideI = planeBytes / size;
+
+  return;
+
+}
+
+/* 
+ * Allocate a three dimensional field array of ni x nj x nk objects.
+ *
+ * The data is held in a single FIELD_ALIGNMENT byte aligned block with the 
+ * strides given by getFieldArrayStrides so element (i,j,k) is at
+ * offset FIELD_INDEX( i , j , k , strideI , strideJ ) from FIELD_DATA( a ).
+ * The data of successive arrays is staggered by a cache line to avoid the 
+ * same elements of different arrays sharing cache sets.
+ *
+ * A separate table of row pointers is also allocated so that the array can
+ * be accessed using a[i][j][k] as for arrays from allocArray. The array must 
+ * be free'd using deallocFieldArray. The number of bytes allocated is returned 
+ * in variable bytes.
+ */
+void *allocFieldArray( unsigned long *bytes , size_t size , int ni , int nj , int nk )
+{
+
+  int lim[6] = { 0 , ni - 1 , 0 , nj - 1 , 0 , nk - 1 };
+
+  return allocFieldArrayRegion( bytes , size , ni , nj , nk , lim );
+
+}
+
+/* 
+ * Allocate the elements of a three dimensional field array of ni x nj x nk
+ * objects within the inclusive index limits lim.
+ *
+ * The array is indexed using the global indices, a[i][j][k], but only the
+ * elements within the limits exist. The plane pointers of planes outside the
+ * limits are NULL, as are the row pointers of rows outside the limits. The
+ * strides are those of an array with the extents of the region so element
+ * (i,j,k) is at offset FIELD_INDEX( i - lim[XLO] , j - lim[YLO] , k - lim[ZLO] , 
+ * strideI , strideJ ) from a[lim[XLO]][lim[YLO]] + lim[ZLO]. The array must be 
+ * free'd using deallocFieldArray.
+ */
+void *allocFieldArrayRegion( unsigned long *bytes , size_t size , int ni , int nj , int nk , int lim[6] )
+{
+
+  void **table;
+  void ***planes;
+  char *block;
+  char *data;
+  size_t strideI , strideJ;
+  size_t offset;
+  size_t tableBytes , dataBytes;
+  int niRegion , njRegion , nkRegion;
+  int i , j;
+
+  niRegion = lim[1] - lim[0] + 1;
+  njRegion = lim[3] - lim[2] + 1;
+  nkRegion = lim[5] - lim[4] + 1;
+
+  getFieldArrayStrides( size , njRegion , nkRegion , &strideI , &strideJ );
+
+  offset = ( numFieldArrays % FIELD_NUM_STAGGERS ) * FIELD_ALIGNMENT;
+  numFieldArrays++;
+
+  /* Table holds the data block pointer followed by the plane and row pointers. */
+  tableBytes = ( 1 + (size_t)ni + (size_t)niRegion * nj ) * sizeof( void * );
+  dataBytes = (size_t)niRegion * strideI * size + offset;
+
+  table = (void **)malloc( tableBytes );
+  if( table == NULL || posix_memalign( (void **)&block , FIELD_ALIGNMENT , dataBytes ) != 0 )
+    message( MSG_ERROR , 0 , "  allocFieldArray: Failed to allocate %.3lf MiB (%dx%dx%d) 3-D array!\n" , 
+             ( tableBytes + dataBytes ) / 1024.0 / 1024.0 , niRegion , njRegion , nkRegion );
+  else
+    message( MSG_DEBUG3 , 0 , "  allocFieldArray: Allocated %.3lf MiB (%dx%dx%d) 3-D array with strides (%lu,%lu)!\n" , 
+             ( tableBytes + dataBytes ) / 1024.0 / 1024.0 , niRegion , njRegion , nkRegion , (unsigned long)strideI , (unsigned long)strideJ );
+
+  totalMemory += tableBytes + dataBytes;
+  *bytes = tableBytes + dataBytes;
+
+  table[0] = block;
+  planes = (void ***)( table + 1 );
+  data = block + offset;
+
+  for( i = 0 ; i < ni ; i++ )
+  {
+    if( i < lim[0] || i > lim[1] )
+    {
+      planes[i] = NULL;
+      continue;
+    }
+    planes[i] = table + 1 + ni + (size_t)( i - lim[0] ) * nj;
+    for( j = 0 ; j < nj ; j++ )
+      if( j < lim[2] || j > lim[3] )
+        planes[i][j] = NULL;
+      else
+        planes[i][j] = data + FIELD_INDEX( i - lim[0] , j - lim[2] , 0 , strideI , strideJ ) * size - (size_t)lim[4] * size;
+  }
+
+  return (void *)planes;
+
+}
+
+/* Deallocate field array. */
+void deallocFieldArray( void *array )
+{
+
+  void **table;
+
+  if( array == NULL )
+    return;
+
+  table = (void **)array - 1;
+  free( table[0] );
+  free( table );
+
+  return;
+
+}
+
 /* Report total memory allocation. */
 void allocArrayReport()
 {
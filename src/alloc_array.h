@@ -27,8 +27,21 @@
 
 #include <malloc.h>
 
+/* Alignment of field array data in bytes. */
+#define FIELD_ALIGNMENT 64
+
+/* Offset of element (i,j,k) in the data of a field array with strides si and sj. */
+#define FIELD_INDEX( i , j , k , si , sj ) ( (size_t)(i) * (si) + (size_t)(j) * (sj) + (size_t)(k) )
+
+/* Pointer to the first element of the contiguous data of a field array. */
+#define FIELD_DATA( array ) ( (array)[0][0] )
+
 void *allocArray( unsigned long *bytes , size_t size , unsigned int dimension , ... );
 void deallocArray( void * array , unsigned int dimension , ... );
+void *allocFieldArray( unsigned long *bytes , size_t size , int ni , int nj , int nk );
+void *allocFieldArrayRegion( unsigned long *bytes , size_t size , int ni , int nj , int nk , int lim[6] );
+void deallocFieldArray( void *array );
+void getFieldArrayStrides( size_t size , int nj , int nk , size_t *strideI , size_t *strideJ );
 void allocArrayReport( void );
 
 #endif
@@ -0,0 +1,504 @@
+/* 
+ * This file is part of Vulture.
+ *
+ * Vulture finite-difference time-domain electromagnetic solver.
+ * Copyright (C) 2011-2016 Ian David Flintoft
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ *
+ * Author: Ian Flintoft <ian.flintoft@googlemail.com>
+ *
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef WITH_OPENMP
+  #include <omp.h>
+#endif
+
+#include "autotune.h"
+#include "fdtd_types.h"
+#include "message.h"
+#include "grid.h"
+#include "simd.h"
+#include "surface.h"
+#include "block.h"
+#include "balance.h"
+#include "domain.h"
+#include "util.h"
+
+/* Number of trial time steps timed for each configuration. */
+#define AUTOTUNE_STEPS 4
+
+/* Number of times each configuration is timed - the fastest is used. */
+#define AUTOTUNE_REPEATS 3
+
+/* Maximum length of the processor model in a wisdom key. */
+#define WISDOM_MODEL_SIZE 256
+
+/* Maximum length of a wisdom key - processor model, three cell counts and threads. */
+#define WISDOM_KEY_SIZE ( WISDOM_MODEL_SIZE + 64 )
+
+/* Maximum length of a line in the wisdom file - key and configuration. */
+#define WISDOM_LINE_SIZE ( WISDOM_KEY_SIZE + 128 )
+
+/* Maximum number of tile sizes tried. */
+#define MAX_TILE_CANDIDATES 8
+
+/* 
+ * Configuration of the update kernels. The SIMD level is -1 if the 
+ * SIMD kernels are not built.
+ */
+typedef struct TuneConfig_t {
+
+  GridKernel kernel;
+  int tile[2];
+  int simdLevel;
+  int numThreads;
+  double stepTime;
+
+} TuneConfig;
+
+/* 
+ * Private data.
+ */
+
+/* Autotuning is off by default. */
+static bool isAutotune = false;
+
+/* Wisdom file name. */
+static char wisdomFileName[PATH_SIZE] = DEFAULT_WISDOM_FILE;
+
+/* 
+ * Private method interfaces. 
+ */
+
+static bool getWisdomKey( char key[] , int size );
+static bool readWisdom( char *key , TuneConfig *config );
+static void writeWisdom( char *key , TuneConfig *config );
+static void getCurrentConfig( TuneConfig *config );
+static void applyConfig( TuneConfig *config );
+static void tuneConfig( TuneConfig *best );
+static void tryConfig( TuneConfig *config , TuneConfig *best );
+static void trialStep( void );
+static void reportConfig( char *prefix , TuneConfig *config );
+static char *getConfigSimdName( TuneConfig *config );
+
+/*
+ * Method Implementations.
+ */
+
+/* Enable or disable autotuning. */
+void setAutotune( bool enable )
+{
+
+  isAutotune = enable;
+
+  return;
+
+}
+
+/* Set the wisdom file name. */
+void setWisdomFileName( char *fileName )
+{
+
+  strncpy( wisdomFileName , fileName , PATH_SIZE - 1 );
+  wisdomFileName[PATH_SIZE-1] = '\0';
+
+  return;
+
+}
+
+/* 
+ * Select the grid kernel, tile size, SIMD level and number of threads. A 
+ * configuration saved in the wisdom file for this processor and grid is used
+ * if there is one. Otherwise short trials of the candidate configurations are
+ * timed and the fastest is saved. The trials step the grid, boundaries, blocks
+ * and surfaces without sources so the fields, which are zero before the first
+ * time step, are left unchanged. This must be called after all the updates 
+ * are initialised and before the fields are stepped.
+ */
+void autotune( void )
+{
+
+  char key[WISDOM_KEY_SIZE];
+  bool isKey;
+  TuneConfig best;
+
+  if( !isAutotune )
+    return;
+
+  message( MSG_LOG , 0 , "\nAutotuning update kernels...\n\n" );
+
+  isKey = getWisdomKey( key , WISDOM_KEY_SIZE );
+
+  if( isKey && readWisdom( key , &best ) )
+  {
+    message( MSG_LOG , 0 , "  Using wisdom from %s\n" , wisdomFileName );
+    applyConfig( &best );
+  }
+  else
+  {
+    tuneConfig( &best );
+    applyConfig( &best );
+    if( isKey && isRootDomain() )
+      writeWisdom( key , &best );
+  }
+
+  reportConfig( "  Selected" , &best );
+
+  /* The trial steps are not part of the run. */
+  resetBalanceTimes();
+
+  return;
+
+}
+
+/* 
+ * Wisdom key - processor model, number of cells and maximum number of threads,
+ * separated by tabs. The model is limited to WISDOM_MODEL_SIZE - 1 characters 
+ * so the key always fits in a wisdom file line. Returns false if the key cannot
+ * be formed, in which case the wisdom file is not used.
+ */
+static bool getWisdomKey( char key[] , int size )
+{
+
+  char cpuModel[PATH_SIZE];
+  int numMeshCells[3];
+  int maxThreads = 1;
+  int length;
+
+  getCpuModel( cpuModel , PATH_SIZE );
+  getGridNumCells( numMeshCells );
+#ifdef WITH_OPENMP
+  maxThreads = omp_get_max_threads();
+#endif
+
+  if( strlen( cpuModel ) >= WISDOM_MODEL_SIZE )
+  {
+    message( MSG_WARN , 0 , "  *** Warning: Processor model name too long - not using wisdom file\n" );
+    return false;
+  }
+
+  length = snprintf( key , size , "%.*s\t%d %d %d\t%d" , WISDOM_MODEL_SIZE - 1 , cpuModel , 
+                     numMeshCells[XDIR] , numMeshCells[YDIR] , numMeshCells[ZDIR] , maxThreads );
+
+  if( length < 0 || length >= size )
+  {
+    message( MSG_WARN , 0 , "  *** Warning: Wisdom key too long - not using wisdom file\n" );
+    return false;
+  }
+
+  return true;
+
+}
+
+/* Find the configuration for a key in the wisdom file - returns false if there is none. */
+static bool readWisdom( char *key , TuneConfig *config )
+{
+
+  char line[WISDOM_LINE_SIZE];
+  char kernelName[TAG_SIZE];
+  char simdName[TAG_SIZE];
+  size_t keyLength = strlen( key );
+  bool isFound = false;
+  FILE *fp;
+
+  fp = fopen( wisdomFileName , "r" );
+  if( !fp )
+    return false;
+
+  while( !isFound && fgets( line , WISDOM_LINE_SIZE , fp ) )
+  {
+    if( line[0] == '#' || strncmp( line , key , keyLength ) != 0 || line[keyLength] != '\t' )
+      continue;
+
+    if( sscanf( line + keyLength + 1 , "%31s %d %d %31s %d %lf" , kernelName , &config->tile[0] , &config->tile[1] , 
+                simdName , &config->numThreads , &config->stepTime ) != 6 )
+    {
+      message( MSG_WARN , 0 , "  *** Warning: Ignoring invalid entry in wisdom file %s\n" , wisdomFileName );
+      continue;
+    }
+
+    config->kernel = GK_UNDEFINED;
+    for( GridKernel kernel = GK_STANDARD ; kernel < GK_UNDEFINED ; kernel++ )
+      if( strncmp( kernelName , GRID_KERNEL_STR[kernel] , TAG_SIZE ) == 0 )
+        config->kernel = kernel;
+
+    config->simdLevel = -1;
+#ifdef USE_SIMD_KERNELS
+    for( SimdLevel level = SL_GENERIC ; level < SL_UNDEFINED ; level++ )
+      if( strncmp( simdName , SIMD_LEVEL_STR[level] , TAG_SIZE ) == 0 )
+        config->simdLevel = level;
+    if( config->simdLevel < 0 || config->simdLevel > getSimdLevel() )
+      config->simdLevel = getSimdLevel();
+#endif
+
+    isFound = ( config->kernel != GK_UNDEFINED && config->tile[0] > 0 && config->tile[1] > 0 && config->numThreads > 0 );
+  }
+
+  fclose( fp );
+
+  return isFound;
+
+}
+
+/* Save the configuration for a key in the wisdom file, replacing any existing entry. */
+static void writeWisdom( char *key , TuneConfig *config )
+{
+
+  char tmpFileName[PATH_SIZE+4];
+  char line[WISDOM_LINE_SIZE];
+  size_t keyLength = strlen( key );
+  FILE *in;
+  FILE *out;
+
+  snprintf( tmpFileName , PATH_SIZE + 4 , "%s.tmp" , wisdomFileName );
+
+  out = fopen( tmpFileName , "w" );
+  if( !out )
+  {
+    message( MSG_WARN , 0 , "  *** Warning: Cannot write wisdom file %s\n" , tmpFileName );
+    return;
+  }
+
+  in = fopen( wisdomFileName , "r" );
+  if( in )
+  {
+    while( fgets( line , WISDOM_LINE_SIZE , in ) )
+      if( strncmp( line , key , keyLength ) != 0 || line[keyLength] != '\t' )
+        fputs( line , out );
+    fclose( in );
+  }
+  else
+  {
+    fprintf( out , "# Vulture wisdom: CPU model, cells, maximum threads, kernel, tile size, SIMD level, threads, time step [s]\n" );
+  }
+
+  fprintf( out , "%s\t%s %d %d %s %d %e\n" , key , GRID_KERNEL_STR[config->kernel] , config->tile[0] , config->tile[1] , 
+           getConfigSimdName( config ) , config->numThreads , config->stepTime );
+
+  fclose( out );
+
+  if( rename( tmpFileName , wisdomFileName ) != 0 )
+    message( MSG_WARN , 0 , "  *** Warning: Cannot write wisdom file %s\n" , wisdomFileName );
+  else
+    message( MSG_LOG , 0 , "  Saved wisdom in %s\n" , wisdomFileName );
+
+  return;
+
+}
+
+/* Get the configuration in use. */
+static void getCurrentConfig( TuneConfig *config )
+{
+
+  config->kernel = getGridKernel();
+  getGridTileSize( config->tile );
+#ifdef USE_SIMD_KERNELS
+  config->simdLevel = getSimdLevel();
+#else
+  config->simdLevel = -1;
+#endif
+#ifdef WITH_OPENMP
+  config->numThreads = omp_get_max_threads();
+#else
+  config->numThreads = 1;
+#endif
+  config->stepTime = 0.0;
+
+  return;
+
+}
+
+/* Use a configuration. */
+static void applyConfig( TuneConfig *config )
+{
+
+  setGridKernel( GRID_KERNEL_STR[config->kernel] );
+  setGridTileSize( config->tile );
+#ifdef USE_SIMD_KERNELS
+  setSimdLevel( SIMD_LEVEL_STR[config->simdLevel] );
+  initSimd();
+#endif
+#ifdef WITH_OPENMP
+  omp_set_num_threads( config->numThreads );
+#endif
+
+  return;
+
+}
+
+/* 
+ * Search for the fastest configuration one parameter at a time: the kernel and
+ * tile size using all the threads, then the SIMD level and finally the number
+ * of threads.
+ */
+static void tuneConfig( TuneConfig *best )
+{
+
+  TuneConfig initial;
+  TuneConfig config;
+  int lim[6];
+  int numTiles = 0;
+  int tiles[MAX_TILE_CANDIDATES][2];
+  bool isNew;
+
+  getCurrentConfig( &initial );
+  *best = initial;
+  best->stepTime = -1.0;
+
+  /* Tile sizes - multiples and fractions of the default in j, whole k-pencils. */
+  getUnionFieldLimits( gfilim , EX , HZ , lim );
+  for( int scale = -2 ; scale <= 2 ; scale++ )
+  {
+    config.tile[0] = scale < 0 ? initial.tile[0] >> -scale : initial.tile[0] << scale;
+    config.tile[1] = initial.tile[1];
+    if( config.tile[0] < 1 ) config.tile[0] = 1;
+    if( config.tile[0] > lim[YHI] - lim[YLO] + 1 ) config.tile[0] = lim[YHI] - lim[YLO] + 1;
+    isNew = true;
+    for( int tile = 0 ; tile < numTiles ; tile++ )
+      if( tiles[tile][0] == config.tile[0] && tiles[tile][1] == config.tile[1] ) isNew = false;
+    if( isNew )
+    {
+      tiles[numTiles][0] = config.tile[0];
+      tiles[numTiles][1] = config.tile[1];
+      numTiles++;
+    }
+  }
+  tiles[numTiles][0] = initial.tile[0];
+  tiles[numTiles][1] = lim[ZHI] - lim[ZLO] + 1;
+  if( tiles[numTiles][1] != initial.tile[1] ) numTiles++;
+
+  /* Kernels and tile sizes. */
+  for( GridKernel kernel = GK_STANDARD ; kernel < GK_UNDEFINED ; kernel++ )
+  {
+    config = initial;
+    config.kernel = kernel;
+    if( kernel != GK_TILED )
+    {
+      tryConfig( &config , best );
+      continue;
+    }
+    for( int tile = 0 ; tile < numTiles ; tile++ )
+    {
+      config.tile[0] = tiles[tile][0];
+      config.tile[1] = tiles[tile][1];
+      tryConfig( &config , best );
+    }
+  }
+
+  /* SIMD levels. */
+#ifdef USE_SIMD_KERNELS
+  for( int level = SL_GENERIC ; level < initial.simdLevel ; level++ )
+  {
+    config = *best;
+    config.simdLevel = level;
+    tryConfig( &config , best );
+  }
+#endif
+
+  /* Numbers of threads. */
+  for( int numThreads = 1 ; numThreads < initial.numThreads ; numThreads *= 2 )
+  {
+    config = *best;
+    config.numThreads = numThreads;
+    tryConfig( &config , best );
+  }
+
+  return;
+
+}
+
+/* Time the trial steps of a configuration and keep it if it is the fastest so far. */
+static void tryConfig( TuneConfig *config , TuneConfig *best )
+{
+
+  double start;
+  double stepTime;
+
+  applyConfig( config );
+
+  /* Warm up. */
+  trialStep();
+
+  config->stepTime = -1.0;
+  for( int repeat = 0 ; repeat < AUTOTUNE_REPEATS ; repeat++ )
+  {
+    start = getWorkTime();
+    for( int step = 0 ; step < AUTOTUNE_STEPS ; step++ )
+      trialStep();
+    stepTime = ( getWorkTime() - start ) / AUTOTUNE_STEPS;
+    if( config->stepTime < 0.0 || stepTime < config->stepTime )
+      config->stepTime = stepTime;
+  }
+
+  reportConfig( "  Trial" , config );
+
+  if( best->stepTime < 0.0 || config->stepTime < best->stepTime )
+    *best = *config;
+
+  return;
+
+}
+
+/* Step the fields without sources, observers or halo exchanges. */
+static void trialStep( void )
+{
+
+  updateExternalSurfacesEfield();
+  updateGridEfield();
+  updateBlocksEfield();
+  updateInternalSurfacesEfield();
+  updateExternalSurfacesHfield();
+  updateGridHfield();
+  updateBlocksHfield();
+  updateInternalSurfacesHfield();
+
+  return;
+
+}
+
+/* Name of the SIMD level of a configuration. */
+static char *getConfigSimdName( TuneConfig *config )
+{
+
+#ifdef USE_SIMD_KERNELS
+  if( config->simdLevel >= 0 )
+    return SIMD_LEVEL_STR[config->simdLevel];
+#endif
+
+  return "NONE";
+
+}
+
+/* Log a configuration. */
+static void reportConfig( char *prefix , TuneConfig *config )
+{
+
+  char tile[TAG_SIZE] = "";
+
+  if( config->kernel == GK_TILED )
+    snprintf( tile , TAG_SIZE , " %dx%d" , config->tile[0] , config->tile[1] );
+
+  message( MSG_LOG , 0 , "%s: kernel %s%s, SIMD %s, %d thread(s): %e s/step\n" , prefix , GRID_KERNEL_STR[config->kernel] , tile , 
+           getConfigSimdName( config ) , config->numThreads , config->stepTime );
+
+  return;
+
+}
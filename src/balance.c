@@ -0,0 +1,444 @@
+/* 
+ * This file is part of Vulture.
+ *
+ * Vulture finite-difference time-domain electromagnetic solver.
+ * Copyright (C) 2011-2016 Ian David Flintoft
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ *
+ * Author: Ian Flintoft <ian.flintoft@googlemail.com>
+ *
+ */
+
+/* For clock_gettime. */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#ifdef WITH_OPENMP
+  #include <omp.h>
+#endif
+
+#include "balance.h"
+#include "fdtd_types.h"
+#include "alloc_array.h"
+#include "message.h"
+#include "memory.h"
+
+/* 
+ * Private data.
+ */
+
+/* Maximum length of a report line or cost weight list. */
+#define REPORT_LINE_SIZE 256
+
+/* Number of busy time slots per thread - keeps each thread's slots on their own cache line. */
+#define BUSY_STRIDE 8
+
+/* Work type names. */
+static char WORK_TYPE_STR[NUM_WORK_TYPES][TAG_SIZE] = { "GRID" , "PML" , "DEBYE" , "SIBC" };
+
+/* 
+ * Cost of updating one field element of each subsystem relative to a field element of
+ * the main grid. The Debye weight is per pole.
+ */
+static double costWeight[NUM_WORK_TYPES] = { 1.0 , 2.0 , 2.0 , 20.0 };
+
+/* Number of threads the work is partitioned between. */
+static int numWorkers = 1;
+
+/* Time each thread spends updating each subsystem. */
+static double **busyTime = NULL;
+
+/* Elapsed time of the sweeps of each subsystem. */
+static double sweepTime[NUM_WORK_TYPES] = { 0.0 };
+
+/* Number of sweeps of and field element updates by each subsystem. */
+static unsigned long numSweeps[NUM_WORK_TYPES] = { 0 };
+static double numCellUpdates[NUM_WORK_TYPES] = { 0.0 };
+
+/*
+ * Method Implementations.
+ */
+
+/* Set cost weights from a list of the form <type>=<weight>[,<type>=<weight>...]. */
+bool setCostWeights( char *spec )
+{
+
+  char buffer[REPORT_LINE_SIZE];
+  char *token;
+  char *value;
+  char *end;
+  double weight;
+  bool isFound;
+
+  strncpy( buffer , spec , REPORT_LINE_SIZE - 1 );
+  buffer[REPORT_LINE_SIZE-1] = '\0';
+
+  for( token = strtok( buffer , "," ) ; token != NULL ; token = strtok( NULL , "," ) )
+  {
+    value = strchr( token , '=' );
+    if( value == NULL )
+      return false;
+    *value++ = '\0';
+
+    weight = strtod( value , &end );
+    if( end == value || *end != '\0' || weight <= 0.0 )
+      return false;
+
+    isFound = false;
+    for( WorkType type = WT_GRID ; type < NUM_WORK_TYPES ; type++ )
+    {
+      if( strcasecmp( token , WORK_TYPE_STR[type] ) == 0 )
+      {
+        costWeight[type] = weight;
+        isFound = true;
+      }
+    }
+
+    if( !isFound )
+      return false;
+  }
+
+  return true;
+
+}
+
+/* Get cost weight of a subsystem. */
+double getCostWeight( WorkType type )
+{
+
+  return costWeight[type];
+
+}
+
+/* Initialise load balancing. */
+/* Depends: number of threads set. */
+void initBalance( void )
+{
+
+  unsigned long bytes;
+
+  message( MSG_LOG , 0 , "\nInitialising load balancing...\n\n" );
+
+#ifdef WITH_OPENMP
+  numWorkers = omp_get_max_threads();
+#endif
+
+  busyTime = allocArray( &bytes , sizeof( double ) , 2 , numWorkers , BUSY_STRIDE );
+  memory.grid += bytes;
+  for( int worker = 0 ; worker < numWorkers ; worker++ )
+    for( int type = 0 ; type < BUSY_STRIDE ; type++ )
+      busyTime[worker][type] = 0.0;
+
+  message( MSG_LOG , 0 , "  Number of workers: %d\n" , numWorkers );
+  message( MSG_LOG , 0 , "  Cost weights: GRID=%g PML=%g DEBYE=%g (per pole) SIBC=%g\n" , 
+           costWeight[WT_GRID] , costWeight[WT_PML] , costWeight[WT_DEBYE] , costWeight[WT_SIBC] );
+
+  return;
+
+}
+
+/* Number of parts work is partitioned into - the maximum number of threads. */
+int getNumWorkParts( void )
+{
+
+  return numWorkers;
+
+}
+
+/* Number of the calling thread in the current team. */
+int getWorkerNumber( void )
+{
+
+#ifdef WITH_OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+
+}
+
+/* Number of threads in the current team. */
+int getNumWorkers( void )
+{
+
+#ifdef WITH_OPENMP
+  return omp_get_num_threads();
+#else
+  return 1;
+#endif
+
+}
+
+/* 
+ * Partition items firstItem to firstItem+numItems-1 with costs cost[item] between the
+ * threads. Each item is given to the part containing the middle of its cost so that
+ * the parts differ from the mean by at most one item.
+ */
+void partitionWork( WorkPartition *partition , WorkType type , double *cost , int firstItem , int numItems , unsigned long numCells )
+{
+
+  unsigned long bytes;
+  double sum = 0.0;
+  double target;
+  int item;
+
+  partition->type = type;
+  partition->numParts = numWorkers;
+  partition->numCells = numCells;
+  partition->first = allocArray( &bytes , sizeof( int ) , 1 , numWorkers + 1 );
+  memory.grid += bytes;
+
+  partition->totalCost = 0.0;
+  for( item = firstItem ; item < firstItem + numItems ; item++ )
+    partition->totalCost += cost[item];
+
+  item = firstItem;
+  partition->first[0] = firstItem;
+  for( int part = 1 ; part < numWorkers ; part++ )
+  {
+    target = partition->totalCost * part / numWorkers;
+    while( item < firstItem + numItems && sum + 0.5 * cost[item] < target )
+      sum += cost[item++];
+    partition->first[part] = item;
+  }
+  partition->first[numWorkers] = firstItem + numItems;
+
+  return;
+
+}
+
+/* Get the range of items in a part of a partition. The range is empty if last < first. */
+void getWorkPart( WorkPartition *partition , int part , int *first , int *last )
+{
+
+  *first = partition->first[part];
+  *last = partition->first[part+1] - 1;
+
+  return;
+
+}
+
+/* Deallocate a partition. */
+void deallocWorkPartition( WorkPartition *partition )
+{
+
+  if( partition->first != NULL )
+    deallocArray( partition->first , 1 , partition->numParts + 1 );
+
+  partition->first = NULL;
+  partition->numParts = 0;
+
+  return;
+
+}
+
+/* Wall clock time in seconds. */
+double getWorkTime( void )
+{
+
+#ifdef WITH_OPENMP
+  return omp_get_wtime();
+#else
+  struct timespec now;
+
+  clock_gettime( CLOCK_MONOTONIC , &now );
+
+  return (double) now.tv_sec + 1e-9 * (double) now.tv_nsec;
+#endif
+
+}
+
+/* 
+ * Add to the time the calling thread spent working on a subsystem. Threads of 
+ * nested teams, such as those started inside tasks, are charged to the thread 
+ * of the outermost team that started them.
+ */
+void addBusyTime( WorkType type , double elapsed )
+{
+
+  int worker = 0;
+
+  if( busyTime == NULL )
+    return;
+
+#ifdef WITH_OPENMP
+  if( omp_get_level() > 0 )
+    worker = omp_get_ancestor_thread_num( 1 ) % numWorkers;
+#endif
+
+  busyTime[worker][type] += elapsed;
+
+  return;
+
+}
+
+/* Add the elapsed time and number of field element updates of a sweep of a subsystem. */
+void addSweepTime( WorkType type , double elapsed , unsigned long numCells )
+{
+
+  #ifdef WITH_OPENMP
+    #pragma omp critical( balanceSweep )
+  #endif
+  {
+    sweepTime[type] += elapsed;
+    numCellUpdates[type] += (double) numCells;
+    numSweeps[type]++;
+  }
+
+  return;
+
+}
+
+/* 
+ * Report the per-thread busy times of the balanced subsystems and the cost
+ * weights measured during the run. The measured weights can be passed back 
+ * with the cost weights option.
+ */
+void reportBalance( void )
+{
+
+  double gridCost = 0.0;
+  double totalBusy;
+  double maxBusy;
+  char line[REPORT_LINE_SIZE];
+  size_t length;
+  bool isBusy[NUM_WORK_TYPES] = { false };
+  bool isAnyBusy = false;
+
+  message( MSG_LOG , 0 , "\nLoad balance:\n\n" );
+
+  for( WorkType type = WT_GRID ; type < NUM_WORK_TYPES ; type++ )
+  {
+    if( numSweeps[type] == 0 )
+      continue;
+    message( MSG_LOG , 0 , "  %-5s: %lu sweeps, %g element updates in %g s\n" , WORK_TYPE_STR[type] , 
+             numSweeps[type] , numCellUpdates[type] , sweepTime[type] );
+    for( int worker = 0 ; worker < numWorkers ; worker++ )
+      if( busyTime[worker][type] > 0.0 )
+        isBusy[type] = isAnyBusy = true;
+  }
+
+  if( !isAnyBusy )
+    return;
+
+  /* Busy time of each thread. */
+  message( MSG_LOG , 0 , "\n  Thread busy times (s):\n\n" );
+  length = snprintf( line , REPORT_LINE_SIZE , "    %8s" , "Thread" );
+  for( WorkType type = WT_GRID ; type < NUM_WORK_TYPES ; type++ )
+    if( isBusy[type] )
+      length += snprintf( line + length , REPORT_LINE_SIZE - length , " %12s" , WORK_TYPE_STR[type] );
+  message( MSG_LOG , 0 , "%s\n" , line );
+
+  for( int worker = 0 ; worker < numWorkers ; worker++ )
+  {
+    length = snprintf( line , REPORT_LINE_SIZE , "    %8d" , worker );
+    for( WorkType type = WT_GRID ; type < NUM_WORK_TYPES ; type++ )
+      if( isBusy[type] && length < REPORT_LINE_SIZE )
+        length += snprintf( line + length , REPORT_LINE_SIZE - length , " %12.4e" , busyTime[worker][type] );
+    message( MSG_LOG , 0 , "%s\n" , line );
+  }
+
+  /* Ratio of maximum to mean busy time. */
+  length = snprintf( line , REPORT_LINE_SIZE , "    %8s" , "Max/mean" );
+  for( WorkType type = WT_GRID ; type < NUM_WORK_TYPES ; type++ )
+  {
+    if( !isBusy[type] )
+      continue;
+    totalBusy = 0.0;
+    maxBusy = 0.0;
+    for( int worker = 0 ; worker < numWorkers ; worker++ )
+    {
+      totalBusy += busyTime[worker][type];
+      if( busyTime[worker][type] > maxBusy ) maxBusy = busyTime[worker][type];
+    }
+    if( length < REPORT_LINE_SIZE )
+      length += snprintf( line + length , REPORT_LINE_SIZE - length , " %12.4f" , maxBusy / ( totalBusy / numWorkers ) );
+  }
+  message( MSG_LOG , 0 , "%s\n" , line );
+
+  /* Measured cost of a field element update relative to the grid. */
+  if( numCellUpdates[WT_GRID] > 0.0 )
+    gridCost = sweepTime[WT_GRID] * numWorkers / numCellUpdates[WT_GRID];
+
+  if( gridCost > 0.0 )
+  {
+    length = snprintf( line , REPORT_LINE_SIZE , "GRID=1" );
+    for( WorkType type = WT_PML ; type < NUM_WORK_TYPES ; type++ )
+    {
+      if( !isBusy[type] || numCellUpdates[type] <= 0.0 )
+        continue;
+      totalBusy = 0.0;
+      for( int worker = 0 ; worker < numWorkers ; worker++ )
+        totalBusy += busyTime[worker][type];
+      if( length < REPORT_LINE_SIZE )
+        length += snprintf( line + length , REPORT_LINE_SIZE - length , ",%s=%.3g" , WORK_TYPE_STR[type] , 
+                            totalBusy / numCellUpdates[type] / gridCost );
+    }
+    message( MSG_LOG , 0 , "\n  Measured cost weights: %s\n" , line );
+  }
+
+  return;
+
+}
+
+/* Discard the times recorded so far, for example those of trial time steps. */
+void resetBalanceTimes( void )
+{
+
+  for( int thread = 0 ; thread < numWorkers ; thread++ )
+    for( WorkType type = 0 ; type < NUM_WORK_TYPES ; type++ )
+      busyTime[thread][type] = 0.0;
+
+  for( WorkType type = 0 ; type < NUM_WORK_TYPES ; type++ )
+  {
+    sweepTime[type] = 0.0;
+    numSweeps[type] = 0;
+    numCellUpdates[type] = 0.0;
+  }
+
+  return;
+
+}
+
+/* Get the number of sweeps of a subsystem and the field element updates and time they took. */
+void getSweepStats( WorkType type , unsigned long *sweeps , double *cellUpdates , double *elapsed )
+{
+
+  *sweeps = numSweeps[type];
+  *cellUpdates = numCellUpdates[type];
+  *elapsed = sweepTime[type];
+
+  return;
+
+}
+
+/* Deallocate load balancing data. */
+void deallocBalance( void )
+{
+
+  if( busyTime != NULL )
+    deallocArray( busyTime , 2 , numWorkers , BUSY_STRIDE );
+
+  busyTime = NULL;
+
+  return;
+
+}
@@ -0,0 +1,76 @@
+/* 
+ * This file is part of Vulture.
+ *
+ * Vulture finite-difference time-domain electromagnetic solver.
+ * Copyright (C) 2011-2016 Ian David Flintoft
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ *
+ * Author: Ian Flintoft <ian.flintoft@googlemail.com>
+ *
+ */
+
+#ifndef _BALANCE_H_
+#define _BALANCE_H_
+
+#include <stdbool.h>
+
+/* Subsystems with different update costs per field element. */
+typedef enum {
+
+  WT_GRID,
+  WT_PML,
+  WT_DEBYE,
+  WT_SIBC,
+  NUM_WORK_TYPES
+
+} WorkType;
+
+/* 
+ * Partition of a list of work items into contiguous parts of equal total cost,
+ * one part per thread. Part p holds items first[p] to first[p+1]-1.
+ */
+typedef struct WorkPartition_t {
+
+  WorkType type;           // Subsystem doing the work.
+  int numParts;            // Number of parts.
+  int *first;              // First item of each part.
+  double totalCost;        // Total cost of the items in grid field element updates.
+  unsigned long numCells;  // Number of field elements updated by the items.
+
+} WorkPartition;
+
+/*
+ * Public method interfaces.
+ */
+
+bool setCostWeights( char *spec );
+double getCostWeight( WorkType type );
+void initBalance( void );
+int getNumWorkParts( void );
+int getWorkerNumber( void );
+int getNumWorkers( void );
+void partitionWork( WorkPartition *partition , WorkType type , double *cost , int firstItem , int numItems , unsigned long numCells );
+void getWorkPart( WorkPartition *partition , int part , int *first , int *last );
+void deallocWorkPartition( WorkPartition *partition );
+double getWorkTime( void );
+void addBusyTime( WorkType type , double elapsed );
+void addSweepTime( WorkType type , double elapsed , unsigned long numCells );
+void resetBalanceTimes( void );
+void getSweepStats( WorkType type , unsigned long *sweeps , double *cellUpdates , double *elapsed );
+void reportBalance( void );
+void deallocBalance( void );
+
+#endif
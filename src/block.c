@@ -53,7 +53,7 @@ static BlockItem *blockList = NULL;
  * Private method interfaces. 
  */
 
-void setMediumOnMesh( MediumIndex ***cellArray , int mbbox[6] , MediumIndex medium );
+void setMediumOnMesh( void ***cellArray , int mbbox[6] , MediumIndex medium );
 
 /*
  * Method Implementations.
@@ -157,15 +157,15 @@ void initBlocks( void )
 
   /* Temporary array for block media. */
   #if USE_AVERAGED_MEDIA
-    MediumIndex ***blockArray;
+    void ***blockArray;
     unsigned long bytes;
     message( MSG_DEBUG1 , 0 , "  Allocating mesh block array\n" );
-    blockArray = allocArray( &bytes , sizeof( MediumIndex ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    blockArray = allocArray( &bytes , mediumIndexSize , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
 
     for ( int i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
       for ( int j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
         for ( int k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
-          blockArray[i][j][k] = MT_FREE_SPACE;
+          SET_MEDIUM_INDEX( blockArray , i , j , k , MT_FREE_SPACE );
   #endif
           
   /* Apply simple media using medium coefficients. */
@@ -228,14 +228,14 @@ void initBlocks( void )
 }
 
 /* Set medium on temporary cell array. */
-void setMediumOnMesh( MediumIndex ***blockArray , int gbbox[6] , MediumIndex medium )
+void setMediumOnMesh( void ***blockArray , int gbbox[6] , MediumIndex medium )
 {
 
   /* Care - upper index one less than bbox because these are cells! */
   for( int i = gbbox[XLO]  ; i < gbbox[XHI] ; i++ )
     for( int j = gbbox[YLO]  ; j < gbbox[YHI] ; j++ )
       for( int k = gbbox[ZLO]  ; k < gbbox[ZHI] ; k++ )
-        blockArray[i][j][k] = medium;
+        SET_MEDIUM_INDEX( blockArray , i , j , k , medium );
 
   return;
 
@@ -302,6 +302,16 @@ void updateBlocksEfield( void )
   
 }
 
+/* Block electric field updates of one component - the components are independent. */
+void updateBlocksEfieldComponent( FieldComponent field )
+{
+  
+  updateDebyeBlocksEfieldComponent( field );
+
+  return;  
+
+}
+
 /* Block magnetic field updates. */
 void updateBlocksHfield( void )
 {
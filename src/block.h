@@ -67,6 +67,7 @@ void gmshBlocks( void );
 void reportBlocks( void );
 bool thereAreBlocks( MediumType type );
 void updateBlocksEfield( void );
+void updateBlocksEfieldComponent( FieldComponent field );
 void updateBlocksHfield( void );
 
 #endif
@@ -31,6 +31,7 @@
 #include "message.h"
 #include "grid.h"
 #include "pml.h"
+#include "mur.h"
 #include "physical.h"
 
 #ifdef WITH_SIBC
@@ -42,10 +43,10 @@
  */
 
 /* Boundary type strings. */
-char BOUNDARY_TYPE_STR[NUM_BOUNDARY_TYPES][11] = { "PMC" , "PML" , "PEC" , "FREE_SPACE" , "PERIODIC" , "MUR" , "SIBC" };
+char BOUNDARY_TYPE_STR[NUM_BOUNDARY_TYPES][11] = { "PMC" , "PML" , "PEC" , "FREE_SPACE" , "PERIODIC" , "MUR" , "SIBC" , "CPML" , "HIGDON" };
 
 /* Mapping of boundary type to medium type. */
-MediumType BOUNDARY_MEDIUM_TYPE[NUM_BOUNDARY_TYPES] = { MT_UNDEFINED , MT_PEC , MT_PEC , MT_FREE_SPACE , MT_UNDEFINED , MT_UNDEFINED , MT_PEC };
+MediumType BOUNDARY_MEDIUM_TYPE[NUM_BOUNDARY_TYPES] = { MT_UNDEFINED , MT_PEC , MT_PEC , MT_FREE_SPACE , MT_UNDEFINED , MT_UNDEFINED , MT_PEC , MT_PEC , MT_UNDEFINED };
 
 /* 
  * Private data. 
@@ -119,6 +120,8 @@ bool parseBT( char *line )
   real n_eff = 0.0;
   real refCoeff = 0.0;
   real kmax = 0.0;
+  real amax = 0.0;
+  real angles[MAX_HIGDON_ORDER] = { -1.0 , -1.0 , -1.0 };
   char fileName[PATH_SIZE] = "";
   BoundaryIndex number;
   real S_TM[2][2] = { { -1.0 , 0.0 } , { 0.0 , -1.0 } };
@@ -174,11 +177,49 @@ bool parseBT( char *line )
                          &order , &n_eff , &refCoeff , &kmax  );
     if( numScanned < 2 )
       assert( 0 );   
+    /* Automatic PML - select the order too if it is not given. */
+    if( numLayers == 0 && numScanned < 4 )
+      order = 0;
+    break;
+  case BT_CPML:
+    setCpmlDefaults( &numLayers , &order , &n_eff , &refCoeff , &kmax , &amax );
+    numScanned = sscanf( line , "%31s %31s %d %d %e %e %e %e" , name , typeStr , &numLayers , 
+                         &order , &n_eff , &refCoeff , &kmax , &amax );
+    if( numScanned < 2 )
+      assert( 0 );   
+    if( numLayers == 0 && numScanned < 4 )
+      order = 0;
+    if( amax < 0.0 )
+    {
+      message( MSG_LOG , 0 , "  Invalid maximum frequency shift %g in CPML boundary card\n" , amax );
+      return false;
+    }
     break;
   case BT_MUR:
     numLayers = 0;
     refCoeff = 0.0;   
     break;
+  case BT_HIGDON:
+    numLayers = 0;
+    refCoeff = 0.0;
+    order = 2;
+    numScanned = sscanf( line , "%31s %31s %d %e %e %e" , name , typeStr , &order , 
+                         &angles[0] , &angles[1] , &angles[2] );
+    if( numScanned < 2 )
+      assert( 0 );   
+    if( order < 1 || order > MAX_HIGDON_ORDER )
+    {
+      message( MSG_LOG , 0 , "  Invalid order %d in HIGDON boundary card\n" , order );
+      return false;
+    }
+    setHigdonDefaults( order , angles );
+    for( int angle = 0 ; angle < order ; angle++ )
+      if( angles[angle] >= 90.0 )
+      {
+        message( MSG_LOG , 0 , "  Invalid angle %g in HIGDON boundary card\n" , angles[angle] );
+        return false;
+      }
+    break;
   case BT_SIBC:
     /* See if scattering parameters given. */
     numScanned = sscanf( line , "%31s %31s %e %e %e %e %e %e %e %e" , name , typeStr , 
@@ -212,7 +253,7 @@ bool parseBT( char *line )
     break;
   }
 
-  addBoundary( name , type , numLayers , order , n_eff , refCoeff , kmax , fileName , S_TM , S_TE );
+  addBoundary( name , type , numLayers , order , n_eff , refCoeff , kmax , amax , angles , fileName , S_TM , S_TE );
 
   return true;
 
@@ -220,7 +261,8 @@ bool parseBT( char *line )
 
 /* Add boundary to lists. */
 void addBoundary( char *name , BoundaryType type , int numLayers , int order , 
-                  real n_eff , real refCoeff , real kmax , char *fileName , real S_TM[2][2] , real S_TE[2][2] )
+                  real n_eff , real refCoeff , real kmax , real amax , real angles[MAX_HIGDON_ORDER] , char *fileName , 
+                  real S_TM[2][2] , real S_TE[2][2] )
 {
 
   BoundaryItem *item = NULL;
@@ -240,6 +282,9 @@ void addBoundary( char *name , BoundaryType type , int numLayers , int order ,
   item->n_eff = n_eff;
   item->refCoeff = refCoeff;
   item->kmax = kmax;
+  item->amax = amax;
+  for( int angle = 0 ; angle < MAX_HIGDON_ORDER ; angle++ )
+    item->angles[angle] = angles != NULL ? angles[angle] : 0.0;
   strncpy( item->fileName , fileName , PATH_SIZE );
   if( S_TM != NULL )
     for( int i = 0 ; i <= 1 ; i++ )
@@ -351,9 +396,9 @@ void reportBoundaries( void )
 
   DL_FOREACH( boundaryList , item ) 
   {
-    message( MSG_DEBUG3 , 0 , "    Boundary #%lu: Name=%s Type=%s Layers=%d Order=%d n_eff=%e rho=%e kmax=%e file=%s\n" , 
+    message( MSG_DEBUG3 , 0 , "    Boundary #%lu: Name=%s Type=%s Layers=%d Order=%d n_eff=%e rho=%e kmax=%e amax=%e file=%s\n" , 
              (unsigned long) item->number , item->name , BOUNDARY_TYPE_STR[item->type] , 
-             item->numLayers , item->order , item->n_eff , item->refCoeff , item->kmax , item->fileName );
+             item->numLayers , item->order , item->n_eff , item->refCoeff , item->kmax , item->amax , item->fileName );
   }
 
   return;
@@ -439,7 +484,7 @@ real getBoundaryRefCoeff( BoundaryIndex number )
 }
 
 /* Get external boundary parameters by boundary number. */
-void getExternalBoundaryParams( BoundaryIndex number , int *order , real *n_eff , real *refCoeff , real *kmax )
+void getExternalBoundaryParams( BoundaryIndex number , int *order , real *n_eff , real *refCoeff , real *kmax , real *amax )
 {
   BoundaryItem *item;
 
@@ -451,8 +496,46 @@ void getExternalBoundaryParams( BoundaryIndex number , int *order , real *n_eff
   *n_eff = item->n_eff;
   *refCoeff = item->refCoeff;
   *kmax = item->kmax;
+  *amax = item->amax;
+
+  return;
+}
+
+/* Set external boundary parameters by boundary number. */
+void setExternalBoundaryParams( BoundaryIndex number , int order , real n_eff , real refCoeff , real kmax , real amax )
+{
+
+  BoundaryItem *item;
+
+  HASH_FIND( hhint , boundaryNumberHash , &number , sizeof( number ) , item );
+  if( !item)
+    assert( 0 );
+  
+  item->order = order;
+  item->n_eff = n_eff;
+  item->refCoeff = refCoeff;
+  item->kmax = kmax;
+  item->amax = amax;
 
   return;
+
+}
+
+/* Get the angles of perfect absorption of a Higdon boundary by number. */
+void getBoundaryAngles( BoundaryIndex number , real angles[MAX_HIGDON_ORDER] )
+{
+
+  BoundaryItem *item;
+
+  HASH_FIND( hhint , boundaryNumberHash , &number , sizeof( number ) , item );
+  if( !item)
+    assert( 0 );
+
+  for( int angle = 0 ; angle < MAX_HIGDON_ORDER ; angle++ )
+    angles[angle] = item->angles[angle];
+
+  return;
+
 }
 
 /* Set the number of layers by number. */
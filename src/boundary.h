@@ -45,7 +45,7 @@ typedef unsigned long BoundaryIndex;
  * *is not* included in the number NUM_BOUNDARY_TYPES.
  */
 
-#define NUM_BOUNDARY_TYPES 7
+#define NUM_BOUNDARY_TYPES 9
 
 /* Boundary types. */
 typedef enum {
@@ -59,10 +59,15 @@ typedef enum {
   BT_PERIODIC,
   BT_MUR,
   BT_SIBC,
+  BT_CPML,
+  BT_HIGDON,
   BT_UNDEFINED
   
 } BoundaryType;
 
+/* Maximum order of Higdon boundaries. */
+#define MAX_HIGDON_ORDER 3
+
 /* 
  * Boundary class. 
  */
@@ -79,6 +84,8 @@ typedef struct BoundaryItem_t {
   real n_eff;                     // Effective refractive index of dominant modes (PML).
   real refCoeff;                  // Theoretical reflection coefficient (PML).
   real kmax;                      // Maximum permittivity (kappa) of PML (PML).
+  real amax;                      // Maximum complex frequency shift (alpha) of PML (CPML).
+  real angles[MAX_HIGDON_ORDER];  // Angles of perfect absorption in degrees (HIGDON).
   char fileName[PATH_SIZE];       // Name of model file (SIBC).
   real S_TM[2][2];                 // Scattering matrix of TM mode. 
   real S_TE[2][2];                 // Scattering matrix of TE mode. 
@@ -118,7 +125,8 @@ void deallocBoundaries( void );
 void reportBoundaries( void );
 bool isBoundary( char *name , BoundaryIndex *number );
 void addBoundary( char *name , BoundaryType type , int numLayers , int order , 
-                  real n_eff , real refCoeff , real kmax , char *fileName , real S_TM[2][2] , real S_TE[2][2] );
+                  real n_eff , real refCoeff , real kmax , real amax , real angles[MAX_HIGDON_ORDER] , char *fileName , 
+                  real S_TM[2][2] , real S_TE[2][2] );
 BoundaryItem * getBoundary( BoundaryIndex number );
 BoundaryType getBoundaryType( BoundaryIndex number );
 char *getBoundaryName( BoundaryIndex number );
@@ -126,6 +134,9 @@ int getBoundaryNumLayers( BoundaryIndex number );
 real getBoundaryRefCoeff( BoundaryIndex number );
 void setBoundaryNumLayers( BoundaryIndex number , int numLayers );
 bool thereAreBoundaries( BoundaryType );
-void getExternalBoundaryParams( BoundaryIndex number , int *order , real *n_eff , real *refCoeff , real *kmax );
+void getExternalBoundaryParams( BoundaryIndex number , int *order , real *n_eff , real *refCoeff , real *kmax , real *amax );
+void setExternalBoundaryParams( BoundaryIndex number , int order , real n_eff , real refCoeff , real kmax , real amax );
+void getBoundaryAngles( BoundaryIndex number , real angles[MAX_HIGDON_ORDER] );
+void getBoundaryAngles( BoundaryIndex number , real angles[MAX_HIGDON_ORDER] );
 
 #endif
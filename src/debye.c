@@ -35,6 +35,8 @@
 #include "bounding_box.h"
 #include "memory.h"
 #include "physical.h"
+#include "domain.h"
+#include "balance.h"
 
 
 /* 
@@ -64,10 +66,37 @@ static BlockIndex numDebyeBlock = 0;
 /* Debye block array. */
 static DebyeItem *debyeArray = NULL;         
 
+/* Debye update task - a block of the cells of one field component of a Debye block. */
+typedef struct DebyeTask_t {
+
+  BlockIndex block;
+  int lim[6];
+
+} DebyeTask;
+
+/* Tasks per thread for the cost balanced update - finer tasks give a closer balance. */
+#define DEBYE_BALANCE_BLOCKS 4
+
+/* Update tasks of each electric field component. */
+static DebyeTask *debyeTasks[3] = { NULL , NULL , NULL };
+static int numDebyeTasks[3] = { 0 , 0 , 0 };
+
+/* Partitions of the tasks between the threads. If Debye blocks overlap, each block is */
+/* partitioned separately and the blocks are updated in turn. */
+static WorkPartition *debyePartitions[3] = { NULL , NULL , NULL };
+static int numDebyePartitions[3] = { 0 , 0 , 0 };
+
+/* Number of pole updates in a sweep of each field component. */
+static unsigned long numDebyePoleUpdates[3] = { 0 , 0 , 0 };
+
 /* 
  * Private method interfaces. 
  */
 
+static void initDebyeBalance( void );
+static bool isDebyeOverlap( FieldComponent field );
+static void updateDebyeTask( FieldComponent field , DebyeTask *task );
+
 /*
  * Method Implementations.
  */
@@ -107,6 +136,7 @@ void initDebyeBlocks( BlockIndex number , BlockItem *blockList )
       offsetBoundingBox( gbbox , item->mbbox , gibox );
       faceMask2boolArray( includeBoundary , item->mask );
       setFieldLimits( gbbox , flim , includeBoundary );
+      clipFieldLimitsToDomain( flim );
       for( field = EX ; field <= EZ ; field++ )
         for( MeshFace face = XLO ; face <= ZHI ; face++ )
           debyeArray[block].flim[field][face] = flim[field][face];
@@ -191,6 +221,140 @@ void initDebyeBlocks( BlockIndex number , BlockItem *blockList )
     }
   }
 
+  /* Share the updates between the threads. */
+  initDebyeBalance();
+
+  return;
+
+}
+
+/* Number of cells within limits. */
+static double getDebyeNumCells( int lim[6] )
+{
+
+  if( lim[XHI] < lim[XLO] || lim[YHI] < lim[YLO] || lim[ZHI] < lim[ZLO] )
+    return 0.0;
+
+  return (double)( lim[XHI] - lim[XLO] + 1 ) * ( lim[YHI] - lim[YLO] + 1 ) * ( lim[ZHI] - lim[ZLO] + 1 );
+
+}
+
+/* Return true if the limits of any two Debye blocks overlap for a field component. */
+static bool isDebyeOverlap( FieldComponent field )
+{
+
+  int *a , *b;
+
+  for( BlockIndex blockA = 0 ; blockA < numDebyeBlock ; blockA++ )
+    for( BlockIndex blockB = blockA + 1 ; blockB < numDebyeBlock ; blockB++ )
+    {
+      a = debyeArray[blockA].flim[field];
+      b = debyeArray[blockB].flim[field];
+      if( getDebyeNumCells( a ) > 0.0 && getDebyeNumCells( b ) > 0.0 &&
+          a[XLO] <= b[XHI] && b[XLO] <= a[XHI] && a[YLO] <= b[YHI] && b[YLO] <= a[YHI] && a[ZLO] <= b[ZHI] && b[ZLO] <= a[ZHI] )
+        return true;
+    }
+
+  return false;
+
+}
+
+/* 
+ * Divide the cells of each field component of each block into tasks in proportion
+ * to their cost and share the tasks between the threads. A cell costs the Debye 
+ * weight for each pole of its medium.
+ */
+static void initDebyeBalance( void )
+{
+
+  unsigned long bytes;
+  double totalCost;
+  double *blockCost;
+  double *cost;
+  int numTasks;
+  int numParts;
+  int firstTask;
+  LoopDecomp decomp;
+
+  if( numDebyeBlock == 0 )
+    return;
+
+  blockCost = allocArray( &bytes , sizeof( double ) , 1 , numDebyeBlock );
+
+  for( FieldComponent field = EX ; field <= EZ ; field++ )
+  {
+
+    totalCost = 0.0;
+    numDebyePoleUpdates[field] = 0;
+    for( BlockIndex block = 0 ; block < numDebyeBlock ; block++ )
+    {
+      blockCost[block] = getCostWeight( WT_DEBYE ) * debyeArray[block].medium->numPoles * getDebyeNumCells( debyeArray[block].flim[field] );
+      totalCost += blockCost[block];
+      numDebyePoleUpdates[field] += (unsigned long) getDebyeNumCells( debyeArray[block].flim[field] ) * debyeArray[block].medium->numPoles;
+    }
+
+    if( totalCost == 0.0 )
+      continue;
+
+    /* Count the tasks, then set them. */
+    for( int pass = 0 ; pass <= 1 ; pass++ )
+    {
+      numTasks = 0;
+      for( BlockIndex block = 0 ; block < numDebyeBlock ; block++ )
+      {
+        numParts = (int) ceil( DEBYE_BALANCE_BLOCKS * getNumWorkParts() * blockCost[block] / totalCost );
+        getLoopDecompBlocks( debyeArray[block].flim[field] , numParts , &decomp );
+        for( int item = 0 ; item < decomp.numItems ; item++ , numTasks++ )
+        {
+          if( pass == 0 )
+            continue;
+          debyeTasks[field][numTasks].block = block;
+          getLoopDecompLimits( &decomp , item , debyeTasks[field][numTasks].lim );
+        }
+      }
+      if( pass == 0 )
+      {
+        debyeTasks[field] = allocArray( &bytes , sizeof( DebyeTask ) , 1 , numTasks );
+        memory.blocks += bytes;
+      }
+    }
+
+    numDebyeTasks[field] = numTasks;
+
+    cost = allocArray( &bytes , sizeof( double ) , 1 , numTasks );
+    for( int task = 0 ; task < numTasks ; task++ )
+      cost[task] = getCostWeight( WT_DEBYE ) * debyeArray[debyeTasks[field][task].block].medium->numPoles * getDebyeNumCells( debyeTasks[field][task].lim );
+
+    /* Overlapping blocks must not be updated at the same time. */
+    numDebyePartitions[field] = isDebyeOverlap( field ) ? numDebyeBlock : 1;
+    debyePartitions[field] = allocArray( &bytes , sizeof( WorkPartition ) , 1 , numDebyePartitions[field] );
+    memory.blocks += bytes;
+
+    if( numDebyePartitions[field] == 1 )
+    {
+      partitionWork( &debyePartitions[field][0] , WT_DEBYE , cost , 0 , numTasks , numDebyePoleUpdates[field] );
+    }
+    else
+    {
+      message( MSG_DEBUG1 , 0 , "  Debye blocks overlap - updating %s in each block in turn\n" , FIELD[field] );
+      firstTask = 0;
+      for( BlockIndex block = 0 ; block < numDebyeBlock ; block++ )
+      {
+        numTasks = firstTask;
+        while( numTasks < numDebyeTasks[field] && debyeTasks[field][numTasks].block == block )
+          numTasks++;
+        partitionWork( &debyePartitions[field][block] , WT_DEBYE , cost , firstTask , numTasks - firstTask , 
+                       (unsigned long) getDebyeNumCells( debyeArray[block].flim[field] ) * debyeArray[block].medium->numPoles );
+        firstTask = numTasks;
+      }
+    }
+
+    deallocArray( cost , 1 , numDebyeTasks[field] );
+
+  }
+
+  deallocArray( blockCost , 1 , numDebyeBlock );
+
   return;
 
 }
@@ -203,6 +367,16 @@ void deallocDebyeBlocks( void )
 
   message( MSG_DEBUG1 , 0 , "Deallocating Debye blocks...\n" );
 
+  for( field = EX ; field <= EZ ; field++ )
+  {
+    if( debyeTasks[field] == NULL )
+      continue;
+    for( int partition = 0 ; partition < numDebyePartitions[field] ; partition++ )
+      deallocWorkPartition( &debyePartitions[field][partition] );
+    deallocArray( debyePartitions[field] , 1 , numDebyePartitions[field] );
+    deallocArray( debyeTasks[field] , 1 , numDebyeTasks[field] );
+  }
+
   for( BlockIndex block = 0 ; block < numDebyeBlock ; block++ )
   {
     /* Deallocate arrays for polarisation currents and last electric field value caches. */
@@ -241,22 +415,76 @@ void deallocDebyeBlocks( void )
 
 /* Debye E field update. Must come before standatd E field update. */
 void updateDebyeBlocksEfield( void )
+{
+
+  for( FieldComponent field = EX ; field <= EZ ; field++ )
+    updateDebyeBlocksEfieldComponent( field );
+
+  return;
+
+}
+
+/* Debye E field update of one component - the components are independent. */
+void updateDebyeBlocksEfieldComponent( FieldComponent field )
+{
+
+  double start;
+
+  if( numDebyeTasks[field] == 0 )
+    return;
+
+  start = getWorkTime();
+
+  #ifdef WITH_OPENMP
+    #pragma omp parallel
+  #endif
+  {
+    int first , last;
+    double busy = 0.0;
+    double busyStart;
+
+    for( int partition = 0 ; partition < numDebyePartitions[field] ; partition++ )
+    {
+      busyStart = getWorkTime();
+      for( int part = getWorkerNumber() ; part < debyePartitions[field][partition].numParts ; part += getNumWorkers() )
+      {
+        getWorkPart( &debyePartitions[field][partition] , part , &first , &last );
+        for( int task = first ; task <= last ; task++ )
+          updateDebyeTask( field , &debyeTasks[field][task] );
+      }
+      busy += getWorkTime() - busyStart;
+      /* Overlapping blocks are updated in turn. */
+      #ifdef WITH_OPENMP
+        #pragma omp barrier
+      #endif
+    }
+
+    addBusyTime( WT_DEBYE , busy );
+  }
+
+  addSweepTime( WT_DEBYE , getWorkTime() - start , numDebyePoleUpdates[field] );
+
+  return;
+
+}
+
+/* Debye E field update of one component over the cells of a task. */
+static void updateDebyeTask( FieldComponent field , DebyeTask *task )
 {
 
   int i , j , k;
   int ii , jj , kk;
   int poleIdx;
   double complex Jsum = 0.0 + I * 0.0;
-  FieldComponent field;
-
-  for( BlockIndex block = 0 ; block < numDebyeBlock ; block++ )
-  { 
-
-    /* Update Jpolx. */
-    field = EX;
-    for( i = debyeArray[block].flim[field][XLO] , ii = 0 ; i <= debyeArray[block].flim[field][XHI] ; i++ , ii++ )
-      for( j = debyeArray[block].flim[field][YLO] , jj = 0 ; j <= debyeArray[block].flim[field][YHI] ; j++ , jj++ )
-        for( k = debyeArray[block].flim[field][ZLO] , kk = 0 ; k <= debyeArray[block].flim[field][ZHI] ; k++ , kk++ )
+  BlockIndex block = task->block;
+  int *lim = task->lim;
+  int *flim = debyeArray[block].flim[field];
+
+  /* Update Jpolx. */
+  if( field == EX )
+    for( i = lim[XLO] , ii = lim[XLO] - flim[XLO] ; i <= lim[XHI] ; i++ , ii++ )
+      for( j = lim[YLO] , jj = lim[YLO] - flim[YLO] ; j <= lim[YHI] ; j++ , jj++ )
+        for( k = lim[ZLO] , kk = lim[ZLO] - flim[ZLO] ; k <= lim[ZHI] ; k++ , kk++ )
         {
           Jsum = 0.0 + I * 0.0;
           for( poleIdx = 0 ; poleIdx < debyeArray[block].medium->numPoles; poleIdx++ )
@@ -268,11 +496,11 @@ void updateDebyeBlocksEfield( void )
           debyeArray[block].lastEx[ii][jj][kk] = Ex[i][j][k];
         }
       
-    /* Update Jpoly. */         
-    field = EY;
-    for( i = debyeArray[block].flim[field][XLO] , ii = 0 ; i <= debyeArray[block].flim[field][XHI] ; i++ , ii++ )
-      for( j = debyeArray[block].flim[field][YLO] , jj = 0 ; j <= debyeArray[block].flim[field][YHI] ; j++ , jj++ )
-        for( k = debyeArray[block].flim[field][ZLO] , kk = 0 ; k <= debyeArray[block].flim[field][ZHI] ; k++ , kk++ )
+  /* Update Jpoly. */         
+  if( field == EY )
+    for( i = lim[XLO] , ii = lim[XLO] - flim[XLO] ; i <= lim[XHI] ; i++ , ii++ )
+      for( j = lim[YLO] , jj = lim[YLO] - flim[YLO] ; j <= lim[YHI] ; j++ , jj++ )
+        for( k = lim[ZLO] , kk = lim[ZLO] - flim[ZLO] ; k <= lim[ZHI] ; k++ , kk++ )
         {
           Jsum = 0.0 + I * 0.0;
           for( poleIdx = 0 ; poleIdx < debyeArray[block].medium->numPoles; poleIdx++ )
@@ -284,12 +512,12 @@ void updateDebyeBlocksEfield( void )
           debyeArray[block].lastEy[ii][jj][kk] = Ey[i][j][k]; 
         }
       
-    /* Update Jpolz. */
-    field = EZ; 
-      for( i = debyeArray[block].flim[field][XLO] , ii = 0 ; i <= debyeArray[block].flim[field][XHI] ; i++ , ii++ )
-        for( j = debyeArray[block].flim[field][YLO] , jj = 0 ; j <= debyeArray[block].flim[field][YHI] ; j++ , jj++ )
-          for( k = debyeArray[block].flim[field][ZLO] , kk = 0 ; k <= debyeArray[block].flim[field][ZHI] ; k++ , kk++ )
-          {
+  /* Update Jpolz. */
+  if( field == EZ )
+    for( i = lim[XLO] , ii = lim[XLO] - flim[XLO] ; i <= lim[XHI] ; i++ , ii++ )
+      for( j = lim[YLO] , jj = lim[YLO] - flim[YLO] ; j <= lim[YHI] ; j++ , jj++ )
+        for( k = lim[ZLO] , kk = lim[ZLO] - flim[ZLO] ; k <= lim[ZHI] ; k++ , kk++ )
+        {
           Jsum = 0.0 + I * 0.0;
           for( poleIdx = 0 ; poleIdx < debyeArray[block].medium->numPoles; poleIdx++ )
             Jsum = Jsum + ( 1 + debyeArray[block].medium->dalpha[poleIdx] ) * debyeArray[block].Jpolz[ii][jj][kk][poleIdx];    
@@ -298,9 +526,7 @@ void updateDebyeBlocksEfield( void )
             debyeArray[block].Jpolz[ii][jj][kk][poleIdx] = debyeArray[block].medium->dalpha[poleIdx] * debyeArray[block].Jpolz[ii][jj][kk][poleIdx] + 
               debyeArray[block].medium->dbeta[poleIdx] * UNSCALE_Ez( Ez[i][j][k] - debyeArray[block].lastEz[ii][jj][kk] , k );
           debyeArray[block].lastEz[ii][jj][kk] = Ez[i][j][k]; 
-          }
-
-  }
+        }
 
   return;
 
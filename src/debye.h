@@ -34,6 +34,7 @@
 
 void initDebyeBlocks( BlockIndex number , BlockItem *blockList );
 void updateDebyeBlocksEfield( void );
+void updateDebyeBlocksEfieldComponent( FieldComponent field );
 void deallocDebyeBlocks( void );
 
 #endif
@@ -0,0 +1,638 @@
+/*
+ * This file is part of Vulture.
+ *
+ * Vulture finite-difference time-domain electromagnetic solver.
+ * Copyright (C) 2011-2016 Ian David Flintoft
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ *
+ * Author: Ian Flintoft <ian.flintoft@googlemail.com>
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+
+#ifdef WITH_MPI
+  #include <mpi.h>
+#endif
+
+#include "domain.h"
+#include "fdtd_types.h"
+#include "message.h"
+#include "grid.h"
+#include "surface.h"
+#include "boundary.h"
+#include "alloc_array.h"
+#include "memory.h"
+
+/*
+ * Domain decomposition.
+ *
+ * With MPI the cells of the grid, including the PML and ghost cells, are split
+ * into a Cartesian array of sub-domains, one per rank. Each rank owns all the
+ * field components with indices in its sub-domain and allocates the grid arrays
+ * for the sub-domain plus one layer of halo cells on every side. The cuts are
+ * placed in the inner grid so the PML and Mur boundaries lie wholly in the
+ * sub-domains on the edges of the grid.
+ *
+ * The electric field update at the low faces of a sub-domain needs the
+ * tangential magnetic field in the halo below it and the magnetic field
+ * update at the high faces needs the tangential electric field in the halo
+ * above it. These are exchanged between neighbouring ranks before each half
+ * time-step with non-blocking messages so the update of the interior of the
+ * sub-domain can proceed while they are in flight.
+ *
+ * Without MPI there is a single domain covering the whole grid.
+ */
+
+/* Minimum number of inner grid cells in each direction of a sub-domain. */
+#define MIN_DOMAIN_CELLS 4
+
+/*
+ * Private data.
+ */
+
+/* Rank and number of ranks. */
+static int domainRank = 0;
+static int numDomainRanks = 1;
+
+/* Number of sub-domains and coordinates of this sub-domain in each direction. */
+static int domainDims[3] = { 1 , 1 , 1 };
+static int domainCoords[3] = { 0 , 0 , 0 };
+
+/* Cell limits owned by this domain. */
+static int ownLim[6] = { 0 , -1 , 0 , -1 , 0 , -1 };
+
+/* Cell limits of the grid arrays of this domain, including the halo. */
+static int arrayLim[6] = { 0 , -1 , 0 , -1 , 0 , -1 };
+
+#ifdef WITH_MPI
+
+/* Cartesian communicator. */
+static MPI_Comm cartComm = MPI_COMM_NULL;
+
+/* Neighbouring ranks across each face, MPI_PROC_NULL on the grid boundaries. */
+static int neighbour[6] = { MPI_PROC_NULL , MPI_PROC_NULL , MPI_PROC_NULL , MPI_PROC_NULL , MPI_PROC_NULL , MPI_PROC_NULL };
+
+/* Tangential field components on the faces normal to each direction. */
+static const FieldComponent TANGENTIAL_E[3][2] = { { EY , EZ } , { EX , EZ } , { EX , EY } };
+static const FieldComponent TANGENTIAL_H[3][2] = { { HY , HZ } , { HX , HZ } , { HX , HY } };
+
+/* Halo message buffers for each direction and their sizes in reals. */
+static real *sendBuffer[3] = { NULL , NULL , NULL };
+static real *recvBuffer[3] = { NULL , NULL , NULL };
+static size_t bufferSize[3] = { 0 , 0 , 0 };
+
+/* Outstanding requests of the current exchange. */
+static MPI_Request requests[6];
+static int numRequests = 0;
+
+#endif
+
+/*
+ * Private method interfaces.
+ */
+
+#ifdef WITH_MPI
+void chooseDomainDims( int dims[3] );
+void allocDomainBuffers( void );
+real ***getFieldArray( FieldComponent field );
+void copyHaloPlane( const FieldComponent components[2] , int direction , int plane , real *buffer , bool isPack );
+void startExchange( const FieldComponent components[3][2] , bool isUp , int tag );
+void finishExchange( const FieldComponent components[3][2] , bool isUp );
+#endif
+
+/*
+ * Method Implementations.
+ */
+
+/* Initialise domain - must be called before anything else in main. */
+void initDomain( int *argc , char ***argv )
+{
+
+#ifdef WITH_MPI
+  int provided;
+
+  /* Only the master thread makes MPI calls. */
+  MPI_Init_thread( argc , argv , MPI_THREAD_FUNNELED , &provided );
+  MPI_Comm_rank( MPI_COMM_WORLD , &domainRank );
+  MPI_Comm_size( MPI_COMM_WORLD , &numDomainRanks );
+#else
+  (void)argc;
+  (void)argv;
+#endif
+
+  return;
+
+}
+
+/* Decompose the grid into sub-domains. */
+/* Depends: setGridExtents. */
+void decomposeDomain( void )
+{
+
+  for( int direction = XDIR ; direction <= ZDIR ; direction++ )
+  {
+    ownLim[2*direction] = 0;
+    ownLim[2*direction+1] = numCells[direction] - 1;
+  }
+
+#ifdef WITH_MPI
+
+  int periods[3] = { 0 , 0 , 0 };
+  int numInner , cut;
+
+  if( numDomainRanks > 1 )
+  {
+
+    chooseDomainDims( domainDims );
+
+    MPI_Cart_create( MPI_COMM_WORLD , 3 , domainDims , periods , 0 , &cartComm );
+    MPI_Cart_coords( cartComm , domainRank , 3 , domainCoords );
+
+    for( int direction = XDIR ; direction <= ZDIR ; direction++ )
+    {
+      MPI_Cart_shift( cartComm , direction , 1 , &neighbour[2*direction] , &neighbour[2*direction+1] );
+
+      /* Cuts divide the inner grid cells evenly. */
+      numInner = gibox[2*direction+1] - gibox[2*direction];
+      if( domainCoords[direction] > 0 )
+      {
+        cut = gibox[2*direction] + ( domainCoords[direction] * numInner ) / domainDims[direction];
+        ownLim[2*direction] = cut;
+      }
+      if( domainCoords[direction] < domainDims[direction] - 1 )
+      {
+        cut = gibox[2*direction] + ( ( domainCoords[direction] + 1 ) * numInner ) / domainDims[direction];
+        ownLim[2*direction+1] = cut - 1;
+      }
+    }
+
+  }
+  else
+  {
+    MPI_Comm_dup( MPI_COMM_WORLD , &cartComm );
+  }
+
+#endif
+
+  /* Arrays include one layer of halo cells within the grid. */
+  for( int direction = XDIR ; direction <= ZDIR ; direction++ )
+  {
+    arrayLim[2*direction] = ownLim[2*direction] > 0 ? ownLim[2*direction] - 1 : 0;
+    arrayLim[2*direction+1] = ownLim[2*direction+1] < numCells[direction] - 1 ? ownLim[2*direction+1] + 1 : numCells[direction] - 1;
+  }
+
+#ifdef WITH_MPI
+  allocDomainBuffers();
+#endif
+
+  return;
+
+}
+
+#ifdef WITH_MPI
+
+/*
+ * Choose the number of sub-domains in each direction that minimises the total
+ * area of the faces between sub-domains. Periodic directions are not divided
+ * and each sub-domain must hold at least MIN_DOMAIN_CELLS of the inner grid.
+ */
+void chooseDomainDims( int dims[3] )
+{
+
+  int numInner[3];
+  int maxDims[3];
+  int trial[3];
+  double area;
+  double minArea = -1.0;
+
+  for( int direction = XDIR ; direction <= ZDIR ; direction++ )
+  {
+    numInner[direction] = gibox[2*direction+1] - gibox[2*direction];
+    if( outerSurfaceType( 2 * direction ) == BT_PERIODIC || outerSurfaceType( 2 * direction + 1 ) == BT_PERIODIC )
+      maxDims[direction] = 1;
+    else
+      maxDims[direction] = numInner[direction] / MIN_DOMAIN_CELLS > 1 ? numInner[direction] / MIN_DOMAIN_CELLS : 1;
+  }
+
+  for( trial[XDIR] = 1 ; trial[XDIR] <= maxDims[XDIR] ; trial[XDIR]++ )
+  {
+    if( numDomainRanks % trial[XDIR] != 0 )
+      continue;
+    for( trial[YDIR] = 1 ; trial[YDIR] <= maxDims[YDIR] ; trial[YDIR]++ )
+    {
+      if( ( numDomainRanks / trial[XDIR] ) % trial[YDIR] != 0 )
+        continue;
+      trial[ZDIR] = numDomainRanks / trial[XDIR] / trial[YDIR];
+      if( trial[ZDIR] > maxDims[ZDIR] )
+        continue;
+      area = (double)( trial[XDIR] - 1 ) * numCells[YDIR] * numCells[ZDIR] +
+             (double)( trial[YDIR] - 1 ) * numCells[XDIR] * numCells[ZDIR] +
+             (double)( trial[ZDIR] - 1 ) * numCells[XDIR] * numCells[YDIR];
+      if( minArea < 0.0 || area < minArea )
+      {
+        minArea = area;
+        dims[XDIR] = trial[XDIR];
+        dims[YDIR] = trial[YDIR];
+        dims[ZDIR] = trial[ZDIR];
+      }
+    }
+  }
+
+  if( minArea < 0.0 )
+    message( MSG_ERROR , 0 , "*** Error: Cannot decompose grid into %d sub-domains with at least %d cells in each non-periodic direction\n" ,
+             numDomainRanks , MIN_DOMAIN_CELLS );
+
+  return;
+
+}
+
+/* Allocate the halo message buffers. */
+void allocDomainBuffers( void )
+{
+
+  unsigned long bytes;
+
+  for( int direction = XDIR ; direction <= ZDIR ; direction++ )
+  {
+    bufferSize[direction] = 2;
+    for( int other = XDIR ; other <= ZDIR ; other++ )
+      if( other != direction )
+        bufferSize[direction] *= (size_t)( ownLim[2*other+1] - ownLim[2*other] + 1 );
+    if( neighbour[2*direction] != MPI_PROC_NULL || neighbour[2*direction+1] != MPI_PROC_NULL )
+    {
+      sendBuffer[direction] = allocArray( &bytes , sizeof( real ) , 1 , bufferSize[direction] );
+      memory.grid += bytes;
+      recvBuffer[direction] = allocArray( &bytes , sizeof( real ) , 1 , bufferSize[direction] );
+      memory.grid += bytes;
+    }
+  }
+
+  return;
+
+}
+
+/* Get grid array of a field component. */
+real ***getFieldArray( FieldComponent field )
+{
+
+  switch( field )
+  {
+  case EX:
+    return Ex;
+  case EY:
+    return Ey;
+  case EZ:
+    return Ez;
+  case HX:
+    return Hx;
+  case HY:
+    return Hy;
+  case HZ:
+    return Hz;
+  default:
+    assert( 0 );
+    return NULL;
+  }
+
+}
+
+/* Pack or unpack two field components on a plane normal to direction over the owned cells. */
+void copyHaloPlane( const FieldComponent components[2] , int direction , int plane , real *buffer , bool isPack )
+{
+
+  int lim[6];
+  real ***array;
+  size_t n = 0;
+
+  for( int face = XLO ; face <= ZHI ; face++ )
+    lim[face] = ownLim[face];
+  lim[2*direction] = plane;
+  lim[2*direction+1] = plane;
+
+  for( int comp = 0 ; comp < 2 ; comp++ )
+  {
+    array = getFieldArray( components[comp] );
+    for( int i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( int j = lim[YLO] ; j <= lim[YHI] ; j++ )
+        for( int k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
+          if( isPack )
+            buffer[n++] = array[i][j][k];
+          else
+            array[i][j][k] = buffer[n++];
+  }
+
+  return;
+
+}
+
+/*
+ * Start exchange of the tangential field components on the faces between
+ * sub-domains. Each rank sends its last owned plane to the neighbour above
+ * if isUp is true, otherwise its first owned plane to the neighbour below.
+ */
+void startExchange( const FieldComponent components[3][2] , bool isUp , int tag )
+{
+
+  int source , dest;
+  int plane;
+
+  numRequests = 0;
+
+  for( int direction = XDIR ; direction <= ZDIR ; direction++ )
+  {
+    source = neighbour[2*direction+( isUp ? 0 : 1 )];
+    dest = neighbour[2*direction+( isUp ? 1 : 0 )];
+    if( source != MPI_PROC_NULL )
+      MPI_Irecv( recvBuffer[direction] , (int)( bufferSize[direction] * sizeof( real ) ) , MPI_BYTE , source ,
+                 tag + direction , cartComm , &requests[numRequests++] );
+    if( dest != MPI_PROC_NULL )
+    {
+      plane = isUp ? ownLim[2*direction+1] : ownLim[2*direction];
+      copyHaloPlane( components[direction] , direction , plane , sendBuffer[direction] , true );
+      MPI_Isend( sendBuffer[direction] , (int)( bufferSize[direction] * sizeof( real ) ) , MPI_BYTE , dest ,
+                 tag + direction , cartComm , &requests[numRequests++] );
+    }
+  }
+
+  return;
+
+}
+
+/* Wait for the exchange to complete and copy the received planes into the halo. */
+void finishExchange( const FieldComponent components[3][2] , bool isUp )
+{
+
+  int source;
+  int plane;
+
+  MPI_Waitall( numRequests , requests , MPI_STATUSES_IGNORE );
+  numRequests = 0;
+
+  for( int direction = XDIR ; direction <= ZDIR ; direction++ )
+  {
+    source = neighbour[2*direction+( isUp ? 0 : 1 )];
+    if( source != MPI_PROC_NULL )
+    {
+      plane = isUp ? ownLim[2*direction] - 1 : ownLim[2*direction+1] + 1;
+      copyHaloPlane( components[direction] , direction , plane , recvBuffer[direction] , false );
+    }
+  }
+
+  return;
+
+}
+
+#endif
+
+/* Start sending the tangential electric field needed by the magnetic field update of the neighbours below. */
+void startExchangeEfield( void )
+{
+
+#ifdef WITH_MPI
+  if( numDomainRanks > 1 )
+    startExchange( TANGENTIAL_E , false , 0 );
+#endif
+
+  return;
+
+}
+
+/* Complete the electric field halo exchange. */
+void finishExchangeEfield( void )
+{
+
+#ifdef WITH_MPI
+  if( numDomainRanks > 1 )
+    finishExchange( TANGENTIAL_E , false );
+#endif
+
+  return;
+
+}
+
+/* Start sending the tangential magnetic field needed by the electric field update of the neighbours above. */
+void startExchangeHfield( void )
+{
+
+#ifdef WITH_MPI
+  if( numDomainRanks > 1 )
+    startExchange( TANGENTIAL_H , true , 3 );
+#endif
+
+  return;
+
+}
+
+/* Complete the magnetic field halo exchange. */
+void finishExchangeHfield( void )
+{
+
+#ifdef WITH_MPI
+  if( numDomainRanks > 1 )
+    finishExchange( TANGENTIAL_H , true );
+#endif
+
+  return;
+
+}
+
+/* Sum a buffer over all the domains into the buffer on the root domain. */
+void reduceToRootDomain( float *buffer , int count )
+{
+
+#ifdef WITH_MPI
+  if( numDomainRanks > 1 )
+    MPI_Reduce( domainRank == 0 ? MPI_IN_PLACE : buffer , buffer , count , MPI_FLOAT , MPI_SUM , 0 , cartComm );
+#else
+  (void)buffer;
+  (void)count;
+#endif
+
+  return;
+
+}
+
+/* Report domain decomposition. */
+void reportDomain( void )
+{
+
+  message( MSG_LOG , 0 , "  Domain rank: %d of %d\n" , domainRank , numDomainRanks );
+  message( MSG_LOG , 0 , "  Sub-domains: %d x %d x %d\n" , domainDims[XDIR] , domainDims[YDIR] , domainDims[ZDIR] );
+  message( MSG_LOG , 0 , "  Sub-domain coordinates: (%d,%d,%d)\n" , domainCoords[XDIR] , domainCoords[YDIR] , domainCoords[ZDIR] );
+  message( MSG_LOG , 0 , "  Sub-domain cells: [%d,%d,%d,%d,%d,%d]\n" ,
+           ownLim[XLO] , ownLim[XHI] , ownLim[YLO] , ownLim[YHI] , ownLim[ZLO] , ownLim[ZHI] );
+  message( MSG_LOG , 0 , "  Sub-domain array cells: [%d,%d,%d,%d,%d,%d]\n" ,
+           arrayLim[XLO] , arrayLim[XHI] , arrayLim[YLO] , arrayLim[YHI] , arrayLim[ZLO] , arrayLim[ZHI] );
+
+  return;
+
+}
+
+/* Deallocate domain and shut down MPI. */
+void deallocDomain( void )
+{
+
+#ifdef WITH_MPI
+  for( int direction = XDIR ; direction <= ZDIR ; direction++ )
+  {
+    if( sendBuffer[direction] != NULL )
+    {
+      deallocArray( sendBuffer[direction] , 1 , bufferSize[direction] );
+      deallocArray( recvBuffer[direction] , 1 , bufferSize[direction] );
+    }
+  }
+  if( cartComm != MPI_COMM_NULL )
+    MPI_Comm_free( &cartComm );
+  MPI_Finalize();
+#endif
+
+  return;
+
+}
+
+/* Abort all ranks after a fatal error on this one. */
+void abortDomain( int code )
+{
+
+#ifdef WITH_MPI
+  int isInitialised = 0;
+  int isFinalised = 0;
+
+  MPI_Initialized( &isInitialised );
+  MPI_Finalized( &isFinalised );
+  if( isInitialised && !isFinalised && numDomainRanks > 1 )
+    MPI_Abort( MPI_COMM_WORLD , code );
+#else
+  (void)code;
+#endif
+
+  return;
+
+}
+
+/* Get rank of domain. */
+int getDomainRank( void )
+{
+
+  return domainRank;
+
+}
+
+/* Get number of domains. */
+int getDomainNumRanks( void )
+{
+
+  return numDomainRanks;
+
+}
+
+/* Return true on the root domain, which writes the shared output files. */
+bool isRootDomain( void )
+{
+
+  return domainRank == 0;
+
+}
+
+/* Return true if the grid is split between more than one domain. */
+bool isDomainDecomposed( void )
+{
+
+  return numDomainRanks > 1;
+
+}
+
+/* Get the cell limits owned by the domain. */
+void getDomainLimits( int lim[6] )
+{
+
+  for( int face = XLO ; face <= ZHI ; face++ )
+    lim[face] = ownLim[face];
+
+  return;
+
+}
+
+/* Get the cell limits of the grid arrays of the domain. */
+void getDomainArrayLimits( int lim[6] )
+{
+
+  for( int face = XLO ; face <= ZHI ; face++ )
+    lim[face] = arrayLim[face];
+
+  return;
+
+}
+
+/*
+ * Clip limits to the cells owned by the domain. If the result is empty the
+ * upper limits are set one below the lower limits in every direction, so
+ * loops over any of them do nothing, and false is returned.
+ */
+bool clipToDomain( int lim[6] )
+{
+
+  bool isEmpty = false;
+
+  for( int face = XLO ; face <= ZHI ; face += 2 )
+  {
+    if( lim[face] < ownLim[face] ) lim[face] = ownLim[face];
+    if( lim[face+1] > ownLim[face+1] ) lim[face+1] = ownLim[face+1];
+    if( lim[face] > lim[face+1] ) isEmpty = true;
+  }
+
+  if( isEmpty )
+    for( int face = XLO ; face <= ZHI ; face += 2 )
+      lim[face+1] = lim[face] - 1;
+
+  return !isEmpty;
+
+}
+
+/* Clip the field limits of each component to the domain. */
+void clipFieldLimitsToDomain( int fieldLimits[6][6] )
+{
+
+  for( FieldComponent field = EX ; field <= HZ ; field++ )
+    clipToDomain( fieldLimits[field] );
+
+  return;
+
+}
+
+/* Return true if the field components at (i,j,k) are owned by the domain. */
+bool isInDomain( int i , int j , int k )
+{
+
+  return i >= ownLim[XLO] && i <= ownLim[XHI] &&
+         j >= ownLim[YLO] && j <= ownLim[YHI] &&
+         k >= ownLim[ZLO] && k <= ownLim[ZHI];
+
+}
+
+/* Return true if a face of the domain lies on the boundary of the grid. */
+bool isOuterDomainFace( MeshFace face )
+{
+
+  if( face % 2 == 0 )
+    return ownLim[face] == 0;
+  else
+    return ownLim[face] == numCells[face/2] - 1;
+
+}
@@ -28,6 +28,10 @@
 #include <assert.h>
 #include <string.h>
 
+#ifdef WITH_OPENMP
+#include <omp.h> 
+#endif
+
 #include "grid.h"
 #include "boundary.h"
 #include "surface.h"
@@ -40,12 +44,28 @@
 #include "mesh.h"
 #include "gnuplot.h"
 #include "pml.h"
+#include "mur.h"
 #include "memory.h"
 #include "util.h"
+#include "simd.h"
+#include "domain.h"
+#include "balance.h"
 
 /* Tolerance on grid type test */
 #define GRID_TYPE_TOL 1e-5    
 
+/* Cache size assumed if it cannot be determined [bytes]. */
+#define DEFAULT_CACHE_SIZE 262144
+
+/* Minimum tile size in k direction. */
+#define MIN_TILE_SIZE 16
+
+/* Minimum edge length of space-time tiles. */
+#define MIN_TIME_BLOCK_TILE_SIZE 8
+
+/* Number of loop decomposition blocks per thread. */
+#define LOOP_BLOCKS_PER_THREAD 4
+
 /* Tolerance on medium checking test. */
 #define CHECK_LIMITS_RTOL    1e-8
 
@@ -87,12 +107,12 @@ real ***Hz;
 
 /* Update coefficient arrays. */
 #ifdef USE_INDEXED_MEDIA
-  MediumIndex ***mediumEx;
-  MediumIndex ***mediumEy;
-  MediumIndex ***mediumEz;
-  MediumIndex ***mediumHx;
-  MediumIndex ***mediumHy;
-  MediumIndex ***mediumHz;
+  void ***mediumEx;
+  void ***mediumEy;
+  void ***mediumEz;
+  void ***mediumHx;
+  void ***mediumHy;
+  void ***mediumHz;
 #else
   real ***alphaEx;             
   real ***alphaEy;
@@ -105,6 +125,15 @@ real ***Hz;
   real ***gammaHz;
 #endif
 
+/* Strides of the flat storage of the real valued field and coefficient arrays. */
+size_t gridStrideI;
+size_t gridStrideJ;
+
+#ifdef WITH_MPI
+/* Indices of the first element of the grid arrays of the domain. */
+int gridOrigin[3];
+#endif
+
 /* Primary grid edge lengths. */
 real *dex;                    
 real *dey;
@@ -138,6 +167,62 @@ char GRID_TYPE[4][11]  = { "CUBIC" , "UNIFORM" , "NONUNIFORM" , "UNDEFINED" };
 /* Type of grid. */
 static GridType gridType;
 
+/* Grid update kernel strings. */
+char GRID_KERNEL_STR[4][11]  = { "STANDARD" , "FUSED" , "TILED" , "UNDEFINED" };
+
+/* Grid update kernel. */
+static GridKernel gridKernel = GK_STANDARD;
+
+/* Tile size in j and k directions for tiled kernels. */
+static int gridTile[2] = { 0 , 0 };
+
+/* Edge length of space-time tiles for temporal blocking. */
+static int timeBlockTile = 0;
+
+/* 
+ * Run of edges along a k-pencil of the inner grid. The update coefficients are 
+ * constant on uniform runs and are held in the run, alpha and beta for electric
+ * fields and gamma, in beta, for magnetic fields.
+ */
+typedef struct PencilRun_t {
+
+  int klo;              // First edge of run.
+  int khi;              // Last edge of run.
+  bool isUniform;       // True if the coefficients are constant on the run.
+  real alpha;           // Coefficients of uniform run.
+  real beta;
+
+} PencilRun;
+
+/* Pencil update kernel of a grid field component. */
+typedef void (*GridPencilFunc)( int i , int j , int klo , int khi );
+
+/* Minimum number of edges in a uniform run. */
+#define MIN_UNIFORM_RUN 8
+
+/* 
+ * Edges inside PEC are left out of the runs and never updated. Limit checking
+ * requires every edge to be visited so they are kept there.
+ */
+#ifndef CHECK_LIMITS
+  #define SKIP_PEC_EDGES
+#endif
+
+/* Runs on the pencils of each field component. */
+static PencilRun *pencilRuns[6] = { NULL , NULL , NULL , NULL , NULL , NULL };
+
+/* Offset of the first run of each pencil in pencilRuns, with an extra end offset. */
+static unsigned long *pencilRunIndex[6] = { NULL , NULL , NULL , NULL , NULL , NULL };
+
+/* Total number of runs for each field component. */
+static unsigned long numPencilRuns[6] = { 0 , 0 , 0 , 0 , 0 , 0 };
+
+/* Proportion of the updated edges in uniform runs. */
+static double uniformEdgeFraction = 0.0;
+
+/* Decomposition of the inner grid into electric and magnetic field update tasks. */
+static LoopDecomp gridTasks[2];
+
 /* Number of mesh lines in each direction. */
 static int numLines[3];
 
@@ -168,6 +253,25 @@ char decodeAlphaBeta( real alpha , real beta );
 char decodeGamma( real gamma );
 void setGridType( void );
 real numPhaseVelocityFunc( real k , real A[3] , real B );
+void updateGridEfieldStandard( void );
+void updateGridHfieldStandard( void );
+void updateGridEfieldFused( void );
+void updateGridHfieldFused( void );
+void updateGridEfieldTiled( void );
+void updateGridHfieldTiled( void );
+static unsigned long getGridSweepCells( FieldComponent firstField );
+void initGridTileSize( void );
+void initTimeBlockTileSize( void );
+void updateTimeBlockTile( int numSteps , int start[3] , int tileSize[3] , int tileIdx[3] , int limE[6] , int limH[6] );
+int findPencilRuns( FieldComponent field , int i , int j , PencilRun *runs );
+#ifdef USE_AVERAGED_MEDIA
+void getAveragedMediumParameters( real *eps_r , real *sigma , real *mu_r , void ***blockArray , size_t blockIndexSize ,
+                                  FieldComponent field , int i , int j , int k );
+void setAveragedMediaOnGrid( void ***blockArray , size_t blockIndexSize , int flim[6][6] , bool isSet );
+#ifdef USE_INDEXED_MEDIA
+void resizeMediumIndexArrays( size_t oldSize );
+#endif
+#endif
 
 /*
  * Method Implementations.
@@ -333,10 +437,25 @@ void initGrid( void )
 
   /* Set the grid extents. */
   setGridExtents();
+
+  /* Split the grid between the domains. */
+  decomposeDomain();
  
   /* Find field array limits. */
   initFieldArrayLimits();
 
+  /* Choose the narrowest medium index type that holds all the media. */
+  setMediumIndexSize();
+
+  /* Set tile size for tiled kernels. */
+  initGridTileSize();
+  initTimeBlockTileSize();
+
+#ifdef USE_SIMD_KERNELS
+  /* Select SIMD kernels for the processor. */
+  initSimd();
+#endif
+
   /* Allocate grid arrays. */
   allocGridArrays();
 
@@ -395,7 +514,7 @@ void initFieldArrayLimits( void )
   bool includeGhostBoundary[6] = { false , false , false , false , false , false };
 
   for( int boundary = XLO ; boundary <= ZHI ; boundary++ )
-    if( outerSurfaceType( boundary ) == BT_MUR ) includeInnerBoundary[boundary] = false;
+    if( isMurFace( boundary ) ) includeInnerBoundary[boundary] = false;
  
   message( MSG_LOG , 0 , "  Initialising array limits ...\n" );
 
@@ -404,6 +523,11 @@ void initFieldArrayLimits( void )
   setFieldLimits( gobox , gfolim , includeOuterBoundary );
   setFieldLimits( ggbox , gfglim , includeGhostBoundary );
 
+  /* Each domain only updates the fields it owns. */
+  clipFieldLimitsToDomain( gfilim );
+  clipFieldLimitsToDomain( gfolim );
+  clipFieldLimitsToDomain( gfglim );
+
   return;
 
 }
@@ -458,6 +582,7 @@ void allocGridArrays( void )
 {
 
   unsigned long bytes;
+  int alim[6];
 
   message( MSG_LOG , 0 , "  Allocating grid arrays...\n" );
 
@@ -499,79 +624,116 @@ void allocGridArrays( void )
   idhz = allocArray( &bytes , sizeof( real ) , 1 , numCells[ZDIR] );
   memory.grid += bytes;
 
-  /* Allocate main#include "fdtd_types.h" field arrays. */
+  /* Only the cells of the domain and its halo are allocated in the field and coefficient arrays. */
+  getDomainArrayLimits( alim );
+#ifdef WITH_MPI
+  gridOrigin[XDIR] = alim[XLO];
+  gridOrigin[YDIR] = alim[YLO];
+  gridOrigin[ZDIR] = alim[ZLO];
+#endif
+
+  /* Strides of the real valued field and coefficient arrays. */
+  getFieldArrayStrides( sizeof( real ) , alim[YHI] - alim[YLO] + 1 , alim[ZHI] - alim[ZLO] + 1 , &gridStrideI , &gridStrideJ );
+
+  /* Allocate main field arrays. */
   message( MSG_DEBUG1 , 0 , "  Allocating grid Ex array\n" );
-  Ex = allocArray( &bytes , sizeof( real ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+  Ex = allocFieldArrayRegion( &bytes , sizeof( real ) , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
   memory.ehFields += bytes;
   message( MSG_DEBUG1 , 0 , "  Allocating grid Ey array\n" );
-  Ey = allocArray( &bytes , sizeof( real ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+  Ey = allocFieldArrayRegion( &bytes , sizeof( real ) , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
   memory.ehFields += bytes;
   message( MSG_DEBUG1 , 0 , "  Allocating grid Ez array\n" );
-  Ez = allocArray( &bytes , sizeof( real ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+  Ez = allocFieldArrayRegion( &bytes , sizeof( real ) , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
   memory.ehFields += bytes;
   message( MSG_DEBUG1 , 0 , "  Allocating grid Hx array\n" );
-  Hx = allocArray( &bytes , sizeof( real ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+  Hx = allocFieldArrayRegion( &bytes , sizeof( real ) , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
   memory.ehFields += bytes;
   message( MSG_DEBUG1 , 0 , "  Allocating grid Hy array\n" );
-  Hy = allocArray( &bytes , sizeof( real ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+  Hy = allocFieldArrayRegion( &bytes , sizeof( real ) , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
   memory.ehFields += bytes;
   message( MSG_DEBUG1 , 0 , "  Allocating grid Hz array\n" );
-  Hz = allocArray( &bytes , sizeof( real ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+  Hz = allocFieldArrayRegion( &bytes , sizeof( real ) , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
   memory.ehFields += bytes;
 
   /* Allocate media arrays. */
   #ifdef USE_INDEXED_MEDIA
 
     message( MSG_DEBUG1 , 0 , "  Allocating grid mediumEx array\n" );
-    mediumEx = allocArray( &bytes , sizeof( MediumIndex ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    mediumEx = allocFieldArrayRegion( &bytes , mediumIndexSize , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
     memory.ehCoeffs += bytes;
     message( MSG_DEBUG1 , 0 , "  Allocating grid mediumEy array\n" );
-    mediumEy = allocArray( &bytes , sizeof( MediumIndex ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    mediumEy = allocFieldArrayRegion( &bytes , mediumIndexSize , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
     memory.ehCoeffs += bytes;
     message( MSG_DEBUG1 , 0 , "  Allocating grid mediumEz array\n" );
-    mediumEz = allocArray( &bytes , sizeof( MediumIndex ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    mediumEz = allocFieldArrayRegion( &bytes , mediumIndexSize , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
     memory.ehCoeffs += bytes;
     message( MSG_DEBUG1 , 0 , "  Allocating grid mediumHx array\n" );
-    mediumHx = allocArray( &bytes , sizeof( MediumIndex ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    mediumHx = allocFieldArrayRegion( &bytes , mediumIndexSize , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
     memory.ehCoeffs += bytes;
     message( MSG_DEBUG1 , 0 , "  Allocating grid mediumHy array\n" );
-    mediumHy = allocArray( &bytes , sizeof( MediumIndex ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    mediumHy = allocFieldArrayRegion( &bytes , mediumIndexSize , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
     memory.ehCoeffs += bytes;
     message( MSG_DEBUG1 , 0 , "  Allocating grid mediumHz array\n" );
-    mediumHz = allocArray( &bytes , sizeof( MediumIndex ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    mediumHz = allocFieldArrayRegion( &bytes , mediumIndexSize , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
     memory.ehCoeffs += bytes;
 
   #else
   
     message( MSG_DEBUG1 , 0 , "  Allocating grid alphaEx array\n" );
-    alphaEx = allocArray( &bytes , sizeof( real ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    alphaEx = allocFieldArrayRegion( &bytes , sizeof( real ) , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
     memory.ehCoeffs += bytes;
     message( MSG_DEBUG1 , 0 , "  Allocating grid alphaEy array\n" );
-    alphaEy = allocArray( &bytes , sizeof( real ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    alphaEy = allocFieldArrayRegion( &bytes , sizeof( real ) , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
     memory.ehCoeffs += bytes;
     message( MSG_DEBUG1 , 0 , "  Allocating grid alphaEz array\n" );
-    alphaEz = allocArray( &bytes , sizeof( real ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    alphaEz = allocFieldArrayRegion( &bytes , sizeof( real ) , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
     memory.ehCoeffs += bytes;
     message( MSG_DEBUG1 , 0 , "  Allocating grid betaEx array\n" );
-    betaEx = allocArray( &bytes , sizeof( real ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    betaEx = allocFieldArrayRegion( &bytes , sizeof( real ) , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
     memory.ehCoeffs += bytes;
     message( MSG_DEBUG1 , 0 , "  Allocating grid betaEy array\n" );
-    betaEy = allocArray( &bytes , sizeof( real ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    betaEy = allocFieldArrayRegion( &bytes , sizeof( real ) , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
     memory.ehCoeffs += bytes;
     message( MSG_DEBUG1 , 0 , "  Allocating grid betaEz array\n" );
-    betaEz = allocArray( &bytes , sizeof( real ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    betaEz = allocFieldArrayRegion( &bytes , sizeof( real ) , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
     memory.ehCoeffs += bytes;
     message( MSG_DEBUG1 , 0 , "  Allocating grid gammaHx array\n" );
-    gammaHx = allocArray( &bytes , sizeof( real ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    gammaHx = allocFieldArrayRegion( &bytes , sizeof( real ) , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
     memory.ehCoeffs += bytes;
     message( MSG_DEBUG1 , 0 , "  Allocating grid gammaHy array\n" );
-    gammaHy = allocArray( &bytes , sizeof( real ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    gammaHy = allocFieldArrayRegion( &bytes , sizeof( real ) , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
     memory.ehCoeffs += bytes;
     message( MSG_DEBUG1 , 0 , "  Allocating grid gammaHz array\n" );
-    gammaHz = allocArray( &bytes , sizeof( real ) , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    gammaHz = allocFieldArrayRegion( &bytes , sizeof( real ) , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
     memory.ehCoeffs += bytes;
 
   #endif
+
+  /* Place the pages of the arrays in memory local to the threads that update them. */
+  firstTouchFieldArray( Ex , sizeof( real ) , alim );
+  firstTouchFieldArray( Ey , sizeof( real ) , alim );
+  firstTouchFieldArray( Ez , sizeof( real ) , alim );
+  firstTouchFieldArray( Hx , sizeof( real ) , alim );
+  firstTouchFieldArray( Hy , sizeof( real ) , alim );
+  firstTouchFieldArray( Hz , sizeof( real ) , alim );
+  #ifdef USE_INDEXED_MEDIA
+    firstTouchFieldArray( mediumEx , mediumIndexSize , alim );
+    firstTouchFieldArray( mediumEy , mediumIndexSize , alim );
+    firstTouchFieldArray( mediumEz , mediumIndexSize , alim );
+    firstTouchFieldArray( mediumHx , mediumIndexSize , alim );
+    firstTouchFieldArray( mediumHy , mediumIndexSize , alim );
+    firstTouchFieldArray( mediumHz , mediumIndexSize , alim );
+  #else
+    firstTouchFieldArray( alphaEx , sizeof( real ) , alim );
+    firstTouchFieldArray( alphaEy , sizeof( real ) , alim );
+    firstTouchFieldArray( alphaEz , sizeof( real ) , alim );
+    firstTouchFieldArray( betaEx , sizeof( real ) , alim );
+    firstTouchFieldArray( betaEy , sizeof( real ) , alim );
+    firstTouchFieldArray( betaEz , sizeof( real ) , alim );
+    firstTouchFieldArray( gammaHx , sizeof( real ) , alim );
+    firstTouchFieldArray( gammaHy , sizeof( real ) , alim );
+    firstTouchFieldArray( gammaHz , sizeof( real ) , alim );
+  #endif
   
   message( MSG_DEBUG1 , 0 , "\n" );
 
@@ -579,6 +741,38 @@ void allocGridArrays( void )
 
 }
 
+/* 
+ * Touch the pages of the elements within limits lim of a field array from 
+ * allocFieldArray for the first time, zeroing them. The array is divided between
+ * the threads in the same way as the update loops so that on NUMA systems the 
+ * operating system places each part of the array in memory local to the thread
+ * that updates it.
+ */
+void firstTouchFieldArray( void *array , size_t size , int lim[6] )
+{
+
+  char ***a = array;
+  int i , j , item;
+  int blim[6];
+  LoopDecomp decomp;
+
+  getLoopDecomp( lim , &decomp );
+
+  #ifdef WITH_OPENMP
+    #pragma omp parallel for private( i , j , item , blim )
+  #endif
+  for ( item = 0 ; item < decomp.numItems ; item++ )
+  {
+    getLoopDecompLimits( &decomp , item , blim );
+    for ( i = blim[XLO] ; i <= blim[XHI] ; i++ )
+      for ( j = blim[YLO] ; j <= blim[YHI] ; j++ )
+        memset( a[i][j] + (size_t)blim[ZLO] * size , 0 , (size_t)( blim[ZHI] - blim[ZLO] + 1 ) * size );
+  }
+
+  return;
+
+}
+
 /* Initialise the cell edge length arrays and time-step. */
 void initCellEdges( void )
 {
@@ -682,208 +876,1535 @@ void initCellEdges( void )
 void clearGrid( void )
 {
 
-  int i , j , k;
+  int i , j , k , item;
+  int lim[6];
+  int blim[6];
+  LoopDecomp decomp;
 
   message( MSG_LOG , 0 , "  Clearing the grid...\n" );
 
   /* Clear E/H over entire grid, including PML and mirror cells. */
   /* INITIAL_FIELD_VALUE is zero unless limit checking mode is enabled. */
-  for ( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ ) {
-    for ( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ ) {
-      for ( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ ) {
-        Ex[i][j][k] = INITIAL_FIELD_VALUE;
-        Ey[i][j][k] = INITIAL_FIELD_VALUE;
-        Ez[i][j][k] = INITIAL_FIELD_VALUE;
-        Hx[i][j][k] = INITIAL_FIELD_VALUE;
-        Hy[i][j][k] = INITIAL_FIELD_VALUE;
-        Hz[i][j][k] = INITIAL_FIELD_VALUE;
+  for( int boundary = XLO ; boundary <= ZHI ; boundary += 2 )
+  {
+    lim[boundary] = gobox[boundary] - 1;
+    lim[boundary+1] = gobox[boundary+1];
+  }
+  clipToDomain( lim );
+  getLoopDecomp( lim , &decomp );
+
+  #ifdef WITH_OPENMP
+    #pragma omp parallel for private( i , j , k , item , blim )
+  #endif
+  for ( item = 0 ; item < decomp.numItems ; item++ ) {
+    getLoopDecompLimits( &decomp , item , blim );
+    for ( i = blim[XLO] ; i <= blim[XHI] ; i++ ) {
+      for ( j = blim[YLO] ; j <= blim[YHI] ; j++ ) {
+        for ( k = blim[ZLO] ; k <= blim[ZHI] ; k++ ) {
+          Ex[i][j][k] = INITIAL_FIELD_VALUE;
+          Ey[i][j][k] = INITIAL_FIELD_VALUE;
+          Ez[i][j][k] = INITIAL_FIELD_VALUE;
+          Hx[i][j][k] = INITIAL_FIELD_VALUE;
+          Hy[i][j][k] = INITIAL_FIELD_VALUE;
+          Hz[i][j][k] = INITIAL_FIELD_VALUE;
+        }
+      }
+    }
+  }
+
+  return;
+
+}
+
+/* Step electric fields in inner grid. */
+void updateGridEfield( void )
+{
+
+  double start = getWorkTime();
+
+  switch( gridKernel )
+  {
+  case GK_FUSED:
+    updateGridEfieldFused();
+    break;
+  case GK_TILED:
+    updateGridEfieldTiled();
+    break;
+  default:
+    updateGridEfieldStandard();
+    break;
+  }
+
+  addSweepTime( WT_GRID , getWorkTime() - start , getGridSweepCells( EX ) );
+
+  return;
+
+}
+
+/* Step magnetic fields in inner grid. */
+void updateGridHfield( void )
+{
+
+  double start = getWorkTime();
+
+  switch( gridKernel )
+  {
+  case GK_FUSED:
+    updateGridHfieldFused();
+    break;
+  case GK_TILED:
+    updateGridHfieldTiled();
+    break;
+  default:
+    updateGridHfieldStandard();
+    break;
+  }
+
+  addSweepTime( WT_GRID , getWorkTime() - start , getGridSweepCells( HX ) );
+
+  return;
+
+}
+
+/* Number of cells updated in a sweep of the three components starting at firstField. */
+static unsigned long getGridSweepCells( FieldComponent firstField )
+{
+
+  unsigned long count = 0;
+
+  for( FieldComponent field = firstField ; field < firstField + 3 ; field++ )
+    if( gfilim[field][XHI] >= gfilim[field][XLO] && gfilim[field][YHI] >= gfilim[field][YLO] && gfilim[field][ZHI] >= gfilim[field][ZLO] )
+      count += (unsigned long)( gfilim[field][XHI] - gfilim[field][XLO] + 1 ) * 
+                              ( gfilim[field][YHI] - gfilim[field][YLO] + 1 ) * 
+                              ( gfilim[field][ZHI] - gfilim[field][ZLO] + 1 );
+
+  return count;
+
+}
+
+/* 
+ * Estimated memory traffic in bytes and floating point operations of a field element 
+ * update of the inner grid for the compiled media mode. The field and the two new 
+ * curl terms are streamed, the other neighbours are reused from cache. Edges in 
+ * uniform runs load no coefficients. With scaled fields the curl needs no inverse 
+ * edge lengths.
+ */
+void getGridUpdateCost( bool isMagnetic , double *bytes , double *flops )
+{
+
+  int numCoeffs = isMagnetic ? 1 : 2;
+
+#ifdef USE_INDEXED_MEDIA
+  double coeffBytes = mediumIndexSize;
+#else
+  double coeffBytes = numCoeffs * sizeof( real );
+#endif
+
+  *bytes = 4 * sizeof( real ) + ( 1.0 - uniformEdgeFraction ) * coeffBytes;
+
+#ifdef USE_SCALED_FIELDS
+  *flops = numCoeffs + 4;
+#else
+  *flops = numCoeffs + 6;
+#endif
+
+  return;
+
+}
+
+/* Get the runs of the (i,j) pencil of a field component. */
+static inline const PencilRun *getPencilRuns( FieldComponent field , int i , int j , int *numRuns )
+{
+
+  unsigned long pencil;
+
+  pencil = (unsigned long)( i - gfilim[field][XLO] ) * ( gfilim[field][YHI] - gfilim[field][YLO] + 1 ) + ( j - gfilim[field][YLO] );
+  *numRuns = (int)( pencilRunIndex[field][pencil+1] - pencilRunIndex[field][pencil] );
+
+  return pencilRuns[field] + pencilRunIndex[field][pencil];
+
+}
+
+/* Get the effective update coefficients of a field component on the inner grid. */
+static inline void getGridCoefficients( FieldComponent field , int i , int j , int k , real *alpha , real *beta )
+{
+
+  switch( field )
+  {
+  case EX:
+    *alpha = ALPHA_EX(i,j,k);
+    *beta = BETA_EX(i,j,k);
+    break;
+  case EY:
+    *alpha = ALPHA_EY(i,j,k);
+    *beta = BETA_EY(i,j,k);
+    break;
+  case EZ:
+    *alpha = ALPHA_EZ(i,j,k);
+    *beta = BETA_EZ(i,j,k);
+    break;
+  case HX:
+    *alpha = 1.0;
+    *beta = GAMMA_HX(i,j,k);
+    break;
+  case HY:
+    *alpha = 1.0;
+    *beta = GAMMA_HY(i,j,k);
+    break;
+  case HZ:
+    *alpha = 1.0;
+    *beta = GAMMA_HZ(i,j,k);
+    break;
+  default:
+    assert( 0 );
+    break;
+  }
+
+  return;
+
+}
+
+/* 
+ * Determine if an edge of the inner grid is PEC. Electric field edges are PEC if
+ * their medium is, so the field on them stays zero. Magnetic field edges are only
+ * treated as PEC if all four electric field edges in their curl are, since their
+ * update is then an identity.
+ */
+static inline bool isPecEdge( FieldComponent field , int i , int j , int k )
+{
+
+  real alpha , beta;
+
+  if( i < gfilim[field][XLO] || i > gfilim[field][XHI] || 
+      j < gfilim[field][YLO] || j > gfilim[field][YHI] || 
+      k < gfilim[field][ZLO] || k > gfilim[field][ZHI] )
+    return false;
+
+  switch( field )
+  {
+  case EX:
+  case EY:
+  case EZ:
+    getGridCoefficients( field , i , j , k , &alpha , &beta );
+    return ( alpha == -1.0 && beta == 0.0 );
+  case HX:
+    return isPecEdge( EY , i , j , k ) && isPecEdge( EY , i , j , k + 1 ) && 
+           isPecEdge( EZ , i , j , k ) && isPecEdge( EZ , i , j + 1 , k );
+  case HY:
+    return isPecEdge( EX , i , j , k ) && isPecEdge( EX , i , j , k + 1 ) && 
+           isPecEdge( EZ , i , j , k ) && isPecEdge( EZ , i + 1 , j , k );
+  case HZ:
+    return isPecEdge( EX , i , j , k ) && isPecEdge( EX , i , j + 1 , k ) && 
+           isPecEdge( EY , i , j , k ) && isPecEdge( EY , i + 1 , j , k );
+  default:
+    assert( 0 );
+    return false;
+  }
+
+}
+
+/* 
+ * Pencil update kernels.
+ *
+ * Each updates one field component along k in [klo,khi] for fixed (i,j). They
+ * are the building blocks for all the grid update kernels. Uniform runs of the
+ * pencil keep their coefficients in registers, the remaining edges load them
+ * per edge. When the SIMD kernels are available the runs are passed to the 
+ * kernels selected for the processor.
+ * With indexed media PENCIL_LOOP has a variant for each medium index width so
+ * the width is tested once per pencil and the index row is read directly.
+ */
+
+#ifdef USE_INDEXED_MEDIA
+
+#define PENCIL_LOOP_WIDTH( type , medium , klo , khi , ... ) \
+  { \
+    const type *mrow = ( (type ***)(medium) )[i][j]; \
+    for ( int k = (klo) ; k <= (khi) ; k++ ) { __VA_ARGS__ } \
+  }
+
+#define PENCIL_LOOP( medium , klo , khi , ... ) \
+  switch( mediumIndexSize ) \
+  { \
+  case sizeof( MediumIndex8 ): \
+    PENCIL_LOOP_WIDTH( MediumIndex8 , medium , klo , khi , __VA_ARGS__ ); \
+    break; \
+  case sizeof( MediumIndex16 ): \
+    PENCIL_LOOP_WIDTH( MediumIndex16 , medium , klo , khi , __VA_ARGS__ ); \
+    break; \
+  default: \
+    PENCIL_LOOP_WIDTH( MediumIndex32 , medium , klo , khi , __VA_ARGS__ ); \
+    break; \
+  }
+
+#define PENCIL_ALPHA_EX mediumArray[mrow[k]]->alpha
+#define PENCIL_ALPHA_EY mediumArray[mrow[k]]->alpha
+#define PENCIL_ALPHA_EZ mediumArray[mrow[k]]->alpha
+#define PENCIL_BETA_EX  SCALE_betaEx( mediumArray[mrow[k]]->beta , i , j , k )
+#define PENCIL_BETA_EY  SCALE_betaEy( mediumArray[mrow[k]]->beta , i , j , k )
+#define PENCIL_BETA_EZ  SCALE_betaEz( mediumArray[mrow[k]]->beta , i , j , k )
+#define PENCIL_GAMMA_HX SCALE_gammaHx( mediumArray[mrow[k]]->gamma , i , j , k )
+#define PENCIL_GAMMA_HY SCALE_gammaHy( mediumArray[mrow[k]]->gamma , i , j , k )
+#define PENCIL_GAMMA_HZ SCALE_gammaHz( mediumArray[mrow[k]]->gamma , i , j , k )
+
+#else
+
+#define PENCIL_LOOP( medium , klo , khi , ... ) \
+  for ( int k = (klo) ; k <= (khi) ; k++ ) { __VA_ARGS__ }
+
+#define PENCIL_ALPHA_EX ALPHA_EX(i,j,k)
+#define PENCIL_ALPHA_EY ALPHA_EY(i,j,k)
+#define PENCIL_ALPHA_EZ ALPHA_EZ(i,j,k)
+#define PENCIL_BETA_EX  BETA_EX(i,j,k)
+#define PENCIL_BETA_EY  BETA_EY(i,j,k)
+#define PENCIL_BETA_EZ  BETA_EZ(i,j,k)
+#define PENCIL_GAMMA_HX GAMMA_HX(i,j,k)
+#define PENCIL_GAMMA_HY GAMMA_HY(i,j,k)
+#define PENCIL_GAMMA_HZ GAMMA_HZ(i,j,k)
+
+#endif
+
+/* Update Ex along a k-pencil. */
+static inline void updateExPencil( int i , int j , int klo , int khi )
+{
+
+  real *Ex_ij = GRID_ROW( Ex , i , j );
+  real *Hy_ij = GRID_ROW( Hy , i , j );
+  real *Hz_ij = GRID_ROW( Hz , i , j );
+  real *Hz_ij1 = GRID_ROW( Hz , i , j-1 );
+  const PencilRun *runs;
+  int numRuns , lo , hi;
+  real alpha , beta;
+
+  runs = getPencilRuns( EX , i , j , &numRuns );
+
+  for( int run = 0 ; run < numRuns && runs[run].klo <= khi ; run++ )
+  {
+
+    lo = runs[run].klo > klo ? runs[run].klo : klo;
+    hi = runs[run].khi < khi ? runs[run].khi : khi;
+    if( lo > hi )
+      continue;
+
+#ifdef USE_SIMD_KERNELS
+
+    if( runs[run].isUniform )
+    {
+      alpha = runs[run].alpha;
+      beta = runs[run].beta;
+      simdKernels->updateEfieldUniformSA( hi - lo + 1 , Ex_ij + lo , alpha , beta ,
+                                          idhy[j] , Hz_ij + lo , Hz_ij1 + lo , &idhz[lo] , Hy_ij + lo - 1 , Hy_ij + lo );
+    }
+    else
+    {
+      simdKernels->updateEfieldSA( hi - lo + 1 , Ex_ij + lo , GRID_ROW( alphaEx , i , j ) + lo , GRID_ROW( betaEx , i , j ) + lo ,
+                                   idhy[j] , Hz_ij + lo , Hz_ij1 + lo , &idhz[lo] , Hy_ij + lo - 1 , Hy_ij + lo );
+    }
+
+#else
+
+    if( runs[run].isUniform )
+    {
+      alpha = runs[run].alpha;
+      beta = runs[run].beta;
+      for ( int k = lo ; k <= hi ; k++ ) 
+      {
+        CHECK_NOT_VISITED( Ex_ij[k] );
+        Ex_ij[k] = alpha * Ex_ij[k] + beta
+          * curl_Hx( Hz_ij[k] , Hz_ij1[k] , Hy_ij[k-1] , Hy_ij[k] , i , j , k );
+        MARK_AS_VISITED( Ex_ij[k] );
       }
     }
+    else
+    {
+      PENCIL_LOOP( mediumEx , lo , hi ,
+        CHECK_NOT_VISITED( Ex_ij[k] );
+        Ex_ij[k] = PENCIL_ALPHA_EX * Ex_ij[k] + PENCIL_BETA_EX
+          * curl_Hx( Hz_ij[k] , Hz_ij1[k] , Hy_ij[k-1] , Hy_ij[k] , i , j , k );
+        MARK_AS_VISITED( Ex_ij[k] ); );
+    }
+
+#endif
+
   }
 
   return;
 
 }
 
-/* Step electric fields in inner grid. */
-void updateGridEfield( void )
+/* Update Ey along a k-pencil. */
+static inline void updateEyPencil( int i , int j , int klo , int khi )
+{
+
+  real *Ey_ij = GRID_ROW( Ey , i , j );
+  real *Hx_ij = GRID_ROW( Hx , i , j );
+  real *Hz_ij = GRID_ROW( Hz , i , j );
+  real *Hz_i1j = GRID_ROW( Hz , i-1 , j );
+  const PencilRun *runs;
+  int numRuns , lo , hi;
+  real alpha , beta;
+
+  runs = getPencilRuns( EY , i , j , &numRuns );
+
+  for( int run = 0 ; run < numRuns && runs[run].klo <= khi ; run++ )
+  {
+
+    lo = runs[run].klo > klo ? runs[run].klo : klo;
+    hi = runs[run].khi < khi ? runs[run].khi : khi;
+    if( lo > hi )
+      continue;
+
+#ifdef USE_SIMD_KERNELS
+
+    if( runs[run].isUniform )
+    {
+      alpha = runs[run].alpha;
+      beta = runs[run].beta;
+      simdKernels->updateEfieldUniformSA( hi - lo + 1 , Ey_ij + lo , alpha , beta ,
+                                          idhx[i] , Hz_i1j + lo , Hz_ij + lo , &idhz[lo] , Hx_ij + lo , Hx_ij + lo - 1 );
+    }
+    else
+    {
+      simdKernels->updateEfieldSA( hi - lo + 1 , Ey_ij + lo , GRID_ROW( alphaEy , i , j ) + lo , GRID_ROW( betaEy , i , j ) + lo ,
+                                   idhx[i] , Hz_i1j + lo , Hz_ij + lo , &idhz[lo] , Hx_ij + lo , Hx_ij + lo - 1 );
+    }
+
+#else
+
+    if( runs[run].isUniform )
+    {
+      alpha = runs[run].alpha;
+      beta = runs[run].beta;
+      for ( int k = lo ; k <= hi ; k++ ) 
+      {
+        CHECK_NOT_VISITED( Ey_ij[k] );
+        Ey_ij[k] = alpha * Ey_ij[k] + beta
+          * curl_Hy( Hx_ij[k] , Hx_ij[k-1] , Hz_i1j[k] , Hz_ij[k] , i , j , k );
+        MARK_AS_VISITED( Ey_ij[k] );
+      }
+    }
+    else
+    {
+      PENCIL_LOOP( mediumEy , lo , hi ,
+        CHECK_NOT_VISITED( Ey_ij[k] );
+        Ey_ij[k] = PENCIL_ALPHA_EY * Ey_ij[k] + PENCIL_BETA_EY
+          * curl_Hy( Hx_ij[k] , Hx_ij[k-1] , Hz_i1j[k] , Hz_ij[k] , i , j , k );
+        MARK_AS_VISITED( Ey_ij[k] ); );
+    }
+
+#endif
+
+  }
+
+  return;
+
+}
+
+/* Update Ez along a k-pencil. */
+static inline void updateEzPencil( int i , int j , int klo , int khi )
+{
+
+  real *Ez_ij = GRID_ROW( Ez , i , j );
+  real *Hx_ij = GRID_ROW( Hx , i , j );
+  real *Hy_ij = GRID_ROW( Hy , i , j );
+  real *Hy_i1j = GRID_ROW( Hy , i-1 , j );
+  real *Hx_ij1 = GRID_ROW( Hx , i , j-1 );
+  const PencilRun *runs;
+  int numRuns , lo , hi;
+  real alpha , beta;
+
+  runs = getPencilRuns( EZ , i , j , &numRuns );
+
+  for( int run = 0 ; run < numRuns && runs[run].klo <= khi ; run++ )
+  {
+
+    lo = runs[run].klo > klo ? runs[run].klo : klo;
+    hi = runs[run].khi < khi ? runs[run].khi : khi;
+    if( lo > hi )
+      continue;
+
+#ifdef USE_SIMD_KERNELS
+
+    if( runs[run].isUniform )
+    {
+      alpha = runs[run].alpha;
+      beta = runs[run].beta;
+      simdKernels->updateEfieldUniformSS( hi - lo + 1 , Ez_ij + lo , alpha , beta ,
+                                          idhx[i] , Hy_ij + lo , Hy_i1j + lo , idhy[j] , Hx_ij1 + lo , Hx_ij + lo );
+    }
+    else
+    {
+      simdKernels->updateEfieldSS( hi - lo + 1 , Ez_ij + lo , GRID_ROW( alphaEz , i , j ) + lo , GRID_ROW( betaEz , i , j ) + lo ,
+                                   idhx[i] , Hy_ij + lo , Hy_i1j + lo , idhy[j] , Hx_ij1 + lo , Hx_ij + lo );
+    }
+
+#else
+
+    if( runs[run].isUniform )
+    {
+      alpha = runs[run].alpha;
+      beta = runs[run].beta;
+      for ( int k = lo ; k <= hi ; k++ ) 
+      {
+        CHECK_NOT_VISITED( Ez_ij[k] );
+        Ez_ij[k] = alpha * Ez_ij[k] + beta
+          * curl_Hz( Hy_ij[k] , Hy_i1j[k] , Hx_ij1[k] , Hx_ij[k] , i , j , k );
+        MARK_AS_VISITED( Ez_ij[k] );
+      }
+    }
+    else
+    {
+      PENCIL_LOOP( mediumEz , lo , hi ,
+        CHECK_NOT_VISITED( Ez_ij[k] );
+        Ez_ij[k] = PENCIL_ALPHA_EZ * Ez_ij[k] + PENCIL_BETA_EZ
+          * curl_Hz( Hy_ij[k] , Hy_i1j[k] , Hx_ij1[k] , Hx_ij[k] , i , j , k );
+        MARK_AS_VISITED( Ez_ij[k] ); );
+    }
+
+#endif
+
+  }
+
+  return;
+
+}
+
+/* Update Hx along a k-pencil. */
+static inline void updateHxPencil( int i , int j , int klo , int khi )
+{
+
+  real *Hx_ij = GRID_ROW( Hx , i , j );
+  real *Ey_ij = GRID_ROW( Ey , i , j );
+  real *Ez_ij = GRID_ROW( Ez , i , j );
+  real *Ez_ij1 = GRID_ROW( Ez , i , j+1 );
+  const PencilRun *runs;
+  int numRuns , lo , hi;
+  real beta;
+
+  runs = getPencilRuns( HX , i , j , &numRuns );
+
+  for( int run = 0 ; run < numRuns && runs[run].klo <= khi ; run++ )
+  {
+
+    lo = runs[run].klo > klo ? runs[run].klo : klo;
+    hi = runs[run].khi < khi ? runs[run].khi : khi;
+    if( lo > hi )
+      continue;
+
+#ifdef USE_SIMD_KERNELS
+
+    if( runs[run].isUniform )
+    {
+      beta = runs[run].beta;
+      simdKernels->updateHfieldUniformSA( hi - lo + 1 , Hx_ij + lo , beta ,
+                                          idey[j] , Ez_ij + lo , Ez_ij1 + lo , &idez[lo] , Ey_ij + lo + 1 , Ey_ij + lo );
+    }
+    else
+    {
+      simdKernels->updateHfieldSA( hi - lo + 1 , Hx_ij + lo , GRID_ROW( gammaHx , i , j ) + lo ,
+                                   idey[j] , Ez_ij + lo , Ez_ij1 + lo , &idez[lo] , Ey_ij + lo + 1 , Ey_ij + lo );
+    }
+
+#else
+
+    if( runs[run].isUniform )
+    {
+      beta = runs[run].beta;
+      for ( int k = lo ; k <= hi ; k++ ) 
+      {
+        CHECK_NOT_VISITED( Hx_ij[k] );
+        Hx_ij[k] = Hx_ij[k] + beta
+          * curl_Ex( Ey_ij[k+1] , Ey_ij[k] , Ez_ij[k] , Ez_ij1[k] , i , j , k );
+        MARK_AS_VISITED( Hx_ij[k] );
+      }
+    }
+    else
+    {
+      PENCIL_LOOP( mediumHx , lo , hi ,
+        CHECK_NOT_VISITED( Hx_ij[k] );
+        Hx_ij[k] = Hx_ij[k] + PENCIL_GAMMA_HX
+          * curl_Ex( Ey_ij[k+1] , Ey_ij[k] , Ez_ij[k] , Ez_ij1[k] , i , j , k );
+        MARK_AS_VISITED( Hx_ij[k] ); );
+    }
+
+#endif
+
+  }
+
+  return;
+
+}
+
+/* Update Hy along a k-pencil. */
+static inline void updateHyPencil( int i , int j , int klo , int khi )
+{
+
+  real *Hy_ij = GRID_ROW( Hy , i , j );
+  real *Ex_ij = GRID_ROW( Ex , i , j );
+  real *Ez_ij = GRID_ROW( Ez , i , j );
+  real *Ez_i1j = GRID_ROW( Ez , i+1 , j );
+  const PencilRun *runs;
+  int numRuns , lo , hi;
+  real beta;
+
+  runs = getPencilRuns( HY , i , j , &numRuns );
+
+  for( int run = 0 ; run < numRuns && runs[run].klo <= khi ; run++ )
+  {
+
+    lo = runs[run].klo > klo ? runs[run].klo : klo;
+    hi = runs[run].khi < khi ? runs[run].khi : khi;
+    if( lo > hi )
+      continue;
+
+#ifdef USE_SIMD_KERNELS
+
+    if( runs[run].isUniform )
+    {
+      beta = runs[run].beta;
+      simdKernels->updateHfieldUniformSA( hi - lo + 1 , Hy_ij + lo , beta ,
+                                          idex[i] , Ez_i1j + lo , Ez_ij + lo , &idez[lo] , Ex_ij + lo , Ex_ij + lo + 1 );
+    }
+    else
+    {
+      simdKernels->updateHfieldSA( hi - lo + 1 , Hy_ij + lo , GRID_ROW( gammaHy , i , j ) + lo ,
+                                   idex[i] , Ez_i1j + lo , Ez_ij + lo , &idez[lo] , Ex_ij + lo , Ex_ij + lo + 1 );
+    }
+
+#else
+
+    if( runs[run].isUniform )
+    {
+      beta = runs[run].beta;
+      for ( int k = lo ; k <= hi ; k++ ) 
+      {
+        CHECK_NOT_VISITED( Hy_ij[k] );
+        Hy_ij[k] = Hy_ij[k] + beta
+          * curl_Ey( Ez_i1j[k] , Ez_ij[k] , Ex_ij[k] , Ex_ij[k+1] , i , j , k );
+        MARK_AS_VISITED( Hy_ij[k] );
+      }
+    }
+    else
+    {
+      PENCIL_LOOP( mediumHy , lo , hi ,
+        CHECK_NOT_VISITED( Hy_ij[k] );
+        Hy_ij[k] = Hy_ij[k] + PENCIL_GAMMA_HY
+          * curl_Ey( Ez_i1j[k] , Ez_ij[k] , Ex_ij[k] , Ex_ij[k+1] , i , j , k );
+        MARK_AS_VISITED( Hy_ij[k] ); );
+    }
+
+#endif
+
+  }
+
+  return;
+
+}
+
+/* Update Hz along a k-pencil. */
+static inline void updateHzPencil( int i , int j , int klo , int khi )
+{
+
+  real *Hz_ij = GRID_ROW( Hz , i , j );
+  real *Ex_ij = GRID_ROW( Ex , i , j );
+  real *Ey_ij = GRID_ROW( Ey , i , j );
+  real *Ex_ij1 = GRID_ROW( Ex , i , j+1 );
+  real *Ey_i1j = GRID_ROW( Ey , i+1 , j );
+  const PencilRun *runs;
+  int numRuns , lo , hi;
+  real beta;
+
+  runs = getPencilRuns( HZ , i , j , &numRuns );
+
+  for( int run = 0 ; run < numRuns && runs[run].klo <= khi ; run++ )
+  {
+
+    lo = runs[run].klo > klo ? runs[run].klo : klo;
+    hi = runs[run].khi < khi ? runs[run].khi : khi;
+    if( lo > hi )
+      continue;
+
+#ifdef USE_SIMD_KERNELS
+
+    if( runs[run].isUniform )
+    {
+      beta = runs[run].beta;
+      simdKernels->updateHfieldUniformSS( hi - lo + 1 , Hz_ij + lo , beta ,
+                                          idey[j] , Ex_ij1 + lo , Ex_ij + lo , idex[i] , Ey_ij + lo , Ey_i1j + lo );
+    }
+    else
+    {
+      simdKernels->updateHfieldSS( hi - lo + 1 , Hz_ij + lo , GRID_ROW( gammaHz , i , j ) + lo ,
+                                   idey[j] , Ex_ij1 + lo , Ex_ij + lo , idex[i] , Ey_ij + lo , Ey_i1j + lo );
+    }
+
+#else
+
+    if( runs[run].isUniform )
+    {
+      beta = runs[run].beta;
+      for ( int k = lo ; k <= hi ; k++ ) 
+      {
+        CHECK_NOT_VISITED( Hz_ij[k] );
+        Hz_ij[k] = Hz_ij[k] + beta
+          * curl_Ez( Ex_ij1[k] , Ex_ij[k] , Ey_ij[k] , Ey_i1j[k] , i , j , k );
+        MARK_AS_VISITED( Hz_ij[k] );
+      }
+    }
+    else
+    {
+      PENCIL_LOOP( mediumHz , lo , hi ,
+        CHECK_NOT_VISITED( Hz_ij[k] );
+        Hz_ij[k] = Hz_ij[k] + PENCIL_GAMMA_HZ
+          * curl_Ez( Ex_ij1[k] , Ex_ij[k] , Ey_ij[k] , Ey_i1j[k] , i , j , k );
+        MARK_AS_VISITED( Hz_ij[k] ); );
+    }
+
+#endif
+
+  }
+
+  return;
+
+}
+
+/* Step electric fields in inner grid - separate sweep for each component. */
+void updateGridEfieldStandard( void )
+{
+
+  int i , j , item;
+  int blim[6];
+  LoopDecomp decomp;
+
+  /* Update Ex. */
+  getLoopDecomp( gfilim[EX] , &decomp );
+  #ifdef WITH_OPENMP
+    #pragma omp parallel for private( i , j , item , blim )
+  #endif
+  for ( item = 0 ; item < decomp.numItems ; item++ ) 
+  {
+    getLoopDecompLimits( &decomp , item , blim );
+    for ( i = blim[XLO] ; i <= blim[XHI] ; i++ ) 
+      for ( j = blim[YLO] ; j <= blim[YHI] ; j++ ) 
+        updateExPencil( i , j , blim[ZLO] , blim[ZHI] );
+  }
+
+  /* Update Ey. */
+  getLoopDecomp( gfilim[EY] , &decomp );
+  #ifdef WITH_OPENMP
+    #pragma omp parallel for private( i , j , item , blim )
+  #endif
+  for ( item = 0 ; item < decomp.numItems ; item++ ) 
+  {
+    getLoopDecompLimits( &decomp , item , blim );
+    for ( i = blim[XLO] ; i <= blim[XHI] ; i++ ) 
+      for ( j = blim[YLO] ; j <= blim[YHI] ; j++ ) 
+        updateEyPencil( i , j , blim[ZLO] , blim[ZHI] );
+  }
+
+  /* Update Ez. */
+  getLoopDecomp( gfilim[EZ] , &decomp );
+  #ifdef WITH_OPENMP
+    #pragma omp parallel for private( i , j , item , blim )
+  #endif
+  for ( item = 0 ; item < decomp.numItems ; item++ ) 
+  {
+    getLoopDecompLimits( &decomp , item , blim );
+    for ( i = blim[XLO] ; i <= blim[XHI] ; i++ ) 
+      for ( j = blim[YLO] ; j <= blim[YHI] ; j++ ) 
+        updateEzPencil( i , j , blim[ZLO] , blim[ZHI] );
+  }
+
+  return;
+
+}
+
+/* Step magnetic fields in inner grid - separate sweep for each component. */
+void updateGridHfieldStandard( void )
+{
+
+  int i , j , item;
+  int blim[6];
+  LoopDecomp decomp;
+
+  /* Update Hx. */
+  getLoopDecomp( gfilim[HX] , &decomp );
+  #ifdef WITH_OPENMP
+    #pragma omp parallel for private( i , j , item , blim )
+  #endif
+  for ( item = 0 ; item < decomp.numItems ; item++ ) 
+  {
+    getLoopDecompLimits( &decomp , item , blim );
+    for ( i = blim[XLO] ; i <= blim[XHI] ; i++ ) 
+      for ( j = blim[YLO] ; j <= blim[YHI] ; j++ ) 
+        updateHxPencil( i , j , blim[ZLO] , blim[ZHI] );
+  }
+
+  /* Update Hy. */
+  getLoopDecomp( gfilim[HY] , &decomp );
+  #ifdef WITH_OPENMP
+    #pragma omp parallel for private( i , j , item , blim )
+  #endif
+  for ( item = 0 ; item < decomp.numItems ; item++ ) 
+  {
+    getLoopDecompLimits( &decomp , item , blim );
+    for ( i = blim[XLO] ; i <= blim[XHI] ; i++ ) 
+      for ( j = blim[YLO] ; j <= blim[YHI] ; j++ ) 
+        updateHyPencil( i , j , blim[ZLO] , blim[ZHI] );
+  }
+
+  /* Update Hz. */
+  getLoopDecomp( gfilim[HZ] , &decomp );
+  #ifdef WITH_OPENMP
+    #pragma omp parallel for private( i , j , item , blim )
+  #endif
+  for ( item = 0 ; item < decomp.numItems ; item++ ) 
+  {
+    getLoopDecompLimits( &decomp , item , blim );
+    for ( i = blim[XLO] ; i <= blim[XHI] ; i++ ) 
+      for ( j = blim[YLO] ; j <= blim[YHI] ; j++ ) 
+        updateHzPencil( i , j , blim[ZLO] , blim[ZHI] );
+  }
+
+  return;
+
+}
+
+/* Update the pencils of a field component within limits - sweep over blocks of (i,j) pencils. */
+static void updateGridComponent( int lim[6] , GridPencilFunc pencil )
+{
+
+  int i , j , item;
+  int blim[6];
+  LoopDecomp decomp;
+
+  getLoopDecomp( lim , &decomp );
+  #ifdef WITH_OPENMP
+    #pragma omp parallel for private( i , j , item , blim )
+  #endif
+  for ( item = 0 ; item < decomp.numItems ; item++ ) 
+  {
+    getLoopDecompLimits( &decomp , item , blim );
+    for ( i = blim[XLO] ; i <= blim[XHI] ; i++ ) 
+      for ( j = blim[YLO] ; j <= blim[YHI] ; j++ ) 
+        pencil( i , j , blim[ZLO] , blim[ZHI] );
+  }
+
+  return;
+
+}
+
+/*
+ * Update a field component of the inner grid either in its interior, which 
+ * excludes the outermost layers of its field limits on every face, or in those 
+ * outermost layers (the shell) only. The shell is one layer deep except on outer
+ * faces with Higdon boundaries, which read as many layers as their order. The 
+ * interior update does not depend on the halo of the domain or on any field the 
+ * external surface updates read, so it can proceed before the halo exchange and 
+ * external surface updates are complete. The shell is swept as the two slabs 
+ * normal to x, then the two normal to y within the remaining x limits and the 
+ * two normal to z within the remaining x and y limits.
+ */
+static void updateGridComponentRegion( FieldComponent field , GridPencilFunc pencil , bool isShell )
+{
+
+  int inner[6];
+  int slab[6];
+
+  for( int face = XLO ; face <= ZHI ; face += 2 )
+  {
+    int depthLo = isOuterDomainFace( face ) ? getMurFaceDepth( face ) : 1;
+    int depthHi = isOuterDomainFace( face + 1 ) ? getMurFaceDepth( face + 1 ) : 1;
+    inner[face] = gfilim[field][face] + depthLo;
+    if( inner[face] > gfilim[field][face+1] + 1 )
+      inner[face] = gfilim[field][face+1] + 1;
+    inner[face+1] = gfilim[field][face+1] - depthHi;
+    if( inner[face+1] < inner[face] - 1 )
+      inner[face+1] = inner[face] - 1;
+  }
+
+  if( !isShell )
+  {
+    updateGridComponent( inner , pencil );
+    return;
+  }
+
+  for( int direction = XDIR ; direction <= ZDIR ; direction++ )
+  {
+    for( int side = 0 ; side <= 1 ; side++ )
+    {
+      for( int other = XDIR ; other <= ZDIR ; other++ )
+      {
+        if( other < direction )
+        {
+          slab[2*other] = inner[2*other];
+          slab[2*other+1] = inner[2*other+1];
+        }
+        else if( other == direction && side == 0 )
+        {
+          slab[2*other] = gfilim[field][2*other];
+          slab[2*other+1] = inner[2*other] - 1;
+        }
+        else if( other == direction )
+        {
+          slab[2*other] = inner[2*other+1] + 1;
+          slab[2*other+1] = gfilim[field][2*other+1];
+        }
+        else
+        {
+          slab[2*other] = gfilim[field][2*other];
+          slab[2*other+1] = gfilim[field][2*other+1];
+        }
+      }
+      if( slab[2*direction] <= slab[2*direction+1] )
+        updateGridComponent( slab , pencil );
+    }
+  }
+
+  return;
+
+}
+
+/* Step electric fields in the interior of the inner grid of the domain. */
+void updateGridEfieldInterior( void )
+{
+
+  updateGridComponentRegion( EX , updateExPencil , false );
+  updateGridComponentRegion( EY , updateEyPencil , false );
+  updateGridComponentRegion( EZ , updateEzPencil , false );
+
+  return;
+
+}
+
+/* Step electric fields in the shell of the inner grid of the domain. */
+void updateGridEfieldShell( void )
+{
+
+  updateGridComponentRegion( EX , updateExPencil , true );
+  updateGridComponentRegion( EY , updateEyPencil , true );
+  updateGridComponentRegion( EZ , updateEzPencil , true );
+
+  return;
+
+}
+
+/* Step magnetic fields in the interior of the inner grid of the domain. */
+void updateGridHfieldInterior( void )
+{
+
+  updateGridComponentRegion( HX , updateHxPencil , false );
+  updateGridComponentRegion( HY , updateHyPencil , false );
+  updateGridComponentRegion( HZ , updateHzPencil , false );
+
+  return;
+
+}
+
+/* Step magnetic fields in the shell of the inner grid of the domain. */
+void updateGridHfieldShell( void )
+{
+
+  updateGridComponentRegion( HX , updateHxPencil , true );
+  updateGridComponentRegion( HY , updateHyPencil , true );
+  updateGridComponentRegion( HZ , updateHzPencil , true );
+
+  return;
+
+}
+
+/* Determine if pencil (i,j) is within the limits of a field component. */
+#define PENCIL_IN_LIMITS( lim , i , j ) ( (i) >= (lim)[XLO] && (i) <= (lim)[XHI] && (j) >= (lim)[YLO] && (j) <= (lim)[YHI] )
+
+/* Update a pencil of a component clipped to the k-range of a tile or block. */
+#define UPDATE_TILE_PENCIL( func , lim , i , j , klo , khi ) \
+  if( PENCIL_IN_LIMITS( lim , i , j ) ) \
+    func( i , j , (klo) > (lim)[ZLO] ? (klo) : (lim)[ZLO] , (khi) < (lim)[ZHI] ? (khi) : (lim)[ZHI] )
+
+/* Find the union of the field limits of components first to last. */
+void getUnionFieldLimits( int fieldLimits[6][6] , FieldComponent first , FieldComponent last , int lim[6] )
+{
+
+  for( MeshFace face = XLO ; face <= ZHI ; face++ )
+    lim[face] = fieldLimits[first][face];
+
+  for( FieldComponent field = first + 1 ; field <= last ; field++ )
+  {
+    for( MeshFace face = XLO ; face <= ZLO ; face += 2 )
+    {
+      if( fieldLimits[field][face] < lim[face] ) lim[face] = fieldLimits[field][face];
+      if( fieldLimits[field][face+1] > lim[face+1] ) lim[face+1] = fieldLimits[field][face+1];
+    }
+  }
+
+  return;
+
+}
+
+/* Update all three electric field components on the pencils of a block of the inner grid. */
+static inline void updateEfieldBlock( int blim[6] )
+{
+
+  for ( int i = blim[XLO] ; i <= blim[XHI] ; i++ ) 
+  {
+    for ( int j = blim[YLO] ; j <= blim[YHI] ; j++ ) 
+    {
+      UPDATE_TILE_PENCIL( updateExPencil , gfilim[EX] , i , j , blim[ZLO] , blim[ZHI] );
+      UPDATE_TILE_PENCIL( updateEyPencil , gfilim[EY] , i , j , blim[ZLO] , blim[ZHI] );
+      UPDATE_TILE_PENCIL( updateEzPencil , gfilim[EZ] , i , j , blim[ZLO] , blim[ZHI] );
+    }
+  }
+
+  return;
+
+}
+
+/* Update all three magnetic field components on the pencils of a block of the inner grid. */
+static inline void updateHfieldBlock( int blim[6] )
+{
+
+  for ( int i = blim[XLO] ; i <= blim[XHI] ; i++ ) 
+  {
+    for ( int j = blim[YLO] ; j <= blim[YHI] ; j++ ) 
+    {
+      UPDATE_TILE_PENCIL( updateHxPencil , gfilim[HX] , i , j , blim[ZLO] , blim[ZHI] );
+      UPDATE_TILE_PENCIL( updateHyPencil , gfilim[HY] , i , j , blim[ZLO] , blim[ZHI] );
+      UPDATE_TILE_PENCIL( updateHzPencil , gfilim[HZ] , i , j , blim[ZLO] , blim[ZHI] );
+    }
+  }
+
+  return;
+
+}
+
+/* Step electric fields in inner grid - single sweep over (i,j) pencils. */
+/* The three components share H field pencils so these are reused from cache. */
+void updateGridEfieldFused( void )
+{
+
+  int item;
+  int lim[6];
+  int blim[6];
+  LoopDecomp decomp;
+
+  getUnionFieldLimits( gfilim , EX , EZ , lim );
+  getLoopDecomp( lim , &decomp );
+
+  #ifdef WITH_OPENMP
+    #pragma omp parallel for private( item , blim )
+  #endif
+  for ( item = 0 ; item < decomp.numItems ; item++ ) 
+  {
+    getLoopDecompLimits( &decomp , item , blim );
+    updateEfieldBlock( blim );
+  }
+
+  return;
+
+}
+
+/* Step magnetic fields in inner grid - single sweep over (i,j) pencils. */
+void updateGridHfieldFused( void )
+{
+
+  int item;
+  int lim[6];
+  int blim[6];
+  LoopDecomp decomp;
+
+  getUnionFieldLimits( gfilim , HX , HZ , lim );
+  getLoopDecomp( lim , &decomp );
+
+  #ifdef WITH_OPENMP
+    #pragma omp parallel for private( item , blim )
+  #endif
+  for ( item = 0 ; item < decomp.numItems ; item++ ) 
+  {
+    getLoopDecompLimits( &decomp , item , blim );
+    updateHfieldBlock( blim );
+  }
+
+  return;
+
+}
+
+/* 
+ * Grid update tasks for the task graph scheduler. Each task is a block of (i,j) 
+ * pencils updated as in the fused kernel.
+ */
+void initGridTasks( int numTasks )
+{
+
+  int lim[6];
+
+  getUnionFieldLimits( gfilim , EX , EZ , lim );
+  getLoopDecompBlocks( lim , numTasks , &gridTasks[0] );
+  getUnionFieldLimits( gfilim , HX , HZ , lim );
+  getLoopDecompBlocks( lim , numTasks , &gridTasks[1] );
+
+  return;
+
+}
+
+/* Number of electric field grid update tasks. */
+int getGridNumEfieldTasks( void )
+{
+
+  return gridTasks[0].numItems;
+
+}
+
+/* Number of magnetic field grid update tasks. */
+int getGridNumHfieldTasks( void )
+{
+
+  return gridTasks[1].numItems;
+
+}
+
+/* Electric field grid update task. */
+void updateGridEfieldTask( int task )
+{
+
+  int blim[6];
+
+  getLoopDecompLimits( &gridTasks[0] , task , blim );
+  updateEfieldBlock( blim );
+
+  return;
+
+}
+
+/* Magnetic field grid update task. */
+void updateGridHfieldTask( int task )
+{
+
+  int blim[6];
+
+  getLoopDecompLimits( &gridTasks[1] , task , blim );
+  updateHfieldBlock( blim );
+
+  return;
+
+}
+
+/* Step electric fields in inner grid - fused sweep through the grid for each (j,k) tile. */
+/* The i-planes of a tile remain in cache between neighbouring values of i. */
+void updateGridEfieldTiled( void )
+{
+
+  int i , j , tile;
+  int jlo , jhi , klo , khi;
+  int lim[6];
+  int numTiles[2];
+
+  getUnionFieldLimits( gfilim , EX , EZ , lim );
+  getNumTiles( lim , gridTile , numTiles );
+
+  #ifdef WITH_OPENMP
+    #pragma omp parallel for private( i , j , tile , jlo , jhi , klo , khi )
+  #endif
+  for ( tile = 0 ; tile < numTiles[0] * numTiles[1] ; tile++ ) 
+  {
+    getTileLimits( lim , gridTile , numTiles , tile , &jlo , &jhi , &klo , &khi );
+    for ( i = lim[XLO] ; i <= lim[XHI] ; i++ ) 
+    {
+      for ( j = jlo ; j <= jhi ; j++ ) 
+      {
+        UPDATE_TILE_PENCIL( updateExPencil , gfilim[EX] , i , j , klo , khi );
+        UPDATE_TILE_PENCIL( updateEyPencil , gfilim[EY] , i , j , klo , khi );
+        UPDATE_TILE_PENCIL( updateEzPencil , gfilim[EZ] , i , j , klo , khi );
+      }
+    }
+  }
+
+  return;
+
+}
+
+/* Step magnetic fields in inner grid - fused sweep through the grid for each (j,k) tile. */
+void updateGridHfieldTiled( void )
+{
+
+  int i , j , tile;
+  int jlo , jhi , klo , khi;
+  int lim[6];
+  int numTiles[2];
+
+  getUnionFieldLimits( gfilim , HX , HZ , lim );
+  getNumTiles( lim , gridTile , numTiles );
+
+  #ifdef WITH_OPENMP
+    #pragma omp parallel for private( i , j , tile , jlo , jhi , klo , khi )
+  #endif
+  for ( tile = 0 ; tile < numTiles[0] * numTiles[1] ; tile++ ) 
+  {
+    getTileLimits( lim , gridTile , numTiles , tile , &jlo , &jhi , &klo , &khi );
+    for ( i = lim[XLO] ; i <= lim[XHI] ; i++ ) 
+    {
+      for ( j = jlo ; j <= jhi ; j++ ) 
+      {
+        UPDATE_TILE_PENCIL( updateHxPencil , gfilim[HX] , i , j , klo , khi );
+        UPDATE_TILE_PENCIL( updateHyPencil , gfilim[HY] , i , j , klo , khi );
+        UPDATE_TILE_PENCIL( updateHzPencil , gfilim[HZ] , i , j , klo , khi );
+      }
+    }
+  }
+
+  return;
+
+}
+
+/* 
+ * Temporally blocked update.
+ *
+ * The inner grid is advanced several time steps at a time using space-time tiles that
+ * are skewed in the x and y directions by two cells per time step. The electric field at 
+ * step t and position x is mapped to x + 2t and the magnetic field to x + 2t + 1. Since E 
+ * only depends on H at x and x - 1 and H only depends on E at x and x + 1 all dependencies
+ * then point to tiles with the same or lower indices in both directions. The tiles are 
+ * processed in wavefronts of constant I + J and tiles in the same wavefront are independent. 
+ * Each tile spans the whole grid in the z direction so the pencil updates keep their full
+ * length. Within a tile each time step is completed before the next so the tile remains
+ * in cache.
+ */
+
+/* Advance the fields in one space-time tile by numSteps time steps. */
+void updateTimeBlockTile( int numSteps , int start[3] , int tileSize[3] , int tileIdx[3] , int limE[6] , int limH[6] )
+{
+
+  int i , j;
+  int s0[3] , s1[3];
+  int lo[3] , hi[3];
+
+  for( int dir = XDIR ; dir <= YDIR ; dir++ )
+  {
+    s0[dir] = start[dir] + tileIdx[dir] * tileSize[dir];
+    s1[dir] = s0[dir] + tileSize[dir] - 1;
+  }
+
+  for( int t = 0 ; t < numSteps ; t++ )
+  {
+
+    /* Electric field: x = s - 2t. */
+    for( int dir = XDIR ; dir <= YDIR ; dir++ )
+    {
+      lo[dir] = s0[dir] - 2 * t;
+      hi[dir] = s1[dir] - 2 * t;
+      if( lo[dir] < limE[2*dir] ) lo[dir] = limE[2*dir];
+      if( hi[dir] > limE[2*dir+1] ) hi[dir] = limE[2*dir+1];
+    }
+    for ( i = lo[XDIR] ; i <= hi[XDIR] ; i++ ) 
+    {
+      for ( j = lo[YDIR] ; j <= hi[YDIR] ; j++ ) 
+      {
+        UPDATE_TILE_PENCIL( updateExPencil , gfilim[EX] , i , j , limE[ZLO] , limE[ZHI] );
+        UPDATE_TILE_PENCIL( updateEyPencil , gfilim[EY] , i , j , limE[ZLO] , limE[ZHI] );
+        UPDATE_TILE_PENCIL( updateEzPencil , gfilim[EZ] , i , j , limE[ZLO] , limE[ZHI] );
+      }
+    }
+
+    /* Magnetic field: x = s - 2t - 1. */
+    for( int dir = XDIR ; dir <= YDIR ; dir++ )
+    {
+      lo[dir] = s0[dir] - 2 * t - 1;
+      hi[dir] = s1[dir] - 2 * t - 1;
+      if( lo[dir] < limH[2*dir] ) lo[dir] = limH[2*dir];
+      if( hi[dir] > limH[2*dir+1] ) hi[dir] = limH[2*dir+1];
+    }
+    for ( i = lo[XDIR] ; i <= hi[XDIR] ; i++ ) 
+    {
+      for ( j = lo[YDIR] ; j <= hi[YDIR] ; j++ ) 
+      {
+        UPDATE_TILE_PENCIL( updateHxPencil , gfilim[HX] , i , j , limH[ZLO] , limH[ZHI] );
+        UPDATE_TILE_PENCIL( updateHyPencil , gfilim[HY] , i , j , limH[ZLO] , limH[ZHI] );
+        UPDATE_TILE_PENCIL( updateHzPencil , gfilim[HZ] , i , j , limH[ZLO] , limH[ZHI] );
+      }
+    }
+
+  }
+
+  return;
+
+}
+
+/* Advance the electric and magnetic fields in the inner grid by numSteps time steps. */
+/* Only valid if nothing else modifies the fields during these steps. */
+void updateGridTimeBlocked( int numSteps )
+{
+
+  int tile , wavefront;
+  int limE[6];
+  int limH[6];
+  int start[3];
+  int end[3];
+  int tileSize[3];
+  int numTiles[3];
+  int tileIdx[3];
+
+  getUnionFieldLimits( gfilim , EX , EZ , limE );
+  getUnionFieldLimits( gfilim , HX , HZ , limH );
+
+  /* Extent of the skewed space. */
+  for( int dir = XDIR ; dir <= YDIR ; dir++ )
+  {
+    start[dir] = limE[2*dir] < limH[2*dir] + 1 ? limE[2*dir] : limH[2*dir] + 1;
+    end[dir] = limE[2*dir+1] + 2 * numSteps - 2 > limH[2*dir+1] + 2 * numSteps - 1 ?
+               limE[2*dir+1] + 2 * numSteps - 2 : limH[2*dir+1] + 2 * numSteps - 1;
+    tileSize[dir] = timeBlockTile;
+    numTiles[dir] = ( end[dir] - start[dir] ) / tileSize[dir] + 1;
+  }
+
+  for( wavefront = 0 ; wavefront <= numTiles[XDIR] + numTiles[YDIR] - 2 ; wavefront++ )
+  {
+    #ifdef WITH_OPENMP
+      #pragma omp parallel for private( tile , tileIdx ) schedule( dynamic )
+    #endif
+    for( tile = 0 ; tile < numTiles[XDIR] ; tile++ )
+    {
+      tileIdx[XDIR] = tile;
+      tileIdx[YDIR] = wavefront - tile;
+      if( tileIdx[YDIR] >= 0 && tileIdx[YDIR] < numTiles[YDIR] )
+        updateTimeBlockTile( numSteps , start , tileSize , tileIdx , limE , limH );
+    }
+  }
+
+  return;
+
+}
+
+/* Set the edge length of the space-time tiles used by temporal blocking. */
+/* A column of cells through the grid in z, for a square tile, should fit in the L2 cache. */
+void initTimeBlockTileSize( void )
+{
+
+  unsigned long cacheSize;
+  unsigned long bytesPerCell;
+  int lim[6];
+
+  cacheSize = getCacheSize( 2 );
+  if( cacheSize == 0 ) cacheSize = DEFAULT_CACHE_SIZE;
+
+#ifdef USE_INDEXED_MEDIA
+  bytesPerCell = 6 * sizeof( real ) + 6 * mediumIndexSize;
+#else
+  bytesPerCell = 15 * sizeof( real );
+#endif
+
+  getUnionFieldLimits( gfilim , EX , HZ , lim );
+  bytesPerCell *= (unsigned long)( lim[ZHI] - lim[ZLO] + 1 );
+
+  timeBlockTile = (int) sqrt( (double) cacheSize / (double) bytesPerCell );
+  if( timeBlockTile < MIN_TIME_BLOCK_TILE_SIZE ) timeBlockTile = MIN_TIME_BLOCK_TILE_SIZE;
+
+  return;
+
+}
+
+/* Find the number of (j,k) tiles covering the limits lim. */
+void getNumTiles( int lim[6] , int tileSize[2] , int numTiles[2] )
+{
+
+  numTiles[0] = ( lim[YHI] - lim[YLO] ) / tileSize[0] + 1;
+  numTiles[1] = ( lim[ZHI] - lim[ZLO] ) / tileSize[1] + 1;
+
+  return;
+
+}
+
+/* Find the j and k limits of a tile. */
+void getTileLimits( int lim[6] , int tileSize[2] , int numTiles[2] , int tile , int *jlo , int *jhi , int *klo , int *khi )
+{
+
+  *jlo = lim[YLO] + ( tile / numTiles[1] ) * tileSize[0];
+  *jhi = *jlo + tileSize[0] - 1;
+  if( *jhi > lim[YHI] ) *jhi = lim[YHI];
+  *klo = lim[ZLO] + ( tile % numTiles[1] ) * tileSize[1];
+  *khi = *klo + tileSize[1] - 1;
+  if( *khi > lim[ZHI] ) *khi = lim[ZHI];
+
+  return;
+
+}
+
+/* 
+ * Decompose the loop nest over the pencils of the box lim into blocks for the threads.
+ * The outer i axis is split first, as the plain parallel loops did, and j is split
+ * too if there are not enough i planes for all the threads. The pencils are only split
+ * along k, into lengths of at least MIN_TILE_SIZE, when there are not enough (i,j)
+ * pencils, so thin and elongated domains and the PML regions still use all the threads.
+ */
+void getLoopDecomp( int lim[6] , LoopDecomp *decomp )
+{
+
+  int numThreads = 1;
+
+#ifdef WITH_OPENMP
+  numThreads = omp_get_max_threads();
+#endif
+
+  getLoopDecompBlocks( lim , numThreads , decomp );
+
+  return;
+
+}
+
+/* Decompose a loop nest as above for numParts workers. */
+void getLoopDecompBlocks( int lim[6] , int numParts , LoopDecomp *decomp )
+{
+
+  int numTarget;
+  int n[3];
+
+  for( MeshFace face = XLO ; face <= ZHI ; face++ )
+    decomp->lim[face] = lim[face];
+
+  for( CoordAxis axis = XDIR ; axis <= ZDIR ; axis++ )
+  {
+    n[axis] = lim[2*axis+1] - lim[2*axis] + 1;
+    decomp->numBlocks[axis] = 1;
+  }
+
+  if( n[XDIR] <= 0 || n[YDIR] <= 0 || n[ZDIR] <= 0 )
+  {
+    decomp->numItems = 0;
+    return;
+  }
+
+  if( numParts > 1 )
+  {
+    numTarget = LOOP_BLOCKS_PER_THREAD * numParts;
+
+    if( n[XDIR] >= numTarget )
+    {
+      decomp->numBlocks[XDIR] = numParts;
+    }
+    else
+    {
+      decomp->numBlocks[XDIR] = n[XDIR];
+      decomp->numBlocks[YDIR] = ( numTarget + n[XDIR] - 1 ) / n[XDIR];
+      if( decomp->numBlocks[YDIR] > n[YDIR] ) decomp->numBlocks[YDIR] = n[YDIR];
+      decomp->numBlocks[ZDIR] = ( numTarget + n[XDIR] * n[YDIR] - 1 ) / ( n[XDIR] * n[YDIR] );
+      if( decomp->numBlocks[ZDIR] > n[ZDIR] / MIN_TILE_SIZE ) decomp->numBlocks[ZDIR] = n[ZDIR] / MIN_TILE_SIZE;
+      if( decomp->numBlocks[ZDIR] < 1 ) decomp->numBlocks[ZDIR] = 1;
+    }
+  }
+
+  decomp->numItems = decomp->numBlocks[XDIR] * decomp->numBlocks[YDIR] * decomp->numBlocks[ZDIR];
+
+  return;
+
+}
+
+/* Find the limits of a block of a loop decomposition. */
+void getLoopDecompLimits( LoopDecomp *decomp , int item , int blim[6] )
+{
+
+  int block[3];
+  int n;
+
+  block[ZDIR] = item % decomp->numBlocks[ZDIR];
+  item /= decomp->numBlocks[ZDIR];
+  block[YDIR] = item % decomp->numBlocks[YDIR];
+  block[XDIR] = item / decomp->numBlocks[YDIR];
+
+  for( CoordAxis axis = XDIR ; axis <= ZDIR ; axis++ )
+  {
+    n = decomp->lim[2*axis+1] - decomp->lim[2*axis] + 1;
+    blim[2*axis] = decomp->lim[2*axis] + (int)( ( (long)block[axis] * n ) / decomp->numBlocks[axis] );
+    blim[2*axis+1] = decomp->lim[2*axis] + (int)( ( (long)( block[axis] + 1 ) * n ) / decomp->numBlocks[axis] ) - 1;
+  }
+
+  return;
+
+}
+
+/* Set the default tile size from the cache size, unless given by the user. */
+/* Two i-planes of each tile, including coefficients, should fit in half the L2 cache. */
+void initGridTileSize( void )
+{
+
+  unsigned long cacheSize;
+  unsigned long bytesPerCell;
+  unsigned long planeCells;
+  int lim[6];
+
+  getUnionFieldLimits( gfilim , EX , HZ , lim );
+
+  if( gridTile[0] <= 0 || gridTile[1] <= 0 )
+  {
+    cacheSize = getCacheSize( 2 );
+    if( cacheSize == 0 ) cacheSize = DEFAULT_CACHE_SIZE;
+
+#ifdef USE_INDEXED_MEDIA
+    bytesPerCell = 6 * sizeof( real ) + 6 * mediumIndexSize;
+#else
+    bytesPerCell = 15 * sizeof( real );
+#endif
+    planeCells = cacheSize / 2 / ( 2 * bytesPerCell );
+
+    /* Keep whole k-pencils if possible for streaming, otherwise split them. */
+    gridTile[1] = lim[ZHI] - lim[ZLO] + 1;
+    if( gridTile[1] > planeCells / MIN_TILE_SIZE ) 
+      gridTile[1] = ( planeCells / MIN_TILE_SIZE / MIN_TILE_SIZE ) * MIN_TILE_SIZE;
+    if( gridTile[1] < MIN_TILE_SIZE ) gridTile[1] = MIN_TILE_SIZE;
+    gridTile[0] = planeCells / gridTile[1];
+    if( gridTile[0] < 1 ) gridTile[0] = 1;
+
+    message( MSG_DEBUG1 , 0 , "  Using L2 cache size %lu bytes for default tile size\n" , cacheSize );
+  }
+
+  if( gridTile[0] > lim[YHI] - lim[YLO] + 1 ) gridTile[0] = lim[YHI] - lim[YLO] + 1;
+  if( gridTile[1] > lim[ZHI] - lim[ZLO] + 1 ) gridTile[1] = lim[ZHI] - lim[ZLO] + 1;
+
+  return;
+
+}
+
+/* Set tile size used by tiled kernels - zero or negative for default. */
+void setGridTileSize( int tileSize[2] )
+{
+
+  gridTile[0] = tileSize[0];
+  gridTile[1] = tileSize[1];
+
+  return;
+
+}
+
+/* Get tile size used by tiled kernels. */
+void getGridTileSize( int tileSize[2] )
 {
 
-  int i , j , k;
-  real **Ex_i, **Ey_i, **Ez_i, **Hx_i, **Hy_i, **Hz_i;
-  real *Ex_ij, *Ey_ij, *Ez_ij, *Hx_ij, *Hy_ij, *Hz_ij;
-  real **Hz_i1 , **Hy_i1 , *Hz_ij1 , *Hz_i1j , *Hy_i1j , *Hx_ij1;
-
-  /* Update Ex. */
-  #ifdef WITH_OPENMP
-    #pragma omp parallel for private( i , j , k , Ex_i , Ex_ij , Hy_i , Hy_ij , Hz_i , Hz_ij , Hz_ij1 )
-  #endif
-  for ( i = gfilim[EX][XLO] ; i <= gfilim[EX][XHI] ; i++ ) 
-  {
-    Ex_i = Ex[i];
-    Hy_i = Hy[i];
-    Hz_i = Hz[i];
-    for ( j = gfilim[EX][YLO] ; j <= gfilim[EX][YHI] ; j++ ) 
-    {
-      Ex_ij = Ex_i[j];
-      Hy_ij = Hy_i[j];
-      Hz_ij = Hz_i[j];
-      Hz_ij1 = Hz_i[j-1];
-      for ( k = gfilim[EX][ZLO] ; k <= gfilim[EX][ZHI] ; k++ ) 
-      {
-	CHECK_NOT_VISITED( Ex_ij[k] );
-        Ex_ij[k] = ALPHA_EX(i,j,k) * Ex_ij[k] + BETA_EX(i,j,k)
-	  * curl_Hx( Hz_ij[k] , Hz_ij1[k] , Hy_ij[k-1] , Hy_ij[k] , i , j , k );
-	MARK_AS_VISITED( Ex_ij[k] );  
-      }
-    }
-  }
-
-  /* Update Ey. */
-  #ifdef WITH_OPENMP
-    #pragma omp parallel for private( i , j , k , Ey_i , Ey_ij , Hx_i , Hx_ij , Hz_i , Hz_ij , Hz_i1 , Hz_i1j )
-  #endif
-  for ( i = gfilim[EY][XLO] ; i <= gfilim[EY][XHI] ; i++ ) 
-  {
-    Ey_i = Ey[i];
-    Hx_i = Hx[i];
-    Hz_i = Hz[i];
-    Hz_i1 = Hz[i-1];   
-    for ( j = gfilim[EY][YLO] ; j <= gfilim[EY][YHI] ; j++ ) 
-    {
-      Ey_ij = Ey_i[j];
-      Hx_ij = Hx_i[j];
-      Hz_ij = Hz_i[j];  
-      Hz_i1j = Hz_i1[j];
-      for ( k = gfilim[EY][ZLO] ; k <= gfilim[EY][ZHI] ; k++ ) 
-      {
-	CHECK_NOT_VISITED( Ey_ij[k] );
-        Ey_ij[k] = ALPHA_EY(i,j,k) * Ey_ij[k] + BETA_EY(i,j,k)
-	  * curl_Hy( Hx_ij[k] , Hx_ij[k-1] , Hz_i1j[k] , Hz_ij[k] , i , j , k ); 
-	MARK_AS_VISITED( Ey_ij[k] );
-      }
-    }
-  }
-
-  /* Update Ez. */
-  #ifdef WITH_OPENMP
-    #pragma omp parallel for private( i , j , k , Ez_i , Ez_ij , Hx_i , Hx_ij , Hy_i , Hy_ij , Hy_i1 , Hy_i1j , Hx_ij1 )
-  #endif
-  for ( i = gfilim[EZ][XLO] ; i <= gfilim[EZ][XHI] ; i++ ) 
-  {
-    Ez_i = Ez[i];
-    Hx_i = Hx[i];
-    Hy_i = Hy[i];
-    Hy_i1 = Hy[i-1];
-    for ( j = gfilim[EZ][YLO] ; j <= gfilim[EZ][YHI] ; j++ ) 
-    {
-      Ez_ij = Ez_i[j];
-      Hx_ij = Hx_i[j];
-      Hy_ij = Hy_i[j];       
-      Hy_i1j = Hy_i1[j];
-      Hx_ij1 = Hx_i[j-1];
-      for ( k = gfilim[EZ][ZLO] ; k <= gfilim[EZ][ZHI] ; k++ ) 
-      {
-	CHECK_NOT_VISITED( Ez_ij[k] );
-        Ez_ij[k] = ALPHA_EZ(i,j,k) * Ez_ij[k] + BETA_EZ(i,j,k)
-	  * curl_Hz( Hy_ij[k] , Hy_i1j[k] , Hx_ij1[k] , Hx_ij[k] , i , j , k );
-	MARK_AS_VISITED( Ez_ij[k] );
-      }
-    }
-  }
+  tileSize[0] = gridTile[0];
+  tileSize[1] = gridTile[1];
 
   return;
 
 }
 
-/* Step magnetic fields in inner grid. */
-void updateGridHfield( void )
+/* Set grid update kernel by name - returns false if name is invalid. */
+bool setGridKernel( char *name )
 {
 
-  int i , j , k;
-  real **Ex_i, **Ey_i, **Ez_i, **Hx_i, **Hy_i, **Hz_i;
-  real *Ex_ij, *Ey_ij, *Ez_ij, *Hx_ij, *Hy_ij, *Hz_ij;
-  real **Ez_i1 , **Ey_i1 , *Ez_ij1 , *Ez_i1j , *Ex_ij1 , *Ey_i1j;
-
-  /* Update Hx. */
-  #ifdef WITH_OPENMP
-    #pragma omp parallel for private( i , j , k , Ey_i , Ey_ij , Ez_i , Ez_ij , Hx_i , Hx_ij , Ez_ij1 )
-  #endif
-  for ( i = gfilim[HX][XLO] ; i <= gfilim[HX][XHI] ; i++ ) 
+  for( GridKernel kernel = GK_STANDARD ; kernel < GK_UNDEFINED ; kernel++ )
   {
-    Hx_i = Hx[i];
-    Ey_i = Ey[i];
-    Ez_i = Ez[i];   
-    for ( j = gfilim[HX][YLO] ; j <= gfilim[HX][YHI] ; j++ ) 
+    if( strncmp( name , GRID_KERNEL_STR[kernel] , TAG_SIZE ) == 0 )
     {
-      Hx_ij = Hx_i[j];
-      Ey_ij = Ey_i[j];
-      Ez_ij = Ez_i[j];   
-      Ez_ij1 = Ez_i[j+1];
-      for ( k = gfilim[HX][ZLO] ; k <= gfilim[HX][ZHI] ; k++ ) 
-      {
-        CHECK_NOT_VISITED( Hx_ij[k] );
-        Hx_ij[k] = Hx_ij[k] + GAMMA_HX(i,j,k)
-	  * curl_Ex( Ey_ij[k+1] , Ey_ij[k] , Ez_ij[k] , Ez_ij1[k] , i , j , k ); 
-	MARK_AS_VISITED( Hx_ij[k] );
-      }
+      gridKernel = kernel;
+      return true;
     }
   }
 
-  /* Update Hy. */
-  #ifdef WITH_OPENMP
-    #pragma omp parallel for private( i , j , k , Ex_i , Ex_ij , Ez_i , Ez_ij , Hy_i , Hy_ij , Ez_i1 , Ez_i1j )
-  #endif
-  for ( i = gfilim[HY][XLO] ; i <= gfilim[HY][XHI] ; i++ ) 
-  {
-    Hy_i = Hy[i];
-    Ex_i = Ex[i];
-    Ez_i = Ez[i];
-    Ez_i1 = Ez[i+1];
-    for ( j = gfilim[HY][YLO] ; j <= gfilim[HY][YHI] ; j++ ) 
-    {
-      Hy_ij = Hy_i[j];
-      Ex_ij = Ex_i[j];
-      Ez_ij = Ez_i[j];   
-      Ez_i1j = Ez_i1[j];
-      for ( k = gfilim[HY][ZLO] ; k <= gfilim[HY][ZHI] ; k++ ) 
-      {
-	CHECK_NOT_VISITED( Hy_ij[k] );
-        Hy_ij[k] = Hy_ij[k] + GAMMA_HY(i,j,k)
-	  * curl_Ey( Ez_i1j[k] , Ez_ij[k] , Ex_ij[k] , Ex_ij[k+1] , i , j , k );
-	MARK_AS_VISITED( Hy_ij[k] );
-      }
-    }
-  }
+  return false;
 
-  /* Update Hz. */
-  #ifdef WITH_OPENMP
-    #pragma omp parallel for private( i , j , k , Ex_i , Ex_ij , Ey_i , Ey_ij , Hz_i , Hz_ij , Ex_ij1 , Ey_i1 , Ey_i1j )
-  #endif
-  for ( i = gfilim[HZ][XLO] ; i <= gfilim[HZ][XHI] ; i++ ) 
-  {
-    Hz_i = Hz[i];
-    Ex_i = Ex[i];
-    Ey_i = Ey[i];
-    Ey_i1 = Ey[i+1];
-    for ( j = gfilim[HZ][YLO] ; j <= gfilim[HZ][YHI] ; j++ ) 
-    {
-      Hz_ij = Hz_i[j];
-      Ex_ij = Ex_i[j];
-      Ey_ij = Ey_i[j];   
-      Ex_ij1 = Ex_i[j+1];
-      Ey_i1j = Ey_i1[j];
-      for ( k = gfilim[HZ][ZLO] ; k <= gfilim[HZ][ZHI] ; k++ ) 
-      {
-        CHECK_NOT_VISITED( Hz_ij[k] );
-        Hz_ij[k] = Hz_ij[k] + GAMMA_HZ(i,j,k)
-	  * curl_Ez( Ex_ij1[k] , Ex_ij[k] , Ey_ij[k] , Ey_i1j[k] , i , j , k );
-	MARK_AS_VISITED( Hz_ij[k] );
-      }
-    }
-  }
+}
 
-  return;
+/* Get grid update kernel. */
+GridKernel getGridKernel( void )
+{
+
+  return gridKernel;
 
 }
 
@@ -894,6 +2415,19 @@ void reportGrid( void )
   message( MSG_LOG , 0 , "\nGrid characteristics:\n\n" );
 
   message( MSG_LOG , 0 , "  Grid is %s\n" , GRID_TYPE[gridType] );
+
+  message( MSG_LOG , 0 , "  Grid update kernel is %s\n" , GRID_KERNEL_STR[gridKernel] );
+  if( gridKernel == GK_TILED )
+    message( MSG_LOG , 0 , "  Grid tile size [cells]: %d x %d\n" , gridTile[0] , gridTile[1] );
+#ifdef USE_SIMD_KERNELS
+  message( MSG_LOG , 0 , "  SIMD kernel instruction set is %s\n" , getSimdLevelName() );
+#endif
+#ifdef USE_INDEXED_MEDIA
+  message( MSG_LOG , 0 , "  Medium index is %lu-bytes\n" , (unsigned long) mediumIndexSize );
+#ifdef USE_AVERAGED_MEDIA
+  message( MSG_LOG , 0 , "  Number of averaged media: %lu\n" , (unsigned long) getNumAveragedMedia() );
+#endif
+#endif
     
   message( MSG_LOG , 0 , "  Number of lines x: %d y: %d z: %d\n" , numLines[XDIR] , numLines[YDIR] , numLines[ZDIR] );
 
@@ -914,6 +2448,9 @@ void reportGrid( void )
     message( MSG_LOG , 0 , "  Ghost grid: BBOX=[%d,%d,%d,%d,%d,%d]\n",
            ggbox[XLO] , ggbox[XHI] , ggbox[YLO] ,
            ggbox[YHI] , ggbox[ZLO] , ggbox[ZHI] );
+
+  if( isDomainDecomposed() )
+    reportDomain();
     
   message( MSG_LOG , 0 , "  Minimum edge lengths: DXMIN = %e, DYMIN = %e, DZMIN = %e\n" , dmin[XDIR] , dmin[YDIR] , dmin[ZDIR] );
 
@@ -939,9 +2476,12 @@ void reportGrid( void )
   allocArrayReport();
 
   /* Write mesh lines to files. */
-  writeLines( "xlines.dat" , numLines[XDIR] , xlines );
-  writeLines( "ylines.dat" , numLines[YDIR] , ylines );
-  writeLines( "zlines.dat" , numLines[ZDIR] , zlines );
+  if( isRootDomain() )
+  {
+    writeLines( "xlines.dat" , numLines[XDIR] , xlines );
+    writeLines( "ylines.dat" , numLines[YDIR] , ylines );
+    writeLines( "zlines.dat" , numLines[ZDIR] , zlines );
+  }
 
   return;
 
@@ -1030,6 +2570,18 @@ void deallocGridArrays( void )
 
   message( MSG_DEBUG1 , 0 , "Deallocating the grid...\n" );
 
+  for( FieldComponent field = EX ; field <= HZ ; field++ )
+  {
+    if( pencilRuns[field] )
+    {
+      message( MSG_DEBUG1 , 0 , "  Deallocating %s pencil run arrays\n" , FIELD[field] );
+      deallocArray( pencilRuns[field] , 1 , numPencilRuns[field] );
+      deallocArray( pencilRunIndex[field] , 1 , 0 );
+      pencilRuns[field] = NULL;
+      pencilRunIndex[field] = NULL;
+    }
+  }
+
   message( MSG_DEBUG1 , 0 , "  Deallocating grid dex array\n" );
   deallocArray( dex , 1 , numCells[XDIR] );
   message( MSG_DEBUG1 , 0 , "  Deallocating grid dey array\n" );
@@ -1056,50 +2608,50 @@ void deallocGridArrays( void )
   deallocArray( idhz , 1 , numCells[ZDIR] );
 
   message( MSG_DEBUG1 , 0 , "  Deallocating grid Ex array\n" );
-  deallocArray( Ex , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+  deallocFieldArray( Ex );
   message( MSG_DEBUG1 , 0 , "  Deallocating grid Ey array\n" );
-  deallocArray( Ey , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+  deallocFieldArray( Ey );
   message( MSG_DEBUG1 , 0 , "  Deallocating grid Ez array\n" );
-  deallocArray( Ez , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+  deallocFieldArray( Ez );
   message( MSG_DEBUG1 , 0 , "  Deallocating grid Hx array\n" );
-  deallocArray( Hx , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+  deallocFieldArray( Hx );
   message( MSG_DEBUG1 , 0 , "  Deallocating grid Hy array\n" );
-  deallocArray( Hy , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+  deallocFieldArray( Hy );
   message( MSG_DEBUG1 , 0 , "  Deallocating grid Hz array\n" );
-  deallocArray( Hz , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+  deallocFieldArray( Hz );
 
   #ifdef USE_INDEXED_MEDIA
     message( MSG_DEBUG1 , 0 , "  Deallocating grid mediumEx array\n" );
-    deallocArray( mediumEx , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    deallocFieldArray( mediumEx );
     message( MSG_DEBUG1 , 0 , "  Deallocating grid mediumEy array\n" );
-    deallocArray( mediumEy , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    deallocFieldArray( mediumEy );
     message( MSG_DEBUG1 , 0 , "  Deallocating grid mediumEz array\n" );
-    deallocArray( mediumEz , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    deallocFieldArray( mediumEz );
     message( MSG_DEBUG1 , 0 , "  Deallocating grid mediumHx array\n" );
-    deallocArray( mediumHx , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    deallocFieldArray( mediumHx );
     message( MSG_DEBUG1 , 0 , "  Deallocating grid mediumHy array\n" );
-    deallocArray( mediumHy , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    deallocFieldArray( mediumHy );
     message( MSG_DEBUG1 , 0 , "  Deallocating grid mediumHz array\n" );
-    deallocArray( mediumHz , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );  
+    deallocFieldArray( mediumHz );  
   #else
     message( MSG_DEBUG1 , 0 , "  Deallocating grid alphaEx array\n" );
-    deallocArray( alphaEx , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    deallocFieldArray( alphaEx );
     message( MSG_DEBUG1 , 0 , "  Deallocating grid alphaEy array\n" );
-    deallocArray( alphaEy , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    deallocFieldArray( alphaEy );
     message( MSG_DEBUG1 , 0 , "  Deallocating grid alphaEz array\n" );
-    deallocArray( alphaEz , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    deallocFieldArray( alphaEz );
     message( MSG_DEBUG1 , 0 , "  Deallocating grid betaEx array\n" );
-    deallocArray( betaEx , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    deallocFieldArray( betaEx );
     message( MSG_DEBUG1 , 0 , "  Deallocating grid betaEy array\n" );
-    deallocArray( betaEy , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    deallocFieldArray( betaEy );
     message( MSG_DEBUG1 , 0 , "  Deallocating grid betaEz array\n" );
-    deallocArray( betaEz , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    deallocFieldArray( betaEz );
     message( MSG_DEBUG1 , 0 , "  Deallocating grid gammaHx array\n" );
-    deallocArray( gammaHx , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    deallocFieldArray( gammaHx );
     message( MSG_DEBUG1 , 0 , "  Deallocating grid gammaHy array\n" );
-    deallocArray( gammaHy , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    deallocFieldArray( gammaHy );
     message( MSG_DEBUG1 , 0 , "  Deallocating grid gammaHz array\n" );
-    deallocArray( gammaHz , 3 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] );
+    deallocFieldArray( gammaHz );
   #endif
     
   message( MSG_DEBUG1 , 0 , "  Deallocating xlines array\n" );
@@ -1129,6 +2681,51 @@ real getGridTimeStep( void )
 
 }
 
+/* 
+ * Edge length of the mesh cell on an external face, which the PML cells beyond the face
+ * copy. Valid once the mesh lines are read, before the grid is initialised.
+ */
+real getMeshBoundaryCellSize( MeshFace face )
+{
+
+  real *lines[3] = { xlines , ylines , zlines };
+  CoordAxis direction = face / 2;
+  int last = numLines[direction] - 1;
+
+  if( face % 2 == 0 )
+    return lines[direction][1] - lines[direction][0];
+  else
+    return lines[direction][last] - lines[direction][last-1];
+
+}
+
+/* 
+ * Time step of the mesh from the smallest mesh cell in each direction. This is the
+ * time step the grid will use, available before the grid is initialised.
+ */
+real getMeshTimeStep( void )
+{
+
+  real *lines[3] = { xlines , ylines , zlines };
+  real minEdge[3];
+  real edge;
+
+  for( CoordAxis direction = XDIR ; direction <= ZDIR ; direction++ )
+  {
+    minEdge[direction] = REAL_MAX;
+    for( int line = 0 ; line < numLines[direction] - 1 ; line++ )
+    {
+      edge = lines[direction][line+1] - lines[direction][line];
+      if( edge < minEdge[direction] ) minEdge[direction] = edge;
+    }
+  }
+
+  return getCourantNumber() / c0 / sqrt( ( 1.0 / minEdge[XDIR] ) * ( 1.0 / minEdge[XDIR] )
+                                       + ( 1.0 / minEdge[YDIR] ) * ( 1.0 / minEdge[YDIR] )
+                                       + ( 1.0 / minEdge[ZDIR] ) * ( 1.0 / minEdge[ZDIR] ) );
+
+}
+
 /* Get number of cells in mesh. */
 void getGridNumCells( int numMeshCells[3] )
 {
@@ -1160,6 +2757,152 @@ void initMediaArrays( void )
 
 }
 
+/* 
+ * Find the uniform runs on the pencils of the inner grid. 
+ * Depends: all initialisation that sets media on the grid.
+ */
+void initPencilRuns( void )
+{
+
+  unsigned long bytes;
+  unsigned long numPencils;
+  unsigned long numEdges = 0;
+  unsigned long numRunEdges = 0;
+  unsigned long numUniformEdges = 0;
+  int ni , nj , nk;
+
+  message( MSG_LOG , 0 , "\nInitialising grid pencil runs...\n\n" );
+
+  for( FieldComponent field = EX ; field <= HZ ; field++ )
+  {
+
+    ni = gfilim[field][XHI] - gfilim[field][XLO] + 1;
+    nj = gfilim[field][YHI] - gfilim[field][YLO] + 1;
+    nk = gfilim[field][ZHI] - gfilim[field][ZLO] + 1;
+    numPencils = ( ni > 0 && nj > 0 ) ? (unsigned long)ni * (unsigned long)nj : 0;
+    numEdges += nk > 0 ? numPencils * (unsigned long)nk : 0;
+
+    message( MSG_DEBUG1 , 0 , "  Allocating %s pencil run index array\n" , FIELD[field] );
+    pencilRunIndex[field] = allocArray( &bytes , sizeof( unsigned long ) , 1 , numPencils + 1 );
+    memory.ehCoeffs += bytes;
+
+    /* Count the runs on each pencil. */
+    pencilRunIndex[field][0] = 0;
+    #ifdef WITH_OPENMP
+      #pragma omp parallel for
+    #endif
+    for( int i = gfilim[field][XLO] ; i <= gfilim[field][XHI] ; i++ )
+      for( int j = gfilim[field][YLO] ; j <= gfilim[field][YHI] ; j++ )
+        pencilRunIndex[field][(unsigned long)( i - gfilim[field][XLO] ) * nj + ( j - gfilim[field][YLO] ) + 1] = 
+          findPencilRuns( field , i , j , NULL );
+
+    for( unsigned long pencil = 0 ; pencil < numPencils ; pencil++ )
+      pencilRunIndex[field][pencil+1] += pencilRunIndex[field][pencil];
+    numPencilRuns[field] = pencilRunIndex[field][numPencils];
+
+    message( MSG_DEBUG1 , 0 , "  Allocating %s pencil run array\n" , FIELD[field] );
+    pencilRuns[field] = allocArray( &bytes , sizeof( PencilRun ) , 1 , numPencilRuns[field] > 0 ? numPencilRuns[field] : 1 );
+    memory.ehCoeffs += bytes;
+
+    /* Set the runs. */
+    #ifdef WITH_OPENMP
+      #pragma omp parallel for
+    #endif
+    for( int i = gfilim[field][XLO] ; i <= gfilim[field][XHI] ; i++ )
+      for( int j = gfilim[field][YLO] ; j <= gfilim[field][YHI] ; j++ )
+        findPencilRuns( field , i , j , pencilRuns[field] + pencilRunIndex[field][(unsigned long)( i - gfilim[field][XLO] ) * nj + ( j - gfilim[field][YLO] )] );
+
+    for( unsigned long run = 0 ; run < numPencilRuns[field] ; run++ )
+    {
+      numRunEdges += pencilRuns[field][run].khi - pencilRuns[field][run].klo + 1;
+      if( pencilRuns[field][run].isUniform )
+        numUniformEdges += pencilRuns[field][run].khi - pencilRuns[field][run].klo + 1;
+    }
+
+  }
+
+  uniformEdgeFraction = numRunEdges > 0 ? (double) numUniformEdges / numRunEdges : 0.0;
+
+  message( MSG_LOG , 0 , "  Edges in uniform runs: %lu of %lu (%.1f%%)\n" , numUniformEdges , numRunEdges , 
+           numRunEdges > 0 ? 100.0 * numUniformEdges / numRunEdges : 0.0 );
+  message( MSG_LOG , 0 , "  PEC edges skipped: %lu of %lu (%.1f%%)\n" , numEdges - numRunEdges , numEdges , 
+           numEdges > 0 ? 100.0 * ( numEdges - numRunEdges ) / numEdges : 0.0 );
+
+  return;
+
+}
+
+/* 
+ * Find the runs on the (i,j) pencil of a field component. Runs of constant coefficients 
+ * at least MIN_UNIFORM_RUN edges long are uniform, the edges between them are merged into
+ * non-uniform runs. Runs of PEC edges are left out. The runs are stored if runs is not 
+ * NULL. Returns the number of runs.
+ */
+int findPencilRuns( FieldComponent field , int i , int j , PencilRun *runs )
+{
+
+  int numRuns = 0;
+  int klo , khi;
+  bool isUniform;
+  bool lastIsUniform = true;
+  bool isPec = false;
+  real alpha0 , beta0 , alpha , beta;
+
+  for( klo = gfilim[field][ZLO] ; klo <= gfilim[field][ZHI] ; klo = khi + 1 )
+  {
+
+    /* Find the end of the run of constant coefficients starting at klo. */
+    getGridCoefficients( field , i , j , klo , &alpha0 , &beta0 );
+#ifdef SKIP_PEC_EDGES
+    isPec = isPecEdge( field , i , j , klo );
+#endif
+    for( khi = klo ; khi < gfilim[field][ZHI] ; khi++ )
+    {
+      getGridCoefficients( field , i , j , khi + 1 , &alpha , &beta );
+      if( alpha != alpha0 || beta != beta0 )
+        break;
+#ifdef SKIP_PEC_EDGES
+      if( isPecEdge( field , i , j , khi + 1 ) != isPec )
+        break;
+#endif
+    }
+
+    /* Skip PEC edges, the next run cannot extend one before them. */
+    if( isPec )
+    {
+      lastIsUniform = true;
+      continue;
+    }
+
+    isUniform = ( khi - klo + 1 >= MIN_UNIFORM_RUN );
+
+    if( !isUniform && !lastIsUniform )
+    {
+      /* Extend the previous non-uniform run. */
+      if( runs )
+        runs[numRuns-1].khi = khi;
+    }
+    else
+    {
+      if( runs )
+      {
+        runs[numRuns].klo = klo;
+        runs[numRuns].khi = khi;
+        runs[numRuns].isUniform = isUniform;
+        runs[numRuns].alpha = alpha0;
+        runs[numRuns].beta = beta0;
+      }
+      numRuns++;
+    }
+
+    lastIsUniform = isUniform;
+
+  }
+
+  return numRuns;
+
+}
+
 /* Write mesh lines to file for processing tools. */
 void writeLines( char *fileName , int n , real *v )
 {
@@ -1624,6 +3367,12 @@ void dumpMediaOnGrid( FieldComponent field )
   char fileName[PATH_SIZE];
 
   message( MSG_LOG , 0 , "\nPrinting the grid %s field media array...\n\n" , FIELD[field] ); 
+
+  if( isDomainDecomposed() )
+  {
+    message( MSG_WARN , 0 , "*** Warning: Cannot print media arrays of a decomposed grid\n" );
+    return;
+  }
   
   /* Determine file name for each field. */
   switch( field )
@@ -1755,6 +3504,9 @@ void setMediumOnGrid( int gbbox[6] , MediumIndex medium , FaceMask mask )
     break;
   }
 
+  /* Only set the fields owned by the domain. */
+  clipFieldLimitsToDomain( flim );
+
   message( MSG_DEBUG3 , 0 , "    EX FLIM=[%d,%d,%d,%d,%d,%d]\n" , flim[EX][XLO] , flim[EX][XHI] , flim[EX][YLO] , flim[EX][YHI] , flim[EX][ZLO] , flim[EX][ZHI] );
   message( MSG_DEBUG3 , 0 , "    EY FLIM=[%d,%d,%d,%d,%d,%d]\n" , flim[EY][XLO] , flim[EY][XHI] , flim[EY][YLO] , flim[EY][YHI] , flim[EY][ZLO] , flim[EY][ZHI] );
   message( MSG_DEBUG3 , 0 , "    EZ FLIM=[%d,%d,%d,%d,%d,%d]\n" , flim[EZ][XLO] , flim[EZ][XHI] , flim[EZ][YLO] , flim[EZ][YHI] , flim[EZ][ZLO] , flim[EZ][ZHI] );
@@ -1771,37 +3523,37 @@ void setMediumOnGrid( int gbbox[6] , MediumIndex medium , FaceMask mask )
     for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
       for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
         for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-          mediumEx[i][j][k] = medium;
+          SET_MEDIUM_INDEX( mediumEx , i , j , k , medium );
 
     field = EY;
     for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
       for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
         for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-          mediumEy[i][j][k] = medium;
+          SET_MEDIUM_INDEX( mediumEy , i , j , k , medium );
 
     field = EZ;
     for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
       for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
         for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-          mediumEz[i][j][k] = medium;
+          SET_MEDIUM_INDEX( mediumEz , i , j , k , medium );
 
     field = HX;
     for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
       for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
         for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-          mediumHx[i][j][k] = medium;
+          SET_MEDIUM_INDEX( mediumHx , i , j , k , medium );
 
     field = HY;
     for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
       for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
         for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-          mediumHy[i][j][k] = medium;
+          SET_MEDIUM_INDEX( mediumHy , i , j , k , medium );
 
     field = HZ;
     for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
       for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
         for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-          mediumHz[i][j][k] = medium;
+          SET_MEDIUM_INDEX( mediumHz , i , j , k , medium );
         
   #else
   
@@ -1899,6 +3651,9 @@ void checkMediumOnGrid( int gbbox[6] , MediumIndex medium )
     break;
   }
 
+  /* Only set the fields owned by the domain. */
+  clipFieldLimitsToDomain( flim );
+
   #ifdef USE_INDEXED_MEDIA
 
     /* Check update coefficients. */
@@ -1906,37 +3661,37 @@ void checkMediumOnGrid( int gbbox[6] , MediumIndex medium )
     for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
       for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
         for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-          assert( mediumEx[i][j][k] == medium );
+          assert( GET_MEDIUM_INDEX( mediumEx , i , j , k ) == medium );
 
     field = EY;
     for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
       for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
         for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-          assert( mediumEy[i][j][k] == medium );
+          assert( GET_MEDIUM_INDEX( mediumEy , i , j , k ) == medium );
 
     field = EZ;
     for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
       for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
         for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-          assert( mediumEz[i][j][k] == medium );
+          assert( GET_MEDIUM_INDEX( mediumEz , i , j , k ) == medium );
 
     field = HX;
     for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
       for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
         for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-          assert( mediumHx[i][j][k] == medium );
+          assert( GET_MEDIUM_INDEX( mediumHx , i , j , k ) == medium );
 
     field = HY;
     for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
       for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
         for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-          assert( mediumHy[i][j][k] == medium );
+          assert( GET_MEDIUM_INDEX( mediumHy , i , j , k ) == medium );
 
     field = HZ;
     for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
       for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
         for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-          assert( mediumHz[i][j][k] == medium );
+          assert( GET_MEDIUM_INDEX( mediumHz , i , j , k ) == medium );
 
   #else
 
@@ -2008,17 +3763,15 @@ void checkMediumOnGrid( int gbbox[6] , MediumIndex medium )
 #ifdef USE_AVERAGED_MEDIA
 
 /* Apply voxels to the grid using media averaging. */
-void applyVoxelsToGrid( MediumIndex ***blockArray )
+void applyVoxelsToGrid( void ***blockArray )
 {
   
-  int field , i , j , k;
+  int i , j , k;
   int bbox[6];
   int flim[6][6];
   //bool includeBoundary[6] = { true  ,  true  ,  true  ,  true  ,  true  ,  true  };
   bool includeBoundary[6] = { false  ,  false ,  false  ,  false  ,  false ,  false  };
-  real eps_r1 , sigma1 , mu_r1 , eps_r2 , sigma2 , mu_r2;
-  real eps_r3 , sigma3 , mu_r3 , eps_r4 , sigma4 , mu_r4;
-  real eps_r , sigma , mu_r , alpha , beta , gamma;
+  size_t blockIndexSize = mediumIndexSize;
   
   /* Copy voxels on grid inner faces into cell within boundary */
   /* so that media on outer surface of mesh are unaveraged by */
@@ -2028,134 +3781,231 @@ void applyVoxelsToGrid( MediumIndex ***blockArray )
   i = bbox[XLO];
   for( j = bbox[YLO]  ; j <= bbox[YHI] ; j++ )
     for( k = bbox[ZLO]  ; k <= bbox[ZHI] ; k++ )
-      blockArray[i-1][j][k] = blockArray[i][j][k];
+      SET_MEDIUM_INDEX( blockArray , i-1 , j , k , GET_MEDIUM_INDEX( blockArray , i , j , k ) );
     
   getFaceOfBoundingBox( bbox , gibox , XHI );
   i = bbox[XHI];
   for( j = bbox[YLO]  ; j <= bbox[YHI] ; j++ )
     for( k = bbox[ZLO]  ; k <= bbox[ZHI] ; k++ )
-      blockArray[i][j][k] = blockArray[i-1][j][k];
+      SET_MEDIUM_INDEX( blockArray , i , j , k , GET_MEDIUM_INDEX( blockArray , i-1 , j , k ) );
     
   getFaceOfBoundingBox( bbox , gibox , YLO );
   j = bbox[YLO];
   for( i = bbox[XLO]  ; i <= bbox[XHI] ; i++ )
     for( k = bbox[ZLO]  ; k <= bbox[ZHI] ; k++ )
-      blockArray[i][j-1][k] = blockArray[i][j][k];
+      SET_MEDIUM_INDEX( blockArray , i , j-1 , k , GET_MEDIUM_INDEX( blockArray , i , j , k ) );
     
   getFaceOfBoundingBox( bbox , gibox , YHI );
   j = bbox[YHI];
   for( i = bbox[XLO]  ; i <= bbox[XHI] ; i++ )
     for( k = bbox[ZLO]  ; k <= bbox[ZHI] ; k++ )
-      blockArray[i][j][k] = blockArray[i][j-1][k];
+      SET_MEDIUM_INDEX( blockArray , i , j , k , GET_MEDIUM_INDEX( blockArray , i , j-1 , k ) );
  
   getFaceOfBoundingBox( bbox , gibox , ZLO );
   k = bbox[ZLO];
   for( i = bbox[XLO]  ; i <= bbox[XHI] ; i++ )
     for( j = bbox[YLO]  ; j <= bbox[YHI] ; j++ )
-      blockArray[i][j][k-1] = blockArray[i][j][k];
+      SET_MEDIUM_INDEX( blockArray , i , j , k-1 , GET_MEDIUM_INDEX( blockArray , i , j , k ) );
   
   getFaceOfBoundingBox( bbox , gibox , ZHI );
   k = bbox[ZHI];
   for( i = bbox[XLO]  ; i <= bbox[XHI] ; i++ )
     for( j = bbox[YLO]  ; j <= bbox[YHI] ; j++ )
-      blockArray[i][j][k] = blockArray[i][j][k-1];
+      SET_MEDIUM_INDEX( blockArray , i , j , k , GET_MEDIUM_INDEX( blockArray , i , j , k-1 ) );
 
   /* Field limits.*/
   setFieldLimits( gibox , flim , includeBoundary );
-  
-  /* Scale and set update coefficients. */
-  field = EX;
-  for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
-    for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
-      for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-      {    
-        getMediumParameters( &eps_r1 , &sigma1 , &mu_r1 , blockArray[i][j-1][k]   );
-        getMediumParameters( &eps_r2 , &sigma2 , &mu_r2 , blockArray[i][j][k]     );
-        getMediumParameters( &eps_r3 , &sigma3 , &mu_r3 , blockArray[i][j][k-1]   );
-        getMediumParameters( &eps_r4 , &sigma4 , &mu_r4 , blockArray[i][j-1][k-1] );
-        eps_r = 0.25 * ( eps_r1 * dey[j-1] * dez[k] + eps_r2 * dey[j] * dez[k] + 
-                         eps_r3 * dey[j] * dez[k-1] + eps_r4 * dey[j-1] * dez[k-1] ) / ( dhy[j] * dhz[k] ); 
-        sigma = 0.25 * ( sigma1 * dey[j-1] * dez[k] + sigma2 * dey[j] * dez[k] + 
-                         sigma3 * dey[j] * dez[k-1] + sigma4 * dey[j-1] * dez[k-1] ) / ( dhy[j] * dhz[k] );
-        calcCoeffFromParam( dt , eps_r , sigma , 1.0 , &alpha , &beta , &gamma );
-        alphaEx[i][j][k] = alpha;
-        betaEx[i][j][k] = SCALE_betaEx( beta , i , j , k );
-      }
+  clipFieldLimitsToDomain( flim );
 
-  field = EY;
-  for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
-    for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
-      for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-      {
-        getMediumParameters( &eps_r1 , &sigma1 , &mu_r1 , blockArray[i][j][k-1]   );
-        getMediumParameters( &eps_r2 , &sigma2 , &mu_r2 , blockArray[i][j][k]     );
-        getMediumParameters( &eps_r3 , &sigma3 , &mu_r3 , blockArray[i-1][j][k]   );
-        getMediumParameters( &eps_r4 , &sigma4 , &mu_r4 , blockArray[i-1][j][k-1] );
-        eps_r = 0.25 * ( eps_r1 * dez[k-1] * dex[i] + eps_r2 * dez[k] * dex[i] + 
-                         eps_r3 * dez[k] * dex[i-1] + eps_r4 * dez[k-1] * dex[i-1] ) / ( dhz[k] * dhx[i] ); 
-        sigma = 0.25 * ( sigma1 * dez[k-1] * dex[i] + sigma2 * dez[k] * dex[i] + 
-                         sigma3 * dez[k] * dex[i-1] + sigma4 * dez[k-1] * dex[i-1] ) / ( dhz[k] * dhx[i] ); 
-        calcCoeffFromParam( dt , eps_r , sigma , 1.0 , &alpha , &beta , &gamma );
-        alphaEy[i][j][k] = alpha;
-        betaEy[i][j][k] = SCALE_betaEy( beta , i , j , k );
-      }
+#ifdef USE_INDEXED_MEDIA
+  /* 
+   * Averaged coefficients are deduplicated into additional media. The first pass 
+   * finds the distinct media so the grid medium index arrays can be widened, if
+   * necessary, before the second pass sets the indices.
+   */
+  setAveragedMediaOnGrid( blockArray , blockIndexSize , flim , false );
+  if( setMediumIndexSize() )
+    resizeMediumIndexArrays( blockIndexSize );
+#endif
 
-  field = EZ;
-  for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
-    for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
-      for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-      {
-        getMediumParameters( &eps_r1 , &sigma1 , &mu_r1 , blockArray[i-1][j][k]   );
-        getMediumParameters( &eps_r2 , &sigma2 , &mu_r2 , blockArray[i][j][k]     );
-        getMediumParameters( &eps_r3 , &sigma3 , &mu_r3 , blockArray[i][j-1][k]   );
-        getMediumParameters( &eps_r4 , &sigma4 , &mu_r4 , blockArray[i-1][j-1][k] );
-        eps_r = 0.25 * ( eps_r1 * dex[i-1] * dey[j] + eps_r2 * dex[i] * dey[j] + 
-                         eps_r3 * dex[i] * dey[j-1] + eps_r4 * dex[i-1] * dey[j-1] ) / ( dhx[i] * dhy[j] ); 
-        sigma = 0.25 * ( sigma1 * dex[i-1] * dey[j] + sigma2 * dex[i] * dey[j] + 
-                         sigma3 * dex[i] * dey[j-1] + sigma4 * dex[i-1] * dey[j-1] ) / ( dhx[i] * dhy[j] );
-        calcCoeffFromParam( dt , eps_r , sigma , 1.0 , &alpha , &beta , &gamma );
-        alphaEz[i][j][k] = alpha;
-        betaEz[i][j][k] = SCALE_betaEz( beta , i , j , k );
-      }
+  setAveragedMediaOnGrid( blockArray , blockIndexSize , flim , true );
 
-  field = HX;
-  for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
-    for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
-      for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-      {
-        getMediumParameters( &eps_r1 , &sigma1 , &mu_r1 , blockArray[i-1][j][k] );
-        getMediumParameters( &eps_r2 , &sigma2 , &mu_r2 , blockArray[i][j][k] );
-        mu_r = 2.0 * mu_r1 * mu_r2 / ( mu_r1 + mu_r2 ); 
-        calcCoeffFromParam( dt , 1.0 , 0.0 , mu_r , &alpha , &beta , &gamma );
-        gammaHx[i][j][k] = SCALE_gammaHx( gamma , i , j , k );
-      }
+  return;
 
-  field = HY;
-  for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
-    for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
-      for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-      {
-        getMediumParameters( &eps_r1 , &sigma1 , &mu_r1 , blockArray[i][j-1][k] );
-        getMediumParameters( &eps_r2 , &sigma2 , &mu_r2 , blockArray[i][j][k] );
-        mu_r = 2.0 * mu_r1 * mu_r2 / ( mu_r1 + mu_r2 ); 
-        calcCoeffFromParam( dt , 1.0 , 0.0 , mu_r , &alpha , &beta , &gamma );
-        gammaHy[i][j][k] = SCALE_gammaHy( gamma , i , j , k );
-      }
+}
 
-  field = HZ;
-  for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
-    for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
-      for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
-      {
-        getMediumParameters( &eps_r1 , &sigma1 , &mu_r1 , blockArray[i][j][k-1] );
-        getMediumParameters( &eps_r2 , &sigma2 , &mu_r2 , blockArray[i][j][k] );
-        mu_r = 2.0 * mu_r1 * mu_r2 / ( mu_r1 + mu_r2 ); 
-        calcCoeffFromParam( dt , 1.0 , 0.0 , mu_r , &alpha , &beta , &gamma );
-        gammaHz[i][j][k] = SCALE_gammaHz( gamma , i , j , k );
-      }
+/* Get averaged medium parameters for field component (i,j,k) from the cell media. */
+void getAveragedMediumParameters( real *eps_r , real *sigma , real *mu_r , void ***blockArray , size_t blockIndexSize ,
+                                  FieldComponent field , int i , int j , int k )
+{
+
+  real eps_r1 , sigma1 , mu_r1 , eps_r2 , sigma2 , mu_r2;
+  real eps_r3 , sigma3 , mu_r3 , eps_r4 , sigma4 , mu_r4;
+
+  #define BLOCK_MEDIUM( i , j , k ) GET_MEDIUM_INDEX_SIZED( blockIndexSize , blockArray , i , j , k )
+
+  switch( field )
+  {
+  case EX:
+    getSimpleMediumParameters( &eps_r1 , &sigma1 , &mu_r1 , BLOCK_MEDIUM( i , j-1 , k )   );
+    getSimpleMediumParameters( &eps_r2 , &sigma2 , &mu_r2 , BLOCK_MEDIUM( i , j , k )     );
+    getSimpleMediumParameters( &eps_r3 , &sigma3 , &mu_r3 , BLOCK_MEDIUM( i , j , k-1 )   );
+    getSimpleMediumParameters( &eps_r4 , &sigma4 , &mu_r4 , BLOCK_MEDIUM( i , j-1 , k-1 ) );
+    *eps_r = 0.25 * ( eps_r1 * dey[j-1] * dez[k] + eps_r2 * dey[j] * dez[k] + 
+                      eps_r3 * dey[j] * dez[k-1] + eps_r4 * dey[j-1] * dez[k-1] ) / ( dhy[j] * dhz[k] ); 
+    *sigma = 0.25 * ( sigma1 * dey[j-1] * dez[k] + sigma2 * dey[j] * dez[k] + 
+                      sigma3 * dey[j] * dez[k-1] + sigma4 * dey[j-1] * dez[k-1] ) / ( dhy[j] * dhz[k] );
+    *mu_r = 1.0;
+    break;
+  case EY:
+    getSimpleMediumParameters( &eps_r1 , &sigma1 , &mu_r1 , BLOCK_MEDIUM( i , j , k-1 )   );
+    getSimpleMediumParameters( &eps_r2 , &sigma2 , &mu_r2 , BLOCK_MEDIUM( i , j , k )     );
+    getSimpleMediumParameters( &eps_r3 , &sigma3 , &mu_r3 , BLOCK_MEDIUM( i-1 , j , k )   );
+    getSimpleMediumParameters( &eps_r4 , &sigma4 , &mu_r4 , BLOCK_MEDIUM( i-1 , j , k-1 ) );
+    *eps_r = 0.25 * ( eps_r1 * dez[k-1] * dex[i] + eps_r2 * dez[k] * dex[i] + 
+                      eps_r3 * dez[k] * dex[i-1] + eps_r4 * dez[k-1] * dex[i-1] ) / ( dhz[k] * dhx[i] ); 
+    *sigma = 0.25 * ( sigma1 * dez[k-1] * dex[i] + sigma2 * dez[k] * dex[i] + 
+                      sigma3 * dez[k] * dex[i-1] + sigma4 * dez[k-1] * dex[i-1] ) / ( dhz[k] * dhx[i] ); 
+    *mu_r = 1.0;
+    break;
+  case EZ:
+    getSimpleMediumParameters( &eps_r1 , &sigma1 , &mu_r1 , BLOCK_MEDIUM( i-1 , j , k )   );
+    getSimpleMediumParameters( &eps_r2 , &sigma2 , &mu_r2 , BLOCK_MEDIUM( i , j , k )     );
+    getSimpleMediumParameters( &eps_r3 , &sigma3 , &mu_r3 , BLOCK_MEDIUM( i , j-1 , k )   );
+    getSimpleMediumParameters( &eps_r4 , &sigma4 , &mu_r4 , BLOCK_MEDIUM( i-1 , j-1 , k ) );
+    *eps_r = 0.25 * ( eps_r1 * dex[i-1] * dey[j] + eps_r2 * dex[i] * dey[j] + 
+                      eps_r3 * dex[i] * dey[j-1] + eps_r4 * dex[i-1] * dey[j-1] ) / ( dhx[i] * dhy[j] ); 
+    *sigma = 0.25 * ( sigma1 * dex[i-1] * dey[j] + sigma2 * dex[i] * dey[j] + 
+                      sigma3 * dex[i] * dey[j-1] + sigma4 * dex[i-1] * dey[j-1] ) / ( dhx[i] * dhy[j] );
+    *mu_r = 1.0;
+    break;
+  case HX:
+    getSimpleMediumParameters( &eps_r1 , &sigma1 , &mu_r1 , BLOCK_MEDIUM( i-1 , j , k ) );
+    getSimpleMediumParameters( &eps_r2 , &sigma2 , &mu_r2 , BLOCK_MEDIUM( i , j , k ) );
+    *eps_r = 1.0;
+    *sigma = 0.0;
+    *mu_r = 2.0 * mu_r1 * mu_r2 / ( mu_r1 + mu_r2 ); 
+    break;
+  case HY:
+    getSimpleMediumParameters( &eps_r1 , &sigma1 , &mu_r1 , BLOCK_MEDIUM( i , j-1 , k ) );
+    getSimpleMediumParameters( &eps_r2 , &sigma2 , &mu_r2 , BLOCK_MEDIUM( i , j , k ) );
+    *eps_r = 1.0;
+    *sigma = 0.0;
+    *mu_r = 2.0 * mu_r1 * mu_r2 / ( mu_r1 + mu_r2 ); 
+    break;
+  case HZ:
+    getSimpleMediumParameters( &eps_r1 , &sigma1 , &mu_r1 , BLOCK_MEDIUM( i , j , k-1 ) );
+    getSimpleMediumParameters( &eps_r2 , &sigma2 , &mu_r2 , BLOCK_MEDIUM( i , j , k ) );
+    *eps_r = 1.0;
+    *sigma = 0.0;
+    *mu_r = 2.0 * mu_r1 * mu_r2 / ( mu_r1 + mu_r2 ); 
+    break;
+  default:
+    assert( 0 );
+    break;
+  }
+
+  #undef BLOCK_MEDIUM
+
+  return;
+
+}
+
+/* 
+ * Set averaged media on the grid. With indexed media each distinct set of
+ * averaged coefficients becomes a medium and the indices are only stored
+ * if isSet is true.
+ */
+void setAveragedMediaOnGrid( void ***blockArray , size_t blockIndexSize , int flim[6][6] , bool isSet )
+{
+
+  real eps_r , sigma , mu_r;
+#ifdef USE_INDEXED_MEDIA
+  MediumIndex medium;
+  void ***fieldMedium[6] = { mediumEx , mediumEy , mediumEz , mediumHx , mediumHy , mediumHz };
+#else
+  real alpha , beta , gamma;
+#endif
+
+  for( FieldComponent field = EX ; field <= HZ ; field++ )
+    for( int i = flim[field][XLO]  ; i <= flim[field][XHI] ; i++ )
+      for( int j = flim[field][YLO]  ; j <= flim[field][YHI] ; j++ )
+        for( int k = flim[field][ZLO]  ; k <= flim[field][ZHI] ; k++ )
+        {
+          getAveragedMediumParameters( &eps_r , &sigma , &mu_r , blockArray , blockIndexSize , field , i , j , k );
+#ifdef USE_INDEXED_MEDIA
+          medium = addAveragedMedium( eps_r , sigma , mu_r );
+          if( isSet )
+            SET_MEDIUM_INDEX( fieldMedium[field] , i , j , k , medium );
+#else
+          (void)isSet;
+          calcCoeffFromParam( &alpha , &beta , &gamma , NULL , NULL , dt , eps_r , sigma , mu_r , 0 , NULL , NULL );
+          switch( field )
+          {
+          case EX:
+            alphaEx[i][j][k] = alpha;
+            betaEx[i][j][k] = SCALE_betaEx( beta , i , j , k );
+            break;
+          case EY:
+            alphaEy[i][j][k] = alpha;
+            betaEy[i][j][k] = SCALE_betaEy( beta , i , j , k );
+            break;
+          case EZ:
+            alphaEz[i][j][k] = alpha;
+            betaEz[i][j][k] = SCALE_betaEz( beta , i , j , k );
+            break;
+          case HX:
+            gammaHx[i][j][k] = SCALE_gammaHx( gamma , i , j , k );
+            break;
+          case HY:
+            gammaHy[i][j][k] = SCALE_gammaHy( gamma , i , j , k );
+            break;
+          case HZ:
+            gammaHz[i][j][k] = SCALE_gammaHz( gamma , i , j , k );
+            break;
+          default:
+            assert( 0 );
+            break;
+          }
+#endif
+        }
 
   return;
 
 }
 
+#ifdef USE_INDEXED_MEDIA
+
+/* Reallocate the grid medium index arrays after the medium index size has changed. */
+void resizeMediumIndexArrays( size_t oldSize )
+{
+
+  void ****arrays[6] = { &mediumEx , &mediumEy , &mediumEz , &mediumHx , &mediumHy , &mediumHz };
+  void ***newArray;
+  unsigned long bytes;
+  int alim[6];
+
+  message( MSG_LOG , 0 , "  Resizing medium index arrays from %lu to %lu bytes\n" , 
+           (unsigned long) oldSize , (unsigned long) mediumIndexSize );
+
+  getDomainArrayLimits( alim );
+
+  for( int field = EX ; field <= HZ ; field++ )
+  {
+    newArray = allocFieldArrayRegion( &bytes , mediumIndexSize , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , alim );
+    memory.ehCoeffs += bytes - bytes / mediumIndexSize * oldSize;
+    for( int i = alim[XLO] ; i <= alim[XHI] ; i++ )
+      for( int j = alim[YLO] ; j <= alim[YHI] ; j++ )
+        for( int k = alim[ZLO] ; k <= alim[ZHI] ; k++ )
+          SET_MEDIUM_INDEX( newArray , i , j , k , GET_MEDIUM_INDEX_SIZED( oldSize , *arrays[field] , i , j , k ) );
+    deallocFieldArray( *arrays[field] );
+    *arrays[field] = newArray;
+  }
+
+  return;
+
+}
+
+#endif // USE_INDEXED_MEDIA
+
 #endif // USE_AVERAGED_MEDIA
@@ -28,6 +28,7 @@
 #include "vulture.h"
 #include "fdtd_types.h"
 #include "medium.h"
+#include "alloc_array.h"
 
 /* Cells used for PMC on XLO/YLO/ZLO and PMC and tangential fields on XHI/YHI/ZHI. */
 #define NUM_GHOST_CELLS 1
@@ -52,10 +53,44 @@ typedef enum {
 
 } GridType;
 
+/* 
+ * Grid update kernels.
+ * 
+ * Grid kernels must begin at zero, be contigous and end with GK_UNDEFINED, which
+ * *is not* included in the number NUM_GRID_KERNELS.
+ */
+
+#define NUM_GRID_KERNELS 3
+
+/* Grid update kernels. */
+typedef enum {
+
+  GK_STANDARD,      // Separate sweep over grid for each field component.
+  GK_FUSED,         // Single sweep over (i,j) pencils for all three components.
+  GK_TILED,         // Fused sweep over i for each cache sized (j,k) tile.
+  GK_UNDEFINED
+
+} GridKernel;
+
+/* 
+ * Decomposition of a loop nest over a box of field limits into blocks for the
+ * threads. Block b of n along an axis of length m spans [b*m/n,(b+1)*m/n).
+ */
+typedef struct LoopDecomp_t {
+
+  int lim[6];           // Limits of the box.
+  int numBlocks[3];     // Number of blocks along each axis.
+  int numItems;         // Total number of blocks.
+
+} LoopDecomp;
+
 /*
  * Global variables.
  */
 
+/* Grid update kernel names. */
+extern char GRID_KERNEL_STR[4][11];
+
 /* Number of cells in each direction, including ghost cells. */
 extern int numCells[3];
 
@@ -81,6 +116,38 @@ extern real ***Ez;
 extern real ***Hx;
 extern real ***Hy;
 extern real ***Hz;
+
+/* Strides of the flat storage of the real valued field and coefficient arrays. */
+extern size_t gridStrideI;
+extern size_t gridStrideJ;
+
+#ifdef WITH_MPI
+
+  /* Indices of the first element of the grid arrays of the domain. */
+  extern int gridOrigin[3];
+
+  /* Offset of element (i,j,k) in the flat storage of the real valued grid arrays. */
+  #define GRID_INDEX( i , j , k ) FIELD_INDEX( (i) - gridOrigin[XDIR] , (j) - gridOrigin[YDIR] , (k) - gridOrigin[ZDIR] , gridStrideI , gridStrideJ )
+
+  /* Pointer to the first element of the flat storage of a real valued grid array. */
+  #define GRID_DATA( array ) ( (array)[gridOrigin[XDIR]][gridOrigin[YDIR]] + gridOrigin[ZDIR] )
+
+  /* Pointer to the k-row (i,j) of a real valued grid array. */
+  #define GRID_ROW( array , i , j ) ( (array)[i][j] )
+
+#else
+
+  /* Offset of element (i,j,k) in the flat storage of the real valued grid arrays. */
+  #define GRID_INDEX( i , j , k ) FIELD_INDEX( i , j , k , gridStrideI , gridStrideJ )
+
+  /* Pointer to the first element of the flat storage of a real valued grid array. */
+  #define GRID_DATA( array ) FIELD_DATA( array )
+
+  /* Pointer to the k-row (i,j) of a real valued grid array using flat indexing. */
+  #define GRID_ROW( array , i , j ) ( FIELD_DATA( array ) + GRID_INDEX( i , j , 0 ) )
+
+#endif
+
 /* Primary grid edge lengths. */
 extern real *dex;
 extern real *dey;
@@ -107,32 +174,36 @@ extern real *idhz;
 
 #ifdef USE_INDEXED_MEDIA
 
-  extern MediumIndex ***mediumEx;
-  extern MediumIndex ***mediumEy;
-  extern MediumIndex ***mediumEz;
-  extern MediumIndex ***mediumHx;
-  extern MediumIndex ***mediumHy;
-  extern MediumIndex ***mediumHz;
+  extern void ***mediumEx;
+  extern void ***mediumEy;
+  extern void ***mediumEz;
+  extern void ***mediumHx;
+  extern void ***mediumHy;
+  extern void ***mediumHz;
   
-  #define ALPHA_EX(i,j,k) mediumArray[mediumEx[i][j][k]]->alpha
-  #define ALPHA_EY(i,j,k) mediumArray[mediumEy[i][j][k]]->alpha  
-  #define ALPHA_EZ(i,j,k) mediumArray[mediumEz[i][j][k]]->alpha
-  #define BETA_EX(i,j,k)  mediumArray[mediumEx[i][j][k]]->beta
-  #define BETA_EY(i,j,k)  mediumArray[mediumEy[i][j][k]]->beta
-  #define BETA_EZ(i,j,k)  mediumArray[mediumEz[i][j][k]]->beta
-  #define GAMMA_HX(i,j,k) mediumArray[mediumHx[i][j][k]]->gamma
-  #define GAMMA_HY(i,j,k) mediumArray[mediumHy[i][j][k]]->gamma
-  #define GAMMA_HZ(i,j,k) mediumArray[mediumHz[i][j][k]]->gamma
+  #define ALPHA_EX(i,j,k) mediumArray[GET_MEDIUM_INDEX( mediumEx , i , j , k )]->alpha
+  #define ALPHA_EY(i,j,k) mediumArray[GET_MEDIUM_INDEX( mediumEy , i , j , k )]->alpha  
+  #define ALPHA_EZ(i,j,k) mediumArray[GET_MEDIUM_INDEX( mediumEz , i , j , k )]->alpha
+  /* 
+   * The medium coefficients are shared by all cells so the edge length scaling
+   * for scaled fields is applied on access using the 1D edge length arrays.
+   */
+  #define BETA_EX(i,j,k)  SCALE_betaEx( mediumArray[GET_MEDIUM_INDEX( mediumEx , i , j , k )]->beta , i , j , k )
+  #define BETA_EY(i,j,k)  SCALE_betaEy( mediumArray[GET_MEDIUM_INDEX( mediumEy , i , j , k )]->beta , i , j , k )
+  #define BETA_EZ(i,j,k)  SCALE_betaEz( mediumArray[GET_MEDIUM_INDEX( mediumEz , i , j , k )]->beta , i , j , k )
+  #define GAMMA_HX(i,j,k) SCALE_gammaHx( mediumArray[GET_MEDIUM_INDEX( mediumHx , i , j , k )]->gamma , i , j , k )
+  #define GAMMA_HY(i,j,k) SCALE_gammaHy( mediumArray[GET_MEDIUM_INDEX( mediumHy , i , j , k )]->gamma , i , j , k )
+  #define GAMMA_HZ(i,j,k) SCALE_gammaHz( mediumArray[GET_MEDIUM_INDEX( mediumHz , i , j , k )]->gamma , i , j , k )
   
-  #define COPY_ALPHA_EX(i1,j1,k1,i0,j0,k0) mediumEx[i1][j1][k1] = mediumEx[i0][j0][k0]
-  #define COPY_ALPHA_EY(i1,j1,k1,i0,j0,k0) mediumEy[i1][j1][k1] = mediumEy[i0][j0][k0]
-  #define COPY_ALPHA_EZ(i1,j1,k1,i0,j0,k0) mediumEz[i1][j1][k1] = mediumEz[i0][j0][k0]
-  #define COPY_BETA_EX(i1,j1,k1,i0,j0,k0)  mediumEx[i1][j1][k1] = mediumEx[i0][j0][k0]
-  #define COPY_BETA_EY(i1,j1,k1,i0,j0,k0)  mediumEy[i1][j1][k1] = mediumEy[i0][j0][k0]
-  #define COPY_BETA_EZ(i1,j1,k1,i0,j0,k0)  mediumEz[i1][j1][k1] = mediumEz[i0][j0][k0]
-  #define COPY_GAMMA_HX(i1,j1,k1,i0,j0,k0) mediumHx[i1][j1][k1] = mediumHx[i0][j0][k0]
-  #define COPY_GAMMA_HY(i1,j1,k1,i0,j0,k0) mediumHy[i1][j1][k1] = mediumHy[i0][j0][k0]
-  #define COPY_GAMMA_HZ(i1,j1,k1,i0,j0,k0) mediumHz[i1][j1][k1] = mediumHz[i0][j0][k0]
+  #define COPY_ALPHA_EX(i1,j1,k1,i0,j0,k0) SET_MEDIUM_INDEX( mediumEx , i1 , j1 , k1 , GET_MEDIUM_INDEX( mediumEx , i0 , j0 , k0 ) )
+  #define COPY_ALPHA_EY(i1,j1,k1,i0,j0,k0) SET_MEDIUM_INDEX( mediumEy , i1 , j1 , k1 , GET_MEDIUM_INDEX( mediumEy , i0 , j0 , k0 ) )
+  #define COPY_ALPHA_EZ(i1,j1,k1,i0,j0,k0) SET_MEDIUM_INDEX( mediumEz , i1 , j1 , k1 , GET_MEDIUM_INDEX( mediumEz , i0 , j0 , k0 ) )
+  #define COPY_BETA_EX(i1,j1,k1,i0,j0,k0)  SET_MEDIUM_INDEX( mediumEx , i1 , j1 , k1 , GET_MEDIUM_INDEX( mediumEx , i0 , j0 , k0 ) )
+  #define COPY_BETA_EY(i1,j1,k1,i0,j0,k0)  SET_MEDIUM_INDEX( mediumEy , i1 , j1 , k1 , GET_MEDIUM_INDEX( mediumEy , i0 , j0 , k0 ) )
+  #define COPY_BETA_EZ(i1,j1,k1,i0,j0,k0)  SET_MEDIUM_INDEX( mediumEz , i1 , j1 , k1 , GET_MEDIUM_INDEX( mediumEz , i0 , j0 , k0 ) )
+  #define COPY_GAMMA_HX(i1,j1,k1,i0,j0,k0) SET_MEDIUM_INDEX( mediumHx , i1 , j1 , k1 , GET_MEDIUM_INDEX( mediumHx , i0 , j0 , k0 ) )
+  #define COPY_GAMMA_HY(i1,j1,k1,i0,j0,k0) SET_MEDIUM_INDEX( mediumHy , i1 , j1 , k1 , GET_MEDIUM_INDEX( mediumHy , i0 , j0 , k0 ) )
+  #define COPY_GAMMA_HZ(i1,j1,k1,i0,j0,k0) SET_MEDIUM_INDEX( mediumHz , i1 , j1 , k1 , GET_MEDIUM_INDEX( mediumHz , i0 , j0 , k0 ) )
   
 #else // USE_INDEXED_MEDIA
 
@@ -146,25 +217,29 @@ extern real *idhz;
   extern real ***gammaHy;
   extern real ***gammaHz;
   
-  #define ALPHA_EX(i,j,k) alphaEx[i][j][k]  
-  #define ALPHA_EY(i,j,k) alphaEy[i][j][k] 
-  #define ALPHA_EZ(i,j,k) alphaEz[i][j][k] 
-  #define BETA_EX(i,j,k)  betaEx[i][j][k] 
-  #define BETA_EY(i,j,k)  betaEy[i][j][k] 
-  #define BETA_EZ(i,j,k)  betaEz[i][j][k] 
-  #define GAMMA_HX(i,j,k) gammaHx[i][j][k] 
-  #define GAMMA_HY(i,j,k) gammaHy[i][j][k] 
-  #define GAMMA_HZ(i,j,k) gammaHz[i][j][k] 
+  #define ALPHA_EX(i,j,k) GRID_DATA( alphaEx )[GRID_INDEX( i , j , k )]
+  #define ALPHA_EY(i,j,k) GRID_DATA( alphaEy )[GRID_INDEX( i , j , k )]
+  #define ALPHA_EZ(i,j,k) GRID_DATA( alphaEz )[GRID_INDEX( i , j , k )]
+  #define BETA_EX(i,j,k)  GRID_DATA( betaEx )[GRID_INDEX( i , j , k )]
+  #define BETA_EY(i,j,k)  GRID_DATA( betaEy )[GRID_INDEX( i , j , k )]
+  #define BETA_EZ(i,j,k)  GRID_DATA( betaEz )[GRID_INDEX( i , j , k )]
+  #define GAMMA_HX(i,j,k) GRID_DATA( gammaHx )[GRID_INDEX( i , j , k )]
+  #define GAMMA_HY(i,j,k) GRID_DATA( gammaHy )[GRID_INDEX( i , j , k )]
+  #define GAMMA_HZ(i,j,k) GRID_DATA( gammaHz )[GRID_INDEX( i , j , k )]
 
   #define COPY_ALPHA_EX(i1,j1,k1,i0,j0,k0) alphaEx[i1][j1][k1] = alphaEx[i0][j0][k0]
   #define COPY_ALPHA_EY(i1,j1,k1,i0,j0,k0) alphaEy[i1][j1][k1] = alphaEy[i0][j0][k0]
   #define COPY_ALPHA_EZ(i1,j1,k1,i0,j0,k0) alphaEz[i1][j1][k1] = alphaEz[i0][j0][k0]
-  #define COPY_BETA_EX(i1,j1,k1,i0,j0,k0)  betaEx[i1][j1][k1]  = betaEx[i0][j0][k0]
-  #define COPY_BETA_EY(i1,j1,k1,i0,j0,k0)  betaEy[i1][j1][k1]  = betaEy[i0][j0][k0]
-  #define COPY_BETA_EZ(i1,j1,k1,i0,j0,k0)  betaEz[i1][j1][k1]  = betaEz[i0][j0][k0]
-  #define COPY_GAMMA_HX(i1,j1,k1,i0,j0,k0) gammaHx[i1][j1][k1] = gammaHx[i0][j0][k0]
-  #define COPY_GAMMA_HY(i1,j1,k1,i0,j0,k0) gammaHy[i1][j1][k1] = gammaHy[i0][j0][k0]
-  #define COPY_GAMMA_HZ(i1,j1,k1,i0,j0,k0) gammaHz[i1][j1][k1] = gammaHz[i0][j0][k0]
+  /* 
+   * With scaled fields the coefficients include the edge lengths of their own cell
+   * so they are unscaled at the source and rescaled at the destination when copied.
+   */
+  #define COPY_BETA_EX(i1,j1,k1,i0,j0,k0)  betaEx[i1][j1][k1]  = SCALE_betaEx( UNSCALE_betaEx( betaEx[i0][j0][k0] , i0 , j0 , k0 ) , i1 , j1 , k1 )
+  #define COPY_BETA_EY(i1,j1,k1,i0,j0,k0)  betaEy[i1][j1][k1]  = SCALE_betaEy( UNSCALE_betaEy( betaEy[i0][j0][k0] , i0 , j0 , k0 ) , i1 , j1 , k1 )
+  #define COPY_BETA_EZ(i1,j1,k1,i0,j0,k0)  betaEz[i1][j1][k1]  = SCALE_betaEz( UNSCALE_betaEz( betaEz[i0][j0][k0] , i0 , j0 , k0 ) , i1 , j1 , k1 )
+  #define COPY_GAMMA_HX(i1,j1,k1,i0,j0,k0) gammaHx[i1][j1][k1] = SCALE_gammaHx( UNSCALE_gammaHx( gammaHx[i0][j0][k0] , i0 , j0 , k0 ) , i1 , j1 , k1 )
+  #define COPY_GAMMA_HY(i1,j1,k1,i0,j0,k0) gammaHy[i1][j1][k1] = SCALE_gammaHy( UNSCALE_gammaHy( gammaHy[i0][j0][k0] , i0 , j0 , k0 ) , i1 , j1 , k1 )
+  #define COPY_GAMMA_HZ(i1,j1,k1,i0,j0,k0) gammaHz[i1][j1][k1] = SCALE_gammaHz( UNSCALE_gammaHz( gammaHz[i0][j0][k0] , i0 , j0 , k0 ) , i1 , j1 , k1 )
 
 #endif // USE_INDEXED_MEDIA
 
@@ -196,7 +271,7 @@ extern real *idhz;
  * Scaled fields are usually preferred as the basic update has one less multiplication.
  */
 
-#ifdef USE_SCALE_FIELDS
+#ifdef USE_SCALED_FIELDS
 
   /* Curl operators - without inverse edge lengths. */
   #define curl_Hx( Hz_ijk , Hz_ij1k , Hy_ijk1 , Hy_ijk , i , j , k ) ( Hz_ijk  - Hz_ij1k + Hy_ijk1 - Hy_ijk  )
@@ -221,44 +296,44 @@ extern real *idhz;
   #define dEy_dx( Ey_ijk , i ) ( Ey_ijk )
 
   /* Scale fields. */
-  #define SCALE_Ex( ex , i ) ( dex[i] * ex )
-  #define SCALE_Ey( ey , j ) ( dey[j] * ey ) 
-  #define SCALE_Ez( ez , k ) ( dez[k] * ez )
-  #define SCALE_Hx( hx , i ) ( dhx[i] * hx )
-  #define SCALE_Hy( hy , j ) ( dhy[j] * hy )
-  #define SCALE_Hz( hz , k ) ( dhz[k] * hz )
-  #define SCALE_Jx( jx , i ) ( dhy[j] * dhz[k] * jx )
-  #define SCALE_Jy( jy , j ) ( dhx[i] * dhz[k] * jy ) 
-  #define SCALE_Jz( jz , k ) ( dhx[i] * dhy[j] * jz )
-  #define SCALE_JMx( jmx , i ) ( dey[j] * dez[k] * jmx )
-  #define SCALE_JMy( jmy , j ) ( dex[i] * dez[k] * jmy )
-  #define SCALE_JMz( jmz , k ) ( dex[i] * dey[j] * jmz )
+  #define SCALE_Ex( ex , i ) ( dex[i] * ( ex ) )
+  #define SCALE_Ey( ey , j ) ( dey[j] * ( ey ) )
+  #define SCALE_Ez( ez , k ) ( dez[k] * ( ez ) )
+  #define SCALE_Hx( hx , i ) ( dhx[i] * ( hx ) )
+  #define SCALE_Hy( hy , j ) ( dhy[j] * ( hy ) )
+  #define SCALE_Hz( hz , k ) ( dhz[k] * ( hz ) )
+  #define SCALE_Jx( jx , i ) ( dhy[j] * dhz[k] * ( jx ) )
+  #define SCALE_Jy( jy , j ) ( dhx[i] * dhz[k] * ( jy ) )
+  #define SCALE_Jz( jz , k ) ( dhx[i] * dhy[j] * ( jz ) )
+  #define SCALE_JMx( jmx , i ) ( dey[j] * dez[k] * ( jmx ) )
+  #define SCALE_JMy( jmy , j ) ( dex[i] * dez[k] * ( jmy ) )
+  #define SCALE_JMz( jmz , k ) ( dex[i] * dey[j] * ( jmz ) )
 
   /* Unscale fields. */
-  #define UNSCALE_Ex( ex , i ) ( idex[i] * ex )
-  #define UNSCALE_Ey( ey , j ) ( idey[j] * ey )
-  #define UNSCALE_Ez( ez , k ) ( idez[k] * ez )
-  #define UNSCALE_Hx( hx , i ) ( idhx[i] * hx )
-  #define UNSCALE_Hy( hy , j ) ( idhy[j] * hy )
-  #define UNSCALE_Hz( hz , k ) ( idhz[k] * hz )
+  #define UNSCALE_Ex( ex , i ) ( idex[i] * ( ex ) )
+  #define UNSCALE_Ey( ey , j ) ( idey[j] * ( ey ) )
+  #define UNSCALE_Ez( ez , k ) ( idez[k] * ( ez ) )
+  #define UNSCALE_Hx( hx , i ) ( idhx[i] * ( hx ) )
+  #define UNSCALE_Hy( hy , j ) ( idhy[j] * ( hy ) )
+  #define UNSCALE_Hz( hz , k ) ( idhz[k] * ( hz ) )
 
   /* Scale update ceofficients. */
-  #define SCALE_betaEx( betaEx , i , j , k ) (  dex[i] * idhy[j] * idhz[k] * betaEx )
-  #define SCALE_betaEy( betaEy , i , j , k ) ( idhx[i] *  dey[j] * idhz[k] * betaEy )
-  #define SCALE_betaEz( betaEz , i , j , k ) ( idhx[i] * idhy[j] *  dez[k] * betaEz )
-  #define SCALE_gammaHx( gammaHx , i , j , k ) (  dhx[i] * idey[j] * idez[k] * gammaHx )
-  #define SCALE_gammaHy( gammaHy , i , j , k ) ( idex[i] *  dhy[j] * idez[k] * gammaHy )
-  #define SCALE_gammaHz( gammaHz , i , j , k ) ( idex[i] * idey[j] *  dhz[k] * gammaHz )
+  #define SCALE_betaEx( betaEx , i , j , k ) (  dex[i] * idhy[j] * idhz[k] * ( betaEx ) )
+  #define SCALE_betaEy( betaEy , i , j , k ) ( idhx[i] *  dey[j] * idhz[k] * ( betaEy ) )
+  #define SCALE_betaEz( betaEz , i , j , k ) ( idhx[i] * idhy[j] *  dez[k] * ( betaEz ) )
+  #define SCALE_gammaHx( gammaHx , i , j , k ) (  dhx[i] * idey[j] * idez[k] * ( gammaHx ) )
+  #define SCALE_gammaHy( gammaHy , i , j , k ) ( idex[i] *  dhy[j] * idez[k] * ( gammaHy ) )
+  #define SCALE_gammaHz( gammaHz , i , j , k ) ( idex[i] * idey[j] *  dhz[k] * ( gammaHz ) )
 
   /* Unscale update ceofficients. */
-  #define UNSCALE_betaEx( betaEx , i , j , k ) ( idex[i] *  dhy[j] *  dhz[k] * betaEx )
-  #define UNSCALE_betaEy( betaEy , i , j , k ) (  dhx[i] * idey[j] *  dhz[k] * betaEy )
-  #define UNSCALE_betaEz( betaEz , i , j , k ) (  dhx[i] *  dhy[j] * idez[k] * betaEz )
-  #define UNSCALE_gammaHx( gammaHx , i , j , k ) ( idhx[i] *  dey[j] *  dez[k] * gammaHx )
-  #define UNSCALE_gammaHy( gammaHy , i , j , k ) (  dex[i] * idhy[j] *  dez[k] * gammaHy )
-  #define UNSCALE_gammaHz( gammaHz , i , j , k ) (  dex[i] *  dey[j] *  idhz[k] * gammaHz )
+  #define UNSCALE_betaEx( betaEx , i , j , k ) ( idex[i] *  dhy[j] *  dhz[k] * ( betaEx ) )
+  #define UNSCALE_betaEy( betaEy , i , j , k ) (  dhx[i] * idey[j] *  dhz[k] * ( betaEy ) )
+  #define UNSCALE_betaEz( betaEz , i , j , k ) (  dhx[i] *  dhy[j] * idez[k] * ( betaEz ) )
+  #define UNSCALE_gammaHx( gammaHx , i , j , k ) ( idhx[i] *  dey[j] *  dez[k] * ( gammaHx ) )
+  #define UNSCALE_gammaHy( gammaHy , i , j , k ) (  dex[i] * idhy[j] *  dez[k] * ( gammaHy ) )
+  #define UNSCALE_gammaHz( gammaHz , i , j , k ) (  dex[i] *  dey[j] *  idhz[k] * ( gammaHz ) )
 
-#else // USE_SCALE_FIELDS
+#else // USE_SCALED_FIELDS
 
   /* Curl operators - includes inverse edge lengths. */  
   #define curl_Hx( Hz_ijk , Hz_ij1k , Hy_ijk1 , Hy_ijk , i , j , k ) ( idhy[j] * ( Hz_ijk - Hz_ij1k ) + idhz[k] * ( Hy_ijk1 - Hy_ijk ) )
@@ -320,7 +395,7 @@ extern real *idhz;
   #define UNSCALE_gammaHy( gammaHy , i , j , k ) ( gammaHy )
   #define UNSCALE_gammaHz( gammaHz , i , j , k ) ( gammaHz )
 
-#endif // USE_SCALE_FIELDS
+#endif // USE_SCALED_FIELDS
 
 /*
  * Public method interfaces.
@@ -335,15 +410,28 @@ void initGrid( void );
 void reportGrid( void );
 void updateGridEfield( void );
 void updateGridHfield( void  );
+void updateGridEfieldInterior( void );
+void updateGridEfieldShell( void );
+void updateGridHfieldInterior( void );
+void updateGridHfieldShell( void );
 void deallocGridArrays( void );
 void gnuplotGridLines( void );
 void checkGrid( void );
 void setFieldLimits( int cellLimits[6] , int fieldLimits[6][6] , bool includeBoundary[6] );
 real getGridMaxEdgeLength( CoordAxis direction );
 real getGridTimeStep( void );
+real getMeshBoundaryCellSize( MeshFace face );
+real getMeshTimeStep( void );
 void getGridNumCells( int numMeshCells[3] );
 void setMediumOnGrid( int bbox[6] , MediumIndex medium , FaceMask mask ); 
 void initMediaArrays( void  );
+void initPencilRuns( void );
+void initGridTasks( int numTasks );
+int getGridNumEfieldTasks( void );
+int getGridNumHfieldTasks( void );
+void updateGridEfieldTask( int task );
+void updateGridHfieldTask( int task );
+void getGridUpdateCost( bool isMagnetic , double *bytes , double *flops );
 void dumpMediaOnGrid( FieldComponent field );
 void bboxInPhysicalUnits( real physbbox[6] , int bbox[6] );
 real indexInPhysicalUnits( int index , CoordAxis dir );
@@ -361,6 +449,18 @@ void getUniformGridSize( real d[3] );
 real numericalPhaseVelocity( real theta , real phi );
 void nodeInPhysicalUnits( real r[3] , real ijk[3] );
 void checkMediumOnGrid( int gbbox[6] , MediumIndex medium );
-void applyVoxelsToGrid( MediumIndex ***blockArray );
+void applyVoxelsToGrid( void ***blockArray );
+bool setGridKernel( char *name );
+GridKernel getGridKernel( void );
+void setGridTileSize( int tileSize[2] );
+void getGridTileSize( int tileSize[2] );
+void getUnionFieldLimits( int fieldLimits[6][6] , FieldComponent first , FieldComponent last , int lim[6] );
+void getNumTiles( int lim[6] , int tileSize[2] , int numTiles[2] );
+void updateGridTimeBlocked( int numSteps );
+void getTileLimits( int lim[6] , int tileSize[2] , int numTiles[2] , int tile , int *jlo , int *jhi , int *klo , int *khi );
+void getLoopDecomp( int lim[6] , LoopDecomp *decomp );
+void getLoopDecompBlocks( int lim[6] , int numParts , LoopDecomp *decomp );
+void getLoopDecompLimits( LoopDecomp *decomp , int item , int blim[6] );
+void firstTouchFieldArray( void *array , size_t size , int lim[6] );
 
 #endif
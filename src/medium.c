@@ -39,6 +39,9 @@
 /* Array of pointer to media indexed by medium number/index. */
 MediumItem **mediumArray = NULL;
 
+/* Size of stored medium indices in bytes. */
+size_t mediumIndexSize = sizeof( MediumIndex32 );
+
 /* 
  * Private data. 
  */
@@ -49,6 +52,10 @@ char MEDIUM_TYPE_STR[NUM_MEDIUM_TYPES][TAG_SIZE] = { "FREE_SPACE" , "PEC" , "SIM
 /* Number of medium types. */
 static MediumIndex numMedium = 0;
 
+/* Number of media created by averaging and allocated size of medium array. */
+static MediumIndex numAveragedMedia = 0;
+static MediumIndex mediumArraySize = 0;
+
 /* Existance flag for media of each type, including undefined. */
 static bool isMediumType[NUM_MEDIUM_TYPES+1] = { false };
 
@@ -61,6 +68,9 @@ static MediumItem *mediumHash = NULL;
 /* Hash of medium type by number.*/
 static MediumItem *mediumNumberHash = NULL;
 
+/* Hash of averaged media by update coefficients. */
+static MediumItem *averagedMediumHash = NULL;
+
 /* 
  * Private method interfaces. 
  */
@@ -394,6 +404,7 @@ void initMedia( void )
   message( MSG_DEBUG1 , 0 , "  Allocating media array\n" );
   mediumArray = allocArray( &bytes , sizeof( MediumItem * ) , 1 , numMedium );
   memory.media += bytes;
+  mediumArraySize = numMedium;
 
   /* Determine update coefficient for each material. */
   mediumNumber = 0;
@@ -511,7 +522,7 @@ void deallocMedia( void )
 
   message( MSG_DEBUG1 , 0 , "Deallocating media...\n" );
  
-  deallocArray( mediumArray , 1 , numMedium );
+  deallocArray( mediumArray , 1 , mediumArraySize );
 
   /* Free the number hash. */
   HASH_ITER( hhint , mediumNumberHash , item , tmp )
@@ -532,10 +543,116 @@ void deallocMedia( void )
     free( item );
   }
 
+  HASH_ITER( hh , averagedMediumHash , item , tmp )
+  {
+    HASH_DEL( averagedMediumHash , item );
+    free( item );
+  }
+
   return;
 
 }
 
+/* 
+ * Choose the narrowest storage type for medium indices that can index all
+ * the media, including any averaged media. Must be called after parsing and 
+ * before any medium index arrays are allocated. Returns true if the size has
+ * changed, in which case existing medium index arrays must be resized.
+ */
+bool setMediumIndexSize( void )
+{
+
+  size_t oldSize = mediumIndexSize;
+  MediumIndex numIndexed = numMedium + numAveragedMedia;
+
+  if( numIndexed <= (MediumIndex)UINT8_MAX + 1 )
+    mediumIndexSize = sizeof( MediumIndex8 );
+  else if( numIndexed <= (MediumIndex)UINT16_MAX + 1 )
+    mediumIndexSize = sizeof( MediumIndex16 );
+  else
+    mediumIndexSize = sizeof( MediumIndex32 );
+
+  return mediumIndexSize != oldSize;
+
+}
+
+/* 
+ * Find or add a simple medium with the update coefficients of the given
+ * averaged parameters. Media are identified by their coefficients so that
+ * edges with the same averaged coefficients share an index. 
+ * Depends: initMedia
+ */
+MediumIndex addAveragedMedium( real eps_r , real sigma , real mu_r )
+{
+
+  MediumItem *item = NULL;
+  MediumItem **newArray = NULL;
+  MediumIndex newSize;
+  real coeff[3];
+  unsigned long bytes = 0;
+
+  /* Only valid after medium array is initialised. */
+  assert( mediumArray );
+
+  calcCoeffFromParam( &coeff[0] , &coeff[1] , &coeff[2] , NULL , NULL , getGridTimeStep() , 
+                      eps_r , sigma , mu_r , 0 , NULL , NULL );
+
+  /* Key is the contiguous alpha, beta and gamma members. */
+  HASH_FIND( hh , averagedMediumHash , coeff , sizeof( coeff ) , item );
+  if( item )
+    return item->number;
+
+  if( numMedium + numAveragedMedia == MAX_MEDIA )
+    message( MSG_ERROR , 0 , "*** Error: Maximum number of media exceeded!\n" );
+
+  item = (MediumItem *) malloc( sizeof( MediumItem ) );
+  if( !item )
+    message( MSG_ERROR , 0 , "*** Error: Failed to allocate medium!\n" );
+
+  snprintf( item->name , TAG_SIZE , "__VR_AV_%lu__" , (unsigned long) numAveragedMedia + 1 );
+  item->number = numMedium + numAveragedMedia;
+  item->type = MT_SIMPLE;
+  item->eps_r = eps_r;
+  item->sigma = sigma;
+  item->mu_r = mu_r;
+  item->numPoles = 0;
+  item->residues = NULL;
+  item->poles = NULL;
+  item->fileName[0] = '\0';
+  item->alpha = coeff[0];
+  item->beta = coeff[1];
+  item->gamma = coeff[2];
+  item->dalpha = NULL;
+  item->dbeta = NULL;
+  HASH_ADD( hh , averagedMediumHash , alpha , sizeof( coeff ) , item );
+
+  /* Grow medium array geometrically. */
+  if( item->number == mediumArraySize )
+  {
+    newSize = mediumArraySize < MAX_MEDIA / 2 ? 2 * mediumArraySize : MAX_MEDIA;
+    newArray = allocArray( &bytes , sizeof( MediumItem * ) , 1 , newSize );
+    memcpy( newArray , mediumArray , mediumArraySize * sizeof( MediumItem * ) );
+    deallocArray( mediumArray , 1 , mediumArraySize );
+    memory.media += bytes - mediumArraySize * sizeof( MediumItem * );
+    mediumArray = newArray;
+    mediumArraySize = newSize;
+  }
+
+  mediumArray[item->number] = item;
+  numAveragedMedia++;
+
+  return item->number;
+
+}
+
+/* Get number of media created by averaging. */
+MediumIndex getNumAveragedMedia( void )
+{
+
+  return numAveragedMedia;
+
+}
+
 /* Report media. */
 void reportMedia( void )
 {
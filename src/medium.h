@@ -26,6 +26,7 @@
 #define _MEDIA_H_
 
 #include <complex.h>
+#include <stdint.h>
 
 #include "fdtd_types.h"
 #include "utlist.h"
@@ -34,8 +35,32 @@
 /* Index type used for counting and iterating over media. */
 typedef unsigned int MediumIndex;
 #define MAX_MEDIA UINT_MAX
-//typedef unsigned char MediumIndex;
-//#define MAX_MEDIA UCHAR_MAX
+
+/* 
+ * Storage types for medium indices in grid arrays. The narrowest type that 
+ * can hold all the media is chosen at run-time by setMediumIndexSize.
+ */
+typedef uint8_t  MediumIndex8;
+typedef uint16_t MediumIndex16;
+typedef uint32_t MediumIndex32;
+
+/* Get medium index (i,j,k) from a 3D array of stored medium indices of given size. */
+#define GET_MEDIUM_INDEX_SIZED( size , array , i , j , k ) \
+  ( (size) == 1 ? (MediumIndex)( (MediumIndex8 ***)(array) )[i][j][k] : \
+  ( (size) == 2 ? (MediumIndex)( (MediumIndex16 ***)(array) )[i][j][k] : \
+                  (MediumIndex)( (MediumIndex32 ***)(array) )[i][j][k] ) )
+
+/* Set medium index (i,j,k) in a 3D array of stored medium indices of given size. */
+#define SET_MEDIUM_INDEX_SIZED( size , array , i , j , k , medium ) \
+  ( (size) == 1 ? (void)( ( (MediumIndex8 ***)(array) )[i][j][k] = (MediumIndex8)(medium) ) : \
+  ( (size) == 2 ? (void)( ( (MediumIndex16 ***)(array) )[i][j][k] = (MediumIndex16)(medium) ) : \
+                  (void)( ( (MediumIndex32 ***)(array) )[i][j][k] = (MediumIndex32)(medium) ) ) )
+
+/* Get/set medium index (i,j,k) in a 3D array of stored medium indices. */
+#define GET_MEDIUM_INDEX( array , i , j , k ) \
+  GET_MEDIUM_INDEX_SIZED( mediumIndexSize , array , i , j , k )
+#define SET_MEDIUM_INDEX( array , i , j , k , medium ) \
+  SET_MEDIUM_INDEX_SIZED( mediumIndexSize , array , i , j , k , medium )
 
 
 /* 
@@ -106,6 +131,9 @@ typedef struct MediumItem_t {
 /* the medium coeffficients from the media list. */
 extern MediumItem **mediumArray;
 
+/* Size of stored medium indices in bytes. */
+extern size_t mediumIndexSize;
+
 /*
  * Public method interfaces.
  */
@@ -128,5 +156,8 @@ void calcCoeffFromParam( real *alpha , real *beta , real *gamma , double complex
                          int numPoles , double complex residues[] , double complex poles[] );
 void updateSimpleMedium( MediumIndex index , real eps_r , real sigma , real mu_r );
 bool thereAreMedia( MediumType );
+bool setMediumIndexSize( void );
+MediumIndex addAveragedMedium( real eps_r , real sigma , real mu_r );
+MediumIndex getNumAveragedMedia( void );
 
 #endif
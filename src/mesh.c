@@ -249,9 +249,9 @@ void initMesh( void )
   message( MSG_LOG , 0 , "\nInitialising mesh...\n\n" );
 
   /* Predefine PEC and free space boundaries. */
-  addBoundary( "PEC" , BT_PEC , 0 , 0 , 1.0 , -1.0 , 1.0 , "" , NULL , NULL );
-  addBoundary( "PMC" , BT_PMC , 0 , 0 , 1.0 , +1.0 , 1.0 , "" , NULL , NULL );
-  addBoundary( "FREE_SPACE" , BT_FREE_SPACE , 0 , 0 , 1.0 , 0.0 , 1.0 , "" , NULL , NULL );
+  addBoundary( "PEC" , BT_PEC , 0 , 0 , 1.0 , -1.0 , 1.0 , 0.0 , NULL , "" , NULL , NULL );
+  addBoundary( "PMC" , BT_PMC , 0 , 0 , 1.0 , +1.0 , 1.0 , 0.0 , NULL , "" , NULL , NULL );
+  addBoundary( "FREE_SPACE" , BT_FREE_SPACE , 0 , 0 , 1.0 , 0.0 , 1.0 , 0.0 , NULL , "" , NULL , NULL );
 
   /* Predefine PEC and free space boundaries. */
   addWire( "PEC" , TW_PEC , 0.0 );
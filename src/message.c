@@ -29,6 +29,7 @@
 #include <string.h>
 
 #include "message.h"
+#include "domain.h"
 
 static FILE *logFile;
 static char *programName;
@@ -102,7 +103,11 @@ void message(  MessageType status , int errnum , const char *message , ... )
   fflush( logFile );
 
   if ( status >= MSG_ERROR )
-     exit( MSG_ERROR );
+  {
+    /* Take down the other domains too rather than leaving them blocked in a halo exchange. */
+    abortDomain( MSG_ERROR );
+    exit( MSG_ERROR );
+  }
 
 }
 
@@ -37,6 +37,7 @@
 #include "medium.h"
 #include "memory.h"
 #include "physical.h"
+#include "domain.h"
 
 /* 
  * Private data.
@@ -51,11 +52,55 @@ static int fmlim[6][6][6];
 /* MUR phase velocity factor arrays. */
 static real zeta[6];
 
+/* Default angles of perfect absorption in degrees for each order of Higdon boundary. */
+static real higdonDefaultAngles[MAX_HIGDON_ORDER][MAX_HIGDON_ORDER] = { {  0.0 ,  0.0 ,  0.0 } ,
+                                                                        {  0.0 , 45.0 ,  0.0 } ,
+                                                                        {  0.0 , 30.0 , 60.0 } };
+
+/* Tangential electric field components on the faces normal to each axis. */
+static FieldComponent higdonField[3][2] = { { EY , EZ } , { EX , EZ } , { EX , EY } };
+
+/* Higdon boundary order. */
+static int higdonOrder[6];
+
+/* Higdon boundary coefficients of E^{n+1-t} on the plane s cells from the boundary. */
+static real higdonCoeff[6][MAX_HIGDON_ORDER+1][MAX_HIGDON_ORDER+1];
+
+/* Stored earlier time levels of the planes of the two tangential components, past[level][s][a][b]. */
+static real ****higdonPast[6][2];
+static int higdonPastSize[6][2][2];
+
+/*
+ * Damping of each Higdon factor relative to c0 / delta for each order of Higdon boundary. The
+ * product of two or more undamped factors has a repeated root at zero frequency and drifts
+ * secularly. Damping reflects low frequencies so the normal incidence factor is damped as little
+ * as possible. The values were chosen empirically from the single and dual grid reflection tests.
+ * The late-time plateaus are the peak field over the last 800 steps of an 8000 step run of the
+ * dual grid test, relative to the incident peak:
+ *
+ * - Order 2 is stable with only the oblique factor damped and settles at about -100 dB. Damping
+ *   both factors by 0.04 made it worse than the Mur boundary at low frequencies.
+ * - Order 3 grows with the normal incidence factor undamped. Damping it by 0.005, 0.01, 0.02 and
+ *   0.04 left plateaus of about -40, -55, -60 and -76 dB, but 0.04 raised the reflection by 6 dB,
+ *   so 0.02 is used.
+ */
+static real higdonDamping[MAX_HIGDON_ORDER][MAX_HIGDON_ORDER] = { { 0.0  , 0.0  , 0.0  } ,
+                                                                  { 0.0  , 0.04 , 0.0  } ,
+                                                                  { 0.02 , 0.04 , 0.04 } };
+
+/* Number of Higdon boundary updates done. */
+static unsigned long higdonStep[6];
+
 /* 
  * Private method interfaces. 
  */
 
 void deselectAdjacentEdgesByType( bool includeBoundary[6] , MeshFace face , BoundaryType type );
+void initHigdonBoundary( MeshFace face );
+void updateHigdonEfieldFace( MeshFace face );
+static inline real predictEx( int i , int j , int k );
+static inline real predictEy( int i , int j , int k );
+static inline real predictEz( int i , int j , int k );
 
 /*
  * Method Implementations.
@@ -109,11 +154,13 @@ void initMurBoundaries( void )
   {
     bool includeBoundary[6] = { true  , true  , true  , true  , true , true };
 
-    if( outerSurfaceType( face ) == BT_MUR )
+    if( isMurFace( face ) )
     {
       getFaceOfBoundingBox( murbox[face] , gibox , face ); 
       deselectAdjacentEdgesByType( includeBoundary , face , BT_MUR );
+      deselectAdjacentEdgesByType( includeBoundary , face , BT_HIGDON );
       setFieldLimits( murbox[face] , fmlim[face] , includeBoundary );
+      clipFieldLimitsToDomain( fmlim[face] );
     }
   }
 
@@ -125,266 +172,442 @@ void initMurBoundaries( void )
   zeta[YHI] = ( c0 * dt - dey[murbox[YHI][YHI-1]] ) / (  c0 * dt + dey[murbox[YHI][YHI-1]] );
   zeta[ZLO] = ( c0 * dt - dez[murbox[ZLO][ZLO]] )   / (  c0 * dt + dez[murbox[ZLO][ZLO]] );
   zeta[ZHI] = ( c0 * dt - dez[murbox[ZHI][ZHI-1]] ) / (  c0 * dt + dez[murbox[ZHI][ZHI-1]] );
+
+  for( MeshFace face = XLO ; face <= ZHI ; face++ )
+    if( outerSurfaceType( face ) == BT_HIGDON )
+      initHigdonBoundary( face );
   
   return;
 
 }
 
+/* 
+ * Initialise a Higdon boundary, see R. L. Higdon, "Numerical absorbing boundary conditions 
+ * for the wave equation", Math. Comp., vol. 49, no. 179, pp. 65-90, 1987. The boundary 
+ * operator is the product of first order operators each exact at one angle of incidence, 
+ *
+ *   prod_p [ cos( alpha_p ) d/dt - c d/dx + delta_p c / dx ] E = 0,
+ *
+ * each discretised with the averages of the Mur boundary. Each factor is a bilinear polynomial
+ * in K, which shifts one cell into the grid, and 1 / z, which shifts one time step back. The 
+ * product is expanded into the coefficients of E^{n+1-t} on the plane s cells from the boundary.
+ */
+void initHigdonBoundary( MeshFace face )
+{
+
+  CoordAxis axis = face / 2;
+  real *de[3] = { dex , dey , dez };
+  real delta = de[axis][murbox[face][2*axis]];
+  real dt = getGridTimeStep();
+  int order;
+  real n_eff , refCoeff , kmax , amax;
+  real angles[MAX_HIGDON_ORDER];
+  real a , b , e;
+  real factor[2][2];
+  real product[MAX_HIGDON_ORDER+1][MAX_HIGDON_ORDER+1];
+  int lim[6];
+  int numLevels;
+  unsigned long bytes = 0;
+
+  getOuterSurfaceParams( face , &order , &n_eff , &refCoeff , &kmax , &amax );
+  getOuterSurfaceAngles( face , angles );
+  higdonOrder[face] = order;
+  higdonStep[face] = 0UL;
+
+  for( int s = 0 ; s <= MAX_HIGDON_ORDER ; s++ )
+    for( int t = 0 ; t <= MAX_HIGDON_ORDER ; t++ )
+      higdonCoeff[face][s][t] = 0.0;
+  higdonCoeff[face][0][0] = 1.0;
+
+  for( int p = 0 ; p < order ; p++ )
+  {
+    a = cos( angles[p] * pi / 180.0 ) / dt;
+    b = c0 / delta;
+    e = higdonDamping[order-1][p] * b;
+    factor[0][0] = 1.0;
+    factor[1][0] = ( a - b + e ) / ( a + b + e );
+    factor[0][1] = ( b - a + e ) / ( a + b + e );
+    factor[1][1] = ( e - a - b ) / ( a + b + e );
+    for( int s = 0 ; s <= p + 1 ; s++ )
+      for( int t = 0 ; t <= p + 1 ; t++ )
+      {
+        product[s][t] = 0.0;
+        for( int fs = 0 ; fs <= 1 ; fs++ )
+          for( int ft = 0 ; ft <= 1 ; ft++ )
+            if( s - fs >= 0 && s - fs <= p && t - ft >= 0 && t - ft <= p )
+              product[s][t] += factor[fs][ft] * higdonCoeff[face][s-fs][t-ft];
+      }
+    for( int s = 0 ; s <= p + 1 ; s++ )
+      for( int t = 0 ; t <= p + 1 ; t++ )
+        higdonCoeff[face][s][t] = product[s][t];
+  }
+
+  message( MSG_LOG , 0 , "  Higdon %s: order=%d angles=[%g,%g,%g] deg\n" , FACE[face] , order , 
+           angles[0] , order > 1 ? angles[1] : 0.0 , order > 2 ? angles[2] : 0.0 );
+
+  /* The planes used must be in the domain. */
+  getDomainLimits( lim );
+  if( isOuterDomainFace( face ) && lim[2*axis+1] - lim[2*axis] < order )
+    message( MSG_ERROR , 0 , "*** Error: Domain is too thin for order %d Higdon boundary on %s\n" , order , FACE[face] );
+
+  /* Earlier time levels of the planes of the tangential components. */
+  numLevels = order - 1;
+  for( int component = 0 ; component <= 1 ; component++ )
+  {
+    FieldComponent field = higdonField[axis][component];
+    int *flim = fmlim[face][field];
+    int dim = 0;
+
+    higdonPast[face][component] = NULL;
+    for( CoordAxis tangent = XDIR ; tangent <= ZDIR ; tangent++ )
+      if( tangent != axis )
+        higdonPastSize[face][component][dim++] = flim[2*tangent+1] - flim[2*tangent] + 1;
+
+    if( numLevels > 0 && higdonPastSize[face][component][0] > 0 && higdonPastSize[face][component][1] > 0 )
+      higdonPast[face][component] = allocArray( &bytes , sizeof( real ) , 4 , numLevels , order + 1 , 
+                                                higdonPastSize[face][component][0] , higdonPastSize[face][component][1] );
+  }
+
+  message( MSG_DEBUG1 , 0 , "  Higdon %s arrays: %lu bytes\n" , FACE[face] , bytes );
+
+  return;
+
+}
+
 /* Update electric field on Mur boundaries. */
 /* Must be done before E field updates. */
 void updateMurEfield( void )
 {
 
-  int i , j , k;
+  for( MeshFace face = XLO ; face <= ZHI ; face++ )
+    updateMurEfieldFace( face );
+
+  return;
+
+}
+
+/* Update electric field on one Mur boundary - the faces are independent. */
+void updateMurEfieldFace( MeshFace face )
+{
+
+  int i , j , k , item;
+  int blim[6];
   real Extemp , Eytemp , Eztemp;
+  LoopDecomp decomp;
+
+  if( outerSurfaceType( face ) == BT_HIGDON )
+  {
+    updateHigdonEfieldFace( face );
+    return;
+  }
   
   /* Mur ABC at XLO. */  
-  if( outerSurfaceType( XLO ) == BT_MUR )
+  if( face == XLO && outerSurfaceType( XLO ) == BT_MUR )
   {
   
     i = fmlim[XLO][EY][XLO];
+    getLoopDecomp( fmlim[XLO][EY] , &decomp );
     #ifdef WITH_OPENMP
-      #pragma omp parallel for private( j , k , Eytemp )
+      #pragma omp parallel for private( j , k , Eytemp , item , blim )
     #endif
-    for ( j = fmlim[XLO][EY][YLO] ; j <= fmlim[XLO][EY][YHI] ; j++ )
+    for ( item = 0 ; item < decomp.numItems ; item++ )
     {
-      for ( k = fmlim[XLO][EY][ZLO] ; k <= fmlim[XLO][EY][ZHI] ; k++ )
+      getLoopDecompLimits( &decomp , item , blim );
+      for ( j = blim[YLO] ; j <= blim[YHI] ; j++ )
       {
-        //zeta = ( sqrt( BETA_EY(i+1,j,k) * GAMMA_EY(i+1,j,k) ) - 1.0 ) /
-        //       ( sqrt( BETA_EY(i+1,j,k) * GAMMA_EY(i+1,j,k) ) + 1.0 );
-        Eytemp = ALPHA_EY(i+1,j,k) * Ey[i+1][j][k] + BETA_EY(i+1,j,k)
-          * curl_Hy( Hx[i+1][j][k] , Hx[i+1][j][k-1] , Hz[i][j][k] , Hz[i+1][j][k] , i + 1 , j , k ); 
-        CHECK_NOT_VISITED( Ey[i][j][k] );
-        Ey[i][j][k] = Ey[i+1][j][k] + zeta[XLO] * ( Eytemp - Ey[i][j][k] );
-        MARK_AS_VISITED( Ey[i][j][k] );
+        for ( k = blim[ZLO] ; k <= blim[ZHI] ; k++ )
+        {
+          //zeta = ( sqrt( BETA_EY(i+1,j,k) * GAMMA_EY(i+1,j,k) ) - 1.0 ) /
+          //       ( sqrt( BETA_EY(i+1,j,k) * GAMMA_EY(i+1,j,k) ) + 1.0 );
+          Eytemp = ALPHA_EY(i+1,j,k) * Ey[i+1][j][k] + BETA_EY(i+1,j,k)
+            * curl_Hy( Hx[i+1][j][k] , Hx[i+1][j][k-1] , Hz[i][j][k] , Hz[i+1][j][k] , i + 1 , j , k ); 
+          CHECK_NOT_VISITED( Ey[i][j][k] );
+          Ey[i][j][k] = Ey[i+1][j][k] + zeta[XLO] * ( Eytemp - Ey[i][j][k] );
+          MARK_AS_VISITED( Ey[i][j][k] );
+        }
       }
     }
 
     i = fmlim[XLO][EZ][XLO];
+    getLoopDecomp( fmlim[XLO][EZ] , &decomp );
     #ifdef WITH_OPENMP
-      #pragma omp parallel for private( j , k , Eztemp )
+      #pragma omp parallel for private( j , k , Eztemp , item , blim )
     #endif
-    for ( j = fmlim[XLO][EZ][YLO] ; j <= fmlim[XLO][EZ][YHI] ; j++ )
+    for ( item = 0 ; item < decomp.numItems ; item++ )
     {
-      for ( k = fmlim[XLO][EZ][ZLO] ; k <= fmlim[XLO][EZ][ZHI] ; k++ )
+      getLoopDecompLimits( &decomp , item , blim );
+      for ( j = blim[YLO] ; j <= blim[YHI] ; j++ )
       {
-        //zeta = ( sqrt( BETA_EZ(i+1,j,k) * GAMMA_EZ(i+1,j,k) ) - 1.0 ) /
-        //       ( sqrt( BETA_EZ(i+1,j,k) * GAMMA_EZ(i+1,j,k) ) + 1.0 );
-        Eztemp = ALPHA_EZ(i+1,j,k) * Ez[i+1][j][k] + BETA_EZ(i+1,j,k)
-          * curl_Hz( Hy[i+1][j][k] , Hy[i][j][k] , Hx[i+1][j-1][k] , Hx[i+1][j][k] , i + 1 , j , k );
-        CHECK_NOT_VISITED( Ez[i][j][k] );
-        Ez[i][j][k] = Ez[i+1][j][k] + zeta[XLO] * ( Eztemp - Ez[i][j][k] );
-        MARK_AS_VISITED( Ez[i][j][k] );        
+        for ( k = blim[ZLO] ; k <= blim[ZHI] ; k++ )
+        {
+          //zeta = ( sqrt( BETA_EZ(i+1,j,k) * GAMMA_EZ(i+1,j,k) ) - 1.0 ) /
+          //       ( sqrt( BETA_EZ(i+1,j,k) * GAMMA_EZ(i+1,j,k) ) + 1.0 );
+          Eztemp = ALPHA_EZ(i+1,j,k) * Ez[i+1][j][k] + BETA_EZ(i+1,j,k)
+            * curl_Hz( Hy[i+1][j][k] , Hy[i][j][k] , Hx[i+1][j-1][k] , Hx[i+1][j][k] , i + 1 , j , k );
+          CHECK_NOT_VISITED( Ez[i][j][k] );
+          Ez[i][j][k] = Ez[i+1][j][k] + zeta[XLO] * ( Eztemp - Ez[i][j][k] );
+          MARK_AS_VISITED( Ez[i][j][k] );        
+        }
       }
     }
 
   } // if
 
   /* Mur ABC at XHI. */
-  if( outerSurfaceType( XHI ) == BT_MUR )
+  if( face == XHI && outerSurfaceType( XHI ) == BT_MUR )
   {
   
     i = fmlim[XHI][EY][XHI];
+    getLoopDecomp( fmlim[XHI][EY] , &decomp );
     #ifdef WITH_OPENMP
-      #pragma omp parallel for private( j , k , Eytemp )
+      #pragma omp parallel for private( j , k , Eytemp , item , blim )
     #endif
-    for ( j = fmlim[XHI][EY][YLO] ; j <= fmlim[XHI][EY][YHI] ; j++ )
+    for ( item = 0 ; item < decomp.numItems ; item++ )
     {
-      for ( k = fmlim[XHI][EY][ZLO] ; k <= fmlim[XHI][EY][ZHI] ; k++ )
+      getLoopDecompLimits( &decomp , item , blim );
+      for ( j = blim[YLO] ; j <= blim[YHI] ; j++ )
       {
-        //zeta = ( sqrt( BETA_EY(i-1,j,k) * GAMMA_EY(i-1,j,k) ) - 1.0 ) /
-        //       ( sqrt( BETA_EY(i-1,j,k) * GAMMA_EY(i-1,j,k) ) + 1.0 );
-        Eytemp = ALPHA_EY(i-1,j,k) * Ey[i-1][j][k] + BETA_EY(i-1,j,k)
-          * curl_Hy( Hx[i-1][j][k] , Hx[i-1][j][k-1] , Hz[i-2][j][k] , Hz[i-1][j][k] , i - 1 , j , k ); 
-        CHECK_NOT_VISITED( Ey[i][j][k] );
-        Ey[i][j][k] = Ey[i-1][j][k] + zeta[XHI] * ( Eytemp - Ey[i][j][k] );
-        MARK_AS_VISITED( Ey[i][j][k] );         
+        for ( k = blim[ZLO] ; k <= blim[ZHI] ; k++ )
+        {
+          //zeta = ( sqrt( BETA_EY(i-1,j,k) * GAMMA_EY(i-1,j,k) ) - 1.0 ) /
+          //       ( sqrt( BETA_EY(i-1,j,k) * GAMMA_EY(i-1,j,k) ) + 1.0 );
+          Eytemp = ALPHA_EY(i-1,j,k) * Ey[i-1][j][k] + BETA_EY(i-1,j,k)
+            * curl_Hy( Hx[i-1][j][k] , Hx[i-1][j][k-1] , Hz[i-2][j][k] , Hz[i-1][j][k] , i - 1 , j , k ); 
+          CHECK_NOT_VISITED( Ey[i][j][k] );
+          Ey[i][j][k] = Ey[i-1][j][k] + zeta[XHI] * ( Eytemp - Ey[i][j][k] );
+          MARK_AS_VISITED( Ey[i][j][k] );         
+        }
       }
     }
 
     i = fmlim[XHI][EZ][XHI];
+    getLoopDecomp( fmlim[XHI][EZ] , &decomp );
     #ifdef WITH_OPENMP
-      #pragma omp parallel for private( j , k , Eztemp )
+      #pragma omp parallel for private( j , k , Eztemp , item , blim )
     #endif
-    for ( j = fmlim[XHI][EZ][YLO] ; j <= fmlim[XHI][EZ][YHI] ; j++ )
+    for ( item = 0 ; item < decomp.numItems ; item++ )
     {
-      for ( k = fmlim[XHI][EZ][ZLO] ; k <= fmlim[XHI][EZ][ZHI] ; k++ )
+      getLoopDecompLimits( &decomp , item , blim );
+      for ( j = blim[YLO] ; j <= blim[YHI] ; j++ )
       {
-        //zeta = ( sqrt( BETA_EZ(i-1,j,k) * GAMMA_EZ(i-1,j,k) ) - 1.0 ) /
-        //       ( sqrt( BETA_EZ(i-1,j,k) * GAMMA_EZ(i-1,j,k) ) + 1.0 );
-        Eztemp = ALPHA_EZ(i-1,j,k) * Ez[i-1][j][k] + BETA_EZ(i-1,j,k)
-          * curl_Hz( Hy[i-1][j][k] , Hy[i-2][j][k] , Hx[i-1][j-1][k] , Hx[i-1][j][k] , i - 1 , j , k );
-        CHECK_NOT_VISITED( Ez[i][j][k] );
-        Ez[i][j][k] = Ez[i-1][j][k] + zeta[XHI] * ( Eztemp - Ez[i][j][k] );
-        MARK_AS_VISITED( Ez[i][j][k] );          
+        for ( k = blim[ZLO] ; k <= blim[ZHI] ; k++ )
+        {
+          //zeta = ( sqrt( BETA_EZ(i-1,j,k) * GAMMA_EZ(i-1,j,k) ) - 1.0 ) /
+          //       ( sqrt( BETA_EZ(i-1,j,k) * GAMMA_EZ(i-1,j,k) ) + 1.0 );
+          Eztemp = ALPHA_EZ(i-1,j,k) * Ez[i-1][j][k] + BETA_EZ(i-1,j,k)
+            * curl_Hz( Hy[i-1][j][k] , Hy[i-2][j][k] , Hx[i-1][j-1][k] , Hx[i-1][j][k] , i - 1 , j , k );
+          CHECK_NOT_VISITED( Ez[i][j][k] );
+          Ez[i][j][k] = Ez[i-1][j][k] + zeta[XHI] * ( Eztemp - Ez[i][j][k] );
+          MARK_AS_VISITED( Ez[i][j][k] );          
+        }
       }
     }
 
   } // if
 
   /* Mur ABC at YLO. */ 
-  if( outerSurfaceType( YLO ) == BT_MUR )
+  if( face == YLO && outerSurfaceType( YLO ) == BT_MUR )
   {
     
     j = fmlim[YLO][EX][YLO];
+    getLoopDecomp( fmlim[YLO][EX] , &decomp );
     #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , k , Extemp )
+      #pragma omp parallel for private( i , k , Extemp , item , blim )
     #endif
-    for ( i = fmlim[YLO][EX][XLO] ; i <= fmlim[YLO][EX][XHI] ; i++ )
+    for ( item = 0 ; item < decomp.numItems ; item++ )
     {
-      for ( k = fmlim[YLO][EX][ZLO] ; k <= fmlim[YLO][EX][ZHI] ; k++ )
+      getLoopDecompLimits( &decomp , item , blim );
+      for ( i = blim[XLO] ; i <= blim[XHI] ; i++ )
       {
-        //zeta = ( sqrt( BETA_EX(i,j+1,k) * GAMMA_EX(i,j+1,k) ) - 1.0 ) /
-        //       ( sqrt( BETA_EX(i,j+1,k) * GAMMA_EX(i,j+1,k) ) + 1.0 );
-        Extemp = ALPHA_EX(i,j+1,k) * Ex[i][j+1][k] + BETA_EX(i,j+1,k)
-          * curl_Hx( Hz[i][j+1][k] , Hz[i][j][k] , Hy[i][j+1][k-1] , Hy[i][j+1][k] , i , j + 1 , k );
-        CHECK_NOT_VISITED( Ex[i][j][k] );          
-        Ex[i][j][k] = Ex[i][j+1][k] + zeta[YLO] * ( Extemp - Ex[i][j][k] );
-        MARK_AS_VISITED( Ex[i][j][k] );          
+        for ( k = blim[ZLO] ; k <= blim[ZHI] ; k++ )
+        {
+          //zeta = ( sqrt( BETA_EX(i,j+1,k) * GAMMA_EX(i,j+1,k) ) - 1.0 ) /
+          //       ( sqrt( BETA_EX(i,j+1,k) * GAMMA_EX(i,j+1,k) ) + 1.0 );
+          Extemp = ALPHA_EX(i,j+1,k) * Ex[i][j+1][k] + BETA_EX(i,j+1,k)
+            * curl_Hx( Hz[i][j+1][k] , Hz[i][j][k] , Hy[i][j+1][k-1] , Hy[i][j+1][k] , i , j + 1 , k );
+          CHECK_NOT_VISITED( Ex[i][j][k] );          
+          Ex[i][j][k] = Ex[i][j+1][k] + zeta[YLO] * ( Extemp - Ex[i][j][k] );
+          MARK_AS_VISITED( Ex[i][j][k] );          
+        }
       }
     }
 
     j = fmlim[YLO][EZ][YLO];
+    getLoopDecomp( fmlim[YLO][EZ] , &decomp );
     #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , k , Eztemp )
+      #pragma omp parallel for private( i , k , Eztemp , item , blim )
     #endif
-    for ( i = fmlim[YLO][EZ][XLO] ; i <= fmlim[YLO][EZ][XHI] ; i++ )
+    for ( item = 0 ; item < decomp.numItems ; item++ )
     {
-      for ( k = fmlim[YLO][EZ][ZLO] ; k <= fmlim[YLO][EZ][ZHI] ; k++ )
+      getLoopDecompLimits( &decomp , item , blim );
+      for ( i = blim[XLO] ; i <= blim[XHI] ; i++ )
       {
-        //zeta = ( sqrt( BETA_EZ(i,j+1,k) * GAMMA_EZ(i,j+1,k) ) - 1.0 ) /
-        //       ( sqrt( BETA_EZ(i,j+1,k) * GAMMA_EZ(i,j+1,k) ) + 1.0 );
-        Eztemp = ALPHA_EZ(i,j+1,k) * Ez[i][j+1][k] + BETA_EZ(i,j+1,k)
-          * curl_Hz( Hy[i][j+1][k] , Hy[i-1][j+1][k] , Hx[i][j][k] , Hx[i][j+1][k] , i , j + 1 , k );
-        CHECK_NOT_VISITED( Ez[i][j][k] );
-        Ez[i][j][k] = Ez[i][j+1][k] + zeta[YLO] * ( Eztemp - Ez[i][j][k] );
-        MARK_AS_VISITED( Ez[i][j][k] );          
+        for ( k = blim[ZLO] ; k <= blim[ZHI] ; k++ )
+        {
+          //zeta = ( sqrt( BETA_EZ(i,j+1,k) * GAMMA_EZ(i,j+1,k) ) - 1.0 ) /
+          //       ( sqrt( BETA_EZ(i,j+1,k) * GAMMA_EZ(i,j+1,k) ) + 1.0 );
+          Eztemp = ALPHA_EZ(i,j+1,k) * Ez[i][j+1][k] + BETA_EZ(i,j+1,k)
+            * curl_Hz( Hy[i][j+1][k] , Hy[i-1][j+1][k] , Hx[i][j][k] , Hx[i][j+1][k] , i , j + 1 , k );
+          CHECK_NOT_VISITED( Ez[i][j][k] );
+          Ez[i][j][k] = Ez[i][j+1][k] + zeta[YLO] * ( Eztemp - Ez[i][j][k] );
+          MARK_AS_VISITED( Ez[i][j][k] );          
+        }
       }
     }
  
   } // if
   
   /* Mur ABC at YHI. */
-  if( outerSurfaceType( YHI ) == BT_MUR )
+  if( face == YHI && outerSurfaceType( YHI ) == BT_MUR )
   {
     
     j = fmlim[YHI][EX][YHI];
+    getLoopDecomp( fmlim[YHI][EX] , &decomp );
     #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , k , Extemp )
+      #pragma omp parallel for private( i , k , Extemp , item , blim )
     #endif
-    for ( i = fmlim[YHI][EX][XLO] ; i <= fmlim[YHI][EX][XHI] ; i++ )
+    for ( item = 0 ; item < decomp.numItems ; item++ )
     {
-      for (k = fmlim[YHI][EX][ZLO] ; k <= fmlim[YHI][EX][ZHI] ; k++ )
+      getLoopDecompLimits( &decomp , item , blim );
+      for ( i = blim[XLO] ; i <= blim[XHI] ; i++ )
       {
-        //zeta = ( sqrt( BETA_EX(i,j-1,k) * GAMMA_EX(i,j-1,k) ) - 1.0 ) /
-        //       ( sqrt( BETA_EX(i,j-1,k) * GAMMA_EX(i,j-1,k) ) + 1.0 );
-        Extemp = ALPHA_EX(i,j-1,k) * Ex[i][j-1][k] + BETA_EX(i,j-1,k)
-          * curl_Hx( Hz[i][j-1][k] , Hz[i][j-2][k] , Hy[i][j-1][k-1] , Hy[i][j-1][k] , i , j - 1 , k );
-        CHECK_NOT_VISITED( Ex[i][j][k] ); 
-        Ex[i][j][k] = Ex[i][j-1][k] + zeta[YHI] * ( Extemp - Ex[i][j][k] );
-        MARK_AS_VISITED( Ex[i][j][k] );              
+        for ( k = blim[ZLO] ; k <= blim[ZHI] ; k++ )
+        {
+          //zeta = ( sqrt( BETA_EX(i,j-1,k) * GAMMA_EX(i,j-1,k) ) - 1.0 ) /
+          //       ( sqrt( BETA_EX(i,j-1,k) * GAMMA_EX(i,j-1,k) ) + 1.0 );
+          Extemp = ALPHA_EX(i,j-1,k) * Ex[i][j-1][k] + BETA_EX(i,j-1,k)
+            * curl_Hx( Hz[i][j-1][k] , Hz[i][j-2][k] , Hy[i][j-1][k-1] , Hy[i][j-1][k] , i , j - 1 , k );
+          CHECK_NOT_VISITED( Ex[i][j][k] ); 
+          Ex[i][j][k] = Ex[i][j-1][k] + zeta[YHI] * ( Extemp - Ex[i][j][k] );
+          MARK_AS_VISITED( Ex[i][j][k] );              
+        }
       }
     }
 
     j = fmlim[YHI][EZ][YHI]; 
+    getLoopDecomp( fmlim[YHI][EZ] , &decomp );
     #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , k , Eztemp )
+      #pragma omp parallel for private( i , k , Eztemp , item , blim )
     #endif
-    for ( i = fmlim[YHI][EZ][XLO] ; i <= fmlim[YHI][EZ][XHI] ; i++ )
+    for ( item = 0 ; item < decomp.numItems ; item++ )
     {
-      for (k = fmlim[YHI][EZ][ZLO] ; k <= fmlim[YHI][EZ][ZHI] ; k++ )
+      getLoopDecompLimits( &decomp , item , blim );
+      for ( i = blim[XLO] ; i <= blim[XHI] ; i++ )
       {
-        //zeta = ( sqrt( BETA_EZ(i,j-1,k) * GAMMA_EZ(i,j-1,k) ) - 1.0 ) /
-        //       ( sqrt( BETA_EZ(i,j-1,k) * GAMMA_EZ(i,j-1,k) ) + 1.0 );
-        Eztemp = ALPHA_EZ(i,j-1,k) * Ez[i][j-1][k] + BETA_EZ(i,j-1,k)
-          * curl_Hz( Hy[i][j-1][k] , Hy[i-1][j-1][k] , Hx[i][j-2][k] , Hx[i][j-1][k] , i , j - 1 , k );
-        CHECK_NOT_VISITED( Ez[i][j][k] );
-        Ez[i][j][k] = Ez[i][j-1][k] + zeta[YHI] * ( Eztemp - Ez[i][j][k] );
-        MARK_AS_VISITED( Ez[i][j][k] );
+        for ( k = blim[ZLO] ; k <= blim[ZHI] ; k++ )
+        {
+          //zeta = ( sqrt( BETA_EZ(i,j-1,k) * GAMMA_EZ(i,j-1,k) ) - 1.0 ) /
+          //       ( sqrt( BETA_EZ(i,j-1,k) * GAMMA_EZ(i,j-1,k) ) + 1.0 );
+          Eztemp = ALPHA_EZ(i,j-1,k) * Ez[i][j-1][k] + BETA_EZ(i,j-1,k)
+            * curl_Hz( Hy[i][j-1][k] , Hy[i-1][j-1][k] , Hx[i][j-2][k] , Hx[i][j-1][k] , i , j - 1 , k );
+          CHECK_NOT_VISITED( Ez[i][j][k] );
+          Ez[i][j][k] = Ez[i][j-1][k] + zeta[YHI] * ( Eztemp - Ez[i][j][k] );
+          MARK_AS_VISITED( Ez[i][j][k] );
+        }
       }
     }
 
   }
   
   /* Mur ABC at ZLO. */ 
-  if( outerSurfaceType( ZLO ) == BT_MUR )
+  if( face == ZLO && outerSurfaceType( ZLO ) == BT_MUR )
   {
     
     k = fmlim[ZLO][EY][ZLO];
+    getLoopDecomp( fmlim[ZLO][EY] , &decomp );
     #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , j , Eytemp )
+      #pragma omp parallel for private( i , j , Eytemp , item , blim )
     #endif
-    for ( i = fmlim[ZLO][EY][XLO] ; i <= fmlim[ZLO][EY][XHI] ; i++ )
+    for ( item = 0 ; item < decomp.numItems ; item++ )
     {
-      for ( j = fmlim[ZLO][EY][YLO] ; j <= fmlim[ZLO][EY][YHI] ; j++ )
+      getLoopDecompLimits( &decomp , item , blim );
+      for ( i = blim[XLO] ; i <= blim[XHI] ; i++ )
       {
-        //zeta = ( sqrt( BETA_EY(i,j,k+1) * GAMMA_EY(i,j,k+1) ) - 1.0 ) /
-        //       ( sqrt( BETA_EY(i,j,k+1) * GAMMA_EY(i,j,k+1) ) + 1.0 );
-        Eytemp = ALPHA_EY(i,j,k+1) * Ey[i][j][k+1] + BETA_EY(i,j,k+1)
-          * curl_Hy( Hx[i][j][k+1] , Hx[i][j][k] , Hz[i-1][j][k+1] , Hz[i][j][k+1] , i , j , k + 1 );
-        CHECK_NOT_VISITED( Ey[i][j][k] );         
-        Ey[i][j][k] = Ey[i][j][k+1] + zeta[ZLO] * ( Eytemp - Ey[i][j][k] );
-        MARK_AS_VISITED( Ey[i][j][k] );        
+        for ( j = blim[YLO] ; j <= blim[YHI] ; j++ )
+        {
+          //zeta = ( sqrt( BETA_EY(i,j,k+1) * GAMMA_EY(i,j,k+1) ) - 1.0 ) /
+          //       ( sqrt( BETA_EY(i,j,k+1) * GAMMA_EY(i,j,k+1) ) + 1.0 );
+          Eytemp = ALPHA_EY(i,j,k+1) * Ey[i][j][k+1] + BETA_EY(i,j,k+1)
+            * curl_Hy( Hx[i][j][k+1] , Hx[i][j][k] , Hz[i-1][j][k+1] , Hz[i][j][k+1] , i , j , k + 1 );
+          CHECK_NOT_VISITED( Ey[i][j][k] );         
+          Ey[i][j][k] = Ey[i][j][k+1] + zeta[ZLO] * ( Eytemp - Ey[i][j][k] );
+          MARK_AS_VISITED( Ey[i][j][k] );        
+        }
       }
     }
 
     k = fmlim[ZLO][EX][ZLO];
+    getLoopDecomp( fmlim[ZLO][EX] , &decomp );
     #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , j , Extemp )
+      #pragma omp parallel for private( i , j , Extemp , item , blim )
     #endif
-    for ( i = fmlim[ZLO][EX][XLO] ; i <= fmlim[ZLO][EX][XHI] ; i++ )
+    for ( item = 0 ; item < decomp.numItems ; item++ )
     {
-      for ( j = fmlim[ZLO][EX][YLO] ; j <= fmlim[ZLO][EX][YHI] ; j++ )
+      getLoopDecompLimits( &decomp , item , blim );
+      for ( i = blim[XLO] ; i <= blim[XHI] ; i++ )
       {
-        //zeta = ( sqrt( BETA_EX(i,j,k+1) * GAMMA_EX(i,j,k+1) ) - 1.0 ) /
-        //       ( sqrt( BETA_EX(i,j,k+1) * GAMMA_EX(i,j,k+1) ) + 1.0 );
-        Extemp = ALPHA_EX(i,j,k+1) * Ex[i][j][k+1] + BETA_EX(i,j,k+1)
-          * curl_Hx( Hz[i][j][k+1] , Hz[i][j-1][k+1] , Hy[i][j][k] , Hy[i][j][k+1] , i , j , k + 1 );
-        CHECK_NOT_VISITED( Ex[i][j][k] );  
-        Ex[i][j][k] = Ex[i][j][k+1] + zeta[ZLO] * ( Extemp - Ex[i][j][k] );
-        MARK_AS_VISITED( Ex[i][j][k] );          
+        for ( j = blim[YLO] ; j <= blim[YHI] ; j++ )
+        {
+          //zeta = ( sqrt( BETA_EX(i,j,k+1) * GAMMA_EX(i,j,k+1) ) - 1.0 ) /
+          //       ( sqrt( BETA_EX(i,j,k+1) * GAMMA_EX(i,j,k+1) ) + 1.0 );
+          Extemp = ALPHA_EX(i,j,k+1) * Ex[i][j][k+1] + BETA_EX(i,j,k+1)
+            * curl_Hx( Hz[i][j][k+1] , Hz[i][j-1][k+1] , Hy[i][j][k] , Hy[i][j][k+1] , i , j , k + 1 );
+          CHECK_NOT_VISITED( Ex[i][j][k] );  
+          Ex[i][j][k] = Ex[i][j][k+1] + zeta[ZLO] * ( Extemp - Ex[i][j][k] );
+          MARK_AS_VISITED( Ex[i][j][k] );          
+        }
       }
     }
 
   }
 
   /* Mur ABC at ZHI. */  
-  if( outerSurfaceType( ZHI ) == BT_MUR )
+  if( face == ZHI && outerSurfaceType( ZHI ) == BT_MUR )
   {
     
     k = fmlim[ZHI][EY][ZHI];
+    getLoopDecomp( fmlim[ZHI][EY] , &decomp );
     #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , j , Eytemp )
+      #pragma omp parallel for private( i , j , Eytemp , item , blim )
     #endif
-    for ( i = fmlim[ZHI][EY][XLO] ; i <= fmlim[ZHI][EY][XHI]; i++ )
+    for ( item = 0 ; item < decomp.numItems ; item++ )
     {
-      for ( j = fmlim[ZHI][EY][YLO] ; j <= fmlim[ZHI][EY][YHI] ; j++ )
+      getLoopDecompLimits( &decomp , item , blim );
+      for ( i = blim[XLO] ; i <= blim[XHI] ; i++ )
       {
-        //zeta = ( sqrt( BETA_EY(i,j,k-1) * GAMMA_EY(i,j,k-1) ) - 1.0 ) /
-        //       ( sqrt( BETA_EY(i,j,k-1) * GAMMA_EY(i,j,k-1) ) + 1.0 );
-        Eytemp = ALPHA_EY(i,j,k-1) * Ey[i][j][k-1] + BETA_EY(i,j,k-1)
-          * curl_Hy( Hx[i][j][k-1] , Hx[i][j][k-2] , Hz[i-1][j][k-1] , Hz[i][j][k-1] , i , j , k - 1 ); 
-        CHECK_NOT_VISITED( Ey[i][j][k] );          
-        Ey[i][j][k] = Ey[i][j][k-1] + zeta[ZHI] * ( Eytemp - Ey[i][j][k] );
-        MARK_AS_VISITED( Ey[i][j][k] );         
+        for ( j = blim[YLO] ; j <= blim[YHI] ; j++ )
+        {
+          //zeta = ( sqrt( BETA_EY(i,j,k-1) * GAMMA_EY(i,j,k-1) ) - 1.0 ) /
+          //       ( sqrt( BETA_EY(i,j,k-1) * GAMMA_EY(i,j,k-1) ) + 1.0 );
+          Eytemp = ALPHA_EY(i,j,k-1) * Ey[i][j][k-1] + BETA_EY(i,j,k-1)
+            * curl_Hy( Hx[i][j][k-1] , Hx[i][j][k-2] , Hz[i-1][j][k-1] , Hz[i][j][k-1] , i , j , k - 1 ); 
+          CHECK_NOT_VISITED( Ey[i][j][k] );          
+          Ey[i][j][k] = Ey[i][j][k-1] + zeta[ZHI] * ( Eytemp - Ey[i][j][k] );
+          MARK_AS_VISITED( Ey[i][j][k] );         
+        }
       }
     }
 
     k = fmlim[ZHI][EX][ZHI];
+    getLoopDecomp( fmlim[ZHI][EX] , &decomp );
     #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , j , Extemp )
+      #pragma omp parallel for private( i , j , Extemp , item , blim )
     #endif
-    for ( i = fmlim[ZHI][EX][XLO] ; i <= fmlim[ZHI][EX][XHI]; i++ )
+    for ( item = 0 ; item < decomp.numItems ; item++ )
     {
-      for ( j = fmlim[ZHI][EX][YLO] ; j <= fmlim[ZHI][EX][YHI] ; j++ )
+      getLoopDecompLimits( &decomp , item , blim );
+      for ( i = blim[XLO] ; i <= blim[XHI] ; i++ )
       {
-        //zeta = ( sqrt ( BETA_EX(i,j,k-1) * GAMMA_EX(i,j,k-1) ) - 1.0 ) /
-        //       ( sqrt ( BETA_EX(i,j,k-1) * GAMMA_EX(i,j,k-1) ) + 1.0 );
-        Extemp = ALPHA_EX(i,j,k-1) * Ex[i][j][k-1] + BETA_EX(i,j,k-1)
-          * curl_Hx( Hz[i][j][k-1] , Hz[i][j-1][k-1] , Hy[i][j][k-2] , Hy[i][j][k-1] , i , j , k - 1 );
-        CHECK_NOT_VISITED( Ex[i][j][k] ); 
-        Ex[i][j][k] = Ex[i][j][k-1] + zeta[ZHI] * ( Extemp - Ex[i][j][k] );
-        MARK_AS_VISITED( Ex[i][j][k] );
+        for ( j = blim[YLO] ; j <= blim[YHI] ; j++ )
+        {
+          //zeta = ( sqrt ( BETA_EX(i,j,k-1) * GAMMA_EX(i,j,k-1) ) - 1.0 ) /
+          //       ( sqrt ( BETA_EX(i,j,k-1) * GAMMA_EX(i,j,k-1) ) + 1.0 );
+          Extemp = ALPHA_EX(i,j,k-1) * Ex[i][j][k-1] + BETA_EX(i,j,k-1)
+            * curl_Hx( Hz[i][j][k-1] , Hz[i][j-1][k-1] , Hy[i][j][k-2] , Hy[i][j][k-1] , i , j , k - 1 );
+          CHECK_NOT_VISITED( Ex[i][j][k] ); 
+          Ex[i][j][k] = Ex[i][j][k-1] + zeta[ZHI] * ( Extemp - Ex[i][j][k] );
+          MARK_AS_VISITED( Ex[i][j][k] );
+        }
       }
     }
    
@@ -394,6 +617,123 @@ void updateMurEfield( void )
 
 }
 
+/* 
+ * Update electric field on one Higdon boundary. As for the Mur boundary the new fields on
+ * the planes inside the grid are found from the current magnetic field, ahead of the grid
+ * update.
+ */
+void updateHigdonEfieldFace( MeshFace face )
+{
+
+  CoordAxis axis = face / 2;
+  int dir = ( face % 2 == 0 ) ? 1 : -1;
+  int di = ( axis == XDIR ) ? dir : 0;
+  int dj = ( axis == YDIR ) ? dir : 0;
+  int dk = ( axis == ZDIR ) ? dir : 0;
+  int order = higdonOrder[face];
+  int numLevels = order - 1;
+  int level[MAX_HIGDON_ORDER+1];
+  int current = 0;
+  int item;
+  int blim[6];
+  LoopDecomp decomp;
+
+  /* Storage of E^{n+1-t}, with the current fields E^n overwriting the oldest level. */
+  for( int t = 2 ; t <= order ; t++ )
+    level[t] = ( higdonStep[face] + numLevels + 1 - t ) % numLevels;
+  if( numLevels > 0 )
+    current = higdonStep[face] % numLevels;
+
+  for( int component = 0 ; component <= 1 ; component++ )
+  {
+    FieldComponent field = higdonField[axis][component];
+    real ***E = ( field == EX ) ? Ex : ( ( field == EY ) ? Ey : Ez );
+    real ****past = higdonPast[face][component];
+    int *flim = fmlim[face][field];
+
+    getLoopDecomp( flim , &decomp );
+    #ifdef WITH_OPENMP
+      #pragma omp parallel for private( item , blim )
+    #endif
+    for ( item = 0 ; item < decomp.numItems ; item++ )
+    {
+      getLoopDecompLimits( &decomp , item , blim );
+      for ( int i = blim[XLO] ; i <= blim[XHI] ; i++ )
+      {
+        for ( int j = blim[YLO] ; j <= blim[YHI] ; j++ )
+        {
+          for ( int k = blim[ZLO] ; k <= blim[ZHI] ; k++ )
+          {
+            int a = ( axis == XDIR ) ? j - flim[YLO] : i - flim[XLO];
+            int b = ( axis == ZDIR ) ? j - flim[YLO] : k - flim[ZLO];
+            real sum = 0.0;
+            real value;
+
+            for( int s = 0 ; s <= order ; s++ )
+            {
+              int is = i + s * di;
+              int js = j + s * dj;
+              int ks = k + s * dk;
+              if( s > 0 )
+              {
+                switch( field )
+                {
+                case EX: value = predictEx( is , js , ks ); break;
+                case EY: value = predictEy( is , js , ks ); break;
+                default: value = predictEz( is , js , ks ); break;
+                }
+                sum += higdonCoeff[face][s][0] * value;
+              }
+              value = E[is][js][ks];
+              sum += higdonCoeff[face][s][1] * value;
+              for( int t = 2 ; t <= order ; t++ )
+                sum += higdonCoeff[face][s][t] * past[level[t]][s][a][b];
+              if( numLevels > 0 )
+                past[current][s][a][b] = value;
+            }
+
+            CHECK_NOT_VISITED( E[i][j][k] );
+            E[i][j][k] = -sum;
+            MARK_AS_VISITED( E[i][j][k] );
+          }
+        }
+      }
+    }
+  }
+
+  higdonStep[face]++;
+
+  return;
+
+}
+
+/* New Ex at (i,j,k) from the current fields, as found by the grid update. */
+static inline real predictEx( int i , int j , int k )
+{
+
+  return ALPHA_EX(i,j,k) * Ex[i][j][k] + BETA_EX(i,j,k) 
+    * curl_Hx( Hz[i][j][k] , Hz[i][j-1][k] , Hy[i][j][k-1] , Hy[i][j][k] , i , j , k );
+
+}
+
+/* New Ey at (i,j,k) from the current fields, as found by the grid update. */
+static inline real predictEy( int i , int j , int k )
+{
+
+  return ALPHA_EY(i,j,k) * Ey[i][j][k] + BETA_EY(i,j,k) 
+    * curl_Hy( Hx[i][j][k] , Hx[i][j][k-1] , Hz[i-1][j][k] , Hz[i][j][k] , i , j , k );
+
+}
+
+/* New Ez at (i,j,k) from the current fields, as found by the grid update. */
+static inline real predictEz( int i , int j , int k )
+{
+
+  return ALPHA_EZ(i,j,k) * Ez[i][j][k] + BETA_EZ(i,j,k) 
+    * curl_Hz( Hy[i][j][k] , Hy[i-1][j][k] , Hx[i][j-1][k] , Hx[i][j][k] , i , j , k );
+
+}
+
 /* Update magnetic field on Mur boundaries. */
 /* These are only necessary to make the normal fields have correct values. */
 /* They can be omitted without affecting the behaviour of the boundary as */
@@ -407,7 +747,7 @@ void updateMurHfield( void )
   real **Ez_i1 , **Ey_i1 , *Ez_ij1 , *Ez_i1j , *Ex_ij1 , *Ey_i1j;
 
   /* Mur ABC at XLO. */  
-  if( outerSurfaceType( XLO ) == BT_MUR )
+  if( isMurFace( XLO ) )
   {
     i = fmlim[XLO][HX][XLO];
     Hx_i = Hx[i];
@@ -430,7 +770,7 @@ void updateMurHfield( void )
   } // if
 
   /* Mur ABC at XHI. */  
-  if( outerSurfaceType( XHI ) == BT_MUR )
+  if( isMurFace( XHI ) )
   {
     i = fmlim[XHI][HX][XLO];
     Hx_i = Hx[i];
@@ -453,7 +793,7 @@ void updateMurHfield( void )
   } // if
 
   /* Mur ABC at YLO. */  
-  if( outerSurfaceType( YLO ) == BT_MUR )
+  if( isMurFace( YLO ) )
   {
     for ( i = fmlim[YLO][HY][XLO] ; i <= fmlim[YLO][HY][XHI] ; i++ ) 
     {
@@ -477,7 +817,7 @@ void updateMurHfield( void )
   } // if
   
   /* Mur ABC at YHI. */  
-  if( outerSurfaceType( YHI ) == BT_MUR )
+  if( isMurFace( YHI ) )
   {
     for ( i = fmlim[YHI][HY][XLO] ; i <= fmlim[YHI][HY][XHI] ; i++ ) 
     {
@@ -501,7 +841,7 @@ void updateMurHfield( void )
   } // if
 
   /* Mur ABC at ZLO. */  
-  if( outerSurfaceType( ZLO ) == BT_MUR )
+  if( isMurFace( ZLO ) )
   {
     for ( i = fmlim[ZLO][HZ][XLO] ; i <= fmlim[ZLO][HZ][XHI] ; i++ ) 
     {
@@ -526,7 +866,7 @@ void updateMurHfield( void )
   } // if
 
   /* Mur ABC at ZHI. */  
-  if( outerSurfaceType( ZHI ) == BT_MUR )
+  if( isMurFace( ZHI ) )
   {
     for ( i = fmlim[ZHI][HZ][XLO] ; i <= fmlim[ZHI][HZ][XHI] ; i++ ) 
     {
@@ -564,12 +904,49 @@ void deallocMurArrays( void )
 
   for( region = XLO ; region <= ZHI ; region++ )
   {
-    if( outerSurfaceType( region ) == BT_MUR )
+    if( outerSurfaceType( region ) == BT_HIGDON )
     {
-      ;  
+      for( int component = 0 ; component <= 1 ; component++ )
+        if( higdonPast[region][component] != NULL )
+        {
+          deallocArray( higdonPast[region][component] , 4 , higdonOrder[region] - 1 , higdonOrder[region] + 1 , 
+                        higdonPastSize[region][component][0] , higdonPastSize[region][component][1] );
+          higdonPast[region][component] = NULL;
+        }
     }
   }
 
   return;
 
 }
+
+/* Determine if an external face is terminated by either the Mur or Higdon boundary. */
+bool isMurFace( MeshFace face )
+{
+
+  return outerSurfaceType( face ) == BT_MUR || outerSurfaceType( face ) == BT_HIGDON;
+
+}
+
+/* Set the default angles of a Higdon boundary for any not given, which are negative. */
+void setHigdonDefaults( int order , real angles[MAX_HIGDON_ORDER] )
+{
+
+  for( int angle = 0 ; angle < order ; angle++ )
+    if( angles[angle] < 0.0 )
+      angles[angle] = higdonDefaultAngles[order-1][angle];
+
+  return;
+
+}
+
+/* Number of planes inside a face read by its boundary update. */
+int getMurFaceDepth( MeshFace face )
+{
+
+  if( outerSurfaceType( face ) == BT_HIGDON )
+    return higdonOrder[face];
+  else
+    return 1;
+
+}
@@ -26,6 +26,7 @@
 #define _MUR_H_
 
 #include "fdtd_types.h"
+#include "boundary.h"
 
 /*
  * Public method interfaces.
@@ -33,7 +34,11 @@
 
 void initMurBoundaries( void );
 void updateMurEfield( void );
+void updateMurEfieldFace( MeshFace face );
 void updateMurHfield( void );
 void deallocMurArrays( void );
+bool isMurFace( MeshFace face );
+void setHigdonDefaults( int order , real angles[MAX_HIGDON_ORDER] );
+int getMurFaceDepth( MeshFace face );
 
 #endif
@@ -39,6 +39,7 @@
 #include "waveform.h"
 #include "mesh.h"
 #include "memory.h"
+#include "domain.h"
   
 /* 
  * Observer class. 
@@ -71,6 +72,8 @@ typedef struct ObserverItem_t {
   real **dft_real;                        // Real part of running DFT - 1D.
   real **dft_imag;                        // Imaginary part of running DFT - 1D.
   struct ObserverItem_t *waveformObserver;// Pointer to reference waveform for DFT types.
+  bool isLocal;                           // Observer is updated on this domain.
+  bool isWriter;                          // Observer output is written by this domain.
   //real *****var_real;                   // Cache/DFT array. var_real[ii][jj][kk][comp][t/f][ii][jj][kk]
   //real *****var_imag;                   // Cache/DFT array. var_imag[ii][jj][kk][comp][1/f][ii][jj][kk]
   //struct ObserverItem_t *subObs;        // Array of sub-observers.
@@ -394,6 +397,20 @@ bool parseOF( char *line )
 
 }
 
+/* Get the output frequency band of the OF card, false if no card was given. */
+bool getOutputFrequencyBand( real *lowFreq , real *highFreq )
+{
+
+  if( !isOF )
+    return false;
+
+  *lowFreq = startFreq;
+  *highFreq = stopFreq;
+
+  return true;
+
+}
+
 /* Initialise observers. */
 /* Depends: initGrid, initSimulation, initWaveforms */
 void initObservers( void )
@@ -472,16 +489,32 @@ void initObservers( void )
     /* Number of components. */
     item->numComp = observerCompMap[item->quantity];
 
+    /* Waveform and binary observers are evaluated on every domain and written by the root domain. */
+    /* Point field observers are evaluated and written by the domain that owns the point. */
+    if( item->quantity == OQ_WF || item->format == OF_BINARY )
+    {
+      item->isLocal = true;
+      item->isWriter = isRootDomain();
+    }
+    else
+    {
+      item->isLocal = isInDomain( item->gbbox[XLO] , item->gbbox[YLO] , item->gbbox[ZLO] );
+      item->isWriter = item->isLocal;
+    }
+
     if( item->format == OF_ASCII )   
     {
       if( item->domain == OD_TIME )
       {
-        initObserverAsciiTime( item );
+        if( item->isWriter )
+          initObserverAsciiTime( item );
       }
       else if( item->domain == OD_FREQ )
       {
-        initObserverAsciiFreq( item );
-        initObserverDft( item );
+        if( item->isWriter )
+          initObserverAsciiFreq( item );
+        if( item->isLocal )
+          initObserverDft( item );
       }      
       else
       {
@@ -626,12 +659,14 @@ void updateObservers( unsigned long tstepNum , real t )
   bool isOTValid = tstepNum >= startTimeStep && tstepNum <= stopTimeStep;
   
   /* Processing compatible output format for first waveform. */
-  if( thereAreObserversFormat( OF_BINARY ) )
+  if( thereAreObserversFormat( OF_BINARY ) && isRootDomain() )
     updateExciteDat( getWaveformValue( t , 0 , 0.0 ) );
 
   DL_FOREACH( observerList , item ) 
   {
-    if( item->quantity == OQ_WF && item->domain == OD_TIME )
+    if( !item->isLocal || ( item->domain == OD_TIME && item->format == OF_ASCII && !item->isWriter ) )
+      /* No-op. Observer is output by another domain. */;
+    else if( item->quantity == OQ_WF && item->domain == OD_TIME )
       updateObserverAsciiTime( item , tstepNum , t );
     else if( item->quantity == OQ_WF && item->domain == OD_FREQ )
       updateObserverAsciiFreq( item , tstepNum , t );     
@@ -649,6 +684,25 @@ void updateObservers( unsigned long tstepNum , real t )
 
 }
 
+/* Return true if any observer needs the fields at the given time step. */
+/* Waveform observers do not depend on the fields. */
+bool observersNeedFields( unsigned long tstepNum )
+{
+
+  ObserverItem *item;
+  bool isOTValid = tstepNum >= startTimeStep && tstepNum <= stopTimeStep;
+
+  if( !isOTValid )
+    return false;
+
+  DL_FOREACH( observerList , item ) 
+    if( item->quantity != OQ_WF )
+      return true;
+
+  return false;
+
+}
+
 /* Deallocate observers. */
 void deallocObservers( void )
 {
@@ -662,7 +716,7 @@ void deallocObservers( void )
   /* reference waveform DFT observer being deallocated. */
   DL_FOREACH( observerList , item ) 
   {
-    if( item->format == OF_ASCII && item->domain == OD_FREQ )
+    if( item->format == OF_ASCII && item->domain == OD_FREQ && item->isWriter )
       flushObserverDft( item );
   }
     
@@ -674,10 +728,12 @@ void deallocObservers( void )
     {
       if( item->domain == OD_FREQ )
       {
-        deallocObserverAsciiFreq( item );  
-        deallocObserverDft( item );
+        if( item->isWriter )
+          deallocObserverAsciiFreq( item );  
+        if( item->isLocal )
+          deallocObserverDft( item );
       }
-      else
+      else if( item->isWriter )
       {
         deallocObserverAsciiTime( item );  
       }
@@ -1027,10 +1083,38 @@ static FILE *impulseDatFile = NULL;
 /* excite.dat file pointer. */
 static FILE *exciteFile = NULL;
 
+/* Number of values gathered by the largest binary observer. */
+static int impulseBufferSize = 0;
+
+/* Buffer used to gather binary observer fields from all domains onto the root domain. */
+static float *impulseBuffer = NULL;
+
 /* Initialise binary observers. */
 void initBinaryObservers( real dt )
 {
 
+  ObserverItem *item;
+  unsigned long bytes;
+  int nx , ny , nz;
+
+  /* Size gather buffer for the largest observer. */
+  DL_FOREACH( observerList , item ) 
+  {
+    if( item->format == OF_BINARY )
+    {
+      getNumberOfOutputNodes( &nx , &ny , &nz , item->gbbox , item->step );
+      if( 6 * nx * ny * nz > impulseBufferSize )
+        impulseBufferSize = 6 * nx * ny * nz;
+    }
+  }
+
+  impulseBuffer = allocArray( &bytes , sizeof( float ) , 1 , impulseBufferSize );
+  memory.observers += bytes;
+
+  /* Only the root domain writes the output files. */
+  if( !isRootDomain() )
+    return;
+
   /* Initialise impulse.dat file. */
   initImpulseDat( dt );
     
@@ -1168,17 +1252,50 @@ void updateImpulseDat( ObserverItem *item )
   int i, j, k;
   float outEx , outEy , outEz , outHx , outHy , outHz;
   int iout , jout , kout;
+  float *value;
+  int count = 0;
 
+  /* Gather the fields at the points owned by this domain, zero elsewhere. */
+  value = impulseBuffer;
+  for( k = item->gbbox[ZLO]; k <= item->gbbox[ZHI] ; k += item->step[ZDIR] )
+    for( j = item->gbbox[YLO] ; j <= item->gbbox[YHI] ; j += item->step[YDIR] )
+      for( i = item->gbbox[XLO] ; i <= item->gbbox[XHI] ; i += item->step[XDIR] )
+      {
+        if( isInDomain( i , j , k ) )
+        {
+          value[0] = UNSCALE_Ex( Ex[i][j][k] , i );
+          value[1] = UNSCALE_Ey( Ey[i][j][k] , j );
+          value[2] = UNSCALE_Ez( Ez[i][j][k] , k );
+          value[3] = UNSCALE_Hx( Hx[i][j][k] , i );
+          value[4] = UNSCALE_Hy( Hy[i][j][k] , j );
+          value[5] = UNSCALE_Hz( Hz[i][j][k] , k );
+        }
+        else
+        {
+          for( int comp = 0 ; comp < 6 ; comp++ )
+            value[comp] = 0.0;
+        }
+        value += 6;
+        count += 6;
+      }
+
+  reduceToRootDomain( impulseBuffer , count );
+
+  if( !isRootDomain() )
+    return;
+
+  value = impulseBuffer;
   for( k = item->gbbox[ZLO]; k <= item->gbbox[ZHI] ; k += item->step[ZDIR] )
     for( j = item->gbbox[YLO] ; j <= item->gbbox[YHI] ; j += item->step[YDIR] )
       for( i = item->gbbox[XLO] ; i <= item->gbbox[XHI] ; i += item->step[XDIR] )
         {
-          outEx = UNSCALE_Ex( Ex[i][j][k] , i );
-          outEy = UNSCALE_Ey( Ey[i][j][k] , j );
-          outEz = UNSCALE_Ez( Ez[i][j][k] , k );
-          outHx = UNSCALE_Hx( Hx[i][j][k] , i );
-          outHy = UNSCALE_Hy( Hy[i][j][k] , j );
-          outHz = UNSCALE_Hz( Hz[i][j][k] , k );
+          outEx = value[0];
+          outEy = value[1];
+          outEz = value[2];
+          outHx = value[3];
+          outHy = value[4];
+          outHz = value[5];
+          value += 6;
           iout = i - gibox[XLO];
           jout = j - gibox[YLO];
           kout = k - gibox[ZLO];
@@ -1201,6 +1318,11 @@ void updateImpulseDat( ObserverItem *item )
 void deallocBinaryObservers( void )
 {
 
+  deallocArray( impulseBuffer , 1 , impulseBufferSize );
+
+  if( !isRootDomain() )
+    return;
+
   /* Close processing tools excitation file. */
   fclose( exciteFile );
  
@@ -96,6 +96,7 @@ bool parseOP( char *line );
 bool parseFF( char *line );
 bool parseOT( char *line );
 bool parseOF( char *line );
+bool getOutputFrequencyBand( real *lowFreq , real *highFreq );
 void initObservers( void );
 void deallocObservers( void );
 void updateObservers( unsigned long tstepNum , real t );
@@ -106,5 +107,6 @@ void gmshObservers( void );
 bool thereAreObservers( void );
 bool thereAreObserversDomain( ObserverDomain domain );
 bool thereAreObserversFormat( ObserverFormat format );
+bool observersNeedFields( unsigned long tstepNum );
 
 #endif
@@ -0,0 +1,403 @@
+/* 
+ * This file is part of Vulture.
+ *
+ * Vulture finite-difference time-domain electromagnetic solver.
+ * Copyright (C) 2011-2016 Ian David Flintoft
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ *
+ * Author: Ian Flintoft <ian.flintoft@googlemail.com>
+ *
+ */
+
+/* For syscall. */
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef WITH_OPENMP
+  #include <omp.h>
+#endif
+
+#ifdef __linux__
+  #include <unistd.h>
+  #include <sys/syscall.h>
+  #include <linux/perf_event.h>
+  #define HAVE_PERF_EVENTS
+#endif
+
+#include "perfcounter.h"
+#include "fdtd_types.h"
+#include "alloc_array.h"
+#include "message.h"
+#include "balance.h"
+
+/* 
+ * Private data.
+ */
+
+/* Number of per-thread counters - the DRAM counters are system wide. */
+#define NUM_THREAD_COUNTERS HC_DRAM_BYTES
+
+/* Maximum number of memory controllers. */
+#define MAX_IMC 32
+
+/* Bytes transferred by a memory controller column access. */
+#define CAS_BYTES 64
+
+/* Elements in each array of the peak bandwidth triad. */
+#define TRIAD_SIZE ( 8 * 1024 * 1024 )
+
+/* Number of repeats of the peak bandwidth triad. */
+#define TRIAD_REPEATS 5
+
+/* Counter names. */
+static char HW_COUNTER_STR[NUM_HW_COUNTERS][TAG_SIZE] = { "CYCLES" , "INSTRUCTIONS" , "LLC_MISSES" , "DRAM_BYTES" };
+
+/* Counters requested. */
+static bool isCountersOn = false;
+
+/* Number of threads with counters. */
+static int numThreads = 1;
+
+/* Counter file descriptors of each thread. */
+static int **threadFd = NULL;
+
+/* Memory controller column read and write counter file descriptors. */
+static int imcFd[2*MAX_IMC];
+static int numImcFd = 0;
+
+/* Counters opened on all threads. */
+static bool isAvailable[NUM_HW_COUNTERS] = { false };
+
+/* Measured peak memory bandwidth in bytes/s. */
+static double peakBandwidth = 0.0;
+
+/* 
+ * Private method interfaces. 
+ */
+
+#ifdef HAVE_PERF_EVENTS
+int openPerfEvent( uint32_t type , uint64_t config , int pid , int cpu );
+uint64_t readPerfEvent( int fd );
+void openImcCounters( void );
+bool readSysfsLine( char *fileName , char *line , int size );
+#endif
+void measurePeakBandwidth( void );
+
+/*
+ * Method Implementations.
+ */
+
+/* Enable or disable hardware performance counters. */
+void setHardwareCounters( bool flag )
+{
+
+  isCountersOn = flag;
+
+  return;
+
+}
+
+/* Hardware performance counters requested. */
+bool isHardwareCountersOn( void )
+{
+
+  return isCountersOn;
+
+}
+
+/* 
+ * Open the counters on each thread and measure the peak memory bandwidth. Counters 
+ * that cannot be opened on every thread, for example without a hardware PMU or 
+ * with too restrictive a perf_event_paranoid setting, are reported as unavailable.
+ * Depends: number of threads set.
+ */
+void initHardwareCounters( void )
+{
+
+  unsigned long bytes;
+#ifdef HAVE_PERF_EVENTS
+  uint64_t config[NUM_THREAD_COUNTERS] = { PERF_COUNT_HW_CPU_CYCLES , PERF_COUNT_HW_INSTRUCTIONS , PERF_COUNT_HW_CACHE_MISSES };
+#endif
+
+  if( !isCountersOn )
+    return;
+
+  message( MSG_LOG , 0 , "\nInitialising hardware performance counters...\n\n" );
+
+#ifdef WITH_OPENMP
+  numThreads = omp_get_max_threads();
+#endif
+
+  threadFd = allocArray( &bytes , sizeof( int ) , 2 , numThreads , NUM_THREAD_COUNTERS );
+  for( int thread = 0 ; thread < numThreads ; thread++ )
+    for( int counter = 0 ; counter < NUM_THREAD_COUNTERS ; counter++ )
+      threadFd[thread][counter] = -1;
+
+#ifdef HAVE_PERF_EVENTS
+
+  /* Each thread opens its own counters so they follow it. */
+  #ifdef WITH_OPENMP
+    #pragma omp parallel
+  #endif
+  {
+    int thread = 0;
+  #ifdef WITH_OPENMP
+    thread = omp_get_thread_num();
+  #endif
+    for( int counter = 0 ; counter < NUM_THREAD_COUNTERS ; counter++ )
+      threadFd[thread][counter] = openPerfEvent( PERF_TYPE_HARDWARE , config[counter] , 0 , -1 );
+  }
+
+  for( int counter = 0 ; counter < NUM_THREAD_COUNTERS ; counter++ )
+  {
+    isAvailable[counter] = true;
+    for( int thread = 0 ; thread < numThreads ; thread++ )
+      if( threadFd[thread][counter] < 0 )
+        isAvailable[counter] = false;
+  }
+
+  openImcCounters();
+  isAvailable[HC_DRAM_BYTES] = ( numImcFd > 0 );
+
+#endif
+
+  for( HardwareCounter counter = 0 ; counter < NUM_HW_COUNTERS ; counter++ )
+    message( MSG_LOG , 0 , "  %-12s: %s\n" , HW_COUNTER_STR[counter] , isAvailable[counter] ? "available" : "not available" );
+
+  measurePeakBandwidth();
+
+  return;
+
+}
+
+#ifdef HAVE_PERF_EVENTS
+
+/* Open a counting perf event for user space, returning -1 on failure. */
+int openPerfEvent( uint32_t type , uint64_t config , int pid , int cpu )
+{
+
+  struct perf_event_attr attr;
+
+  memset( &attr , 0 , sizeof( attr ) );
+  attr.size = sizeof( attr );
+  attr.type = type;
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  if( type == PERF_TYPE_HARDWARE )
+  {
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+  }
+
+  return (int) syscall( __NR_perf_event_open , &attr , pid , cpu , -1 , 0 );
+
+}
+
+/* Read a perf event, scaling for the time it was not scheduled on the PMU. */
+uint64_t readPerfEvent( int fd )
+{
+
+  uint64_t value[3];
+
+  if( read( fd , value , sizeof( value ) ) != sizeof( value ) || value[2] == 0 )
+    return 0;
+
+  if( value[2] < value[1] )
+    return (uint64_t)( (double) value[0] * (double) value[1] / (double) value[2] );
+  else
+    return value[0];
+
+}
+
+/* 
+ * Open the column read and write counters of the integrated memory controllers 
+ * exposed by the uncore PMUs. These count all traffic to the memory, not just 
+ * that of the solver, and usually need perf_event_paranoid of 0 or less.
+ */
+void openImcCounters( void )
+{
+
+  char fileName[PATH_SIZE];
+  char line[PATH_SIZE];
+  char *eventName[2] = { "cas_count_read" , "cas_count_write" };
+  unsigned int type , event , umask;
+  int cpu;
+  int fd;
+
+  for( int imc = 0 ; imc < MAX_IMC ; imc++ )
+  {
+    snprintf( fileName , PATH_SIZE , "/sys/bus/event_source/devices/uncore_imc_%d/type" , imc );
+    if( !readSysfsLine( fileName , line , PATH_SIZE ) || sscanf( line , "%u" , &type ) != 1 )
+      break;
+
+    snprintf( fileName , PATH_SIZE , "/sys/bus/event_source/devices/uncore_imc_%d/cpumask" , imc );
+    if( !readSysfsLine( fileName , line , PATH_SIZE ) || sscanf( line , "%d" , &cpu ) != 1 )
+      cpu = 0;
+
+    for( int direction = 0 ; direction < 2 ; direction++ )
+    {
+      snprintf( fileName , PATH_SIZE , "/sys/bus/event_source/devices/uncore_imc_%d/events/%s" , imc , eventName[direction] );
+      if( !readSysfsLine( fileName , line , PATH_SIZE ) || sscanf( line , "event=%x,umask=%x" , &event , &umask ) != 2 )
+        continue;
+      fd = openPerfEvent( type , event | ( umask << 8 ) , -1 , cpu );
+      if( fd >= 0 )
+        imcFd[numImcFd++] = fd;
+    }
+  }
+
+  return;
+
+}
+
+/* Read the first line of a sysfs file. */
+bool readSysfsLine( char *fileName , char *line , int size )
+{
+
+  FILE *fp;
+  bool isRead;
+
+  fp = fopen( fileName , "r" );
+  if( !fp )
+    return false;
+
+  isRead = ( fgets( line , size , fp ) != NULL );
+  fclose( fp );
+
+  return isRead;
+
+}
+
+#endif
+
+/* Determine if a counter is available. */
+bool isHardwareCounterAvailable( HardwareCounter counter )
+{
+
+  return isAvailable[counter];
+
+}
+
+/* Read the counters, summed over the threads. Unavailable counters are zero. */
+void readHardwareCounters( uint64_t counts[NUM_HW_COUNTERS] )
+{
+
+  for( HardwareCounter counter = 0 ; counter < NUM_HW_COUNTERS ; counter++ )
+    counts[counter] = 0;
+
+#ifdef HAVE_PERF_EVENTS
+
+  for( int counter = 0 ; counter < NUM_THREAD_COUNTERS ; counter++ )
+    if( isAvailable[counter] )
+      for( int thread = 0 ; thread < numThreads ; thread++ )
+        counts[counter] += readPerfEvent( threadFd[thread][counter] );
+
+  for( int imc = 0 ; imc < numImcFd ; imc++ )
+    counts[HC_DRAM_BYTES] += CAS_BYTES * readPerfEvent( imcFd[imc] );
+
+#endif
+
+  return;
+
+}
+
+/* 
+ * Measure the peak memory bandwidth using a triad on arrays much larger than
+ * the caches, counting the bytes read and written by the loop.
+ */
+void measurePeakBandwidth( void )
+{
+
+  unsigned long bytes;
+  real *a , *b , *c;
+  double start;
+  double time;
+  double bestTime = -1.0;
+
+  a = allocArray( &bytes , sizeof( real ) , 1 , TRIAD_SIZE );
+  b = allocArray( &bytes , sizeof( real ) , 1 , TRIAD_SIZE );
+  c = allocArray( &bytes , sizeof( real ) , 1 , TRIAD_SIZE );
+
+  #ifdef WITH_OPENMP
+    #pragma omp parallel for
+  #endif
+  for( int i = 0 ; i < TRIAD_SIZE ; i++ )
+  {
+    a[i] = 0.0;
+    b[i] = 1.0;
+    c[i] = 2.0;
+  }
+
+  for( int repeat = 0 ; repeat < TRIAD_REPEATS ; repeat++ )
+  {
+    start = getWorkTime();
+    #ifdef WITH_OPENMP
+      #pragma omp parallel for
+    #endif
+    for( int i = 0 ; i < TRIAD_SIZE ; i++ )
+      a[i] = b[i] + 0.5 * c[i];
+    time = getWorkTime() - start;
+    if( bestTime < 0.0 || time < bestTime )
+      bestTime = time;
+  }
+
+  if( bestTime > 0.0 )
+    peakBandwidth = 3.0 * TRIAD_SIZE * sizeof( real ) / bestTime;
+
+  message( MSG_LOG , 0 , "  Peak memory bandwidth (triad): %.2f GB/s\n" , 1e-9 * peakBandwidth );
+
+  deallocArray( a , 1 , TRIAD_SIZE );
+  deallocArray( b , 1 , TRIAD_SIZE );
+  deallocArray( c , 1 , TRIAD_SIZE );
+
+  return;
+
+}
+
+/* Get the measured peak memory bandwidth in bytes/s. */
+double getPeakBandwidth( void )
+{
+
+  return peakBandwidth;
+
+}
+
+/* Close the counters. */
+void deallocHardwareCounters( void )
+{
+
+#ifdef HAVE_PERF_EVENTS
+  if( threadFd != NULL )
+    for( int thread = 0 ; thread < numThreads ; thread++ )
+      for( int counter = 0 ; counter < NUM_THREAD_COUNTERS ; counter++ )
+        if( threadFd[thread][counter] >= 0 )
+          close( threadFd[thread][counter] );
+
+  for( int imc = 0 ; imc < numImcFd ; imc++ )
+    close( imcFd[imc] );
+#endif
+
+  if( threadFd != NULL )
+    deallocArray( threadFd , 2 , numThreads , NUM_THREAD_COUNTERS );
+
+  threadFd = NULL;
+  numImcFd = 0;
+
+  return;
+
+}
@@ -0,0 +1,54 @@
+/* 
+ * This file is part of Vulture.
+ *
+ * Vulture finite-difference time-domain electromagnetic solver.
+ * Copyright (C) 2011-2016 Ian David Flintoft
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ *
+ * Author: Ian Flintoft <ian.flintoft@googlemail.com>
+ *
+ */
+
+#ifndef _PERFCOUNTER_H_
+#define _PERFCOUNTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Hardware performance counters. */
+typedef enum {
+
+  HC_CYCLES,
+  HC_INSTRUCTIONS,
+  HC_LLC_MISSES,
+  HC_DRAM_BYTES,
+  NUM_HW_COUNTERS
+
+} HardwareCounter;
+
+/*
+ * Public method interfaces.
+ */
+
+void setHardwareCounters( bool flag );
+bool isHardwareCountersOn( void );
+void initHardwareCounters( void );
+bool isHardwareCounterAvailable( HardwareCounter counter );
+void readHardwareCounters( uint64_t counts[NUM_HW_COUNTERS] );
+double getPeakBandwidth( void );
+void deallocHardwareCounters( void );
+
+#endif
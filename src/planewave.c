@@ -25,6 +25,7 @@
 #include <assert.h>
 #include <math.h>
 #include <string.h>
+#include <stdlib.h>
 
 #include "planewave.h"
 #include "utlist.h"
@@ -39,6 +40,8 @@
 #include "surface.h"
 #include "physical.h"
 #include "util.h"
+#include "domain.h"
+#include "memory.h"
 
 /* 
  * Plane wave class. 
@@ -68,6 +71,13 @@ typedef struct PlaneWaveItem_t {
   real r0[3];                     // Origin of planewave in physical units.
   real phaseVelocity;             // Free-space numerical phase velocity on grid.
 
+  /* Analytic incident field tables for each face and incident field component. */
+  int tlim[6][6][6];              // Limits of the incident field points.
+  int ***delayIndex[6][6];        // Index of the delay of each incident field point.
+  int numDelays[6][6];            // Number of distinct delays.
+  real *delays[6][6];             // Distinct delays [s].
+  real *incValues[6][6];          // Incident field at the distinct delays at the current time.
+
   /* Auxiliary grid parameters. */
   int nx;                         // Length of grid.
   real *Eyi;                      // Field arrays.
@@ -115,7 +125,7 @@ static int m0 = 2;
 static int npml = 10;
 
 /* Function pointer for indicent field function. */
-static real (*incidentField)( FieldComponent field , int i , int j , int k , real time , PlaneWaveItem *item ) = NULL;
+static real (*incidentField)( MeshFace face , FieldComponent field , int i , int j , int k , real time , PlaneWaveItem *item ) = NULL;
 
 /* 
  * Private method interfaces. 
@@ -124,8 +134,13 @@ static real (*incidentField)( FieldComponent field , int i , int j , int k , rea
 void addPlaneWave( int mbbox[6] , char name[TAG_SIZE] , bool isActive[6] , real theta , real phi , real eta , 
                    real size , real delay , WaveformIndex waveformNumber );
 bool decodeFaceMask( bool isActive[6] , char maskStr[] );
-real incidentFieldAnalytic( FieldComponent field , int i , int j , int k , real time , PlaneWaveItem *item );
-real incidentFieldAuxGrid( FieldComponent field , int i , int j , int k , real time , PlaneWaveItem *item );
+real incidentFieldAnalytic( MeshFace face , FieldComponent field , int i , int j , int k , real time , PlaneWaveItem *item );
+real incidentFieldAuxGrid( MeshFace face , FieldComponent field , int i , int j , int k , real time , PlaneWaveItem *item );
+real getIncidentDelay( FieldComponent field , int i , int j , int k , PlaneWaveItem *item );
+void initIncidentTables( PlaneWaveItem *item );
+void updateIncidentTables( PlaneWaveItem *item , real time , FieldComponent firstField );
+void deallocIncidentTables( PlaneWaveItem *item );
+int compareReals( const void *a , const void *b );
 void updateAuxGridHfield( PlaneWaveItem *item , real time );
 void updateAuxGridEfield( PlaneWaveItem *item , real time);
 void deallocAuxGrid( PlaneWaveItem *item );
@@ -374,6 +389,7 @@ void initPlaneWaves( void )
                                                    edgeIsActive[YLO] , edgeIsActive[YHI] , 
                                                    edgeIsActive[ZLO] , edgeIsActive[ZHI] );
     setFieldLimits( bbox , item->flim[XLO] , includeBoundary );
+    clipFieldLimitsToDomain( item->flim[XLO] );
 
     /* XHI. */
     setBoundingBoxFromNodes( bbox , item->gbbox[XHI] , item->gbbox[XHI] + 1 , 
@@ -383,6 +399,7 @@ void initPlaneWaves( void )
                                                    edgeIsActive[YLO] , edgeIsActive[YHI] , 
                                                    edgeIsActive[ZLO] , edgeIsActive[ZHI] );
     setFieldLimits( bbox , item->flim[XHI] , includeBoundary );
+    clipFieldLimitsToDomain( item->flim[XHI] );
     
      /* YLO. */
     setBoundingBoxFromNodes( bbox , item->gbbox[XLO]     , item->gbbox[XHI] , 
@@ -392,6 +409,7 @@ void initPlaneWaves( void )
                                                    false             , true              , 
                                                    edgeIsActive[ZLO] , edgeIsActive[ZHI] );
     setFieldLimits( bbox , item->flim[YLO] , includeBoundary );
+    clipFieldLimitsToDomain( item->flim[YLO] );
  
     /* YHI. */
     setBoundingBoxFromNodes( bbox , item->gbbox[XLO] , item->gbbox[XHI]     , 
@@ -401,6 +419,7 @@ void initPlaneWaves( void )
                                                    true              , false             , 
                                                    edgeIsActive[ZLO] , edgeIsActive[ZHI] );
     setFieldLimits( bbox , item->flim[YHI] , includeBoundary );
+    clipFieldLimitsToDomain( item->flim[YHI] );
     
      /* ZLO. */
     setBoundingBoxFromNodes( bbox , item->gbbox[XLO]     , item->gbbox[XHI] , 
@@ -410,6 +429,7 @@ void initPlaneWaves( void )
                                                    edgeIsActive[YLO] , edgeIsActive[YHI] ,
                                                    false             , true              );
     setFieldLimits( bbox , item->flim[ZLO] , includeBoundary );
+    clipFieldLimitsToDomain( item->flim[ZLO] );
     
      /* ZHI. */
     setBoundingBoxFromNodes( bbox , item->gbbox[XLO] , item->gbbox[XHI]     , 
@@ -419,6 +439,7 @@ void initPlaneWaves( void )
                                                    edgeIsActive[YLO] , edgeIsActive[YHI] ,
                                                    true              , false             );
     setFieldLimits( bbox , item->flim[ZHI] , includeBoundary );    
+    clipFieldLimitsToDomain( item->flim[ZHI] );
 
     /* Log field limits. */
     for( MeshFace face = XLO ; face <= ZHI ; face++ )
@@ -439,6 +460,10 @@ void initPlaneWaves( void )
         }
       }
     }
+
+    /* Delays of the incident field points for the analytic calculation. */
+    if( !useAuxGrid )
+      initIncidentTables( item );
               
   } //   DL_FOREACH( planeWaveList , item ) 
     
@@ -553,8 +578,21 @@ void calcIncidentFieldVectors( real kinc[3] , real Finc[6] , real ijk0[3] , int
 
 }
 
-/* Determine incient field component in cell (i,j,k) at time t. */
-real incidentFieldAnalytic( FieldComponent field , int i , int j , int k , real time , PlaneWaveItem *item )
+/* 
+ * Determine incident field component in cell (i,j,k) on a face of the TF/SF box at time t 
+ * from the incident field tables, which must have been updated to time t.
+ */
+real incidentFieldAnalytic( MeshFace face , FieldComponent field , int i , int j , int k , real time , PlaneWaveItem *item )
+{
+
+  int *lim = item->tlim[face][field];
+
+  return item->incValues[face][field][item->delayIndex[face][field][i-lim[XLO]][j-lim[YLO]][k-lim[ZLO]]];
+
+}
+
+/* Delay of incident field component in cell (i,j,k) relative to the origin of the plane wave. */
+real getIncidentDelay( FieldComponent field , int i , int j , int k , PlaneWaveItem *item )
 {
 
   real rcomp[3];
@@ -568,12 +606,220 @@ real incidentFieldAnalytic( FieldComponent field , int i , int j , int k , real
       item->kinc[YDIR] * ( rcomp[YDIR] - item->r0[YDIR] ) + 
       item->kinc[ZDIR] * ( rcomp[ZDIR] - item->r0[ZDIR] );
 
-  return item->Finc[field] * getWaveformValue( time - d / item->phaseVelocity , item->waveformNumber , item->delay );
+  return d / item->phaseVelocity;
+
+}
+
+/* 
+ * Initialise the incident field tables of the analytic calculation. The correction of each
+ * field component on a face uses the incident field of the other type along the remaining
+ * tangential direction, half a cell outside the face for the electric field corrections and
+ * half a cell inside for the magnetic field corrections. The delays of these points are time
+ * invariant, so the distinct delays on each face are found once here and the waveform is 
+ * only evaluated at those each time step.
+ */
+void initIncidentTables( PlaneWaveItem *item )
+{
+
+  unsigned long bytes = 0;
+  unsigned long totalBytes = 0;
+  unsigned long numPoints = 0;
+  unsigned long numDelays = 0;
+
+  for( MeshFace face = XLO ; face <= ZHI ; face++ )
+  {
+    CoordAxis normal = face / 2;
+    int offset = 0;
+
+    for( FieldComponent field = EX ; field <= HZ ; field++ )
+    {
+      item->delayIndex[face][field] = NULL;
+      item->delays[face][field] = NULL;
+      item->incValues[face][field] = NULL;
+      item->numDelays[face][field] = 0;
+    }
+
+    if( !item->isActive[face] )
+      continue;
+
+    for( FieldComponent field = EX ; field <= HZ ; field++ )
+    {
+      FieldComponent incField;
+      int *lim;
+      int size[3];
+      unsigned long num;
+      real *pointDelays;
+      real *delays;
+      int numDistinct;
+      
+      if( !fieldIsParallelToBoundary( field , face ) )
+        continue;
+
+      /* Incident field component and offset of its points normal to the face. */
+      if( field <= EZ )
+      {
+        incField = HX + ( 3 - normal - field );
+        offset = ( face % 2 == 0 ) ? -1 : 0;
+      }
+      else
+      {
+        incField = EX + ( 3 - normal - ( field - HX ) );
+        offset = ( face % 2 == 0 ) ? 1 : 0;
+      }
+
+      lim = item->tlim[face][incField];
+      for( int boundary = XLO ; boundary <= ZHI ; boundary++ )
+        lim[boundary] = item->flim[face][field][boundary];
+      lim[2*normal] += offset;
+      lim[2*normal+1] += offset;
+      for( CoordAxis axis = XDIR ; axis <= ZDIR ; axis++ )
+        size[axis] = lim[2*axis+1] - lim[2*axis] + 1;
+      if( size[XDIR] <= 0 || size[YDIR] <= 0 || size[ZDIR] <= 0 )
+        continue;
+      num = (unsigned long)size[XDIR] * size[YDIR] * size[ZDIR];
+
+      /* Sort the delays of the points and remove duplicates. */
+      pointDelays = (real *) malloc( sizeof( real ) * num );
+      if( !pointDelays )
+        message( MSG_ERROR , 0 , "*** Error: Failed to allocate plane wave delays\n" );
+      num = 0;
+      for( int i = lim[XLO] ; i <= lim[XHI] ; i++ )
+        for( int j = lim[YLO] ; j <= lim[YHI] ; j++ )
+          for( int k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
+            pointDelays[num++] = getIncidentDelay( incField , i , j , k , item );
+      qsort( pointDelays , num , sizeof( real ) , compareReals );
+      numDistinct = 1;
+      for( unsigned long point = 1 ; point < num ; point++ )
+        if( pointDelays[point] != pointDelays[numDistinct-1] )
+          pointDelays[numDistinct++] = pointDelays[point];
+
+      delays = allocArray( &bytes , sizeof( real ) , 1 , numDistinct );
+      totalBytes += bytes;
+      for( int delay = 0 ; delay < numDistinct ; delay++ )
+        delays[delay] = pointDelays[delay];
+      free( pointDelays );
+
+      item->incValues[face][incField] = allocArray( &bytes , sizeof( real ) , 1 , numDistinct );
+      totalBytes += bytes;
+      item->delayIndex[face][incField] = allocArray( &bytes , sizeof( int ) , 3 , size[XDIR] , size[YDIR] , size[ZDIR] );
+      totalBytes += bytes;
+      for( int i = lim[XLO] ; i <= lim[XHI] ; i++ )
+        for( int j = lim[YLO] ; j <= lim[YHI] ; j++ )
+          for( int k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
+          {
+            real delay = getIncidentDelay( incField , i , j , k , item );
+            real *found = bsearch( &delay , delays , numDistinct , sizeof( real ) , compareReals );
+            assert( found != NULL );
+            item->delayIndex[face][incField][i-lim[XLO]][j-lim[YLO]][k-lim[ZLO]] = found - delays;
+          }
+
+      item->delays[face][incField] = delays;
+      item->numDelays[face][incField] = numDistinct;
+      numPoints += num;
+      numDelays += numDistinct;
+    }
+  }
+
+  memory.sources += totalBytes;
+
+  message( MSG_DEBUG1 , 0 , "    Incident field tables: %lu points, %lu distinct delays, %lu bytes\n" , 
+           numPoints , numDelays , totalBytes );
+
+  return;
+
+}
+
+/* Evaluate the incident field at the distinct delays for the components from firstField. */
+void updateIncidentTables( PlaneWaveItem *item , real time , FieldComponent firstField )
+{
+
+  for( MeshFace face = XLO ; face <= ZHI ; face++ )
+  {
+    for( FieldComponent field = firstField ; field <= firstField + 2 ; field++ )
+    {
+      real *delays = item->delays[face][field];
+      real *values = item->incValues[face][field];
+      int delay;
+
+      #ifdef WITH_OPENMP
+      #pragma omp parallel for private( delay )
+      #endif
+      for( delay = 0 ; delay < item->numDelays[face][field] ; delay++ )
+        values[delay] = item->Finc[field] * getWaveformValue( time - delays[delay] , item->waveformNumber , item->delay );
+    }
+  }
+
+  return;
+
+}
+
+/* Deallocate the incident field tables. */
+void deallocIncidentTables( PlaneWaveItem *item )
+{
+
+  for( MeshFace face = XLO ; face <= ZHI ; face++ )
+  {
+    for( FieldComponent field = EX ; field <= HZ ; field++ )
+    {
+      int *lim = item->tlim[face][field];
+
+      if( item->delayIndex[face][field] != NULL )
+      {
+        deallocArray( item->delayIndex[face][field] , 3 , lim[XHI] - lim[XLO] + 1 , 
+                      lim[YHI] - lim[YLO] + 1 , lim[ZHI] - lim[ZLO] + 1 );
+        deallocArray( item->delays[face][field] , 1 , item->numDelays[face][field] );
+        deallocArray( item->incValues[face][field] , 1 , item->numDelays[face][field] );
+      }
+    }
+  }
+
+  return;
+
+}
+
+/* Order reals in ascending value. */
+int compareReals( const void *a , const void *b )
+{
+
+  real p = *(const real *)a;
+  real q = *(const real *)b;
+
+  return ( p > q ) - ( p < q );
 
 }
 
 /* Apply electric field plane wave correction. */
 void updatePlaneWavesEfield( real timeE )
+{
+
+  updatePlaneWavesAuxEfield( timeE );
+
+  for( FieldComponent field = EX ; field <= EZ ; field++ )
+    updatePlaneWavesEfieldComponent( field , timeE );
+
+  return;
+
+}
+
+/* Update the auxiliary grids or the incident magnetic field tables of the plane waves. */
+void updatePlaneWavesAuxEfield( real timeE )
+{
+
+  PlaneWaveItem *item;
+
+  if( useAuxGrid )
+    DL_FOREACH( planeWaveList , item ) 
+      updateAuxGridEfield( item , timeE );
+  else
+    DL_FOREACH( planeWaveList , item ) 
+      updateIncidentTables( item , timeE , HX );
+
+  return;
+
+}
+
+/* Apply plane wave correction to one field component - the components are independent. */
+void updatePlaneWavesEfieldComponent( FieldComponent field , real timeE )
 {
 
   PlaneWaveItem *item;
@@ -582,37 +828,40 @@ void updatePlaneWavesEfield( real timeE )
 
   DL_FOREACH( planeWaveList , item ) 
   {
-
-    if( useAuxGrid )
-      updateAuxGridEfield( item , timeE );
       
     if( item->isActive[YLO] )
     {
       /* YLO face, EX - eqn. (5.48a). */
-      j = item->flim[YLO][EX][YLO];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , k , incField )
-      #endif
-      for ( i = item->flim[YLO][EX][XLO] ; i <= item->flim[YLO][EX][XHI] ; i++ ) 
+      if( field == EX )
       {
-        for ( k = item->flim[YLO][EX][ZLO] ; k <= item->flim[YLO][EX][ZHI] ; k++ )
+        j = item->flim[YLO][EX][YLO];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( i , k , incField )
+        #endif
+        for ( i = item->flim[YLO][EX][XLO] ; i <= item->flim[YLO][EX][XHI] ; i++ ) 
         {
-          incField = SCALE_Hz( incidentField( HZ , i , j - 1 , k , timeE , item ) , k );
-          Ex[i][j][k] = ALPHA_EX(i,j,k) * Ex[i][j][k] - BETA_EX(i,j,k) * dHz_dy( incField , j );  
+          for ( k = item->flim[YLO][EX][ZLO] ; k <= item->flim[YLO][EX][ZHI] ; k++ )
+          {
+            incField = SCALE_Hz( incidentField( YLO , HZ , i , j - 1 , k , timeE , item ) , k );
+            Ex[i][j][k] = ALPHA_EX(i,j,k) * Ex[i][j][k] - BETA_EX(i,j,k) * dHz_dy( incField , j );  
+          }
         }
       }
 
       /* YLO face, EZ - eqn. (5.48b). */
-      j = item->flim[YLO][EZ][YLO];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , k , incField )
-      #endif
-      for ( i = item->flim[YLO][EZ][XLO] ; i <= item->flim[YLO][EZ][XHI] ; i++ ) 
+      if( field == EZ )
       {
-        for ( k = item->flim[YLO][EZ][ZLO] ; k <= item->flim[YLO][EZ][ZHI] ; k++ )
+        j = item->flim[YLO][EZ][YLO];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( i , k , incField )
+        #endif
+        for ( i = item->flim[YLO][EZ][XLO] ; i <= item->flim[YLO][EZ][XHI] ; i++ ) 
         {
-          incField = SCALE_Hx( incidentField( HX , i , j - 1 , k , timeE , item ) , i );
-          Ez[i][j][k] = ALPHA_EZ(i,j,k) * Ez[i][j][k] + BETA_EZ(i,j,k) * dHx_dy( incField , j );
+          for ( k = item->flim[YLO][EZ][ZLO] ; k <= item->flim[YLO][EZ][ZHI] ; k++ )
+          {
+            incField = SCALE_Hx( incidentField( YLO , HX , i , j - 1 , k , timeE , item ) , i );
+            Ez[i][j][k] = ALPHA_EZ(i,j,k) * Ez[i][j][k] + BETA_EZ(i,j,k) * dHx_dy( incField , j );
+          }
         }
       }
 
@@ -621,30 +870,36 @@ void updatePlaneWavesEfield( real timeE )
     if( item->isActive[YHI] )
     {
       /* YHI face, EX - eqn. (5.49a). */
-      j = item->flim[YHI][EX][YHI];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , k , incField )
-      #endif
-      for ( i = item->flim[YHI][EX][XLO] ; i <= item->flim[YHI][EX][XHI] ; i++ ) 
+      if( field == EX )
       {
-        for ( k = item->flim[YHI][EX][ZLO] ; k <= item->flim[YHI][EX][ZHI] ; k++ )
+        j = item->flim[YHI][EX][YHI];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( i , k , incField )
+        #endif
+        for ( i = item->flim[YHI][EX][XLO] ; i <= item->flim[YHI][EX][XHI] ; i++ ) 
         {
-          incField = SCALE_Hz( incidentField( HZ , i , j , k , timeE , item ) , k );
-          Ex[i][j][k] = ALPHA_EX(i,j,k) * Ex[i][j][k] + BETA_EX(i,j,k) * dHz_dy( incField , j );  
+          for ( k = item->flim[YHI][EX][ZLO] ; k <= item->flim[YHI][EX][ZHI] ; k++ )
+          {
+            incField = SCALE_Hz( incidentField( YHI , HZ , i , j , k , timeE , item ) , k );
+            Ex[i][j][k] = ALPHA_EX(i,j,k) * Ex[i][j][k] + BETA_EX(i,j,k) * dHz_dy( incField , j );  
+          }
         }
       }
 
       /* YHI face, EZ - eqn. (5.49b). */
-      j = item->flim[YHI][EZ][YHI];      
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , k , incField )
-      #endif
-      for ( i = item->flim[YHI][EZ][XLO] ; i <= item->flim[YHI][EZ][XHI] ; i++ ) 
+      if( field == EZ )
       {
-        for ( k = item->flim[YHI][EZ][ZLO] ; k <= item->flim[YHI][EZ][ZHI] ; k++ )
+        j = item->flim[YHI][EZ][YHI];      
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( i , k , incField )
+        #endif
+        for ( i = item->flim[YHI][EZ][XLO] ; i <= item->flim[YHI][EZ][XHI] ; i++ ) 
         {
-          incField = SCALE_Hx( incidentField( HX , i , j , k , timeE , item ) , i );
-          Ez[i][j][k] = ALPHA_EZ(i,j,k) * Ez[i][j][k] - BETA_EZ(i,j,k) * dHx_dy( incField , j );  
+          for ( k = item->flim[YHI][EZ][ZLO] ; k <= item->flim[YHI][EZ][ZHI] ; k++ )
+          {
+            incField = SCALE_Hx( incidentField( YHI , HX , i , j , k , timeE , item ) , i );
+            Ez[i][j][k] = ALPHA_EZ(i,j,k) * Ez[i][j][k] - BETA_EZ(i,j,k) * dHx_dy( incField , j );  
+          }
         }
       }
 
@@ -654,30 +909,36 @@ void updatePlaneWavesEfield( real timeE )
     {
 
       /* ZLO face, EX - eqn. (5.50a). */
-      k = item->flim[ZLO][EX][ZLO];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , j , incField )
-      #endif
-      for ( i = item->flim[ZLO][EX][XLO] ; i <= item->flim[ZLO][EX][XHI] ; i++ ) 
+      if( field == EX )
       {
-        for ( j = item->flim[ZLO][EX][YLO] ; j <= item->flim[ZLO][EX][YHI] ; j++ )
+        k = item->flim[ZLO][EX][ZLO];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( i , j , incField )
+        #endif
+        for ( i = item->flim[ZLO][EX][XLO] ; i <= item->flim[ZLO][EX][XHI] ; i++ ) 
         {
-          incField = SCALE_Hy( incidentField( HY , i , j , k - 1  , timeE , item ) , j );
-          Ex[i][j][k] = ALPHA_EX(i,j,k) * Ex[i][j][k] + BETA_EX(i,j,k) * dHy_dz( incField , k );
+          for ( j = item->flim[ZLO][EX][YLO] ; j <= item->flim[ZLO][EX][YHI] ; j++ )
+          {
+            incField = SCALE_Hy( incidentField( ZLO , HY , i , j , k - 1  , timeE , item ) , j );
+            Ex[i][j][k] = ALPHA_EX(i,j,k) * Ex[i][j][k] + BETA_EX(i,j,k) * dHy_dz( incField , k );
+          }
         }
       }
 
       /* ZLO face, EY - eqn. (5.50b). */
-      k = item->flim[ZLO][EY][ZLO];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , j , incField )
-      #endif
-      for ( i = item->flim[ZLO][EY][XLO] ; i <= item->flim[ZLO][EY][XHI] ; i++ ) 
+      if( field == EY )
       {
-        for ( j = item->flim[ZLO][EY][YLO] ; j <= item->flim[ZLO][EY][YHI] ; j++ )
+        k = item->flim[ZLO][EY][ZLO];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( i , j , incField )
+        #endif
+        for ( i = item->flim[ZLO][EY][XLO] ; i <= item->flim[ZLO][EY][XHI] ; i++ ) 
         {
-          incField = SCALE_Hx( incidentField( HX , i , j , k - 1  , timeE , item ) , i );
-          Ey[i][j][k] = ALPHA_EY(i,j,k) * Ey[i][j][k] - BETA_EY(i,j,k) * dHx_dz( incField , k ); 
+          for ( j = item->flim[ZLO][EY][YLO] ; j <= item->flim[ZLO][EY][YHI] ; j++ )
+          {
+            incField = SCALE_Hx( incidentField( ZLO , HX , i , j , k - 1  , timeE , item ) , i );
+            Ey[i][j][k] = ALPHA_EY(i,j,k) * Ey[i][j][k] - BETA_EY(i,j,k) * dHx_dz( incField , k ); 
+          }
         }
       }
 
@@ -687,30 +948,36 @@ void updatePlaneWavesEfield( real timeE )
     {
 
       /* ZHI face, EX - eqn. (5.51a). */
-      k = item->flim[ZHI][EX][ZHI];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , j , incField )
-      #endif
-      for ( i = item->flim[ZHI][EX][XLO] ; i <= item->flim[ZHI][EX][XHI] ; i++ ) 
+      if( field == EX )
       {
-        for ( j = item->flim[ZHI][EX][YLO] ; j <= item->flim[ZHI][EX][YHI] ; j++ )
+        k = item->flim[ZHI][EX][ZHI];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( i , j , incField )
+        #endif
+        for ( i = item->flim[ZHI][EX][XLO] ; i <= item->flim[ZHI][EX][XHI] ; i++ ) 
         {
-          incField = SCALE_Hy( incidentField( HY , i , j , k , timeE , item ) , j );
-          Ex[i][j][k] = ALPHA_EX(i,j,k) * Ex[i][j][k] - BETA_EX(i,j,k) * dHy_dz( incField , k );
+          for ( j = item->flim[ZHI][EX][YLO] ; j <= item->flim[ZHI][EX][YHI] ; j++ )
+          {
+            incField = SCALE_Hy( incidentField( ZHI , HY , i , j , k , timeE , item ) , j );
+            Ex[i][j][k] = ALPHA_EX(i,j,k) * Ex[i][j][k] - BETA_EX(i,j,k) * dHy_dz( incField , k );
+          }
         }
       }
 
       /* ZHI face, EY - eqn. (5.51b). */
-      k = item->flim[ZHI][EY][ZHI];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , j , incField )
-      #endif
-      for ( i = item->flim[ZHI][EY][XLO] ; i <= item->flim[ZHI][EY][XHI] ; i++ ) 
+      if( field == EY )
       {
-        for ( j = item->flim[ZHI][EY][YLO] ; j <= item->flim[ZHI][EY][YHI] ; j++ )
+        k = item->flim[ZHI][EY][ZHI];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( i , j , incField )
+        #endif
+        for ( i = item->flim[ZHI][EY][XLO] ; i <= item->flim[ZHI][EY][XHI] ; i++ ) 
         {
-          incField = SCALE_Hx( incidentField( HX , i , j , k , timeE , item ) , i );
-          Ey[i][j][k] = ALPHA_EY(i,j,k) * Ey[i][j][k] + BETA_EY(i,j,k) * dHx_dz( incField , k ); 
+          for ( j = item->flim[ZHI][EY][YLO] ; j <= item->flim[ZHI][EY][YHI] ; j++ )
+          {
+            incField = SCALE_Hx( incidentField( ZHI , HX , i , j , k , timeE , item ) , i );
+            Ey[i][j][k] = ALPHA_EY(i,j,k) * Ey[i][j][k] + BETA_EY(i,j,k) * dHx_dz( incField , k ); 
+          }
         }
       }
   
@@ -720,30 +987,36 @@ void updatePlaneWavesEfield( real timeE )
     {     
 
       /* XLO face, EY - eqn. (5.52a). */
-      i = item->flim[XLO][EY][XLO];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( j , k , incField )
-      #endif
-      for ( j = item->flim[XLO][EY][YLO] ; j <= item->flim[XLO][EY][YHI] ; j++ )
+      if( field == EY )
       {
-        for ( k = item->flim[XLO][EY][ZLO] ; k <= item->flim[XLO][EY][ZHI] ; k++ )
+        i = item->flim[XLO][EY][XLO];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( j , k , incField )
+        #endif
+        for ( j = item->flim[XLO][EY][YLO] ; j <= item->flim[XLO][EY][YHI] ; j++ )
         {
-          incField = SCALE_Hz( incidentField( HZ , i - 1  , j , k , timeE , item ) , k );
-          Ey[i][j][k] = ALPHA_EY(i,j,k) * Ey[i][j][k] + BETA_EY(i,j,k) * dHz_dx( incField , i );
+          for ( k = item->flim[XLO][EY][ZLO] ; k <= item->flim[XLO][EY][ZHI] ; k++ )
+          {
+            incField = SCALE_Hz( incidentField( XLO , HZ , i - 1  , j , k , timeE , item ) , k );
+            Ey[i][j][k] = ALPHA_EY(i,j,k) * Ey[i][j][k] + BETA_EY(i,j,k) * dHz_dx( incField , i );
+          }
         }
       }
 
       /* XLO face, EZ - eqn. (5.52b). */
-      i = item->flim[XLO][EZ][XLO];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( j , k , incField )
-      #endif
-      for ( j = item->flim[XLO][EZ][YLO] ; j <= item->flim[XLO][EZ][YHI] ; j++ )
+      if( field == EZ )
       {
-        for ( k = item->flim[XLO][EZ][ZLO] ; k <= item->flim[XLO][EZ][ZHI] ; k++ )
+        i = item->flim[XLO][EZ][XLO];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( j , k , incField )
+        #endif
+        for ( j = item->flim[XLO][EZ][YLO] ; j <= item->flim[XLO][EZ][YHI] ; j++ )
         {
-          incField = SCALE_Hy( incidentField( HY , i - 1  , j , k , timeE , item ) , j );
-          Ez[i][j][k] = ALPHA_EZ(i,j,k) * Ez[i][j][k] - BETA_EZ(i,j,k) * dHy_dx( incField , i );
+          for ( k = item->flim[XLO][EZ][ZLO] ; k <= item->flim[XLO][EZ][ZHI] ; k++ )
+          {
+            incField = SCALE_Hy( incidentField( XLO , HY , i - 1  , j , k , timeE , item ) , j );
+            Ez[i][j][k] = ALPHA_EZ(i,j,k) * Ez[i][j][k] - BETA_EZ(i,j,k) * dHy_dx( incField , i );
+          }
         }
       }
 
@@ -753,30 +1026,36 @@ void updatePlaneWavesEfield( real timeE )
     {  
 
       /* XHI face, EY - eqn. (5.53a). */
-      i = item->flim[XHI][EY][XHI];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( j , k , incField )
-      #endif
-      for ( j = item->flim[XHI][EY][YLO] ; j <= item->flim[XHI][EY][YHI] ; j++ )
+      if( field == EY )
       {
-        for ( k = item->flim[XHI][EY][ZLO] ; k <= item->flim[XHI][EY][ZHI] ; k++ )
+        i = item->flim[XHI][EY][XHI];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( j , k , incField )
+        #endif
+        for ( j = item->flim[XHI][EY][YLO] ; j <= item->flim[XHI][EY][YHI] ; j++ )
         {
-          incField = SCALE_Hz( incidentField( HZ , i , j , k , timeE , item ) , k );
-          Ey[i][j][k] = ALPHA_EY(i,j,k) * Ey[i][j][k] - BETA_EY(i,j,k) * dHz_dx( incField , i );
+          for ( k = item->flim[XHI][EY][ZLO] ; k <= item->flim[XHI][EY][ZHI] ; k++ )
+          {
+            incField = SCALE_Hz( incidentField( XHI , HZ , i , j , k , timeE , item ) , k );
+            Ey[i][j][k] = ALPHA_EY(i,j,k) * Ey[i][j][k] - BETA_EY(i,j,k) * dHz_dx( incField , i );
+          }
         }
       }
 
       /* XHI face, EZ - eqn. (5.53b). */
-      i = item->flim[XHI][EZ][XHI];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( j , k , incField )
-      #endif
-      for ( j = item->flim[XHI][EZ][YLO] ; j <= item->flim[XHI][EZ][YHI] ; j++ )
+      if( field == EZ )
       {
-        for ( k = item->flim[XHI][EZ][ZLO] ; k <= item->flim[XHI][EZ][ZHI] ; k++ )
+        i = item->flim[XHI][EZ][XHI];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( j , k , incField )
+        #endif
+        for ( j = item->flim[XHI][EZ][YLO] ; j <= item->flim[XHI][EZ][YHI] ; j++ )
         {
-          incField = SCALE_Hy( incidentField( HY , i , j , k , timeE , item ) , j );
-          Ez[i][j][k] = ALPHA_EZ(i,j,k) * Ez[i][j][k] + BETA_EZ(i,j,k) * dHy_dx( incField , i );
+          for ( k = item->flim[XHI][EZ][ZLO] ; k <= item->flim[XHI][EZ][ZHI] ; k++ )
+          {
+            incField = SCALE_Hy( incidentField( XHI , HY , i , j , k , timeE , item ) , j );
+            Ez[i][j][k] = ALPHA_EZ(i,j,k) * Ez[i][j][k] + BETA_EZ(i,j,k) * dHy_dx( incField , i );
+          }
         }
       }
 
@@ -790,6 +1069,36 @@ void updatePlaneWavesEfield( real timeE )
 
 /* Apply magnetic field plane wave correction. */
 void updatePlaneWavesHfield( real timeH )
+{
+
+  updatePlaneWavesAuxHfield( timeH );
+
+  for( FieldComponent field = HX ; field <= HZ ; field++ )
+    updatePlaneWavesHfieldComponent( field , timeH );
+
+  return;
+
+}
+
+/* Update the auxiliary grids or the incident electric field tables of the plane waves. */
+void updatePlaneWavesAuxHfield( real timeH )
+{
+
+  PlaneWaveItem *item;
+
+  if( useAuxGrid )
+    DL_FOREACH( planeWaveList , item ) 
+      updateAuxGridHfield( item , timeH );
+  else
+    DL_FOREACH( planeWaveList , item ) 
+      updateIncidentTables( item , timeH , EX );
+
+  return;
+
+}
+
+/* Apply plane wave correction to one field component - the components are independent. */
+void updatePlaneWavesHfieldComponent( FieldComponent field , real timeH )
 {
 
   PlaneWaveItem *item;
@@ -798,38 +1107,41 @@ void updatePlaneWavesHfield( real timeH )
 
   DL_FOREACH( planeWaveList , item ) 
   {
-
-    if( useAuxGrid )
-      updateAuxGridHfield( item , timeH );
     
     if( item->isActive[YLO] )
     {
       
       /* YLO face, HZ - eqn. (5.54a). */
-      j = item->flim[YLO][HZ][YLO];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , k , incField )
-      #endif
-      for ( i = item->flim[YLO][HZ][XLO] ; i <= item->flim[YLO][HZ][XHI] ; i++ ) 
+      if( field == HZ )
       {
-        for ( k = item->flim[YLO][HZ][ZLO] ; k <= item->flim[YLO][HZ][ZHI] ; k++ )
+        j = item->flim[YLO][HZ][YLO];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( i , k , incField )
+        #endif
+        for ( i = item->flim[YLO][HZ][XLO] ; i <= item->flim[YLO][HZ][XHI] ; i++ ) 
         {
-          incField = SCALE_Ex( incidentField( EX , i , j + 1 , k , timeH , item ) , i );       
-          Hz[i][j][k] = Hz[i][j][k] - GAMMA_HZ(i,j,k) * dEx_dy( incField , j );
+          for ( k = item->flim[YLO][HZ][ZLO] ; k <= item->flim[YLO][HZ][ZHI] ; k++ )
+          {
+            incField = SCALE_Ex( incidentField( YLO , EX , i , j + 1 , k , timeH , item ) , i );       
+            Hz[i][j][k] = Hz[i][j][k] - GAMMA_HZ(i,j,k) * dEx_dy( incField , j );
+          }
         }
       }
 
       /* YLO face, HX - eqn. (5.54b). */
-      j = item->flim[YLO][HX][YLO];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , k , incField )
-      #endif
-      for ( i = item->flim[YLO][HX][XLO] ; i <= item->flim[YLO][HX][XHI] ; i++ ) 
+      if( field == HX )
       {
-        for ( k = item->flim[YLO][HX][ZLO] ; k <= item->flim[YLO][HX][ZHI] ; k++ )
+        j = item->flim[YLO][HX][YLO];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( i , k , incField )
+        #endif
+        for ( i = item->flim[YLO][HX][XLO] ; i <= item->flim[YLO][HX][XHI] ; i++ ) 
         {
-          incField = SCALE_Ez( incidentField( EZ , i , j + 1 , k , timeH , item ) , k );
-          Hx[i][j][k] = Hx[i][j][k] + GAMMA_HX(i,j,k) * dEz_dy( incField , j ); 
+          for ( k = item->flim[YLO][HX][ZLO] ; k <= item->flim[YLO][HX][ZHI] ; k++ )
+          {
+            incField = SCALE_Ez( incidentField( YLO , EZ , i , j + 1 , k , timeH , item ) , k );
+            Hx[i][j][k] = Hx[i][j][k] + GAMMA_HX(i,j,k) * dEz_dy( incField , j ); 
+          }
         }
       }
 
@@ -839,30 +1151,36 @@ void updatePlaneWavesHfield( real timeH )
     {
       
       /* YHI face, HZ - eqn. (5.55a). */
-      j = item->flim[YHI][HZ][YHI];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , k , incField )
-      #endif
-      for ( i = item->flim[YHI][HZ][XLO] ; i <= item->flim[YHI][HZ][XHI] ; i++ ) 
+      if( field == HZ )
       {
-        for ( k = item->flim[YHI][HZ][ZLO] ; k <= item->flim[YHI][HZ][ZHI] ; k++ )
+        j = item->flim[YHI][HZ][YHI];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( i , k , incField )
+        #endif
+        for ( i = item->flim[YHI][HZ][XLO] ; i <= item->flim[YHI][HZ][XHI] ; i++ ) 
         {
-          incField = SCALE_Ex( incidentField( EX , i , j , k , timeH , item ) , i );
-          Hz[i][j][k] = Hz[i][j][k] + GAMMA_HZ(i,j,k) * dEx_dy( incField , j );
+          for ( k = item->flim[YHI][HZ][ZLO] ; k <= item->flim[YHI][HZ][ZHI] ; k++ )
+          {
+            incField = SCALE_Ex( incidentField( YHI , EX , i , j , k , timeH , item ) , i );
+            Hz[i][j][k] = Hz[i][j][k] + GAMMA_HZ(i,j,k) * dEx_dy( incField , j );
+          }
         }
       }
 
       /* YHI face, HX - eqn. (5.55b). */
-      j = item->flim[YHI][HX][YHI];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , k , incField )
-      #endif
-      for ( i = item->flim[YHI][HX][XLO] ; i <= item->flim[YHI][HX][XHI] ; i++ ) 
+      if( field == HX )
       {
-        for ( k = item->flim[YHI][HX][ZLO] ; k <= item->flim[YHI][HX][ZHI] ; k++ )
+        j = item->flim[YHI][HX][YHI];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( i , k , incField )
+        #endif
+        for ( i = item->flim[YHI][HX][XLO] ; i <= item->flim[YHI][HX][XHI] ; i++ ) 
         {
-          incField = SCALE_Ez( incidentField( EZ , i , j , k , timeH , item ) , k );
-          Hx[i][j][k] = Hx[i][j][k] - GAMMA_HX(i,j,k) * dEz_dy( incField , j ); 
+          for ( k = item->flim[YHI][HX][ZLO] ; k <= item->flim[YHI][HX][ZHI] ; k++ )
+          {
+            incField = SCALE_Ez( incidentField( YHI , EZ , i , j , k , timeH , item ) , k );
+            Hx[i][j][k] = Hx[i][j][k] - GAMMA_HX(i,j,k) * dEz_dy( incField , j ); 
+          }
         }
       }
 
@@ -872,30 +1190,36 @@ void updatePlaneWavesHfield( real timeH )
     {
       
       /* ZLO face, HY - eqn. (5.56a). */
-      k = item->flim[ZLO][HY][ZLO];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , j , incField )
-      #endif
-      for ( i = item->flim[ZLO][HY][XLO] ; i <= item->flim[ZLO][HY][XHI] ; i++ ) 
+      if( field == HY )
       {
-        for ( j = item->flim[ZLO][HY][YLO] ; j <= item->flim[ZLO][HY][YHI] ; j++ )
+        k = item->flim[ZLO][HY][ZLO];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( i , j , incField )
+        #endif
+        for ( i = item->flim[ZLO][HY][XLO] ; i <= item->flim[ZLO][HY][XHI] ; i++ ) 
         {
-          incField = SCALE_Ex( incidentField( EX , i , j , k + 1 , timeH , item ) , i );
-          Hy[i][j][k] = Hy[i][j][k] + GAMMA_HY(i,j,k) * dEx_dz( incField , k );
+          for ( j = item->flim[ZLO][HY][YLO] ; j <= item->flim[ZLO][HY][YHI] ; j++ )
+          {
+            incField = SCALE_Ex( incidentField( ZLO , EX , i , j , k + 1 , timeH , item ) , i );
+            Hy[i][j][k] = Hy[i][j][k] + GAMMA_HY(i,j,k) * dEx_dz( incField , k );
+          }
         }
       }
 
       /* ZLO face, HX - eqn. (5.56b). */
-      k = item->flim[ZLO][HX][ZLO];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , j , incField )
-      #endif
-      for ( i = item->flim[ZLO][HX][XLO] ; i <= item->flim[ZLO][HX][XHI] ; i++ ) 
+      if( field == HX )
       {
-        for ( j = item->flim[ZLO][HX][YLO] ; j <= item->flim[ZLO][HX][YHI] ; j++ )
+        k = item->flim[ZLO][HX][ZLO];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( i , j , incField )
+        #endif
+        for ( i = item->flim[ZLO][HX][XLO] ; i <= item->flim[ZLO][HX][XHI] ; i++ ) 
         {
-          incField = SCALE_Ey( incidentField( EY , i , j , k + 1 , timeH , item ) , j );
-          Hx[i][j][k] = Hx[i][j][k] - GAMMA_HX(i,j,k) * dEy_dz( incField , k );
+          for ( j = item->flim[ZLO][HX][YLO] ; j <= item->flim[ZLO][HX][YHI] ; j++ )
+          {
+            incField = SCALE_Ey( incidentField( ZLO , EY , i , j , k + 1 , timeH , item ) , j );
+            Hx[i][j][k] = Hx[i][j][k] - GAMMA_HX(i,j,k) * dEy_dz( incField , k );
+          }
         }
       }
 
@@ -905,30 +1229,36 @@ void updatePlaneWavesHfield( real timeH )
     {
       
       /* ZHI face, HY - eqn. (5.57a). */
-      k = item->flim[ZHI][HY][ZHI];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , j , incField )
-      #endif
-      for ( i = item->flim[ZHI][HY][XLO] ; i <= item->flim[ZHI][HY][XHI] ; i++ ) 
+      if( field == HY )
       {
-        for ( j = item->flim[ZHI][HY][YLO] ; j <= item->flim[ZHI][HY][YHI] ; j++ )
+        k = item->flim[ZHI][HY][ZHI];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( i , j , incField )
+        #endif
+        for ( i = item->flim[ZHI][HY][XLO] ; i <= item->flim[ZHI][HY][XHI] ; i++ ) 
         {
-          incField = SCALE_Ex( incidentField( EX , i , j , k , timeH , item ) , i );
-          Hy[i][j][k] = Hy[i][j][k] - GAMMA_HY(i,j,k) * dEx_dz( incField , k );
+          for ( j = item->flim[ZHI][HY][YLO] ; j <= item->flim[ZHI][HY][YHI] ; j++ )
+          {
+            incField = SCALE_Ex( incidentField( ZHI , EX , i , j , k , timeH , item ) , i );
+            Hy[i][j][k] = Hy[i][j][k] - GAMMA_HY(i,j,k) * dEx_dz( incField , k );
+          }
         }
       }
 
       /* ZHI face, HX - eqn. (5.57b). */
-      k = item->flim[ZHI][HX][ZHI];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( i , j , incField )
-      #endif
-      for ( i = item->flim[ZHI][HX][XLO] ; i <= item->flim[ZHI][HX][XHI] ; i++ ) 
+      if( field == HX )
       {
-        for ( j = item->flim[ZHI][HX][YLO] ; j <= item->flim[ZHI][HX][YHI] ; j++ )
+        k = item->flim[ZHI][HX][ZHI];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( i , j , incField )
+        #endif
+        for ( i = item->flim[ZHI][HX][XLO] ; i <= item->flim[ZHI][HX][XHI] ; i++ ) 
         {
-          incField = SCALE_Ey( incidentField( EY , i , j , k , timeH , item ) , j );
-          Hx[i][j][k] = Hx[i][j][k] + GAMMA_HX(i,j,k) * dEy_dz( incField , k );
+          for ( j = item->flim[ZHI][HX][YLO] ; j <= item->flim[ZHI][HX][YHI] ; j++ )
+          {
+            incField = SCALE_Ey( incidentField( ZHI , EY , i , j , k , timeH , item ) , j );
+            Hx[i][j][k] = Hx[i][j][k] + GAMMA_HX(i,j,k) * dEy_dz( incField , k );
+          }
         }
       }
 
@@ -938,30 +1268,36 @@ void updatePlaneWavesHfield( real timeH )
     {
       
       /* XLO face, HZ - eqn. (5.58a). */
-      i = item->flim[XLO][HZ][XLO];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( j , k , incField )
-      #endif
-      for ( j = item->flim[XLO][HZ][YLO] ; j <= item->flim[XLO][HZ][YHI] ; j++ )
+      if( field == HZ )
       {
-        for ( k = item->flim[XLO][HZ][ZLO] ; k <= item->flim[XLO][HZ][ZHI] ; k++ )
+        i = item->flim[XLO][HZ][XLO];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( j , k , incField )
+        #endif
+        for ( j = item->flim[XLO][HZ][YLO] ; j <= item->flim[XLO][HZ][YHI] ; j++ )
         {
-          incField = SCALE_Ey( incidentField( EY , i + 1 , j , k , timeH , item ) , j );
-          Hz[i][j][k] = Hz[i][j][k] + GAMMA_HZ(i,j,k) * dEy_dx( incField , i );
+          for ( k = item->flim[XLO][HZ][ZLO] ; k <= item->flim[XLO][HZ][ZHI] ; k++ )
+          {
+            incField = SCALE_Ey( incidentField( XLO , EY , i + 1 , j , k , timeH , item ) , j );
+            Hz[i][j][k] = Hz[i][j][k] + GAMMA_HZ(i,j,k) * dEy_dx( incField , i );
+          }
         }
       }
 
       /* XLO face, HY - eqn. (5.58b). */
-      i = item->flim[XLO][HY][XLO];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( j , k , incField )
-      #endif
-      for ( j = item->flim[XLO][HY][YLO] ; j <= item->flim[XLO][HY][YHI] ; j++ )
+      if( field == HY )
       {
-        for ( k = item->flim[XLO][HY][ZLO] ; k <= item->flim[XLO][HY][ZHI] ; k++ )
+        i = item->flim[XLO][HY][XLO];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( j , k , incField )
+        #endif
+        for ( j = item->flim[XLO][HY][YLO] ; j <= item->flim[XLO][HY][YHI] ; j++ )
         {
-          incField = SCALE_Ez( incidentField( EZ , i + 1 , j , k , timeH , item ) , k );
-          Hy[i][j][k] = Hy[i][j][k] - GAMMA_HY(i,j,k) * dEz_dx( incField , i );
+          for ( k = item->flim[XLO][HY][ZLO] ; k <= item->flim[XLO][HY][ZHI] ; k++ )
+          {
+            incField = SCALE_Ez( incidentField( XLO , EZ , i + 1 , j , k , timeH , item ) , k );
+            Hy[i][j][k] = Hy[i][j][k] - GAMMA_HY(i,j,k) * dEz_dx( incField , i );
+          }
         }
       }
 
@@ -971,30 +1307,36 @@ void updatePlaneWavesHfield( real timeH )
     {
       
       /* XHI face, HZ - eqn. (5.59a). */
-      i = item->flim[XHI][HZ][XHI];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( j , k , incField )
-      #endif
-      for ( j = item->flim[XHI][HZ][YLO] ; j <= item->flim[XHI][HZ][YHI] ; j++ )
+      if( field == HZ )
       {
-        for ( k = item->flim[XHI][HZ][ZLO] ; k <= item->flim[XHI][HZ][ZHI] ; k++ )
+        i = item->flim[XHI][HZ][XHI];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( j , k , incField )
+        #endif
+        for ( j = item->flim[XHI][HZ][YLO] ; j <= item->flim[XHI][HZ][YHI] ; j++ )
         {
-          incField = SCALE_Ey( incidentField( EY , i , j , k , timeH , item ) , j );
-          Hz[i][j][k] = Hz[i][j][k] - GAMMA_HZ(i,j,k) * dEy_dx( incField , i );
+          for ( k = item->flim[XHI][HZ][ZLO] ; k <= item->flim[XHI][HZ][ZHI] ; k++ )
+          {
+            incField = SCALE_Ey( incidentField( XHI , EY , i , j , k , timeH , item ) , j );
+            Hz[i][j][k] = Hz[i][j][k] - GAMMA_HZ(i,j,k) * dEy_dx( incField , i );
+          }
         }
       }
 
       /* XHI face, HY - eqn. (5.59b). */
-      i = item->flim[XHI][HY][XHI];
-      #ifdef WITH_OPENMP
-      #pragma omp parallel for private( j , k , incField )
-      #endif
-      for ( j = item->flim[XHI][HY][YLO] ; j <= item->flim[XHI][HY][YHI] ; j++ )
+      if( field == HY )
       {
-        for ( k = item->flim[XHI][HY][ZLO] ; k <= item->flim[XHI][HY][ZHI] ; k++ )
+        i = item->flim[XHI][HY][XHI];
+        #ifdef WITH_OPENMP
+        #pragma omp parallel for private( j , k , incField )
+        #endif
+        for ( j = item->flim[XHI][HY][YLO] ; j <= item->flim[XHI][HY][YHI] ; j++ )
         {
-          incField = SCALE_Ez( incidentField( EZ , i , j , k , timeH , item ) , k );
-          Hy[i][j][k] = Hy[i][j][k] + GAMMA_HY(i,j,k) * dEz_dx( incField , i );
+          for ( k = item->flim[XHI][HY][ZLO] ; k <= item->flim[XHI][HY][ZHI] ; k++ )
+          {
+            incField = SCALE_Ez( incidentField( XHI , EZ , i , j , k , timeH , item ) , k );
+            Hy[i][j][k] = Hy[i][j][k] + GAMMA_HY(i,j,k) * dEz_dx( incField , i );
+          }
         }
       }
 
@@ -1052,6 +1394,8 @@ void deallocPlaneWaves( void )
   {
      if( useAuxGrid )
        deallocAuxGrid( item );
+     else
+       deallocIncidentTables( item );
       
     HASH_DELETE( hh , planeWaveHash , item );
     free( item );
@@ -1372,7 +1716,7 @@ void updateAuxGridHfield( PlaneWaveItem *item , real time )
 }
 
 /* Determine incient field component in cell (i,j,k) at time t using auxiliary grid. */
-real incidentFieldAuxGrid( FieldComponent field , int i , int j , int k , real time , PlaneWaveItem *item )
+real incidentFieldAuxGrid( MeshFace face , FieldComponent field , int i , int j , int k , real time , PlaneWaveItem *item )
 {
 
   real rcomp[3];
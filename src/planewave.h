@@ -38,7 +38,11 @@ typedef unsigned int PlaneWaveIndex;
 bool parsePW( char *line );
 void initPlaneWaves( void );
 void updatePlaneWavesEfield( real timeE );
+void updatePlaneWavesAuxEfield( real timeE );
+void updatePlaneWavesEfieldComponent( FieldComponent field , real timeE );
 void updatePlaneWavesHfield( real timeH );
+void updatePlaneWavesAuxHfield( real timeH );
+void updatePlaneWavesHfieldComponent( FieldComponent field , real timeH );
 void reportPlaneWaves( void );
 void deallocPlaneWaves( void );
 void gnuplotPlaneWaves( void );
@@ -27,6 +27,7 @@
 #include <limits.h>
 #include <assert.h>
 #include <stdbool.h>
+#include <complex.h>
 
 #include "pml.h"
 #include "grid.h"
@@ -36,6 +37,11 @@
 #include "medium.h"
 #include "memory.h"
 #include "physical.h"
+#include "simd.h"
+#include "domain.h"
+#include "balance.h"
+#include "observer.h"
+#include "waveform.h"
 
 /* 
  * Private data.
@@ -43,15 +49,6 @@
 
 static int pbox[6][6];       // Bounding boxes for PML regions.
 static int fplim[6][6][6];   // Field array limits for PML regions.
-static real ***PPx[6];       // Auxiliary PML field arrays.
-static real ***PPy[6];
-static real ***PPz[6];
-static real ***Px[6];
-static real ***Py[6];
-static real ***Pz[6];
-static real ***Bx[6];
-static real ***By[6];
-static real ***Bz[6];
 static real *adx;            // PML loss profile arrays.
 static real *bdx;
 static real *gdx;
@@ -83,6 +80,106 @@ static real *ibhx;
 static real *ibhy;
 static real *ibhz;
 
+/* 
+ * CPML profile arrays for each axis - the recursive convolution coefficients, b and c,
+ * and the inverse of the stretching factor, kappa, at the primary (d) and secondary (h)
+ * grid nodes. Where the axis is not attenuated c is zero and the inverse kappa is one.
+ */
+static real *cbd[3];
+static real *ccd[3];
+static real *ikd[3];
+static real *cbh[3];
+static real *cch[3];
+static real *ikh[3];
+
+/* 
+ * PML block update kernels. A UPML update has two stages, the first applying the stretching
+ * along the next axis in cyclic order to the field component, e.g. y for Ex, and the second
+ * that along the other two axes. Where only one stage stretches the other is an identity
+ * and its auxiliary array is not needed. The magnetic field only has a second stage array
+ * so a block with second stage stretching always uses the full kernel.
+ */
+typedef enum {
+
+  PK_UPML,          // Both UPML stages.
+  PK_UPML_STAGE1,   // First UPML stage only.
+  PK_UPML_STAGE2,   // Second UPML stage only, electric field.
+  PK_CPML,          // CPML.
+  NUM_PML_KERNELS
+
+} PmlKernel;
+
+static char PML_KERNEL_STR[NUM_PML_KERNELS][8] = { "UPML" , "UPML-1" , "UPML-2" , "CPML" };
+
+/* 
+ * PML block - a box of one field component of a PML region in which the same axes are
+ * stretched, so that the PML is divided into disjoint face, edge and corner slabs. The
+ * auxiliary arrays are sized to the block and only those needed by its kernel are 
+ * allocated. For the UPML aux[0] holds PPx, or Bx for the magnetic field, and aux[1] 
+ * holds Px. For the CPML they hold the convolutions of the derivatives along the next 
+ * two axes in cyclic order, e.g. y and z for Ex.
+ */
+typedef struct PmlBlock_t {
+
+  int region;
+  FieldComponent field;
+  PmlKernel kernel;
+  int lim[6];
+  real ***aux[2];
+
+} PmlBlock;
+
+static PmlBlock *pmlBlocks = NULL;
+static int numPmlBlocks = 0;
+
+/* Memory used by the auxiliary arrays of the blocks and that UPML arrays spanning whole regions would need. */
+static unsigned long pmlAuxBytes = 0;
+static unsigned long pmlRegionBytes = 0;
+
+/* PML update task - a box of the pencils of a block. */
+typedef struct PmlTask_t {
+
+  PmlBlock *block;
+  int lim[6];
+
+} PmlTask;
+
+static PmlTask *pmlTasks[2] = { NULL , NULL };  // Electric and magnetic field update tasks.
+static int numPmlTasks[2] = { 0 , 0 };
+
+/* Blocks per thread for the cost balanced update - finer blocks give a closer balance. */
+#define PML_BALANCE_BLOCKS 4
+
+/* Blocks of the cost balanced update and their partition between the threads. */
+static PmlTask *pmlWork[2] = { NULL , NULL };
+static int numPmlWork[2] = { 0 , 0 };
+static WorkPartition pmlPartition[2];
+
+/* 
+ * Automatic PML selection. A PML given with no layers has its depth and profiles chosen
+ * as the thinnest meeting a target reflection coefficient over the frequency band.
+ */
+#define AUTO_PML_MAX_LAYERS 32        // Deepest PML considered.
+#define AUTO_PML_NUM_FREQS 16         // Number of frequencies sampled in the band.
+#define AUTO_PML_DEFAULT_TARGET 1e-3  // Target reflection coefficient if none given.
+#define AUTO_PML_MIN_GRADING 2        // Range of theoretical reflection coefficient exponents.
+#define AUTO_PML_MAX_GRADING 16
+#define AUTO_PML_MIN_ORDER 2          // Range of profile orders searched if none given.
+#define AUTO_PML_MAX_ORDER 4
+
+static real autoPmlKmax[] = { 1.0 , 2.0 , 5.0 , 10.0 };
+
+typedef struct PmlSelection_t {
+  bool isAuto;     // Parameters selected automatically.
+  real target;     // Target reflection coefficient.
+  real predicted;  // Largest predicted reflection coefficient in the band.
+  real lowFreq;    // Frequency band [Hz].
+  real highFreq;
+  real meshSize;   // Cell size normal to the face [m].
+} PmlSelection;
+
+static PmlSelection pmlSelection[6];
+
 /* 
  * Private method interfaces. 
  */
@@ -100,6 +197,64 @@ void setProfile( real *de , real *dh , int low , int high , int dir ,
                  real *ibd , real *ibh );
 real pmlSigmaProfile( real x , real totalDepth , real meshSize , int order , real n_eff , real refCoeff );
 real pmlKappaProfile( real x , real totalDepth , real meshSize , int order , real kmax );
+real pmlAlphaProfile( real x , real amax );
+bool isPmlFace( MeshFace face );
+void setCpmlProfile( real *de , real *dh , int low , int high , int dir , 
+                     int order , real n_eff , real refCoeff , real kmax , real amax ,
+                     real *bd , real *cd , real *kd , real *bh , real *ch , real *kh );
+void setCpmlCoefficients( real x , real totalDepth , real meshSize , real dt , int order , real n_eff , 
+                          real refCoeff , real kmax , real amax , real *b , real *c , real *ik );
+void initPmlBlocks( void );
+void firstTouchPmlBlockArray( real ***array , PmlBlock *block );
+int getPmlRuns( bool isCpml , CoordAxis axis , bool isHalf , int lo , int hi , int runs[3][2] , bool isStretched[3] );
+void updatePmlBlockTiled( PmlBlock *block );
+void updatePmlEfieldTiled( void );
+void updatePmlHfieldTiled( void );
+void getPmlSelectionBand( real meshSize , real dt , real n_eff , real *lowFreq , real *highFreq );
+double getPmlDiscreteReflection( bool isCpml , int numLayers , real meshSize , real dt , int order , real n_eff , 
+                                 real refCoeff , real kmax , real amax , real freq );
+double complex getPmlInverseStretch( bool isCpml , real x , int numLayers , real meshSize , real dt , int order , 
+                                     real n_eff , real refCoeff , real kmax , real amax , double complex z );
+
+/* Pencil update function of a PML block. */
+typedef void (*PmlPencilFunc)( PmlBlock *block , int i , int j , int klo , int khi );
+
+static void buildPmlTasks( int numParts , PmlTask *tasks[2] , int numTasks[2] );
+static void initPmlBalance( void );
+static void updatePmlBalanced( int isH );
+static void updatePmlExPencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updatePmlEyPencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updatePmlEzPencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updatePmlHxPencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updatePmlHyPencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updatePmlHzPencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updatePmlExStage1Pencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updatePmlEyStage1Pencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updatePmlEzStage1Pencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updatePmlHxStage1Pencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updatePmlHyStage1Pencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updatePmlHzStage1Pencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updatePmlExStage2Pencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updatePmlEyStage2Pencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updatePmlEzStage2Pencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updateCpmlExPencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updateCpmlEyPencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updateCpmlEzPencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updateCpmlHxPencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updateCpmlHyPencil( PmlBlock *block , int i , int j , int klo , int khi );
+static void updateCpmlHzPencil( PmlBlock *block , int i , int j , int klo , int khi );
+
+/* Pencil update functions indexed by kernel and field component. */
+static const PmlPencilFunc pmlPencil[NUM_PML_KERNELS][6] = 
+  { { updatePmlExPencil , updatePmlEyPencil , updatePmlEzPencil , 
+      updatePmlHxPencil , updatePmlHyPencil , updatePmlHzPencil } ,
+    { updatePmlExStage1Pencil , updatePmlEyStage1Pencil , updatePmlEzStage1Pencil , 
+      updatePmlHxStage1Pencil , updatePmlHyStage1Pencil , updatePmlHzStage1Pencil } ,
+    { updatePmlExStage2Pencil , updatePmlEyStage2Pencil , updatePmlEzStage2Pencil , 
+      NULL , NULL , NULL } ,
+    { updateCpmlExPencil , updateCpmlEyPencil , updateCpmlEzPencil , 
+      updateCpmlHxPencil , updateCpmlHyPencil , updateCpmlHzPencil } };
+
 /*
  * Method Implementations.
  */
@@ -119,12 +274,18 @@ void initPmlBoundaries( void )
   /* Initialise PML parameters to free space. */
   setPmlParameters();
 
+  /* Divide the PML regions into blocks and allocate their auxiliary arrays. */
+  initPmlBlocks();
+
   /* Carry materials on inner boundaries into PML.*/
   initPmlMaterialArrays();
 
   /* Clear the PML arrays. */
   clearPml();
 
+  /* Share the PML updates between the threads. */
+  initPmlBalance();
+
   return;
 
 }
@@ -188,7 +349,10 @@ void setPmlLimits( void )
 
   /* Field limits for PML regions. */
   for( MeshFace region = XLO ; region <= ZHI ; region++ )
+  {
     setFieldLimits( pbox[region] , fplim[region] , includeBoundary[region] );
+    clipFieldLimitsToDomain( fplim[region] );
+  }
 
   return;
 
@@ -298,6 +462,99 @@ real pmlKappaProfile( real x , real totalDepth , real meshSize , int order , rea
 
 }
 
+/* Complex frequency shift profile for CPML. x=0 is PML to internal space boundary and */
+/* x=1 is the PML to PEC boundary. */
+real pmlAlphaProfile( real x , real amax )
+{
+
+  /* Linear profile, largest at the internal boundary. */
+  return amax * ( 1.0 - x );
+
+}
+
+/* Determine if an external face is terminated by either type of PML. */
+bool isPmlFace( MeshFace face )
+{
+
+  return outerSurfaceType( face ) == BT_PML || outerSurfaceType( face ) == BT_CPML;
+
+}
+
+/* 
+ * Set the CPML recursive convolution coefficients and inverse stretching factor at 
+ * normalised depth x into the PML, see Roden and Gedney, "Convolution PML (CPML): An 
+ * efficient FDTD implementation of the CFS-PML for arbitrary media", Microwave Opt. 
+ * Technol. Lett., vol. 27, no. 5, pp. 334-339, 2000:
+ *
+ *   b = exp( -( sigma / kappa + alpha ) dt / eps0 )
+ *   c = sigma / ( sigma kappa + kappa^2 alpha ) ( b - 1 )
+ */
+void setCpmlCoefficients( real x , real totalDepth , real meshSize , real dt , int order , real n_eff , 
+                          real refCoeff , real kmax , real amax , real *b , real *c , real *ik )
+{
+
+  real sigma = pmlSigmaProfile( x , totalDepth , meshSize , order , n_eff , refCoeff );
+  real kappa = pmlKappaProfile( x , totalDepth , meshSize , order , kmax );
+  real alpha = pmlAlphaProfile( x , amax );
+
+  *b = exp( -( sigma / kappa + alpha ) * dt / eps0 );
+  if( sigma > 0.0 )
+    *c = sigma / ( sigma * kappa + kappa * kappa * alpha ) * ( *b - 1.0 );
+  else
+    *c = 0.0;
+  *ik = 1.0 / kappa;
+
+  return;
+
+}
+
+/* Set CPML parameter profiles in PML regions. The depths are sampled as in setProfile. */
+void setCpmlProfile( real *de , real *dh , int low , int high , int dir , 
+                     int order , real n_eff , real refCoeff , real kmax , real amax ,
+                     real *bd , real *cd , real *kd , real *bh , real *ch , real *kh )
+{
+
+  real total_depth = 0.0;
+  real depthE , depthH;
+  real dt = getGridTimeStep();
+  int i;
+
+  for ( i = low ; i <= high ; i++ )
+    total_depth =  total_depth + de[i];
+
+  if( dir == -1 )
+  {
+    depthE = total_depth;
+    depthH = total_depth - 0.5 * de[low];
+  }
+  else
+  {
+    depthE = 0.0;
+    depthH = 0.5 * de[low];
+  }
+
+  for ( i = low ; i <= high ; i++ )
+  {
+    setCpmlCoefficients( depthE / total_depth , total_depth , de[low] , dt , order , n_eff , refCoeff , 
+                         kmax , amax , &bd[i] , &cd[i] , &kd[i] );
+    depthE = depthE + dir * de[i];
+  }
+
+  if( dir == + 1 )
+    setCpmlCoefficients( depthE / total_depth , total_depth , de[low] , dt , order , n_eff , refCoeff , 
+                         kmax , amax , &bd[high+1] , &cd[high+1] , &kd[high+1] );
+
+  for ( i = low ; i <= high ; i++ )
+  {
+    setCpmlCoefficients( depthH / total_depth , total_depth , de[low] , dt , order , n_eff , refCoeff , 
+                         kmax , amax , &bh[i] , &ch[i] , &kh[i] );
+    depthH = depthH + dir * dh[i];
+  }
+
+  return;
+
+}
+
 /* Set PML grading parameters. */
 void setPmlParameters( void )
 {
@@ -306,7 +563,21 @@ void setPmlParameters( void )
   real n_eff;
   real refCoeff;
   real kmax;
+  real amax;
   
+  for( CoordAxis axis = XDIR ; axis <= ZDIR ; axis++ )
+  {
+    for ( int i = gobox[2*axis] - 1 ; i <= gobox[2*axis+1] ; i++ ) 
+    {
+      cbd[axis][i] = 1.0;
+      ccd[axis][i] = 0.0;
+      ikd[axis][i] = 1.0;
+      cbh[axis][i] = 1.0;
+      cch[axis][i] = 0.0;
+      ikh[axis][i] = 1.0;
+    }
+  }
+
   for ( int i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ ) 
   {
     kdx[i] = 1.0;
@@ -351,64 +622,82 @@ void setPmlParameters( void )
 
   
   /* Set up PML loss profiles for each face. */
-  if( outerSurfaceType( XLO ) == BT_PML )
+  if( isPmlFace( XLO ) )
   {
-    getOuterSurfaceParams( XLO , &order , &n_eff , &refCoeff , &kmax );
+    getOuterSurfaceParams( XLO , &order , &n_eff , &refCoeff , &kmax , &amax );
     message( MSG_DEBUG3 , 0 , "  Setting PML profile, XLO: order=%d n_eff=%e refCeoff=%e kmax=%e\n" , 
              order , n_eff , refCoeff , kmax );
     setProfile( dex , dhx  , gobox[XLO] , gibox[XLO] - 1 , -1 , 
                 order , n_eff , refCoeff , kmax ,
                 gdx , kdx , bdx , adx , ghx , khx , bhx , ahx , ibdx , ibhx );
+    setCpmlProfile( dex , dhx , gobox[XLO] , gibox[XLO] - 1 , -1 , 
+                    order , n_eff , refCoeff , kmax , amax ,
+                    cbd[XDIR] , ccd[XDIR] , ikd[XDIR] , cbh[XDIR] , cch[XDIR] , ikh[XDIR] );
   }
   
-  if( outerSurfaceType( XHI ) == BT_PML )
+  if( isPmlFace( XHI ) )
   {
-    getOuterSurfaceParams( XHI , &order , &n_eff , &refCoeff , &kmax );
+    getOuterSurfaceParams( XHI , &order , &n_eff , &refCoeff , &kmax , &amax );
     message( MSG_DEBUG3 , 0 , "  Setting PML profile, XHI: order=%d n_eff=%e refCeoff=%e kmax=%e\n" , 
              order , n_eff , refCoeff , kmax );
     setProfile( dex , dhx , gibox[XHI] , gobox[XHI] - 1 , +1 , 
                 order , n_eff , refCoeff , kmax ,
                 gdx , kdx , bdx , adx , ghx , khx , bhx , ahx , ibdx , ibhx );
+    setCpmlProfile( dex , dhx , gibox[XHI] , gobox[XHI] - 1 , +1 , 
+                    order , n_eff , refCoeff , kmax , amax ,
+                    cbd[XDIR] , ccd[XDIR] , ikd[XDIR] , cbh[XDIR] , cch[XDIR] , ikh[XDIR] );
   }
   
-  if( outerSurfaceType( YLO ) == BT_PML )
+  if( isPmlFace( YLO ) )
   {
-    getOuterSurfaceParams( YLO , &order , &n_eff , &refCoeff , &kmax );
+    getOuterSurfaceParams( YLO , &order , &n_eff , &refCoeff , &kmax , &amax );
     message( MSG_DEBUG3 , 0 , "  Setting PML profile, YLO: order=%d n_eff=%e refCeoff=%e kmax=%e\n" , 
              order , n_eff , refCoeff , kmax );
     setProfile( dey , dhy  , gobox[YLO] , gibox[YLO] - 1 , -1 , 
                 order , n_eff , refCoeff , kmax ,
                 gdy , kdy , bdy , ady , ghy , khy , bhy , ahy , ibdy , ibhy );
+    setCpmlProfile( dey , dhy , gobox[YLO] , gibox[YLO] - 1 , -1 , 
+                    order , n_eff , refCoeff , kmax , amax ,
+                    cbd[YDIR] , ccd[YDIR] , ikd[YDIR] , cbh[YDIR] , cch[YDIR] , ikh[YDIR] );
   }
   
-  if( outerSurfaceType( YHI ) == BT_PML )
+  if( isPmlFace( YHI ) )
   {
-    getOuterSurfaceParams( YHI , &order , &n_eff , &refCoeff , &kmax );
+    getOuterSurfaceParams( YHI , &order , &n_eff , &refCoeff , &kmax , &amax );
     message( MSG_DEBUG3 , 0 , "  Setting PML profile, YHI: order=%d n_eff=%e refCeoff=%e kmax=%e\n" , 
              order , n_eff , refCoeff , kmax );
     setProfile( dey , dhy , gibox[YHI] , gobox[YHI] - 1 , +1 , 
                 order , n_eff , refCoeff , kmax ,
                 gdy , kdy , bdy , ady , ghy , khy , bhy , ahy , ibdy , ibhy );
+    setCpmlProfile( dey , dhy , gibox[YHI] , gobox[YHI] - 1 , +1 , 
+                    order , n_eff , refCoeff , kmax , amax ,
+                    cbd[YDIR] , ccd[YDIR] , ikd[YDIR] , cbh[YDIR] , cch[YDIR] , ikh[YDIR] );
   }
   
-  if( outerSurfaceType( ZLO ) == BT_PML )
+  if( isPmlFace( ZLO ) )
   {
-    getOuterSurfaceParams( ZLO , &order , &n_eff , &refCoeff , &kmax );
+    getOuterSurfaceParams( ZLO , &order , &n_eff , &refCoeff , &kmax , &amax );
     message( MSG_DEBUG3 , 0 , "  Setting PML profile, ZLO: order=%d n_eff=%e refCeoff=%e kmax=%e\n" , 
              order , n_eff , refCoeff , kmax );
     setProfile( dez , dhz  , gobox[ZLO] , gibox[ZLO] - 1 , -1 , 
                 order , n_eff , refCoeff , kmax ,
                 gdz , kdz , bdz , adz , ghz , khz , bhz , ahz , ibdz , ibhz );
+    setCpmlProfile( dez , dhz , gobox[ZLO] , gibox[ZLO] - 1 , -1 , 
+                    order , n_eff , refCoeff , kmax , amax ,
+                    cbd[ZDIR] , ccd[ZDIR] , ikd[ZDIR] , cbh[ZDIR] , cch[ZDIR] , ikh[ZDIR] );
   }
   
-  if( outerSurfaceType( ZHI ) == BT_PML )
+  if( isPmlFace( ZHI ) )
   {
-    getOuterSurfaceParams( ZHI , &order , &n_eff , &refCoeff , &kmax );
+    getOuterSurfaceParams( ZHI , &order , &n_eff , &refCoeff , &kmax , &amax );
     message( MSG_DEBUG3 , 0 , "  Setting PML profile, ZHI: order=%d n_eff=%e refCeoff=%e kmax=%e\n" , 
              order , n_eff , refCoeff , kmax );
     setProfile( dez , dhz , gibox[ZHI] , gobox[ZHI] - 1 , +1 , 
                 order , n_eff , refCoeff , kmax ,
                 gdz , kdz , bdz , adz , ghz , khz , bhz , ahz , ibdz , ibhz );
+    setCpmlProfile( dez , dhz , gibox[ZHI] , gobox[ZHI] - 1 , +1 , 
+                    order , n_eff , refCoeff , kmax , amax ,
+                    cbd[ZDIR] , ccd[ZDIR] , ikd[ZDIR] , cbh[ZDIR] , cch[ZDIR] , ikh[ZDIR] );
   }
   
   message( MSG_DEBUG3 , 0 , "  PML profile, XDIR:\n" );
@@ -474,7 +763,10 @@ void initPmlMaterialArrays( void )
 
   /* Field limits for PML regions. */
   for( MeshFace region = XLO ; region <= ZHI ; region++ )
+  {
     setFieldLimits( pbox[region] , fpmlim[region] , includeBoundary[region] );
+    clipFieldLimitsToDomain( fpmlim[region] );
+  }
 
   /* Counters. */
   int i , j , k;
@@ -632,63 +924,10 @@ void initPmlMaterialArrays( void )
 void allocPmlArrays( void )
 {
 
-  int region;
   unsigned long bytes;
 
   message( MSG_LOG , 0 , "  Allocating PML arrays...\n" );
 
-  for( region = XLO ; region <= ZHI ; region++ )
-  {
-    if( outerSurfaceType( region ) == BT_PML )
-    {
-      message( MSG_DEBUG1 , 0 , "  Allocating grid PML Px[%s] array\n" , FACE[region] );
-      Px[region] = allocArray( &bytes , sizeof( real ) , 3 , fplim[region][EX][XHI] - fplim[region][EX][XLO] + 1 , 
-                                                        fplim[region][EX][YHI] - fplim[region][EX][YLO] + 1 , 
-                                                        fplim[region][EX][ZHI] - fplim[region][EX][ZLO] + 1 );
-      memory.pmlFields += bytes;
-      message( MSG_DEBUG1 , 0 , "  Allocating grid PML Py[%s] array\n" , FACE[region] );
-      Py[region] = allocArray( &bytes , sizeof( real ) , 3 , fplim[region][EY][XHI] - fplim[region][EY][XLO] + 1 , 
-                                                        fplim[region][EY][YHI] - fplim[region][EY][YLO] + 1 , 
-                                                        fplim[region][EY][ZHI] - fplim[region][EY][ZLO] + 1 );
-      memory.pmlFields += bytes;
-      message( MSG_DEBUG1 , 0 , "  Allocating grid PML Pz[%s] array\n" , FACE[region] );
-      Pz[region] = allocArray( &bytes , sizeof( real ) , 3 , fplim[region][EZ][XHI] - fplim[region][EZ][XLO] + 1 , 
-                                                        fplim[region][EZ][YHI] - fplim[region][EZ][YLO] + 1 , 
-                                                        fplim[region][EZ][ZHI] - fplim[region][EZ][ZLO] + 1 );
-      memory.pmlFields += bytes;
-      message( MSG_DEBUG1 , 0 , "  Allocating grid PML PPx[%s] array\n" , FACE[region] );
-      PPx[region] = allocArray( &bytes , sizeof( real ) , 3 , fplim[region][EX][XHI] - fplim[region][EX][XLO] + 1 , 
-                                                         fplim[region][EX][YHI] - fplim[region][EX][YLO] + 1 , 
-                                                         fplim[region][EX][ZHI] - fplim[region][EX][ZLO] + 1 );
-      memory.pmlFields += bytes;
-      message( MSG_DEBUG1 , 0 , "  Allocating grid PML PPy[%s] array\n" , FACE[region] );
-      PPy[region] = allocArray( &bytes , sizeof( real ) , 3 , fplim[region][EY][XHI] - fplim[region][EY][XLO] + 1 , 
-                                                         fplim[region][EY][YHI] - fplim[region][EY][YLO] + 1 , 
-                                                         fplim[region][EY][ZHI] - fplim[region][EY][ZLO] + 1 );
-      memory.pmlFields += bytes;
-      message( MSG_DEBUG1 , 0 , "  Allocating grid PML PPz[%s] array\n" , FACE[region] );
-      PPz[region] = allocArray( &bytes , sizeof( real ) , 3 , fplim[region][EZ][XHI] - fplim[region][EZ][XLO] + 1 , 
-                                                         fplim[region][EZ][YHI] - fplim[region][EZ][YLO] + 1 , 
-                                                         fplim[region][EZ][ZHI] - fplim[region][EZ][ZLO] + 1 );
-      memory.pmlFields += bytes;
-      message( MSG_DEBUG1 , 0 , "  Allocating grid PML Bx[%s] array\n" , FACE[region] );
-      Bx[region] = allocArray( &bytes , sizeof( real ) , 3 , fplim[region][HX][XHI] - fplim[region][HX][XLO] + 1 , 
-                                                        fplim[region][HX][YHI] - fplim[region][HX][YLO] + 1 , 
-                                                        fplim[region][HX][ZHI] - fplim[region][HX][ZLO] + 1 );
-      memory.pmlFields += bytes;
-      message( MSG_DEBUG1 , 0 , "  Allocating grid PML By[%s] array\n" , FACE[region] );
-      By[region] = allocArray( &bytes , sizeof( real ) , 3 , fplim[region][HY][XHI] - fplim[region][HY][XLO] + 1 , 
-                                                        fplim[region][HY][YHI] - fplim[region][HY][YLO] + 1 , 
-                                                        fplim[region][HY][ZHI] - fplim[region][HY][ZLO] + 1 );
-      memory.pmlFields += bytes;
-      message( MSG_DEBUG1 , 0 , "  Allocating grid PML Bz[%s] array\n" , FACE[region] );
-      Bz[region] = allocArray( &bytes , sizeof( real ) , 3 , fplim[region][HZ][XHI] - fplim[region][HZ][XLO] + 1 , 
-                                                        fplim[region][HZ][YHI] - fplim[region][HZ][YLO] + 1 , 
-                                                        fplim[region][HZ][ZHI] - fplim[region][HZ][ZLO] + 1 );
-      memory.pmlFields += bytes;
-    }
-  }
-
   message( MSG_DEBUG1 , 0 , "  Allocating grid PML adx array\n" );
   adx = allocArray( &bytes , sizeof( real ) , 1 , numCells[XDIR] );
   memory.pmlCoeffs += bytes;
@@ -782,73 +1021,246 @@ void allocPmlArrays( void )
   ibhz = allocArray( &bytes , sizeof( real ) , 1 , numCells[ZDIR] );
   memory.pmlCoeffs += bytes;
 
+  for( CoordAxis axis = XDIR ; axis <= ZDIR ; axis++ )
+  {
+    message( MSG_DEBUG1 , 0 , "  Allocating grid CPML %s profile arrays\n" , AXIS[axis] );
+    cbd[axis] = allocArray( &bytes , sizeof( real ) , 1 , numCells[axis] );
+    memory.pmlCoeffs += bytes;
+    ccd[axis] = allocArray( &bytes , sizeof( real ) , 1 , numCells[axis] );
+    memory.pmlCoeffs += bytes;
+    ikd[axis] = allocArray( &bytes , sizeof( real ) , 1 , numCells[axis] );
+    memory.pmlCoeffs += bytes;
+    cbh[axis] = allocArray( &bytes , sizeof( real ) , 1 , numCells[axis] );
+    memory.pmlCoeffs += bytes;
+    cch[axis] = allocArray( &bytes , sizeof( real ) , 1 , numCells[axis] );
+    memory.pmlCoeffs += bytes;
+    ikh[axis] = allocArray( &bytes , sizeof( real ) , 1 , numCells[axis] );
+    memory.pmlCoeffs += bytes;
+  }
+
   return;
 
 }
 
-/* Set initial PML field values. */
-void clearPml( void )
+/* First touch a PML auxiliary array with the decomposition of the PML update. */
+void firstTouchPmlBlockArray( real ***array , PmlBlock *block )
 {
 
-  int i , j , k;
+  int lim[6] = { 0 , block->lim[XHI] - block->lim[XLO] , 
+                 0 , block->lim[YHI] - block->lim[YLO] , 
+                 0 , block->lim[ZHI] - block->lim[ZLO] };
 
-  message( MSG_LOG , 0 , "  Clearing the PML...\n" );
+  firstTouchFieldArray( array , sizeof( real ) , lim );
 
-  /* Clear PML arrays. */
-  for( int region = XLO ; region <= ZHI ; region++ )
-  {
+  return;
 
-    for ( i = 0 ; i <= fplim[region][EX][XHI] - fplim[region][EX][XLO] ; i++ ) {
-      for ( j = 0 ; j <= fplim[region][EX][YHI] - fplim[region][EX][YLO] ; j++ ) {
-        for ( k = 0 ; k <= fplim[region][EX][ZHI] - fplim[region][EX][ZLO] ; k++ ) {
-          PPx[region][i][j][k] = INITIAL_FIELD_VALUE;
-          Px[region][i][j][k] = INITIAL_FIELD_VALUE;
-        }
-      }
-    }
+}
 
-    for ( i = 0 ; i <= fplim[region][EY][XHI] - fplim[region][EY][XLO] ; i++ ) {
-      for ( j = 0 ; j <= fplim[region][EY][YHI] - fplim[region][EY][YLO] ; j++ ) {
-        for ( k = 0 ; k <= fplim[region][EY][ZHI] - fplim[region][EY][ZLO] ; k++ ) {
-          PPy[region][i][j][k] = INITIAL_FIELD_VALUE;
-          Py[region][i][j][k] = INITIAL_FIELD_VALUE;
-        }
-      }
+/* 
+ * Split the range [lo,hi] of field positions along an axis into runs that are and are
+ * not stretched by the PML. Positions are at primary nodes, or at secondary nodes if 
+ * isHalf is true. Returns the number of runs, which is at most three - the low PML, the
+ * inner grid and the high PML.
+ */
+int getPmlRuns( bool isCpml , CoordAxis axis , bool isHalf , int lo , int hi , int runs[3][2] , bool isStretched[3] )
+{
+
+  real *bd[3] = { bdx , bdy , bdz };
+  real *bh[3] = { bhx , bhy , bhz };
+  real *c = isHalf ? cch[axis] : ccd[axis];
+  real *ik = isHalf ? ikh[axis] : ikd[axis];
+  real *b = isHalf ? bh[axis] : bd[axis];
+  bool flag;
+  int numRuns = 0;
+
+  for( int i = lo ; i <= hi ; i++ )
+  {
+    if( isCpml )
+      flag = ( c[i] != 0.0 || ik[i] != 1.0 );
+    else
+      flag = ( b[i] != 1.0 );
+    if( numRuns == 0 || flag != isStretched[numRuns-1] )
+    {
+      assert( numRuns < 3 );
+      runs[numRuns][0] = i;
+      isStretched[numRuns] = flag;
+      numRuns++;
     }
+    runs[numRuns-1][1] = i;
+  }
+
+  return numRuns;
 
-    for ( i = 0 ; i <= fplim[region][EZ][XHI] - fplim[region][EZ][XLO] ; i++ ) {
-      for ( j = 0 ; j <= fplim[region][EZ][YHI] - fplim[region][EZ][YLO] ; j++ ) {
-        for ( k = 0 ; k <= fplim[region][EZ][ZHI] - fplim[region][EZ][ZLO] ; k++ ) {
-          PPz[region][i][j][k] = INITIAL_FIELD_VALUE;
-          Pz[region][i][j][k] = INITIAL_FIELD_VALUE;
+}
+
+/* 
+ * Divide the field limits of each component in the PML regions into blocks in which the
+ * same axes are stretched and select the kernel and auxiliary arrays each block needs.
+ * The CPML blocks are only divided along the two derivative axes of the component.
+ */
+void initPmlBlocks( void )
+{
+
+  unsigned long bytes;
+  int lim[6];
+  int runs[3][3][2];
+  bool isStretched[3][3];
+  int numRuns[3];
+  int run[3];
+  bool isCpml;
+  bool isMagnetic;
+  bool isStage1;
+  bool isStage2;
+  bool needAux[2];
+  CoordAxis axis0 , axis1 , axis2;
+  PmlBlock *block;
+  int count;
+
+  for( int pass = 0 ; pass <= 1 ; pass++ )
+  {
+    count = 0;
+    for( int region = XLO ; region <= ZHI ; region++ )
+    {
+      /* Only the regions, or parts of regions, in the domain. */
+      for( int face = XLO ; face <= ZHI ; face++ )
+        lim[face] = pbox[region][face];
+      if( !isPmlFace( region ) || !clipToDomain( lim ) )
+        continue;
+      isCpml = ( outerSurfaceType( region ) == BT_CPML );
+
+      for( FieldComponent field = EX ; field <= HZ ; field++ )
+      {
+        int *flim = fplim[region][field];
+        if( flim[XHI] < flim[XLO] || flim[YHI] < flim[YLO] || flim[ZHI] < flim[ZLO] )
+          continue;
+        isMagnetic = ( field >= HX );
+        axis0 = field % 3;
+        axis1 = ( axis0 + 1 ) % 3;
+        axis2 = ( axis0 + 2 ) % 3;
+
+        /* The component's own axis is at secondary nodes for the electric field and at */
+        /* primary nodes for the magnetic field; the other two axes are the opposite. */
+        for( CoordAxis axis = XDIR ; axis <= ZDIR ; axis++ )
+        {
+          if( isCpml && axis == axis0 )
+          {
+            numRuns[axis] = 1;
+            runs[axis][0][0] = flim[2*axis];
+            runs[axis][0][1] = flim[2*axis+1];
+            isStretched[axis][0] = false;
+          }
+          else
+          {
+            numRuns[axis] = getPmlRuns( isCpml , axis , ( axis == axis0 ) != isMagnetic , flim[2*axis] , flim[2*axis+1] , 
+                                        runs[axis] , isStretched[axis] );
+          }
         }
-      }
-    }
 
-    for ( i = 0 ; i <= fplim[region][HX][XHI] - fplim[region][HX][XLO] ; i++ ) {
-      for ( j = 0 ; j <= fplim[region][HX][YHI] - fplim[region][HX][YLO] ; j++ ) {
-        for ( k = 0 ; k <= fplim[region][HX][ZHI] - fplim[region][HX][ZLO] ; k++ ) {
-          Bx[region][i][j][k] = INITIAL_FIELD_VALUE;
+        if( pass == 0 )
+        {
+          count += numRuns[XDIR] * numRuns[YDIR] * numRuns[ZDIR];
+          pmlRegionBytes += ( isMagnetic ? 1 : 2 ) * sizeof( real ) * ( flim[XHI] - flim[XLO] + 1 ) 
+            * ( flim[YHI] - flim[YLO] + 1 ) * ( flim[ZHI] - flim[ZLO] + 1 );
+          continue;
         }
-      }
-    }
 
-    for ( i = 0 ; i <= fplim[region][HY][XHI] - fplim[region][HY][XLO] ; i++ ) {
-      for ( j = 0 ; j <= fplim[region][HY][YHI] - fplim[region][HY][YLO] ; j++ ) {
-        for ( k = 0 ; k <= fplim[region][HY][ZHI] - fplim[region][HY][ZLO] ; k++ ) {
-          By[region][i][j][k] = INITIAL_FIELD_VALUE;
+        for( run[XDIR] = 0 ; run[XDIR] < numRuns[XDIR] ; run[XDIR]++ )
+        {
+          for( run[YDIR] = 0 ; run[YDIR] < numRuns[YDIR] ; run[YDIR]++ )
+          {
+            for( run[ZDIR] = 0 ; run[ZDIR] < numRuns[ZDIR] ; run[ZDIR]++ , count++ )
+            {
+              block = &pmlBlocks[count];
+              block->region = region;
+              block->field = field;
+              for( CoordAxis axis = XDIR ; axis <= ZDIR ; axis++ )
+              {
+                block->lim[2*axis] = runs[axis][run[axis]][0];
+                block->lim[2*axis+1] = runs[axis][run[axis]][1];
+              }
+
+              isStage1 = isStretched[axis1][run[axis1]];
+              isStage2 = isStretched[axis2][run[axis2]] || isStretched[axis0][run[axis0]];
+              if( isCpml )
+              {
+                block->kernel = PK_CPML;
+                needAux[0] = isStretched[axis1][run[axis1]];
+                needAux[1] = isStretched[axis2][run[axis2]];
+              }
+              else if( isStage2 && ( isStage1 || isMagnetic ) )
+              {
+                block->kernel = PK_UPML;
+                needAux[0] = true;
+                needAux[1] = !isMagnetic;
+              }
+              else if( isStage2 )
+              {
+                block->kernel = PK_UPML_STAGE2;
+                needAux[0] = true;
+                needAux[1] = false;
+              }
+              else
+              {
+                block->kernel = PK_UPML_STAGE1;
+                needAux[0] = !isMagnetic;
+                needAux[1] = false;
+              }
+
+              for( int term = 0 ; term <= 1 ; term++ )
+              {
+                block->aux[term] = NULL;
+                if( needAux[term] )
+                {
+                  message( MSG_DEBUG1 , 0 , "  Allocating grid PML %s[%s] block %d array %d\n" , 
+                           FIELD[field] , FACE[region] , count , term );
+                  block->aux[term] = allocFieldArray( &bytes , sizeof( real ) , block->lim[XHI] - block->lim[XLO] + 1 , 
+                                                                                block->lim[YHI] - block->lim[YLO] + 1 , 
+                                                                                block->lim[ZHI] - block->lim[ZLO] + 1 );
+                  memory.pmlFields += bytes;
+                  pmlAuxBytes += bytes;
+                  /* Place the pages of the arrays in memory local to the threads that update them. */
+                  firstTouchPmlBlockArray( block->aux[term] , block );
+                }
+              }
+            }
+          }
         }
       }
     }
 
-    for ( i = 0 ; i <= fplim[region][HZ][XHI] - fplim[region][HZ][XLO] ; i++ ) {
-      for ( j = 0 ; j <= fplim[region][HZ][YHI] - fplim[region][HZ][YLO] ; j++ ) {
-        for ( k = 0 ; k <= fplim[region][HZ][ZHI] - fplim[region][HZ][ZLO] ; k++ ) {
-          Bz[region][i][j][k] = INITIAL_FIELD_VALUE;
-        }
-      }
+    if( pass == 0 && count > 0 )
+    {
+      pmlBlocks = allocArray( &bytes , sizeof( PmlBlock ) , 1 , count );
+      memory.pmlCoeffs += bytes;
     }
+  }
+
+  numPmlBlocks = count;
+
+  return;
+
+}
 
+/* Set initial PML field values. */
+void clearPml( void )
+{
+
+  int i , j , k;
+
+  message( MSG_LOG , 0 , "  Clearing the PML...\n" );
+
+  /* Clear the auxiliary arrays of the blocks. */
+  for( int block = 0 ; block < numPmlBlocks ; block++ )
+  {
+    for( int term = 0 ; term <= 1 ; term++ )
+    {
+      if( pmlBlocks[block].aux[term] == NULL )
+        continue;
+      for ( i = 0 ; i <= pmlBlocks[block].lim[XHI] - pmlBlocks[block].lim[XLO] ; i++ )
+        for ( j = 0 ; j <= pmlBlocks[block].lim[YHI] - pmlBlocks[block].lim[YLO] ; j++ )
+          for ( k = 0 ; k <= pmlBlocks[block].lim[ZHI] - pmlBlocks[block].lim[ZLO] ; k++ )
+            pmlBlocks[block].aux[term][i][j][k] = INITIAL_FIELD_VALUE;
+    }
   }
 
   return;
@@ -859,164 +1271,17 @@ void clearPml( void )
 void updatePmlEfield( void )
 {
 
-  int i , j , k , region;
-  int ir , jr , kr;
-  int *fplim_rf;
-  real **Ex_i, **Ey_i, **Ez_i, **Hx_i, **Hy_i, **Hz_i;
-  real *Ex_ij, *Ey_ij, *Ez_ij, *Hx_ij, *Hy_ij, *Hz_ij;
-  real **Hz_i1 , **Hy_i1 , *Hz_ij1 , *Hz_i1j , *Hy_i1j , *Hx_ij1;
-  real **Px_i, **Py_i, **Pz_i;
-  real *Px_ij, *Py_ij, *Pz_ij;
-  real **PPx_i, **PPy_i, **PPz_i;
-  real *PPx_ij, *PPy_ij, *PPz_ij;
-  real ahx_i, ibhx_i , ady_j, bdy_j;
-  real adx_i , bdx_i , ahy_j , ibhy_j;
-
-  /* Temporary storage for field arrays. */
-  real oldPx, oldPy, oldPz, oldPPx, oldPPy, oldPPz;
+  if( getGridKernel() == GK_TILED )
+  {
+    updatePmlEfieldTiled();
+    return;
+  }
 
   /* Since the 6 PML regions do not coincide with the boundaries of each face we cannot */
   /* easily check which loops to run from the border flags. The update of the PML is */
-  /* therefore controlled by the array limits only. */
-  for( region = XLO ; region <= ZHI ; region++ )
-  {
- 
-    if( Px[region] != NULL )
-    {
-
-      /* Update Ex from H, PPx and Px. */
-      fplim_rf = fplim[region][EX];
-      #ifdef WITH_OPENMP
-        #pragma omp parallel for private( i , j , k , ir , jr , kr , Ex_i , Ex_ij , Hy_i , Hy_ij , Hz_i , Hz_ij , Hz_ij1 , Px_i , Px_ij , PPx_i , PPx_ij , oldPx , oldPPx , ahx_i, ibhx_i , ady_j, bdy_j )
-      #endif
-      for ( i = fplim_rf[XLO] ; i <= fplim_rf[XHI] ; i++ ) 
-      {
-        ir = i - fplim_rf[XLO];
-        Ex_i = Ex[i];
-        Hy_i = Hy[i];
-        Hz_i = Hz[i];
-        Px_i = Px[region][ir];
-        PPx_i = PPx[region][ir];
-        ahx_i = ahx[i];  
-        ibhx_i = ibhx[i];
-        for ( j = fplim_rf[YLO] ; j <= fplim_rf[YHI] ; j++ ) 
-        {
-          jr = j - fplim_rf[YLO];
-          Ex_ij = Ex_i[j];
-          Hy_ij = Hy_i[j];
-          Hz_ij = Hz_i[j];
-          Hz_ij1 = Hz_i[j-1];
-          Px_ij = Px_i[jr];
-          PPx_ij = PPx_i[jr];
-          ady_j = ady[j];
-          bdy_j = bdy[j];
-          for ( k = fplim_rf[ZLO] ; k <= fplim_rf[ZHI] ; k++ ) 
-          {
-            kr = k - fplim_rf[ZLO];
-            oldPPx = PPx_ij[kr];
-            PPx_ij[kr] = ALPHA_EX(i,j,k) * PPx_ij[kr] + BETA_EX(i,j,k) 
-              * curl_Hx( Hz_ij[k] , Hz_ij1[k] , Hy_ij[k-1] , Hy_ij[k] , i , j , k );
-            oldPx = Px_ij[kr];
-            Px_ij[kr] = ady_j * Px_ij[kr] + bdy_j * ( PPx_ij[kr] - oldPPx );
-	    CHECK_NOT_VISITED( Ex_ij[k] );
-	    Ex_ij[k] = adz[k] * Ex_ij[k] + bdz[k] * ibhx_i * ( Px_ij[kr] - ahx_i * oldPx );
-	    MARK_AS_VISITED( Ex_ij[k] ); 
-	  } // for k
-        } // for j
-      } // for i
-    } // if
-    
-    /* Update Ey from H, PPy and Py. */
-    if( Py[region] != NULL )
-    {
-      fplim_rf = fplim[region][EY]; 
-      #ifdef WITH_OPENMP
-        #pragma omp parallel for private( i , j , k , ir , jr , kr , Ey_i , Ey_ij , Hx_i , Hx_ij , Hz_i , Hz_ij , Hz_i1 , Hz_i1j , Py_i , Py_ij , PPy_i , PPy_ij , oldPy , oldPPy , adx_i , bdx_i , ahy_j , ibhy_j )
-      #endif
-      for ( i = fplim_rf[XLO] ; i <= fplim_rf[XHI] ; i++ ) 
-      {
-        ir = i - fplim_rf[XLO];
-        Ey_i = Ey[i];
-        Hx_i = Hx[i];
-        Hz_i = Hz[i];
-        Hz_i1 = Hz[i-1];
-        Py_i = Py[region][ir];
-        PPy_i = PPy[region][ir];
-        adx_i = adx[i];
-        bdx_i = bdx[i];
-        for ( j = fplim_rf[YLO] ; j <= fplim_rf[YHI] ; j++ ) 
-        {
-          jr = j - fplim_rf[YLO];
-          Ey_ij = Ey_i[j];
-          Hx_ij = Hx_i[j];
-          Hz_ij = Hz_i[j];  
-          Hz_i1j = Hz_i1[j];
-          Py_ij = Py_i[jr];
-          PPy_ij = PPy_i[jr];
-          ahy_j = ahy[j];
-          ibhy_j = ibhy[j];
-          for ( k = fplim_rf[ZLO] ; k <= fplim_rf[ZHI] ; k++ ) 
-	  {
-            kr = k - fplim_rf[ZLO];
-            oldPPy = PPy_ij[kr];
-            PPy_ij[kr] = ALPHA_EY(i,j,k) * PPy_ij[kr] + BETA_EY(i,j,k)
-	      * curl_Hy( Hx_ij[k] , Hx_ij[k-1] , Hz_i1j[k] , Hz_ij[k] , i , j , k );
-            oldPy = Py_ij[kr];
-            Py_ij[kr] = adz[k] * Py_ij[kr] + bdz[k] * ( PPy_ij[kr] - oldPPy );
-	    CHECK_NOT_VISITED( Ey_ij[k] );
-	    Ey_ij[k] = adx_i * Ey_ij[k] + bdx_i * ibhy_j * ( Py_ij[kr] - ahy_j * oldPy );
-	    MARK_AS_VISITED( Ey_ij[k] ); 
-	  } // for k
-        } // for j
-      } // for i
-    } // if
-    
-    /* Update Ez from H, PPz and Pz. */
-    if( Pz[region] != NULL )
-      {
-      fplim_rf = fplim[region][EZ]; 
-      #ifdef WITH_OPENMP
-        #pragma omp parallel for private( i , j , k , ir , jr , kr , Ez_i , Ez_ij , Hx_i , Hx_ij , Hy_i , Hy_ij , Hy_i1 , Hy_i1j , Hx_ij1 , Pz_i , Pz_ij , PPz_i , PPz_ij , oldPz , oldPPz , adx_i , bdx_i , ady_j , bdy_j )
-      #endif
-      for ( i = fplim_rf[XLO] ; i <= fplim_rf[XHI] ; i++ ) 
-      {
-        ir = i - fplim_rf[XLO];
-        Ez_i = Ez[i];
-        Hx_i = Hx[i];
-        Hy_i = Hy[i];
-        Hy_i1 = Hy[i-1];
-        Pz_i = Pz[region][ir];
-        PPz_i = PPz[region][ir];
-        adx_i = adx[i];
-        bdx_i = bdx[i];
-        for ( j = fplim_rf[YLO] ; j <= fplim_rf[YHI] ; j++ ) 
-        {
-          jr = j - fplim_rf[YLO];
-          Ez_ij = Ez_i[j];
-          Hx_ij = Hx_i[j];
-          Hy_ij = Hy_i[j];       
-          Hy_i1j = Hy_i1[j];
-          Hx_ij1 = Hx_i[j-1];
-          Pz_ij = Pz_i[jr];
-          PPz_ij = PPz_i[jr];
-          ady_j = ady[j];
-          bdy_j = bdy[j];
-          for ( k = fplim_rf[ZLO] ; k <= fplim_rf[ZHI] ; k++ ) 
-	  {
-            kr = k - fplim_rf[ZLO];
-            oldPPz = PPz_ij[kr];
-            PPz_ij[kr] = ALPHA_EZ(i,j,k) * PPz_ij[kr] + BETA_EZ(i,j,k)
-     	      * curl_Hz( Hy_ij[k] , Hy_i1j[k] , Hx_ij1[k] , Hx_ij[k] , i , j , k );
-            oldPz = Pz_ij[kr];
-            Pz_ij[kr] = adx_i * Pz_ij[kr] + bdx_i * ( PPz_ij[kr] - oldPPz );
-	    CHECK_NOT_VISITED( Ez_ij[k] );
-	    Ez_ij[k] = ady_j * Ez_ij[k] + bdy_j * ibhz[k] * ( Pz_ij[kr] - ahz[k] * oldPz );
-	    MARK_AS_VISITED( Ez_ij[k] ); 
-	  } // for i
-        } // for j
-      } // for i
-    } // if
-  }
+  /* therefore controlled by the array limits only. The blocks of all the regions are */
+  /* updated together so that small regions do not leave threads idle. */
+  updatePmlBalanced( 0 );
 
   return;
 
@@ -1026,225 +1291,1166 @@ void updatePmlEfield( void )
 void updatePmlHfield( void )
 {
 
-  int i , j , k , region;
-  int ir , jr , kr;
-  int *fplim_rf;
-  real **Ex_i, **Ey_i, **Ez_i, **Hx_i, **Hy_i, **Hz_i;
-  real *Ex_ij, *Ey_ij, *Ez_ij, *Hx_ij, *Hy_ij, *Hz_ij;
-  real **Ez_i1 , **Ey_i1 , *Ez_ij1 , *Ez_i1j , *Ex_ij1 , *Ey_i1j;
-  real **Bx_i, **By_i, **Bz_i;
-  real *Bx_ij, *By_ij, *Bz_ij;
-  real ahy_j , bhy_j , adx_i , ibdx_i;
-  real ahx_i , bhx_i , ady_j , ibdy_j;
-  
-  /* Temporary storage for field arrays. */
-  real oldBx, oldBy, oldBz; 
+  if( getGridKernel() == GK_TILED )
+  {
+    updatePmlHfieldTiled();
+    return;
+  }
 
   /* Since the 6 PML regions do not coincide with the boundaries of each face we cannot */
   /* easily check which loops to run from the border flags. The update of the PML is */
-  /* therefore controlled by the array limits only. */
-  for( region = XLO ; region <= ZHI ; region++ )
+  /* therefore controlled by the array limits only. The blocks of all the regions are */
+  /* updated together so that small regions do not leave threads idle. */
+  updatePmlBalanced( 1 );
+
+  return;
+
+}
+
+/* 
+ * Pencil update kernels.
+ *
+ * Each updates one field component of a PML block along k in [klo,khi] for
+ * fixed (i,j). When the SIMD kernels are available the pencil of a block with
+ * both UPML stages is passed to the kernel selected for the processor.
+ */
+
+/* Update Ex along a k-pencil of a UPML block. */
+static void updatePmlExPencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  int *blim = block->lim;
+  int ir = i - blim[XLO];
+  int jr = j - blim[YLO];
+  int kr;
+  real *Ex_ij = Ex[i][j];
+  real *Hy_ij = Hy[i][j];
+  real *Hz_ij = Hz[i][j];
+  real *Hz_ij1 = Hz[i][j-1];
+  real *Px_ij = block->aux[1][ir][jr];
+  real *PPx_ij = block->aux[0][ir][jr];
+  real ahx_i = ahx[i];
+  real ibhx_i = ibhx[i];
+  real ady_j = ady[j];
+  real bdy_j = bdy[j];
+
+#ifdef USE_SIMD_KERNELS
+
+  kr = klo - blim[ZLO];
+  simdKernels->updatePmlEx( khi - klo + 1 , &Ex_ij[klo] , &PPx_ij[kr] , &Px_ij[kr] , &alphaEx[i][j][klo] , &betaEx[i][j][klo] ,
+                            idhy[j] , &Hz_ij[klo] , &Hz_ij1[klo] , &idhz[klo] , &Hy_ij[klo-1] , &Hy_ij[klo] ,
+                            ady_j , bdy_j , &adz[klo] , &bdz[klo] , ibhx_i , ahx_i );
+
+#else
+
+  real oldPx , oldPPx;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
   {
+    kr = k - blim[ZLO];
+    oldPPx = PPx_ij[kr];
+    PPx_ij[kr] = ALPHA_EX(i,j,k) * PPx_ij[kr] + BETA_EX(i,j,k) 
+      * curl_Hx( Hz_ij[k] , Hz_ij1[k] , Hy_ij[k-1] , Hy_ij[k] , i , j , k );
+    oldPx = Px_ij[kr];
+    Px_ij[kr] = ady_j * Px_ij[kr] + bdy_j * ( PPx_ij[kr] - oldPPx );
+    CHECK_NOT_VISITED( Ex_ij[k] );
+    Ex_ij[k] = adz[k] * Ex_ij[k] + bdz[k] * ibhx_i * ( Px_ij[kr] - ahx_i * oldPx );
+    MARK_AS_VISITED( Ex_ij[k] ); 
+  }
 
-    /* Update Hx from E and Bx. */
-    if( Bx[region] != NULL )
-    {
-      fplim_rf = fplim[region][HX];
-      #ifdef WITH_OPENMP
-        #pragma omp parallel for private( i , j , k , ir , jr , kr , Ey_i , Ey_ij , Ez_i , Ez_ij , Hx_i , Hx_ij , Ez_ij1 , Bx_i , Bx_ij , oldBx , ahy_j , bhy_j , adx_i , ibdx_i )
-      #endif
-      for ( i = fplim_rf[XLO] ; i <= fplim_rf[XHI] ; i++ ) 
-      {
-        ir = i - fplim_rf[XLO];
-        Hx_i = Hx[i];
-        Ey_i = Ey[i];
-        Ez_i = Ez[i];
-        Bx_i = Bx[region][ir];
-        adx_i = adx[i];
-        ibdx_i = ibdx[i];
-        for ( j = fplim_rf[YLO] ; j <= fplim_rf[YHI] ; j++ ) 
-        {
-          jr = j - fplim_rf[YLO];
-          Hx_ij = Hx_i[j];
-          Ey_ij = Ey_i[j];
-          Ez_ij = Ez_i[j];   
-          Ez_ij1 = Ez_i[j+1];
-          Bx_ij = Bx_i[jr];
-          ahy_j = ahy[j];
-          bhy_j = bhy[j];
-          for ( k = fplim_rf[ZLO] ; k <= fplim_rf[ZHI] ; k++ ) 
-	  {
-            kr = k - fplim_rf[ZLO];
-            oldBx = Bx_ij[kr];
-            Bx_ij[kr] = ahy_j * Bx_ij[kr] + GAMMA_HX(i,j,k) * bhy_j
-      	      * curl_Ex( Ey_ij[k+1] , Ey_ij[k] , Ez_ij[k] , Ez_ij1[k] , i , j , k ); 
-	    CHECK_NOT_VISITED( Hx_ij[k] );
-            Hx_ij[k] = ahz[k] * Hx_ij[k] + bhz[k] * ibdx_i * ( Bx_ij[kr] - adx_i * oldBx );
-	    MARK_AS_VISITED( Hx_ij[k] ); 
-	  } // for k
-        } // for j
-      } // for i
-    } // if
-    
-    /* Update Hy from E and By. */
-    if( By[region] != NULL )
-    {
-      fplim_rf = fplim[region][HY];
-      #ifdef WITH_OPENMP
-        #pragma omp parallel for private( i , j , k , ir , jr , kr , Ex_i , Ex_ij , Ez_i , Ez_ij , Hy_i , Hy_ij , Ez_i1 , Ez_i1j , By_i , By_ij , oldBy , ahx_i , bhx_i , ady_j , ibdy_j )
-      #endif
-      for ( i = fplim_rf[XLO] ; i <= fplim_rf[XHI] ; i++ ) 
-      {
-        ir = i - fplim_rf[XLO];
-        Hy_i = Hy[i];
-        Ex_i = Ex[i];
-        Ez_i = Ez[i];
-        Ez_i1 = Ez[i+1];
-        By_i = By[region][ir];   
-        ahx_i = ahx[i];
-        bhx_i = bhx[i];
-        for ( j = fplim_rf[YLO] ; j <= fplim_rf[YHI] ; j++ ) 
-        {
-          jr = j - fplim_rf[YLO];
-          Hy_ij = Hy_i[j];
-          Ex_ij = Ex_i[j];
-          Ez_ij = Ez_i[j];   
-          Ez_i1j = Ez_i1[j];
-          By_ij = By_i[jr];
-          ady_j = ady[j];
-          ibdy_j = ibdy[j];
-          for ( k = fplim_rf[ZLO] ; k <= fplim_rf[ZHI] ; k++ ) 
-	  {
-            kr = k - fplim_rf[ZLO];
-            oldBy = By_ij[kr];
-            By_ij[kr] = ahz[k] * By_ij[kr] + GAMMA_HY(i,j,k) * bhz[k]
-    	      * curl_Ey( Ez_i1j[k] , Ez_ij[k] , Ex_ij[k] , Ex_ij[k+1] , i , j , k );
-	    CHECK_NOT_VISITED( Hy_ij[k] );
-	    Hy_ij[k] = ahx_i * Hy_ij[k] + bhx_i * ibdy_j * ( By_ij[kr] - ady_j * oldBy );
-	    MARK_AS_VISITED( Hy_ij[k] ); 
-  	  } // for k
-        } // for j
-      } // for i
-    } // if
-    
-    /* Update Hz from E and Bz. */
-    if( Bz[region] != NULL )
-    {
-      fplim_rf = fplim[region][HZ];
-      #ifdef WITH_OPENMP
-        #pragma omp parallel for private( i , j , k , ir , jr , kr , Ex_i , Ex_ij , Ey_i , Ey_ij , Hz_i , Hz_ij , Ex_ij1 , Ey_i1 , Ey_i1j , Bz_i , Bz_ij , oldBz , ahx_i , bhx_i , ahy_j , bhy_j )
-      #endif
-      for ( i = fplim_rf[XLO] ; i <= fplim_rf[XHI] ; i++ ) 
-      {
-        ir = i - fplim_rf[XLO];
-        Hz_i = Hz[i];
-        Ex_i = Ex[i];
-        Ey_i = Ey[i];
-        Ey_i1 = Ey[i+1];
-        Bz_i = Bz[region][ir];
-        ahx_i = ahx[i];
-        bhx_i = bhx[i];
-        for ( j = fplim_rf[YLO] ; j <= fplim_rf[YHI] ; j++ ) 
-        {
-          jr = j - fplim_rf[YLO];
-          Hz_ij = Hz_i[j];
-          Ex_ij = Ex_i[j];
-          Ey_ij = Ey_i[j];   
-          Ex_ij1 = Ex_i[j+1];
-          Ey_i1j = Ey_i1[j];
-          Bz_ij = Bz_i[jr];
-          ahy_j = ahy[j];
-          bhy_j = bhy[j];
-          for ( k = fplim_rf[ZLO] ; k <= fplim_rf[ZHI] ; k++ ) 
-  	  {
-            kr = k - fplim_rf[ZLO];
-            oldBz = Bz_ij[kr];
-            Bz_ij[kr] = ahx_i * Bz_ij[kr] + GAMMA_HZ(i,j,k) * bhx_i
- 	      * curl_Ez( Ex_ij1[k] , Ex_ij[k] , Ey_ij[k] , Ey_i1j[k] , i , j , k );   
-	    CHECK_NOT_VISITED( Hz_ij[k] );
-	    Hz_ij[k] = ahy_j * Hz_ij[k] + bhy_j * ibdz[k] * ( Bz_ij[kr] - adz[k] * oldBz );
-	    MARK_AS_VISITED( Hz_ij[k] ); 
-	  } // for k
-        } // for j
-      } // for i 
-    } // if
+#endif
+
+  return;
+
+}
+
+/* Update Ey along a k-pencil of a UPML block. */
+static void updatePmlEyPencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
 
+  int *blim = block->lim;
+  int ir = i - blim[XLO];
+  int jr = j - blim[YLO];
+  int kr;
+  real *Ey_ij = Ey[i][j];
+  real *Hx_ij = Hx[i][j];
+  real *Hz_ij = Hz[i][j];
+  real *Hz_i1j = Hz[i-1][j];
+  real *Py_ij = block->aux[1][ir][jr];
+  real *PPy_ij = block->aux[0][ir][jr];
+  real adx_i = adx[i];
+  real bdx_i = bdx[i];
+  real ahy_j = ahy[j];
+  real ibhy_j = ibhy[j];
+
+#ifdef USE_SIMD_KERNELS
+
+  kr = klo - blim[ZLO];
+  simdKernels->updatePmlEy( khi - klo + 1 , &Ey_ij[klo] , &PPy_ij[kr] , &Py_ij[kr] , &alphaEy[i][j][klo] , &betaEy[i][j][klo] ,
+                            idhx[i] , &Hz_i1j[klo] , &Hz_ij[klo] , &idhz[klo] , &Hx_ij[klo] , &Hx_ij[klo-1] ,
+                            &adz[klo] , &bdz[klo] , adx_i , bdx_i , ibhy_j , ahy_j );
+
+#else
+
+  real oldPy , oldPPy;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    kr = k - blim[ZLO];
+    oldPPy = PPy_ij[kr];
+    PPy_ij[kr] = ALPHA_EY(i,j,k) * PPy_ij[kr] + BETA_EY(i,j,k)
+      * curl_Hy( Hx_ij[k] , Hx_ij[k-1] , Hz_i1j[k] , Hz_ij[k] , i , j , k );
+    oldPy = Py_ij[kr];
+    Py_ij[kr] = adz[k] * Py_ij[kr] + bdz[k] * ( PPy_ij[kr] - oldPPy );
+    CHECK_NOT_VISITED( Ey_ij[k] );
+    Ey_ij[k] = adx_i * Ey_ij[k] + bdx_i * ibhy_j * ( Py_ij[kr] - ahy_j * oldPy );
+    MARK_AS_VISITED( Ey_ij[k] ); 
   }
 
+#endif
+
   return;
 
 }
 
-/* Deallocate PML arrays. */
-void deallocPmlArrays( void )
+/* Update Ez along a k-pencil of a UPML block. */
+static void updatePmlEzPencil( PmlBlock *block , int i , int j , int klo , int khi )
 {
 
-  int region;
+  int *blim = block->lim;
+  int ir = i - blim[XLO];
+  int jr = j - blim[YLO];
+  int kr;
+  real *Ez_ij = Ez[i][j];
+  real *Hx_ij = Hx[i][j];
+  real *Hy_ij = Hy[i][j];
+  real *Hy_i1j = Hy[i-1][j];
+  real *Hx_ij1 = Hx[i][j-1];
+  real *Pz_ij = block->aux[1][ir][jr];
+  real *PPz_ij = block->aux[0][ir][jr];
+  real adx_i = adx[i];
+  real bdx_i = bdx[i];
+  real ady_j = ady[j];
+  real bdy_j = bdy[j];
+
+#ifdef USE_SIMD_KERNELS
+
+  kr = klo - blim[ZLO];
+  simdKernels->updatePmlEz( khi - klo + 1 , &Ez_ij[klo] , &PPz_ij[kr] , &Pz_ij[kr] , &alphaEz[i][j][klo] , &betaEz[i][j][klo] ,
+                            idhx[i] , &Hy_ij[klo] , &Hy_i1j[klo] , idhy[j] , &Hx_ij1[klo] , &Hx_ij[klo] ,
+                            adx_i , bdx_i , ady_j , bdy_j , &ibhz[klo] , &ahz[klo] );
+
+#else
+
+  real oldPz , oldPPz;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    kr = k - blim[ZLO];
+    oldPPz = PPz_ij[kr];
+    PPz_ij[kr] = ALPHA_EZ(i,j,k) * PPz_ij[kr] + BETA_EZ(i,j,k)
+      * curl_Hz( Hy_ij[k] , Hy_i1j[k] , Hx_ij1[k] , Hx_ij[k] , i , j , k );
+    oldPz = Pz_ij[kr];
+    Pz_ij[kr] = adx_i * Pz_ij[kr] + bdx_i * ( PPz_ij[kr] - oldPPz );
+    CHECK_NOT_VISITED( Ez_ij[k] );
+    Ez_ij[k] = ady_j * Ez_ij[k] + bdy_j * ibhz[k] * ( Pz_ij[kr] - ahz[k] * oldPz );
+    MARK_AS_VISITED( Ez_ij[k] ); 
+  }
 
-  message( MSG_DEBUG1 , 0 , "Deallocating the PML...\n" );
+#endif
+
+  return;
+
+}
+
+/* Update Hx along a k-pencil of a UPML block. */
+static void updatePmlHxPencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  int *blim = block->lim;
+  int ir = i - blim[XLO];
+  int jr = j - blim[YLO];
+  int kr;
+  real *Hx_ij = Hx[i][j];
+  real *Ey_ij = Ey[i][j];
+  real *Ez_ij = Ez[i][j];
+  real *Ez_ij1 = Ez[i][j+1];
+  real *Bx_ij = block->aux[0][ir][jr];
+  real adx_i = adx[i];
+  real ibdx_i = ibdx[i];
+  real ahy_j = ahy[j];
+  real bhy_j = bhy[j];
 
-  for( region = XLO ; region <= ZHI ; region++ )
+#ifdef USE_SIMD_KERNELS
+
+  kr = klo - blim[ZLO];
+  simdKernels->updatePmlHx( khi - klo + 1 , &Hx_ij[klo] , &Bx_ij[kr] , &gammaHx[i][j][klo] ,
+                            idey[j] , &Ez_ij[klo] , &Ez_ij1[klo] , &idez[klo] , &Ey_ij[klo+1] , &Ey_ij[klo] ,
+                            ahy_j , bhy_j , &ahz[klo] , &bhz[klo] , ibdx_i , adx_i );
+
+#else
+
+  real oldBx;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
   {
-    if( outerSurfaceType( region ) == BT_PML )
-    {
-      message( MSG_DEBUG1 , 0 , "  Deallocating grid PML Px array\n" );
-      deallocArray( Px[region] , 3 , fplim[region][EX][XHI] - fplim[region][EX][XLO] + 1 , 
-                                         fplim[region][EX][YHI] - fplim[region][EX][YLO] + 1 , 
-                                         fplim[region][EX][ZHI] - fplim[region][EX][ZLO] + 1 );
-      message( MSG_DEBUG1 , 0 , "  Deallocating grid PML Py array\n" );
-      deallocArray( Py[region] , 3 , fplim[region][EY][XHI] - fplim[region][EY][XLO] + 1 , 
-                                         fplim[region][EY][YHI] - fplim[region][EY][YLO] + 1 , 
-                                         fplim[region][EY][ZHI] - fplim[region][EY][ZLO] + 1 );
-      message( MSG_DEBUG1 , 0 , "  Deallocating grid PML Pz array\n" );
-      deallocArray( Pz[region] , 3 , fplim[region][EZ][XHI] - fplim[region][EZ][XLO] + 1 , 
-                                         fplim[region][EZ][YHI] - fplim[region][EZ][YLO] + 1 , 
-                                         fplim[region][EZ][ZHI] - fplim[region][EZ][ZLO] + 1 );
-      message( MSG_DEBUG1 , 0 , "  Deallocating grid PML PPx array\n" );
-      deallocArray( PPx[region] , 3 , fplim[region][EX][XHI] - fplim[region][EX][XLO] + 1 , 
-                                          fplim[region][EX][YHI] - fplim[region][EX][YLO] + 1 , 
-                                          fplim[region][EX][ZHI] - fplim[region][EX][ZLO] + 1 );
-      message( MSG_DEBUG1 , 0 , "  Deallocating grid PML PPy array\n" );
-      deallocArray( PPy[region] , 3 , fplim[region][EY][XHI] - fplim[region][EY][XLO] + 1 , 
-                                          fplim[region][EY][YHI] - fplim[region][EY][YLO] + 1 , 
-                                          fplim[region][EY][ZHI] - fplim[region][EY][ZLO] + 1 );
-      message( MSG_DEBUG1 , 0 , "  Deallocating grid PML PPz array\n" );
-      deallocArray( PPz[region] , 3 , fplim[region][EZ][XHI] - fplim[region][EZ][XLO] + 1 , 
-                                          fplim[region][EZ][YHI] - fplim[region][EZ][YLO] + 1 , 
-                                          fplim[region][EZ][ZHI] - fplim[region][EZ][ZLO] + 1 );
-      message( MSG_DEBUG1 , 0 , "  Deallocating grid PML Bx array\n" );
-      deallocArray( Bx[region] , 3 , fplim[region][HX][XHI] - fplim[region][HX][XLO] + 1 , 
-                                         fplim[region][HX][YHI] - fplim[region][HX][YLO] + 1 , 
-                                         fplim[region][HX][ZHI] - fplim[region][HX][ZLO] + 1 );
-      message( MSG_DEBUG1 , 0 , "  Deallocating grid PML By array\n" );
-      deallocArray( By[region] , 3 , fplim[region][HY][XHI] - fplim[region][HY][XLO] + 1 , 
-                                         fplim[region][HY][YHI] - fplim[region][HY][YLO] + 1 , 
-                                         fplim[region][HY][ZHI] - fplim[region][HY][ZLO] + 1 );
-      message( MSG_DEBUG1 , 0 , "  Deallocating grid PML Bz array\n" );
-      deallocArray( Bz[region] , 3 , fplim[region][HZ][XHI] - fplim[region][HZ][XLO] + 1 , 
-                                         fplim[region][HZ][YHI] - fplim[region][HZ][YLO] + 1 , 
-                                         fplim[region][HZ][ZHI] - fplim[region][HZ][ZLO] + 1 );
-    }
+    kr = k - blim[ZLO];
+    oldBx = Bx_ij[kr];
+    Bx_ij[kr] = ahy_j * Bx_ij[kr] + GAMMA_HX(i,j,k) * bhy_j
+      * curl_Ex( Ey_ij[k+1] , Ey_ij[k] , Ez_ij[k] , Ez_ij1[k] , i , j , k ); 
+    CHECK_NOT_VISITED( Hx_ij[k] );
+    Hx_ij[k] = ahz[k] * Hx_ij[k] + bhz[k] * ibdx_i * ( Bx_ij[kr] - adx_i * oldBx );
+    MARK_AS_VISITED( Hx_ij[k] ); 
   }
 
-  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML adx array\n" );
-  deallocArray( adx , numCells[XDIR] );
-  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML bdx array\n" );
-  deallocArray( bdx , numCells[XDIR] );
-  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML gdx array\n" );
-  deallocArray( gdx , numCells[XDIR] );
-  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML kdx array\n" );
-  deallocArray( kdx , numCells[XDIR] );
-  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML ahx array\n" );
-  deallocArray( ahx , numCells[XDIR] );
-  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML bhx array\n" );
-  deallocArray( bhx , numCells[XDIR] );
-  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML ghx array\n" );
-  deallocArray( ghx , numCells[XDIR] );
-  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML khx array\n" );
-  deallocArray( khx , numCells[XDIR] );
+#endif
 
-  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML ady array\n" );
-  deallocArray( ady , numCells[YDIR] );
+  return;
+
+}
+
+/* Update Hy along a k-pencil of a UPML block. */
+static void updatePmlHyPencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  int *blim = block->lim;
+  int ir = i - blim[XLO];
+  int jr = j - blim[YLO];
+  int kr;
+  real *Hy_ij = Hy[i][j];
+  real *Ex_ij = Ex[i][j];
+  real *Ez_ij = Ez[i][j];
+  real *Ez_i1j = Ez[i+1][j];
+  real *By_ij = block->aux[0][ir][jr];
+  real ahx_i = ahx[i];
+  real bhx_i = bhx[i];
+  real ady_j = ady[j];
+  real ibdy_j = ibdy[j];
+
+#ifdef USE_SIMD_KERNELS
+
+  kr = klo - blim[ZLO];
+  simdKernels->updatePmlHy( khi - klo + 1 , &Hy_ij[klo] , &By_ij[kr] , &gammaHy[i][j][klo] ,
+                            idex[i] , &Ez_i1j[klo] , &Ez_ij[klo] , &idez[klo] , &Ex_ij[klo] , &Ex_ij[klo+1] ,
+                            &ahz[klo] , &bhz[klo] , ahx_i , bhx_i , ibdy_j , ady_j );
+
+#else
+
+  real oldBy;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    kr = k - blim[ZLO];
+    oldBy = By_ij[kr];
+    By_ij[kr] = ahz[k] * By_ij[kr] + GAMMA_HY(i,j,k) * bhz[k]
+      * curl_Ey( Ez_i1j[k] , Ez_ij[k] , Ex_ij[k] , Ex_ij[k+1] , i , j , k );
+    CHECK_NOT_VISITED( Hy_ij[k] );
+    Hy_ij[k] = ahx_i * Hy_ij[k] + bhx_i * ibdy_j * ( By_ij[kr] - ady_j * oldBy );
+    MARK_AS_VISITED( Hy_ij[k] ); 
+  }
+
+#endif
+
+  return;
+
+}
+
+/* Update Hz along a k-pencil of a UPML block. */
+static void updatePmlHzPencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  int *blim = block->lim;
+  int ir = i - blim[XLO];
+  int jr = j - blim[YLO];
+  int kr;
+  real *Hz_ij = Hz[i][j];
+  real *Ex_ij = Ex[i][j];
+  real *Ey_ij = Ey[i][j];
+  real *Ex_ij1 = Ex[i][j+1];
+  real *Ey_i1j = Ey[i+1][j];
+  real *Bz_ij = block->aux[0][ir][jr];
+  real ahx_i = ahx[i];
+  real bhx_i = bhx[i];
+  real ahy_j = ahy[j];
+  real bhy_j = bhy[j];
+
+#ifdef USE_SIMD_KERNELS
+
+  kr = klo - blim[ZLO];
+  simdKernels->updatePmlHz( khi - klo + 1 , &Hz_ij[klo] , &Bz_ij[kr] , &gammaHz[i][j][klo] ,
+                            idey[j] , &Ex_ij1[klo] , &Ex_ij[klo] , idex[i] , &Ey_ij[klo] , &Ey_i1j[klo] ,
+                            ahx_i , bhx_i , ahy_j , bhy_j , &ibdz[klo] , &adz[klo] );
+
+#else
+
+  real oldBz;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    kr = k - blim[ZLO];
+    oldBz = Bz_ij[kr];
+    Bz_ij[kr] = ahx_i * Bz_ij[kr] + GAMMA_HZ(i,j,k) * bhx_i
+      * curl_Ez( Ex_ij1[k] , Ex_ij[k] , Ey_ij[k] , Ey_i1j[k] , i , j , k );   
+    CHECK_NOT_VISITED( Hz_ij[k] );
+    Hz_ij[k] = ahy_j * Hz_ij[k] + bhy_j * ibdz[k] * ( Bz_ij[kr] - adz[k] * oldBz );
+    MARK_AS_VISITED( Hz_ij[k] ); 
+  }
+
+#endif
+
+  return;
+
+}
+
+/* 
+ * Single stage UPML pencil update kernels.
+ *
+ * Where only one stage of the UPML update stretches the other is an identity, so the
+ * field itself takes the place of the output of the first stage, or of the second
+ * stage input, and only the stretching factors of the active stage are applied.
+ */
+
+/* Update Ex along a k-pencil of a UPML block with only first stage stretching. */
+static void updatePmlExStage1Pencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  int *blim = block->lim;
+  int ir = i - blim[XLO];
+  int jr = j - blim[YLO];
+  int kr;
+  real *Ex_ij = Ex[i][j];
+  real *Hy_ij = Hy[i][j];
+  real *Hz_ij = Hz[i][j];
+  real *Hz_ij1 = Hz[i][j-1];
+  real *PPx_ij = block->aux[0][ir][jr];
+  real ady_j = ady[j];
+  real bdy_j = bdy[j];
+  real oldPPx;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    kr = k - blim[ZLO];
+    oldPPx = PPx_ij[kr];
+    PPx_ij[kr] = ALPHA_EX(i,j,k) * PPx_ij[kr] + BETA_EX(i,j,k)
+      * curl_Hx( Hz_ij[k] , Hz_ij1[k] , Hy_ij[k-1] , Hy_ij[k] , i , j , k );
+    CHECK_NOT_VISITED( Ex_ij[k] );
+    Ex_ij[k] = ady_j * Ex_ij[k] + bdy_j * ( PPx_ij[kr] - oldPPx );
+    MARK_AS_VISITED( Ex_ij[k] ); 
+  }
+
+  return;
+
+}
+
+/* Update Ey along a k-pencil of a UPML block with only first stage stretching. */
+static void updatePmlEyStage1Pencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  int *blim = block->lim;
+  int ir = i - blim[XLO];
+  int jr = j - blim[YLO];
+  int kr;
+  real *Ey_ij = Ey[i][j];
+  real *Hx_ij = Hx[i][j];
+  real *Hz_ij = Hz[i][j];
+  real *Hz_i1j = Hz[i-1][j];
+  real *PPy_ij = block->aux[0][ir][jr];
+  real oldPPy;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    kr = k - blim[ZLO];
+    oldPPy = PPy_ij[kr];
+    PPy_ij[kr] = ALPHA_EY(i,j,k) * PPy_ij[kr] + BETA_EY(i,j,k)
+      * curl_Hy( Hx_ij[k] , Hx_ij[k-1] , Hz_i1j[k] , Hz_ij[k] , i , j , k );
+    CHECK_NOT_VISITED( Ey_ij[k] );
+    Ey_ij[k] = adz[k] * Ey_ij[k] + bdz[k] * ( PPy_ij[kr] - oldPPy );
+    MARK_AS_VISITED( Ey_ij[k] ); 
+  }
+
+  return;
+
+}
+
+/* Update Ez along a k-pencil of a UPML block with only first stage stretching. */
+static void updatePmlEzStage1Pencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  int *blim = block->lim;
+  int ir = i - blim[XLO];
+  int jr = j - blim[YLO];
+  int kr;
+  real *Ez_ij = Ez[i][j];
+  real *Hx_ij = Hx[i][j];
+  real *Hx_ij1 = Hx[i][j-1];
+  real *Hy_ij = Hy[i][j];
+  real *Hy_i1j = Hy[i-1][j];
+  real *PPz_ij = block->aux[0][ir][jr];
+  real adx_i = adx[i];
+  real bdx_i = bdx[i];
+  real oldPPz;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    kr = k - blim[ZLO];
+    oldPPz = PPz_ij[kr];
+    PPz_ij[kr] = ALPHA_EZ(i,j,k) * PPz_ij[kr] + BETA_EZ(i,j,k)
+      * curl_Hz( Hy_ij[k] , Hy_i1j[k] , Hx_ij1[k] , Hx_ij[k] , i , j , k );
+    CHECK_NOT_VISITED( Ez_ij[k] );
+    Ez_ij[k] = adx_i * Ez_ij[k] + bdx_i * ( PPz_ij[kr] - oldPPz );
+    MARK_AS_VISITED( Ez_ij[k] ); 
+  }
+
+  return;
+
+}
+
+/* Update Hx along a k-pencil of a UPML block with only first stage stretching. */
+static void updatePmlHxStage1Pencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  real *Hx_ij = Hx[i][j];
+  real *Ey_ij = Ey[i][j];
+  real *Ez_ij = Ez[i][j];
+  real *Ez_ij1 = Ez[i][j+1];
+  real ahy_j = ahy[j];
+  real bhy_j = bhy[j];
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    CHECK_NOT_VISITED( Hx_ij[k] );
+    Hx_ij[k] = ahy_j * Hx_ij[k] + GAMMA_HX(i,j,k) * bhy_j
+      * curl_Ex( Ey_ij[k+1] , Ey_ij[k] , Ez_ij[k] , Ez_ij1[k] , i , j , k );
+    MARK_AS_VISITED( Hx_ij[k] ); 
+  }
+
+  return;
+
+}
+
+/* Update Hy along a k-pencil of a UPML block with only first stage stretching. */
+static void updatePmlHyStage1Pencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  real *Hy_ij = Hy[i][j];
+  real *Ex_ij = Ex[i][j];
+  real *Ez_ij = Ez[i][j];
+  real *Ez_i1j = Ez[i+1][j];
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    CHECK_NOT_VISITED( Hy_ij[k] );
+    Hy_ij[k] = ahz[k] * Hy_ij[k] + GAMMA_HY(i,j,k) * bhz[k]
+      * curl_Ey( Ez_i1j[k] , Ez_ij[k] , Ex_ij[k] , Ex_ij[k+1] , i , j , k );
+    MARK_AS_VISITED( Hy_ij[k] ); 
+  }
+
+  return;
+
+}
+
+/* Update Hz along a k-pencil of a UPML block with only first stage stretching. */
+static void updatePmlHzStage1Pencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  real *Hz_ij = Hz[i][j];
+  real *Ex_ij = Ex[i][j];
+  real *Ex_ij1 = Ex[i][j+1];
+  real *Ey_ij = Ey[i][j];
+  real *Ey_i1j = Ey[i+1][j];
+  real ahx_i = ahx[i];
+  real bhx_i = bhx[i];
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    CHECK_NOT_VISITED( Hz_ij[k] );
+    Hz_ij[k] = ahx_i * Hz_ij[k] + GAMMA_HZ(i,j,k) * bhx_i
+      * curl_Ez( Ex_ij1[k] , Ex_ij[k] , Ey_ij[k] , Ey_i1j[k] , i , j , k );
+    MARK_AS_VISITED( Hz_ij[k] ); 
+  }
+
+  return;
+
+}
+
+/* Update Ex along a k-pencil of a UPML block with only second stage stretching. */
+static void updatePmlExStage2Pencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  int *blim = block->lim;
+  int ir = i - blim[XLO];
+  int jr = j - blim[YLO];
+  int kr;
+  real *Ex_ij = Ex[i][j];
+  real *Hy_ij = Hy[i][j];
+  real *Hz_ij = Hz[i][j];
+  real *Hz_ij1 = Hz[i][j-1];
+  real *PPx_ij = block->aux[0][ir][jr];
+  real ibhx_i = ibhx[i];
+  real ahx_i = ahx[i];
+  real oldPPx;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    kr = k - blim[ZLO];
+    oldPPx = PPx_ij[kr];
+    PPx_ij[kr] = ALPHA_EX(i,j,k) * PPx_ij[kr] + BETA_EX(i,j,k)
+      * curl_Hx( Hz_ij[k] , Hz_ij1[k] , Hy_ij[k-1] , Hy_ij[k] , i , j , k );
+    CHECK_NOT_VISITED( Ex_ij[k] );
+    Ex_ij[k] = adz[k] * Ex_ij[k] + bdz[k] * ibhx_i * ( PPx_ij[kr] - ahx_i * oldPPx );
+    MARK_AS_VISITED( Ex_ij[k] ); 
+  }
+
+  return;
+
+}
+
+/* Update Ey along a k-pencil of a UPML block with only second stage stretching. */
+static void updatePmlEyStage2Pencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  int *blim = block->lim;
+  int ir = i - blim[XLO];
+  int jr = j - blim[YLO];
+  int kr;
+  real *Ey_ij = Ey[i][j];
+  real *Hx_ij = Hx[i][j];
+  real *Hz_ij = Hz[i][j];
+  real *Hz_i1j = Hz[i-1][j];
+  real *PPy_ij = block->aux[0][ir][jr];
+  real adx_i = adx[i];
+  real bdx_ibhy_ij = bdx[i] * ibhy[j];
+  real ahy_j = ahy[j];
+  real oldPPy;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    kr = k - blim[ZLO];
+    oldPPy = PPy_ij[kr];
+    PPy_ij[kr] = ALPHA_EY(i,j,k) * PPy_ij[kr] + BETA_EY(i,j,k)
+      * curl_Hy( Hx_ij[k] , Hx_ij[k-1] , Hz_i1j[k] , Hz_ij[k] , i , j , k );
+    CHECK_NOT_VISITED( Ey_ij[k] );
+    Ey_ij[k] = adx_i * Ey_ij[k] + bdx_ibhy_ij * ( PPy_ij[kr] - ahy_j * oldPPy );
+    MARK_AS_VISITED( Ey_ij[k] ); 
+  }
+
+  return;
+
+}
+
+/* Update Ez along a k-pencil of a UPML block with only second stage stretching. */
+static void updatePmlEzStage2Pencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  int *blim = block->lim;
+  int ir = i - blim[XLO];
+  int jr = j - blim[YLO];
+  int kr;
+  real *Ez_ij = Ez[i][j];
+  real *Hx_ij = Hx[i][j];
+  real *Hx_ij1 = Hx[i][j-1];
+  real *Hy_ij = Hy[i][j];
+  real *Hy_i1j = Hy[i-1][j];
+  real *PPz_ij = block->aux[0][ir][jr];
+  real ady_j = ady[j];
+  real bdy_j = bdy[j];
+  real oldPPz;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    kr = k - blim[ZLO];
+    oldPPz = PPz_ij[kr];
+    PPz_ij[kr] = ALPHA_EZ(i,j,k) * PPz_ij[kr] + BETA_EZ(i,j,k)
+      * curl_Hz( Hy_ij[k] , Hy_i1j[k] , Hx_ij1[k] , Hx_ij[k] , i , j , k );
+    CHECK_NOT_VISITED( Ez_ij[k] );
+    Ez_ij[k] = ady_j * Ez_ij[k] + bdy_j * ibhz[k] * ( PPz_ij[kr] - ahz[k] * oldPPz );
+    MARK_AS_VISITED( Ez_ij[k] ); 
+  }
+
+  return;
+
+}
+
+/* 
+ * CPML pencil update kernels.
+ *
+ * The curl terms along the attenuated axes of a block are scaled by the inverse
+ * stretching factor and corrected by their recursive convolutions, which are held
+ * for these axes only. The tests on the convolution arrays are invariant over the
+ * block. There are no SIMD versions of these kernels.
+ */
+
+/* Update Ex along a k-pencil of a CPML block. */
+static void updateCpmlExPencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  int ir = i - block->lim[XLO];
+  int jr = j - block->lim[YLO];
+  int kr;
+  real *Ex_ij = Ex[i][j];
+  real *Hy_ij = Hy[i][j];
+  real *Hz_ij = Hz[i][j];
+  real *Hz_ij1 = Hz[i][j-1];
+  real *psiY_ij = block->aux[0] ? block->aux[0][ir][jr] : NULL;
+  real *psiZ_ij = block->aux[1] ? block->aux[1][ir][jr] : NULL;
+  real cby_j = cbd[YDIR][j];
+  real ccy_j = ccd[YDIR][j];
+  real iky_j = ikd[YDIR][j];
+  real *cbz = cbd[ZDIR];
+  real *ccz = ccd[ZDIR];
+  real *ikz = ikd[ZDIR];
+  real dy , dz , curl;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    kr = k - block->lim[ZLO];
+    dy = dHz_dy( ( Hz_ij[k] - Hz_ij1[k] ) , j );
+    dz = dHy_dz( ( Hy_ij[k-1] - Hy_ij[k] ) , k );
+    curl = iky_j * dy + ikz[k] * dz;
+    if( psiY_ij != NULL )
+    {
+      psiY_ij[kr] = cby_j * psiY_ij[kr] + ccy_j * dy;
+      curl = curl + psiY_ij[kr];
+    }
+    if( psiZ_ij != NULL )
+    {
+      psiZ_ij[kr] = cbz[k] * psiZ_ij[kr] + ccz[k] * dz;
+      curl = curl + psiZ_ij[kr];
+    }
+    CHECK_NOT_VISITED( Ex_ij[k] );
+    Ex_ij[k] = ALPHA_EX(i,j,k) * Ex_ij[k] + BETA_EX(i,j,k) * curl;
+    MARK_AS_VISITED( Ex_ij[k] ); 
+  }
+
+  return;
+
+}
+
+/* Update Ey along a k-pencil of a CPML block. */
+static void updateCpmlEyPencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  int ir = i - block->lim[XLO];
+  int jr = j - block->lim[YLO];
+  int kr;
+  real *Ey_ij = Ey[i][j];
+  real *Hx_ij = Hx[i][j];
+  real *Hz_ij = Hz[i][j];
+  real *Hz_i1j = Hz[i-1][j];
+  real *psiZ_ij = block->aux[0] ? block->aux[0][ir][jr] : NULL;
+  real *psiX_ij = block->aux[1] ? block->aux[1][ir][jr] : NULL;
+  real *cbz = cbd[ZDIR];
+  real *ccz = ccd[ZDIR];
+  real *ikz = ikd[ZDIR];
+  real cbx_i = cbd[XDIR][i];
+  real ccx_i = ccd[XDIR][i];
+  real ikx_i = ikd[XDIR][i];
+  real dz , dx , curl;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    kr = k - block->lim[ZLO];
+    dz = dHx_dz( ( Hx_ij[k] - Hx_ij[k-1] ) , k );
+    dx = dHz_dx( ( Hz_i1j[k] - Hz_ij[k] ) , i );
+    curl = ikz[k] * dz + ikx_i * dx;
+    if( psiZ_ij != NULL )
+    {
+      psiZ_ij[kr] = cbz[k] * psiZ_ij[kr] + ccz[k] * dz;
+      curl = curl + psiZ_ij[kr];
+    }
+    if( psiX_ij != NULL )
+    {
+      psiX_ij[kr] = cbx_i * psiX_ij[kr] + ccx_i * dx;
+      curl = curl + psiX_ij[kr];
+    }
+    CHECK_NOT_VISITED( Ey_ij[k] );
+    Ey_ij[k] = ALPHA_EY(i,j,k) * Ey_ij[k] + BETA_EY(i,j,k) * curl;
+    MARK_AS_VISITED( Ey_ij[k] ); 
+  }
+
+  return;
+
+}
+
+/* Update Ez along a k-pencil of a CPML block. */
+static void updateCpmlEzPencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  int ir = i - block->lim[XLO];
+  int jr = j - block->lim[YLO];
+  int kr;
+  real *Ez_ij = Ez[i][j];
+  real *Hx_ij = Hx[i][j];
+  real *Hx_ij1 = Hx[i][j-1];
+  real *Hy_ij = Hy[i][j];
+  real *Hy_i1j = Hy[i-1][j];
+  real *psiX_ij = block->aux[0] ? block->aux[0][ir][jr] : NULL;
+  real *psiY_ij = block->aux[1] ? block->aux[1][ir][jr] : NULL;
+  real cbx_i = cbd[XDIR][i];
+  real ccx_i = ccd[XDIR][i];
+  real ikx_i = ikd[XDIR][i];
+  real cby_j = cbd[YDIR][j];
+  real ccy_j = ccd[YDIR][j];
+  real iky_j = ikd[YDIR][j];
+  real dx , dy , curl;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    kr = k - block->lim[ZLO];
+    dx = dHy_dx( ( Hy_ij[k] - Hy_i1j[k] ) , i );
+    dy = dHx_dy( ( Hx_ij1[k] - Hx_ij[k] ) , j );
+    curl = ikx_i * dx + iky_j * dy;
+    if( psiX_ij != NULL )
+    {
+      psiX_ij[kr] = cbx_i * psiX_ij[kr] + ccx_i * dx;
+      curl = curl + psiX_ij[kr];
+    }
+    if( psiY_ij != NULL )
+    {
+      psiY_ij[kr] = cby_j * psiY_ij[kr] + ccy_j * dy;
+      curl = curl + psiY_ij[kr];
+    }
+    CHECK_NOT_VISITED( Ez_ij[k] );
+    Ez_ij[k] = ALPHA_EZ(i,j,k) * Ez_ij[k] + BETA_EZ(i,j,k) * curl;
+    MARK_AS_VISITED( Ez_ij[k] ); 
+  }
+
+  return;
+
+}
+
+/* Update Hx along a k-pencil of a CPML block. */
+static void updateCpmlHxPencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  int ir = i - block->lim[XLO];
+  int jr = j - block->lim[YLO];
+  int kr;
+  real *Hx_ij = Hx[i][j];
+  real *Ey_ij = Ey[i][j];
+  real *Ez_ij = Ez[i][j];
+  real *Ez_ij1 = Ez[i][j+1];
+  real *psiY_ij = block->aux[0] ? block->aux[0][ir][jr] : NULL;
+  real *psiZ_ij = block->aux[1] ? block->aux[1][ir][jr] : NULL;
+  real cby_j = cbh[YDIR][j];
+  real ccy_j = cch[YDIR][j];
+  real iky_j = ikh[YDIR][j];
+  real *cbz = cbh[ZDIR];
+  real *ccz = cch[ZDIR];
+  real *ikz = ikh[ZDIR];
+  real dy , dz , curl;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    kr = k - block->lim[ZLO];
+    dy = dEz_dy( ( Ez_ij[k] - Ez_ij1[k] ) , j );
+    dz = dEy_dz( ( Ey_ij[k+1] - Ey_ij[k] ) , k );
+    curl = iky_j * dy + ikz[k] * dz;
+    if( psiY_ij != NULL )
+    {
+      psiY_ij[kr] = cby_j * psiY_ij[kr] + ccy_j * dy;
+      curl = curl + psiY_ij[kr];
+    }
+    if( psiZ_ij != NULL )
+    {
+      psiZ_ij[kr] = cbz[k] * psiZ_ij[kr] + ccz[k] * dz;
+      curl = curl + psiZ_ij[kr];
+    }
+    CHECK_NOT_VISITED( Hx_ij[k] );
+    Hx_ij[k] = Hx_ij[k] + GAMMA_HX(i,j,k) * curl;
+    MARK_AS_VISITED( Hx_ij[k] ); 
+  }
+
+  return;
+
+}
+
+/* Update Hy along a k-pencil of a CPML block. */
+static void updateCpmlHyPencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  int ir = i - block->lim[XLO];
+  int jr = j - block->lim[YLO];
+  int kr;
+  real *Hy_ij = Hy[i][j];
+  real *Ex_ij = Ex[i][j];
+  real *Ez_ij = Ez[i][j];
+  real *Ez_i1j = Ez[i+1][j];
+  real *psiZ_ij = block->aux[0] ? block->aux[0][ir][jr] : NULL;
+  real *psiX_ij = block->aux[1] ? block->aux[1][ir][jr] : NULL;
+  real *cbz = cbh[ZDIR];
+  real *ccz = cch[ZDIR];
+  real *ikz = ikh[ZDIR];
+  real cbx_i = cbh[XDIR][i];
+  real ccx_i = cch[XDIR][i];
+  real ikx_i = ikh[XDIR][i];
+  real dz , dx , curl;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    kr = k - block->lim[ZLO];
+    dz = dEx_dz( ( Ex_ij[k] - Ex_ij[k+1] ) , k );
+    dx = dEz_dx( ( Ez_i1j[k] - Ez_ij[k] ) , i );
+    curl = ikz[k] * dz + ikx_i * dx;
+    if( psiZ_ij != NULL )
+    {
+      psiZ_ij[kr] = cbz[k] * psiZ_ij[kr] + ccz[k] * dz;
+      curl = curl + psiZ_ij[kr];
+    }
+    if( psiX_ij != NULL )
+    {
+      psiX_ij[kr] = cbx_i * psiX_ij[kr] + ccx_i * dx;
+      curl = curl + psiX_ij[kr];
+    }
+    CHECK_NOT_VISITED( Hy_ij[k] );
+    Hy_ij[k] = Hy_ij[k] + GAMMA_HY(i,j,k) * curl;
+    MARK_AS_VISITED( Hy_ij[k] ); 
+  }
+
+  return;
+
+}
+
+/* Update Hz along a k-pencil of a CPML block. */
+static void updateCpmlHzPencil( PmlBlock *block , int i , int j , int klo , int khi )
+{
+
+  int ir = i - block->lim[XLO];
+  int jr = j - block->lim[YLO];
+  int kr;
+  real *Hz_ij = Hz[i][j];
+  real *Ex_ij = Ex[i][j];
+  real *Ex_ij1 = Ex[i][j+1];
+  real *Ey_ij = Ey[i][j];
+  real *Ey_i1j = Ey[i+1][j];
+  real *psiX_ij = block->aux[0] ? block->aux[0][ir][jr] : NULL;
+  real *psiY_ij = block->aux[1] ? block->aux[1][ir][jr] : NULL;
+  real cbx_i = cbh[XDIR][i];
+  real ccx_i = cch[XDIR][i];
+  real ikx_i = ikh[XDIR][i];
+  real cby_j = cbh[YDIR][j];
+  real ccy_j = cch[YDIR][j];
+  real iky_j = ikh[YDIR][j];
+  real dx , dy , curl;
+
+  for ( int k = klo ; k <= khi ; k++ ) 
+  {
+    kr = k - block->lim[ZLO];
+    dx = dEy_dx( ( Ey_ij[k] - Ey_i1j[k] ) , i );
+    dy = dEx_dy( ( Ex_ij1[k] - Ex_ij[k] ) , j );
+    curl = ikx_i * dx + iky_j * dy;
+    if( psiX_ij != NULL )
+    {
+      psiX_ij[kr] = cbx_i * psiX_ij[kr] + ccx_i * dx;
+      curl = curl + psiX_ij[kr];
+    }
+    if( psiY_ij != NULL )
+    {
+      psiY_ij[kr] = cby_j * psiY_ij[kr] + ccy_j * dy;
+      curl = curl + psiY_ij[kr];
+    }
+    CHECK_NOT_VISITED( Hz_ij[k] );
+    Hz_ij[k] = Hz_ij[k] + GAMMA_HZ(i,j,k) * curl;
+    MARK_AS_VISITED( Hz_ij[k] ); 
+  }
+
+  return;
+
+}
+/* Update a PML block sweeping through i for each (j,k) tile. */
+void updatePmlBlockTiled( PmlBlock *block )
+{
+
+  int i , j , tile;
+  int jlo , jhi , klo , khi;
+  int *lim = block->lim;
+  int tileSize[2];
+  int numTiles[2];
+  PmlPencilFunc pencil = pmlPencil[block->kernel][block->field];
+
+  getGridTileSize( tileSize );
+  getNumTiles( lim , tileSize , numTiles );
+
+  #ifdef WITH_OPENMP
+    #pragma omp parallel for private( i , j , tile , jlo , jhi , klo , khi )
+  #endif
+  for ( tile = 0 ; tile < numTiles[0] * numTiles[1] ; tile++ ) 
+  {
+    getTileLimits( lim , tileSize , numTiles , tile , &jlo , &jhi , &klo , &khi );
+    for ( i = lim[XLO] ; i <= lim[XHI] ; i++ ) 
+      for ( j = jlo ; j <= jhi ; j++ ) 
+        pencil( block , i , j , klo , khi );
+  }
+
+  return;
+
+}
+
+/* Number of field elements within limits. */
+static double getPmlNumCells( int lim[6] )
+{
+
+  if( lim[XHI] < lim[XLO] || lim[YHI] < lim[YLO] || lim[ZHI] < lim[ZLO] )
+    return 0.0;
+
+  return (double)( lim[XHI] - lim[XLO] + 1 ) * ( lim[YHI] - lim[YLO] + 1 ) * ( lim[ZHI] - lim[ZLO] + 1 );
+
+}
+
+/* Initialise the PML update tasks for the task graph scheduler. */
+void initPmlTasks( int numParts )
+{
+
+  buildPmlTasks( numParts , pmlTasks , numPmlTasks );
+
+  return;
+
+}
+
+/* 
+ * Build the electric and magnetic field PML update tasks. The pencils of each PML 
+ * block are divided into blocks for numParts workers. 
+ */
+static void buildPmlTasks( int numParts , PmlTask *tasks[2] , int numTasks[2] )
+{
+
+  unsigned long bytes;
+  int count;
+  int numRegionParts;
+  double numCells;
+  double totalCells;
+  LoopDecomp decomp;
+
+  for( int isH = 0 ; isH <= 1 ; isH++ )
+  {
+
+    /* Share the parts between the blocks according to their size. */
+    totalCells = 0.0;
+    for( int block = 0 ; block < numPmlBlocks ; block++ )
+      if( ( pmlBlocks[block].field >= HX ) == isH )
+        totalCells += getPmlNumCells( pmlBlocks[block].lim );
+
+    /* Count the tasks, then set them. */
+    for( int pass = 0 ; pass <= 1 ; pass++ )
+    {
+      count = 0;
+      for( int block = 0 ; block < numPmlBlocks ; block++ )
+      {
+        if( ( pmlBlocks[block].field >= HX ) != isH )
+          continue;
+        numCells = getPmlNumCells( pmlBlocks[block].lim );
+        numRegionParts = (int) ceil( numParts * numCells / totalCells );
+        getLoopDecompBlocks( pmlBlocks[block].lim , numRegionParts , &decomp );
+        for( int item = 0 ; item < decomp.numItems ; item++ , count++ )
+        {
+          if( pass == 0 )
+            continue;
+          tasks[isH][count].block = &pmlBlocks[block];
+          getLoopDecompLimits( &decomp , item , tasks[isH][count].lim );
+        }
+      }
+      if( pass == 0 && count > 0 )
+      {
+        tasks[isH] = allocArray( &bytes , sizeof( PmlTask ) , 1 , count );
+        memory.pmlCoeffs += bytes;
+      }
+    }
+
+    numTasks[isH] = count;
+
+  }
+
+  return;
+
+}
+
+/* Number of electric field PML update tasks. */
+int getPmlNumEfieldTasks( void )
+{
+
+  return numPmlTasks[0];
+
+}
+
+/* Number of magnetic field PML update tasks. */
+int getPmlNumHfieldTasks( void )
+{
+
+  return numPmlTasks[1];
+
+}
+
+/* Update the pencils of a PML task with the kernel of its block. */
+static void updatePmlTask( PmlTask *task )
+{
+
+  PmlBlock *block = task->block;
+  PmlPencilFunc pencil = pmlPencil[block->kernel][block->field];
+
+  for ( int i = task->lim[XLO] ; i <= task->lim[XHI] ; i++ ) 
+    for ( int j = task->lim[YLO] ; j <= task->lim[YHI] ; j++ ) 
+      pencil( block , i , j , task->lim[ZLO] , task->lim[ZHI] );
+
+  return;
+
+}
+
+/* Electric field PML update task. */
+void updatePmlEfieldTask( int task )
+{
+
+  updatePmlTask( &pmlTasks[0][task] );
+
+  return;
+
+}
+
+/* Magnetic field PML update task. */
+void updatePmlHfieldTask( int task )
+{
+
+  updatePmlTask( &pmlTasks[1][task] );
+
+  return;
+
+}
+
+/* Share the PML update blocks of each field type between the threads in proportion to their cost. */
+static void initPmlBalance( void )
+{
+
+  unsigned long bytes;
+  unsigned long numCells;
+  double *cost;
+
+  buildPmlTasks( PML_BALANCE_BLOCKS * getNumWorkParts() , pmlWork , numPmlWork );
+
+  for( int isH = 0 ; isH <= 1 ; isH++ )
+  {
+    if( numPmlWork[isH] == 0 )
+      continue;
+
+    cost = allocArray( &bytes , sizeof( double ) , 1 , numPmlWork[isH] );
+    numCells = 0;
+    for( int task = 0 ; task < numPmlWork[isH] ; task++ )
+    {
+      cost[task] = getCostWeight( WT_PML ) * getPmlNumCells( pmlWork[isH][task].lim );
+      numCells += (unsigned long) getPmlNumCells( pmlWork[isH][task].lim );
+    }
+
+    partitionWork( &pmlPartition[isH] , WT_PML , cost , 0 , numPmlWork[isH] , numCells );
+
+    deallocArray( cost , 1 , numPmlWork[isH] );
+  }
+
+  return;
+
+}
+
+/* Update the PML blocks of one field type, each thread taking its part of the partition. */
+static void updatePmlBalanced( int isH )
+{
+
+  double start;
+
+  if( numPmlWork[isH] == 0 )
+    return;
+
+  start = getWorkTime();
+
+  #ifdef WITH_OPENMP
+    #pragma omp parallel
+  #endif
+  {
+    int first , last;
+    double busyStart = getWorkTime();
+
+    for( int part = getWorkerNumber() ; part < pmlPartition[isH].numParts ; part += getNumWorkers() )
+    {
+      getWorkPart( &pmlPartition[isH] , part , &first , &last );
+      for( int task = first ; task <= last ; task++ )
+        updatePmlTask( &pmlWork[isH][task] );
+    }
+
+    addBusyTime( WT_PML , getWorkTime() - busyStart );
+  }
+
+  addSweepTime( WT_PML , getWorkTime() - start , pmlPartition[isH].numCells );
+
+  return;
+
+}
+
+/* Update electric field in PML regions using tiled traversal. */
+void updatePmlEfieldTiled( void )
+{
+
+  for( int block = 0 ; block < numPmlBlocks ; block++ )
+    if( pmlBlocks[block].field <= EZ )
+      updatePmlBlockTiled( &pmlBlocks[block] );
+
+  return;
+
+}
+
+/* Update magnetic field in PML regions using tiled traversal. */
+void updatePmlHfieldTiled( void )
+{
+
+  for( int block = 0 ; block < numPmlBlocks ; block++ )
+    if( pmlBlocks[block].field >= HX )
+      updatePmlBlockTiled( &pmlBlocks[block] );
+
+  return;
+
+}
+
+/* Deallocate PML arrays. */
+void deallocPmlArrays( void )
+{
+
+  message( MSG_DEBUG1 , 0 , "Deallocating the PML...\n" );
+
+  for( int isH = 0 ; isH <= 1 ; isH++ )
+  {
+    if( pmlTasks[isH] != NULL )
+      deallocArray( pmlTasks[isH] , 1 , numPmlTasks[isH] );
+    if( pmlWork[isH] != NULL )
+    {
+      deallocArray( pmlWork[isH] , 1 , numPmlWork[isH] );
+      deallocWorkPartition( &pmlPartition[isH] );
+    }
+  }
+
+  if( pmlBlocks != NULL )
+  {
+    message( MSG_DEBUG1 , 0 , "  Deallocating grid PML auxiliary arrays\n" );
+    for( int block = 0 ; block < numPmlBlocks ; block++ )
+      for( int term = 0 ; term <= 1 ; term++ )
+        if( pmlBlocks[block].aux[term] != NULL )
+          deallocFieldArray( pmlBlocks[block].aux[term] );
+    deallocArray( pmlBlocks , 1 , numPmlBlocks );
+  }
+
+  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML adx array\n" );
+  deallocArray( adx , numCells[XDIR] );
+  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML bdx array\n" );
+  deallocArray( bdx , numCells[XDIR] );
+  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML gdx array\n" );
+  deallocArray( gdx , numCells[XDIR] );
+  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML kdx array\n" );
+  deallocArray( kdx , numCells[XDIR] );
+  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML ahx array\n" );
+  deallocArray( ahx , numCells[XDIR] );
+  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML bhx array\n" );
+  deallocArray( bhx , numCells[XDIR] );
+  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML ghx array\n" );
+  deallocArray( ghx , numCells[XDIR] );
+  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML khx array\n" );
+  deallocArray( khx , numCells[XDIR] );
+
+  message( MSG_DEBUG1 , 0 , "  Deallocating grid PML ady array\n" );
+  deallocArray( ady , numCells[YDIR] );
   message( MSG_DEBUG1 , 0 , "  Deallocating grid PML bdy array\n" );
   deallocArray( bdy , numCells[YDIR] );
   message( MSG_DEBUG1 , 0 , "  Deallocating grid PML gdy array\n" );
@@ -1290,6 +2496,17 @@ void deallocPmlArrays( void )
   message( MSG_DEBUG1 , 0 , "  Deallocating grid PML ibhz array\n" );
   deallocArray( ibhz , numCells[ZDIR] );
 
+  for( CoordAxis axis = XDIR ; axis <= ZDIR ; axis++ )
+  {
+    message( MSG_DEBUG1 , 0 , "  Deallocating grid CPML %s profile arrays\n" , AXIS[axis] );
+    deallocArray( cbd[axis] , numCells[axis] );
+    deallocArray( ccd[axis] , numCells[axis] );
+    deallocArray( ikd[axis] , numCells[axis] );
+    deallocArray( cbh[axis] , numCells[axis] );
+    deallocArray( cch[axis] , numCells[axis] );
+    deallocArray( ikh[axis] , numCells[axis] );
+  }
+
   return;
 
 }
@@ -1318,10 +2535,304 @@ void reportPml( void )
     }
   }
 
+  for( MeshFace face = XLO ; face <= ZHI ; face++ )
+  {
+    if( pmlSelection[face].isAuto )
+    {
+      int order;
+      real n_eff , refCoeff , kmax , amax;
+      getOuterSurfaceParams( face , &order , &n_eff , &refCoeff , &kmax , &amax );
+      message( MSG_LOG , 0 , "  PML %s automatic: layers=%d order=%d kmax=%g grading=%g predicted |R|=%g (target %g) over [%g,%g] Hz\n" ,
+               FACE[face] , outerSurfaceNumLayers( face ) , order , kmax , refCoeff , pmlSelection[face].predicted , 
+               pmlSelection[face].target , pmlSelection[face].lowFreq , pmlSelection[face].highFreq );
+    }
+  }
+
+  if( numPmlBlocks > 0 )
+  {
+    int numKernelBlocks[NUM_PML_KERNELS] = { 0 };
+    for( int block = 0 ; block < numPmlBlocks ; block++ )
+      numKernelBlocks[pmlBlocks[block].kernel]++;
+    message( MSG_LOG , 0 , "  PML update blocks: %d (%s %d, %s %d, %s %d, %s %d)\n" , numPmlBlocks ,
+             PML_KERNEL_STR[PK_UPML] , numKernelBlocks[PK_UPML] , PML_KERNEL_STR[PK_UPML_STAGE1] , numKernelBlocks[PK_UPML_STAGE1] ,
+             PML_KERNEL_STR[PK_UPML_STAGE2] , numKernelBlocks[PK_UPML_STAGE2] , PML_KERNEL_STR[PK_CPML] , numKernelBlocks[PK_CPML] );
+    message( MSG_LOG , 0 , "  PML auxiliary arrays: %.2f MiB (%.0f%% of region-wide UPML arrays)\n" , 
+             pmlAuxBytes / 1048576.0 , pmlRegionBytes > 0 ? 100.0 * pmlAuxBytes / pmlRegionBytes : 0.0 );
+    for( int block = 0 ; block < numPmlBlocks ; block++ )
+      message( MSG_DEBUG1 , 0 , "  PML %s Region, %s Block limits: [%d,%d,%d,%d,%d,%d] kernel=%s arrays=[%d,%d]\n",
+               FACE[pmlBlocks[block].region] , FIELD[pmlBlocks[block].field] ,
+               pmlBlocks[block].lim[XLO] , pmlBlocks[block].lim[XHI] ,
+               pmlBlocks[block].lim[YLO] , pmlBlocks[block].lim[YHI] ,
+               pmlBlocks[block].lim[ZLO] , pmlBlocks[block].lim[ZHI] ,
+               PML_KERNEL_STR[pmlBlocks[block].kernel] ,
+               pmlBlocks[block].aux[0] != NULL , pmlBlocks[block].aux[1] != NULL );
+  }
+
   return;
 
 }
 
+/* 
+ * Estimated memory traffic in bytes and floating point operations of a field element
+ * update in the PML for the compiled media mode. The field, the two new curl terms, 
+ * the auxiliary arrays and the coefficients are streamed. The flops and auxiliary 
+ * arrays are averaged over the elements of the blocks of the field type according
+ * to their kernels.
+ */
+void getPmlUpdateCost( bool isMagnetic , double *bytes , double *flops )
+{
+
+  double numCells;
+  double totalCells = 0.0;
+  double numAuxReals = 0.0;
+  double numFlops = 0.0;
+  double blockFlops;
+  int numAux;
+
+#ifdef USE_INDEXED_MEDIA
+  double coeffBytes = mediumIndexSize;
+#else
+  double coeffBytes = ( isMagnetic ? 1 : 2 ) * sizeof( real );
+#endif
+
+  for( int block = 0 ; block < numPmlBlocks ; block++ )
+  {
+    if( ( pmlBlocks[block].field >= HX ) != isMagnetic )
+      continue;
+    numCells = getPmlNumCells( pmlBlocks[block].lim );
+    numAux = ( pmlBlocks[block].aux[0] != NULL ) + ( pmlBlocks[block].aux[1] != NULL );
+    switch( pmlBlocks[block].kernel )
+    {
+    case PK_UPML:        blockFlops = isMagnetic ? 15 : 18; break;
+    case PK_UPML_STAGE1: blockFlops = isMagnetic ? 9 : 12; break;
+    case PK_UPML_STAGE2: blockFlops = 14; break;
+    case PK_CPML:        blockFlops = ( isMagnetic ? 9 : 10 ) + 4 * numAux; break;
+    default: assert( 0 ); blockFlops = 0; break;
+    }
+#ifdef USE_SCALED_FIELDS
+    blockFlops -= 2;
+#endif
+    totalCells += numCells;
+    numAuxReals += 2 * numAux * numCells;
+    numFlops += blockFlops * numCells;
+  }
+
+  if( totalCells > 0.0 )
+  {
+    numAuxReals /= totalCells;
+    *flops = numFlops / totalCells;
+  }
+  else
+  {
+    numAuxReals = isMagnetic ? 2 : 4;
+#ifdef USE_SCALED_FIELDS
+    *flops = isMagnetic ? 13 : 16;
+#else
+    *flops = isMagnetic ? 15 : 18;
+#endif
+  }
+
+  *bytes = ( 4 + numAuxReals ) * sizeof( real ) + coeffBytes;
+
+  return;
+
+}
+
+/* 
+ * Select the number of layers, profile order, kappa maximum and grading of a PML on an 
+ * external face. The thinnest PML whose largest predicted reflection coefficient over the
+ * band meets the target is chosen, taking the best profile at that depth. On entry 
+ * refCoeff is the target, with the default used if it is not positive; on return it is 
+ * the theoretical reflection coefficient that sets the loss grading. A positive order on
+ * entry is kept, otherwise the order is selected too. Only the mesh lines
+ * are needed so this can be used before the grid is initialised.
+ */
+void selectPmlParameters( MeshFace face , bool isCpml , int *numLayers , int *order , real n_eff , 
+                          real *refCoeff , real *kmax , real amax )
+{
+
+  real target = *refCoeff > 0.0 ? *refCoeff : AUTO_PML_DEFAULT_TARGET;
+  real meshSize = getMeshBoundaryCellSize( face );
+  real dt = getMeshTimeStep();
+  real lowFreq , highFreq;
+  real freq[AUTO_PML_NUM_FREQS];
+  real grading;
+  double reflection;
+  double bestReflection = 1.0e300;
+  int bestLayers = AUTO_PML_MAX_LAYERS;
+  int bestOrder = *order;
+  real bestKmax = *kmax;
+  real bestGrading = target;
+  int numKmax = sizeof( autoPmlKmax ) / sizeof( autoPmlKmax[0] );
+  int minOrder = *order > 0 ? *order : AUTO_PML_MIN_ORDER;
+  int maxOrder = *order > 0 ? *order : AUTO_PML_MAX_ORDER;
+
+  getPmlSelectionBand( meshSize , dt , n_eff , &lowFreq , &highFreq );
+  for( int f = 0 ; f < AUTO_PML_NUM_FREQS ; f++ )
+    freq[f] = lowFreq + ( highFreq - lowFreq ) * f / ( AUTO_PML_NUM_FREQS - 1.0 );
+
+  for( int layers = 1 ; layers <= AUTO_PML_MAX_LAYERS ; layers++ )
+  {
+    for( int m = minOrder ; m <= maxOrder ; m++ )
+    {
+      for( int kappa = 0 ; kappa < numKmax ; kappa++ )
+      {
+        for( int p = AUTO_PML_MIN_GRADING ; p <= AUTO_PML_MAX_GRADING ; p++ )
+        {
+          grading = pow( 10.0 , -p );
+          reflection = 0.0;
+          for( int f = 0 ; f < AUTO_PML_NUM_FREQS && reflection < bestReflection ; f++ )
+            reflection = fmax( reflection , getPmlDiscreteReflection( isCpml , layers , meshSize , dt , m , n_eff , 
+                                                                      grading , autoPmlKmax[kappa] , amax , freq[f] ) );
+          if( reflection < bestReflection )
+          {
+            bestReflection = reflection;
+            bestLayers = layers;
+            bestOrder = m;
+            bestKmax = autoPmlKmax[kappa];
+            bestGrading = grading;
+          }
+        }
+      }
+    }
+    if( bestReflection <= target )
+      break;
+  }
+
+  if( bestReflection > target )
+    message( MSG_WARN , 0 , "  *** Warning: PML on %s cannot meet reflection coefficient %g with %d layers, using |R|=%g\n" ,
+             FACE[face] , target , AUTO_PML_MAX_LAYERS , bestReflection );
+
+  *numLayers = bestLayers;
+  *order = bestOrder;
+  *kmax = bestKmax;
+  *refCoeff = bestGrading;
+
+  pmlSelection[face].isAuto = true;
+  pmlSelection[face].target = target;
+  pmlSelection[face].predicted = bestReflection;
+  pmlSelection[face].lowFreq = lowFreq;
+  pmlSelection[face].highFreq = highFreq;
+  pmlSelection[face].meshSize = meshSize;
+
+  message( MSG_LOG , 0 , "  PML on %s: %d layers, order %d, kmax %g, grading %g, predicted |R|=%g over [%g,%g] Hz\n" ,
+           FACE[face] , bestLayers , bestOrder , bestKmax , bestGrading , bestReflection , lowFreq , highFreq );
+
+  return;
+
+}
+
+/* 
+ * Frequency band for the PML selection from the output frequencies, else the waveforms, 
+ * limited to that resolved by ten cells per wavelength at the boundary.
+ */
+void getPmlSelectionBand( real meshSize , real dt , real n_eff , real *lowFreq , real *highFreq )
+{
+
+  real resolvedFreq = c0 / ( n_eff * 10.0 * meshSize );
+
+  if( !getOutputFrequencyBand( lowFreq , highFreq ) && !getWaveformBand( dt , lowFreq , highFreq ) )
+  {
+    *lowFreq = 0.0;
+    *highFreq = resolvedFreq;
+  }
+
+  if( *highFreq > resolvedFreq || *highFreq <= 0.0 )
+  {
+    message( MSG_DEBUG1 , 0 , "  Limiting PML selection band to %g Hz\n" , resolvedFreq );
+    *highFreq = resolvedFreq;
+  }
+
+  if( *lowFreq >= *highFreq )
+    *lowFreq = *highFreq;
+  else if( *lowFreq <= 0.0 )
+    *lowFreq = *highFreq / AUTO_PML_NUM_FREQS;
+
+  return;
+
+}
+
+/* 
+ * Reflection coefficient of a normally incident plane wave from a PML on the discrete
+ * grid. The frequency domain update equations for the transverse fields are solved
+ * from the PEC backing, where E = 0, back into the interior cell and the field there
+ * is split into the incident and reflected numerical plane waves.
+ */
+double getPmlDiscreteReflection( bool isCpml , int numLayers , real meshSize , real dt , int order , real n_eff , 
+                                 real refCoeff , real kmax , real amax , real freq )
+{
+
+  double complex z = cexp( I * 2.0 * pi * freq * dt );
+  double omegaTilde = 2.0 / dt * sin( pi * freq * dt );
+  double q = ( omegaTilde * meshSize * n_eff / c0 ) * ( omegaTilde * meshSize * n_eff / c0 );
+  double complex phase;
+  double complex inc;
+  double complex iE , iHlow , iHhigh;
+  double complex Elow , E , Ehigh;
+  double scale;
+
+  /* Not propagating on the grid. */
+  if( q >= 4.0 )
+    return 1.0;
+
+  phase = cexp( I * acos( 1.0 - 0.5 * q ) );
+
+  /* E at the PEC and the node before it. */
+  Ehigh = 0.0;
+  E = 1.0;
+
+  for( int k = numLayers - 1 ; k >= 0 ; k-- )
+  {
+    iE = getPmlInverseStretch( isCpml , (real)k / numLayers , numLayers , meshSize , dt , order , 
+                               n_eff , refCoeff , kmax , amax , z );
+    iHhigh = getPmlInverseStretch( isCpml , ( k + 0.5 ) / numLayers , numLayers , meshSize , dt , order , 
+                                   n_eff , refCoeff , kmax , amax , z );
+    if( k > 0 )
+      iHlow = getPmlInverseStretch( isCpml , ( k - 0.5 ) / numLayers , numLayers , meshSize , dt , order , 
+                                    n_eff , refCoeff , kmax , amax , z );
+    else
+      iHlow = 1.0;
+    Elow = ( ( iHhigh + iHlow ) * E - iHhigh * Ehigh - q * E / iE ) / iHlow;
+    scale = 1.0 / cabs( Elow );
+    Ehigh = E * scale;
+    E = Elow * scale;
+  }
+
+  /* E is now at the interior node and Ehigh at the PML surface. */
+  inc = ( E - Ehigh / phase ) / ( phase - 1.0 / phase );
+
+  return cabs( ( Ehigh - inc ) / inc );
+
+}
+
+/* 
+ * Inverse coordinate stretching factor at normalised depth x into a PML in the 
+ * frequency domain for the time step update, z = exp( j omega dt ). For the UPML the
+ * trapezoidal integral of the loss gives s = kappa + sigma dt / ( 2 eps0 ) ( z + 1 ) / ( z - 1 ),
+ * for the CPML the recursive convolution gives 1 / s = 1 / kappa + c / ( 1 - b / z ).
+ */
+double complex getPmlInverseStretch( bool isCpml , real x , int numLayers , real meshSize , real dt , int order , 
+                                     real n_eff , real refCoeff , real kmax , real amax , double complex z )
+{
+
+  real totalDepth = numLayers * meshSize;
+  real sigma , kappa;
+  real b , c , ik;
+
+  if( isCpml )
+  {
+    setCpmlCoefficients( x , totalDepth , meshSize , dt , order , n_eff , refCoeff , kmax , amax , &b , &c , &ik );
+    return ik + c / ( 1.0 - b / z );
+  }
+  else
+  {
+    sigma = pmlSigmaProfile( x , totalDepth , meshSize , order , n_eff , refCoeff );
+    kappa = pmlKappaProfile( x , totalDepth , meshSize , order , kmax );
+    return 1.0 / ( kappa + 0.5 * dt / eps0 * sigma * ( z + 1.0 ) / ( z - 1.0 ) );
+  }
+
+}
+
 /* Default PML parameters. */
 void setPmlDefaults( int *numLayers , int *order , real *n_eff , real *refCoeff , real *kmax )
 {
@@ -1335,3 +2846,14 @@ void setPmlDefaults( int *numLayers , int *order , real *n_eff , real *refCoeff
   return;
 
 }
+
+/* Default CPML parameters. */
+void setCpmlDefaults( int *numLayers , int *order , real *n_eff , real *refCoeff , real *kmax , real *amax )
+{
+
+  setPmlDefaults( numLayers , order , n_eff , refCoeff , kmax );
+  *amax = 0.0;
+
+  return;
+
+}
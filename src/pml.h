@@ -37,5 +37,14 @@ void updatePmlEfield( void );
 void updatePmlHfield( void );
 void deallocPmlArrays( void );
 void setPmlDefaults( int *numLayers , int *order , real *n_eff , real *refCoeff , real *kmax );
+void setCpmlDefaults( int *numLayers , int *order , real *n_eff , real *refCoeff , real *kmax , real *amax );
+void selectPmlParameters( MeshFace face , bool isCpml , int *numLayers , int *order , real n_eff , 
+                          real *refCoeff , real *kmax , real amax );
+void initPmlTasks( int numParts );
+int getPmlNumEfieldTasks( void );
+int getPmlNumHfieldTasks( void );
+void updatePmlEfieldTask( int task );
+void updatePmlHfieldTask( int task );
+void getPmlUpdateCost( bool isMagnetic , double *bytes , double *flops );
 
 #endif
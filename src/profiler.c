@@ -0,0 +1,464 @@
+/* 
+ * This file is part of Vulture.
+ *
+ * Vulture finite-difference time-domain electromagnetic solver.
+ * Copyright (C) 2011-2016 Ian David Flintoft
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ *
+ * Author: Ian Flintoft <ian.flintoft@googlemail.com>
+ *
+ */
+
+/* For clock_gettime. */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#ifdef WITH_OPENMP
+  #include <omp.h>
+#endif
+
+#include "profiler.h"
+#include "fdtd_types.h"
+#include "alloc_array.h"
+#include "message.h"
+#include "simulation.h"
+#include "perfcounter.h"
+#include "balance.h"
+#include "grid.h"
+#include "pml.h"
+
+/* 
+ * Private data.
+ */
+
+/* Number of stage slots per thread - keeps each thread's slots on their own cache lines. */
+#define STAGE_STRIDE ( ( NUM_PROFILE_STAGES + 7 ) / 8 * 8 )
+
+/* Stage names. */
+static char PROFILE_STAGE_STR[NUM_PROFILE_STAGES][TAG_SIZE] = { 
+  "OBSERVERS" , "WAVEFORMS" , 
+  "PML_E" , "MUR_E" , "GRID_E" , "BLOCKS_E" , "INTERNAL_SURFACES_E" , "LINES_E" , "SOURCES_E" , "PLANE_WAVES_E" , "GHOST_E" , "HALO_E" ,
+  "PML_H" , "MUR_H" , "GRID_H" , "BLOCKS_H" , "INTERNAL_SURFACES_H" , "LINES_H" , "SOURCES_H" , "PLANE_WAVES_H" , "GHOST_H" , "HALO_H" ,
+  "GRID_TIME_BLOCKED" };
+
+/* Profiling requested. */
+static bool isProfilingOn = false;
+
+/* Profiling the time stepping loop. */
+static bool isActive = false;
+
+/* Number of threads with stage timers. */
+static int numThreads = 1;
+
+/* Time in ns each thread spent in each stage and the number of calls. */
+static uint64_t **stageTime = NULL;
+static unsigned long **stageCalls = NULL;
+
+/* Hardware counters of each stage and at the start of the current stage. */
+static uint64_t stageCounts[NUM_PROFILE_STAGES][NUM_HW_COUNTERS];
+static uint64_t startCounts[NUM_HW_COUNTERS];
+
+/* Reading hardware counters around the stages. */
+static bool isCounting = false;
+
+/* Start and end of the time stepping loop in ns. */
+static uint64_t loopStart = 0;
+static uint64_t loopEnd = 0;
+
+/* 
+ * Private method interfaces. 
+ */
+
+uint64_t readProfileClock( void );
+double getStageTime( ProfileStage stage );
+double getStageTraffic( ProfileStage stage );
+void reportHardwareCounters( void );
+void reportRoofline( void );
+
+/*
+ * Method Implementations.
+ */
+
+/* Enable or disable profiling of the time stepping loop. */
+void setProfiling( bool flag )
+{
+
+  isProfilingOn = flag;
+
+  return;
+
+}
+
+/* Start profiling the time stepping loop. */
+/* Depends: number of threads set. */
+void startProfile( void )
+{
+
+  unsigned long bytes;
+
+  if( !isProfilingOn )
+    return;
+
+#ifdef WITH_OPENMP
+  numThreads = omp_get_max_threads();
+#endif
+
+  stageTime = allocArray( &bytes , sizeof( uint64_t ) , 2 , numThreads , STAGE_STRIDE );
+  stageCalls = allocArray( &bytes , sizeof( unsigned long ) , 2 , numThreads , STAGE_STRIDE );
+  for( int thread = 0 ; thread < numThreads ; thread++ )
+    for( int stage = 0 ; stage < STAGE_STRIDE ; stage++ )
+    {
+      stageTime[thread][stage] = 0;
+      stageCalls[thread][stage] = 0;
+    }
+
+  for( ProfileStage stage = 0 ; stage < NUM_PROFILE_STAGES ; stage++ )
+    for( HardwareCounter counter = 0 ; counter < NUM_HW_COUNTERS ; counter++ )
+      stageCounts[stage][counter] = 0;
+
+  if( isHardwareCountersOn() )
+  {
+    initHardwareCounters();
+    isCounting = true;
+  }
+
+  isActive = true;
+  loopStart = readProfileClock();
+
+  return;
+
+}
+
+/* Monotonic clock in ns. */
+uint64_t readProfileClock( void )
+{
+
+  struct timespec now;
+
+  clock_gettime( CLOCK_MONOTONIC , &now );
+
+  return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+
+}
+
+/* 
+ * Time at the start of a stage in ns, or zero if not profiling. Hardware counters
+ * are only read for stages called from the time stepping loop, where the stages 
+ * run one at a time.
+ */
+uint64_t getProfileTime( void )
+{
+
+  if( !isActive )
+    return 0;
+
+#ifdef WITH_OPENMP
+  if( isCounting && omp_get_level() == 0 )
+#else
+  if( isCounting )
+#endif
+    readHardwareCounters( startCounts );
+
+  return readProfileClock();
+
+}
+
+/* 
+ * Add the time since start to a stage. Stages run inside tasks are charged to
+ * the thread running the task.
+ */
+void addStageTime( ProfileStage stage , uint64_t start )
+{
+
+  int thread = 0;
+  uint64_t counts[NUM_HW_COUNTERS];
+
+  if( !isActive )
+    return;
+
+#ifdef WITH_OPENMP
+  if( omp_get_level() > 0 )
+    thread = omp_get_ancestor_thread_num( 1 ) % numThreads;
+#endif
+
+  stageTime[thread][stage] += readProfileClock() - start;
+  stageCalls[thread][stage]++;
+
+#ifdef WITH_OPENMP
+  if( isCounting && omp_get_level() == 0 )
+#else
+  if( isCounting )
+#endif
+  {
+    readHardwareCounters( counts );
+    for( HardwareCounter counter = 0 ; counter < NUM_HW_COUNTERS ; counter++ )
+      stageCounts[stage][counter] += counts[counter] - startCounts[counter];
+  }
+
+  return;
+
+}
+
+/* Stop profiling the time stepping loop. */
+void stopProfile( void )
+{
+
+  if( !isActive )
+    return;
+
+  loopEnd = readProfileClock();
+  isActive = false;
+
+  return;
+
+}
+
+/* 
+ * Report the time spent in each stage as a proportion of the time stepping loop.
+ * With the task graph scheduler stages overlap so the proportions can sum to more
+ * than 100%.
+ */
+void reportProfile( void )
+{
+
+  double loopTime;
+  double time;
+  double totalTime = 0.0;
+  double threadTime;
+  unsigned long calls;
+  unsigned long numSteps = getNumTimeSteps();
+
+  if( stageTime == NULL )
+    return;
+
+  loopTime = 1e-9 * (double)( loopEnd - loopStart );
+
+  message( MSG_LOG , 0 , "\nTime step profile:\n\n" );
+  message( MSG_LOG , 0 , "  %-20s %10s %12s %14s %8s\n" , "Stage" , "Calls" , "Time [s]" , "Per step [us]" , "Loop [%]" );
+
+  for( ProfileStage stage = 0 ; stage < NUM_PROFILE_STAGES ; stage++ )
+  {
+    time = 0.0;
+    calls = 0;
+    for( int thread = 0 ; thread < numThreads ; thread++ )
+    {
+      time += 1e-9 * (double) stageTime[thread][stage];
+      calls += stageCalls[thread][stage];
+    }
+    if( calls == 0 )
+      continue;
+    totalTime += time;
+    message( MSG_LOG , 0 , "  %-20s %10lu %12.4e %14.3f %8.2f\n" , PROFILE_STAGE_STR[stage] , calls , time , 
+             numSteps > 0 ? 1e6 * time / numSteps : 0.0 , loopTime > 0.0 ? 100.0 * time / loopTime : 0.0 );
+  }
+
+  message( MSG_LOG , 0 , "  %-20s %10s %12.4e %14.3f %8.2f\n" , "Total stages" , "" , totalTime , 
+           numSteps > 0 ? 1e6 * totalTime / numSteps : 0.0 , loopTime > 0.0 ? 100.0 * totalTime / loopTime : 0.0 );
+  message( MSG_LOG , 0 , "  %-20s %10s %12.4e %14.3f %8.2f\n" , "Time stepping loop" , "" , loopTime , 
+           numSteps > 0 ? 1e6 * loopTime / numSteps : 0.0 , 100.0 );
+
+  /* Stages called from the time stepping loop are charged to thread 0, stages run as tasks to the thread running them. */
+  message( MSG_LOG , 0 , "\n  %8s %12s %8s\n" , "Thread" , "Time [s]" , "Loop [%]" );
+  for( int thread = 0 ; thread < numThreads ; thread++ )
+  {
+    threadTime = 0.0;
+    for( ProfileStage stage = 0 ; stage < NUM_PROFILE_STAGES ; stage++ )
+      threadTime += 1e-9 * (double) stageTime[thread][stage];
+    message( MSG_LOG , 0 , "  %8d %12.4e %8.2f\n" , thread , threadTime , loopTime > 0.0 ? 100.0 * threadTime / loopTime : 0.0 );
+  }
+
+  if( isCounting )
+  {
+    reportHardwareCounters();
+    reportRoofline();
+  }
+
+  return;
+
+}
+
+/* Total time of a stage over all threads in seconds. */
+double getStageTime( ProfileStage stage )
+{
+
+  double time = 0.0;
+
+  for( int thread = 0 ; thread < numThreads ; thread++ )
+    time += 1e-9 * (double) stageTime[thread][stage];
+
+  return time;
+
+}
+
+/* 
+ * Memory traffic of a stage in bytes, from the memory controllers if available, 
+ * otherwise estimated from the last level cache misses. Returns a negative value
+ * if neither is available.
+ */
+double getStageTraffic( ProfileStage stage )
+{
+
+  if( isHardwareCounterAvailable( HC_DRAM_BYTES ) )
+    return (double) stageCounts[stage][HC_DRAM_BYTES];
+  else if( isHardwareCounterAvailable( HC_LLC_MISSES ) )
+    return 64.0 * (double) stageCounts[stage][HC_LLC_MISSES];
+  else
+    return -1.0;
+
+}
+
+/* Report the hardware counters of each stage. */
+void reportHardwareCounters( void )
+{
+
+  double time;
+  double traffic;
+  char cycles[TAG_SIZE] = "-";
+  char instructions[TAG_SIZE] = "-";
+  char ipc[TAG_SIZE] = "-";
+  char misses[TAG_SIZE] = "-";
+  char bandwidth[TAG_SIZE] = "-";
+
+  message( MSG_LOG , 0 , "\nHardware counters:\n\n" );
+
+  if( isHardwareCounterAvailable( HC_DRAM_BYTES ) )
+    message( MSG_LOG , 0 , "  Memory bandwidth from memory controller counters - includes other processes\n\n" );
+  else if( isHardwareCounterAvailable( HC_LLC_MISSES ) )
+    message( MSG_LOG , 0 , "  Memory bandwidth estimated from last level cache misses - excludes writebacks\n\n" );
+
+  message( MSG_LOG , 0 , "  %-20s %14s %14s %6s %14s %10s\n" , "Stage" , "Cycles" , "Instructions" , "IPC" , "LLC misses" , "Mem [GB/s]" );
+
+  for( ProfileStage stage = 0 ; stage < NUM_PROFILE_STAGES ; stage++ )
+  {
+    time = getStageTime( stage );
+    if( time <= 0.0 )
+      continue;
+    traffic = getStageTraffic( stage );
+    if( isHardwareCounterAvailable( HC_CYCLES ) )
+      snprintf( cycles , TAG_SIZE , "%14.4e" , (double) stageCounts[stage][HC_CYCLES] );
+    if( isHardwareCounterAvailable( HC_INSTRUCTIONS ) )
+      snprintf( instructions , TAG_SIZE , "%14.4e" , (double) stageCounts[stage][HC_INSTRUCTIONS] );
+    if( isHardwareCounterAvailable( HC_CYCLES ) && isHardwareCounterAvailable( HC_INSTRUCTIONS ) && stageCounts[stage][HC_CYCLES] > 0 )
+      snprintf( ipc , TAG_SIZE , "%6.2f" , (double) stageCounts[stage][HC_INSTRUCTIONS] / (double) stageCounts[stage][HC_CYCLES] );
+    if( isHardwareCounterAvailable( HC_LLC_MISSES ) )
+      snprintf( misses , TAG_SIZE , "%14.4e" , (double) stageCounts[stage][HC_LLC_MISSES] );
+    if( traffic >= 0.0 )
+      snprintf( bandwidth , TAG_SIZE , "%10.2f" , 1e-9 * traffic / time );
+    message( MSG_LOG , 0 , "  %-20s %14s %14s %6s %14s %10s\n" , PROFILE_STAGE_STR[stage] , cycles , instructions , ipc , misses , bandwidth );
+  }
+
+  return;
+
+}
+
+/* 
+ * Report the arithmetic intensity of the grid and PML updates implied by the
+ * compiled media mode and the achieved fraction of the peak memory bandwidth. 
+ * The fraction uses the measured memory traffic if available, otherwise the 
+ * modelled traffic.
+ */
+void reportRoofline( void )
+{
+
+  ProfileStage stages[4] = { PS_GRID_E , PS_GRID_H , PS_PML_E , PS_PML_H };
+  WorkType types[4] = { WT_GRID , WT_GRID , WT_PML , WT_PML };
+  unsigned long sweeps;
+  double cellUpdates;
+  double elapsed;
+  double calls;
+  double time;
+  double numCells;
+  double bytes;
+  double flops;
+  double modelBandwidth;
+  double traffic;
+  double peak = getPeakBandwidth();
+  char measured[TAG_SIZE];
+
+  message( MSG_LOG , 0 , "\nRoofline (media mode: %s, peak bandwidth %.2f GB/s):\n\n" , 
+#if defined( USE_INDEXED_MEDIA )
+           "indexed" ,
+#elif defined( USE_AVERAGED_MEDIA ) && defined( USE_SCALED_FIELDS )
+           "averaged, scaled" ,
+#elif defined( USE_AVERAGED_MEDIA )
+           "averaged" ,
+#elif defined( USE_SCALED_FIELDS )
+           "scaled" ,
+#else
+           "direct" ,
+#endif
+           1e-9 * peak );
+  message( MSG_LOG , 0 , "  %-8s %12s %10s %10s %10s %10s %10s %10s %8s\n" , "Stage" , "Cells/call" , "Bytes/cell" , "Flops/cell" , 
+           "Flops/byte" , "GFlop/s" , "Model GB/s" , "Mem GB/s" , "Peak [%]" );
+
+  for( int row = 0 ; row < 4 ; row++ )
+  {
+    getSweepStats( types[row] , &sweeps , &cellUpdates , &elapsed );
+    time = getStageTime( stages[row] );
+    calls = 0.0;
+    for( int thread = 0 ; thread < numThreads ; thread++ )
+      calls += stageCalls[thread][stages[row]];
+    if( sweeps == 0 || time <= 0.0 || calls <= 0.0 )
+      continue;
+
+    /* Sweeps count both the electric and magnetic field updates. */
+    numCells = cellUpdates / sweeps;
+
+    if( types[row] == WT_GRID )
+      getGridUpdateCost( stages[row] == PS_GRID_H , &bytes , &flops );
+    else
+      getPmlUpdateCost( stages[row] == PS_PML_H , &bytes , &flops );
+
+    modelBandwidth = numCells * calls * bytes / time;
+    traffic = getStageTraffic( stages[row] );
+    if( traffic >= 0.0 )
+      snprintf( measured , TAG_SIZE , "%10.2f" , 1e-9 * traffic / time );
+    else
+      snprintf( measured , TAG_SIZE , "%10s" , "-" );
+
+    message( MSG_LOG , 0 , "  %-8s %12.0f %10.2f %10.0f %10.3f %10.3f %10.2f %s %8.1f\n" , PROFILE_STAGE_STR[stages[row]] , 
+             numCells , bytes , flops , flops / bytes , 1e-9 * numCells * calls * flops / time , 1e-9 * modelBandwidth , measured ,
+             peak > 0.0 ? 100.0 * ( traffic >= 0.0 ? traffic / time : modelBandwidth ) / peak : 0.0 );
+  }
+
+  return;
+
+}
+
+/* Deallocate profiler. */
+void deallocProfiler( void )
+{
+
+  if( stageTime != NULL )
+  {
+    deallocArray( stageTime , 2 , numThreads , STAGE_STRIDE );
+    deallocArray( stageCalls , 2 , numThreads , STAGE_STRIDE );
+  }
+
+  stageTime = NULL;
+  stageCalls = NULL;
+
+  if( isCounting )
+    deallocHardwareCounters();
+
+  isCounting = false;
+
+  return;
+
+}
@@ -0,0 +1,73 @@
+/* 
+ * This file is part of Vulture.
+ *
+ * Vulture finite-difference time-domain electromagnetic solver.
+ * Copyright (C) 2011-2016 Ian David Flintoft
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ *
+ * Author: Ian Flintoft <ian.flintoft@googlemail.com>
+ *
+ */
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Stages of a time step. */
+typedef enum {
+
+  PS_OBSERVERS,
+  PS_WAVEFORMS,
+  PS_PML_E,
+  PS_MUR_E,
+  PS_GRID_E,
+  PS_BLOCKS_E,
+  PS_INTERNAL_SURFACES_E,
+  PS_LINES_E,
+  PS_SOURCES_E,
+  PS_PLANE_WAVES_E,
+  PS_GHOST_E,
+  PS_HALO_E,
+  PS_PML_H,
+  PS_MUR_H,
+  PS_GRID_H,
+  PS_BLOCKS_H,
+  PS_INTERNAL_SURFACES_H,
+  PS_LINES_H,
+  PS_SOURCES_H,
+  PS_PLANE_WAVES_H,
+  PS_GHOST_H,
+  PS_HALO_H,
+  PS_GRID_TIME_BLOCKED,
+  NUM_PROFILE_STAGES
+
+} ProfileStage;
+
+/*
+ * Public method interfaces.
+ */
+
+void setProfiling( bool flag );
+void startProfile( void );
+uint64_t getProfileTime( void );
+void addStageTime( ProfileStage stage , uint64_t start );
+void stopProfile( void );
+void reportProfile( void );
+void deallocProfiler( void );
+
+#endif
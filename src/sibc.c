@@ -37,6 +37,7 @@
 #include "memory.h"
 #include "physical.h"
 #include "filter.h"
+#include "balance.h"
 
 /* 
  * SIBC class. 
@@ -67,6 +68,19 @@ static SurfaceIndex numSibcSurface = 0;
 /* Internal SIBC surface array. */
 static SibcItem *sibcArray = NULL;         
 
+/* SIBC electric field update task - a row of faces of a surface. Upper limits are exclusive. */
+typedef struct SibcTask_t {
+
+  SurfaceIndex surface;
+  int lim[6];
+
+} SibcTask;
+
+/* Electric field update tasks and their partition between the threads. */
+static SibcTask *sibcTasks = NULL;
+static int numSibcTasks = 0;
+static WorkPartition sibcPartition = { 0 };
+
 /* Orientation matrices. */
 static real Acp[4][4] = { { 0.0 , 0.0 , 1.0 , 0.0 } ,
                           { 0.0 , 0.0 , 0.0 ,-1.0 } ,
@@ -117,6 +131,9 @@ void matLinearComb( real C[4][4] , real a , real A[4][4] , real b , real B[4][4]
 void tportS2Z( real Z[2][2] , real S[2][2] );
 bool isPassiveS( real S[2][2] );
 void setSibcFace( bool ****isSibcFace , int gbbox[6] , CoordAxis dir , bool value );
+static void initSibcBalance( void );
+static void zeroSibcSurfacesEfield( void );
+static void updateSibcTaskEfield( SibcTask *task );
 
 /*
  * Method Implementations.
@@ -391,11 +408,68 @@ void initSibcSurfaces( SurfaceIndex number , SurfaceItem *surfaceList )
   
   /* Deallocate temporary adjacency array. */
   deallocArray( isSibcFace , 4 , numCells[XDIR] , numCells[YDIR] , numCells[ZDIR] , 3 );
+
+  /* Share the electric field updates between the threads. */
+  initSibcBalance();
       
   return;
 
 }
 
+/* 
+ * Divide the surfaces into rows of faces and share the rows between the threads
+ * in proportion to their cost. Single face surfaces are single rows.
+ */
+static void initSibcBalance( void )
+{
+
+  unsigned long bytes;
+  unsigned long numFaces = 0;
+  double *cost;
+  CoordAxis rowAxis;
+  int task;
+
+  numSibcTasks = 0;
+  for( SurfaceIndex surface = 0 ; surface < numSibcSurface ; surface++ )
+  {
+    rowAxis = ( sibcArray[surface].normal == XDIR ) ? YDIR : XDIR;
+    numSibcTasks += sibcArray[surface].gbbox[2*rowAxis+1] - sibcArray[surface].gbbox[2*rowAxis];
+  }
+
+  if( numSibcTasks == 0 )
+    return;
+
+  sibcTasks = allocArray( &bytes , sizeof( SibcTask ) , 1 , numSibcTasks );
+  memory.surfaces += bytes;
+  cost = allocArray( &bytes , sizeof( double ) , 1 , numSibcTasks );
+
+  task = 0;
+  for( SurfaceIndex surface = 0 ; surface < numSibcSurface ; surface++ )
+  {
+    rowAxis = ( sibcArray[surface].normal == XDIR ) ? YDIR : XDIR;
+    for( int row = sibcArray[surface].gbbox[2*rowAxis] ; row < sibcArray[surface].gbbox[2*rowAxis+1] ; row++ , task++ )
+    {
+      sibcTasks[task].surface = surface;
+      for( MeshFace face = XLO ; face <= ZHI ; face++ )
+        sibcTasks[task].lim[face] = sibcArray[surface].gbbox[face];
+      sibcTasks[task].lim[2*rowAxis] = row;
+      sibcTasks[task].lim[2*rowAxis+1] = row + 1;
+      cost[task] = ( sibcTasks[task].lim[XHI] - sibcTasks[task].lim[XLO] ) * 
+                   ( sibcTasks[task].lim[YHI] - sibcTasks[task].lim[YLO] ) * 
+                   ( sibcTasks[task].lim[ZHI] - sibcTasks[task].lim[ZLO] );
+      numFaces += (unsigned long) cost[task];
+      cost[task] *= getCostWeight( WT_SIBC );
+    }
+  }
+
+  partitionWork( &sibcPartition , WT_SIBC , cost , 0 , numSibcTasks , numFaces );
+
+  deallocArray( cost , 1 , numSibcTasks );
+
+  return;
+
+}
+
 /* Deallocate SIBC surfaces. */
 void deallocSibcSurfaces( void )
 {
@@ -405,6 +479,13 @@ void deallocSibcSurfaces( void )
 
   message( MSG_DEBUG1 , 0 , "Deallocating SIBC surfaces...\n" );
 
+  if( sibcTasks != NULL )
+  {
+    deallocWorkPartition( &sibcPartition );
+    deallocArray( sibcTasks , 1 , numSibcTasks );
+    sibcTasks = NULL;
+  }
+
   for( SurfaceIndex surface = 0 ; surface < numSibcSurface ; surface++ )
   {
 
@@ -444,142 +525,202 @@ void deallocSibcSurfaces( void )
 void updateSibcSurfacesEfield( void )
 {
 
-  int i , j , k , p , q;
-  int ii , jj , kk;
-  real Eout[4];
-  real Htan[4];
-  real Hin[4];
-  real A[4][4] = { { 0.0 } };
-  real B[4][4] = { { 0.0 } };
+  double start;
 
-  /* Find orientation and polarisation matrices for surface. 
-   * This could be done at init phase and saved but could be a huge memory
-     hog if there are many one face TBs in the mesh.
-   */ 
-  for( SurfaceIndex surface = 0 ; surface < numSibcSurface ; surface++ )
-  { 
+  if( numSibcTasks == 0 )
+    return;
 
-    /* Calculate pre and post filtering axes transformation matrices. */
-    switch( sibcArray[surface].orientation )
+  start = getWorkTime();
+
+  /* Neighbouring faces share edges so the mesh is zeroed serially. */
+  zeroSibcSurfacesEfield();
+
+  #ifdef WITH_OPENMP
+    #pragma omp parallel
+  #endif
+  {
+    int first , last;
+    double busyStart = getWorkTime();
+
+    for( int part = getWorkerNumber() ; part < sibcPartition.numParts ; part += getNumWorkers() )
     {
-    case 1:
-      matLinearComb( A , sibcArray[surface].cosa , Acp , sibcArray[surface].sina , Asp );
-      matLinearComb( B , sibcArray[surface].cosa , Bcp , sibcArray[surface].sina , Bsp );
-      break;
-    case -1:
-      matLinearComb( A , sibcArray[surface].cosa , Acm , sibcArray[surface].sina , Asm );
-      matLinearComb( B , sibcArray[surface].cosa , Bcm , sibcArray[surface].sina , Bsm );
-      break;
-    default:
-      assert( 0 );
-      break;
+      getWorkPart( &sibcPartition , part , &first , &last );
+      for( int task = first ; task <= last ; task++ )
+        updateSibcTaskEfield( &sibcTasks[task] );
     }
 
-    switch( sibcArray[surface].normal )
-    {
-    case XDIR:
-      for( i = sibcArray[surface].gbbox[XLO] , ii = 0 ; i < sibcArray[surface].gbbox[XHI] ; i++ , ii++ )
-        for( j = sibcArray[surface].gbbox[YLO] , jj = 0 ; j < sibcArray[surface].gbbox[YHI] ; j++ , jj++ )
-          for( k = sibcArray[surface].gbbox[ZLO] , kk = 0 ; k < sibcArray[surface].gbbox[ZHI] ; k++ , kk++ )
-          { 
-            /* Zero tangential electric field on mesh. These should be unnecessary. */
+    addBusyTime( WT_SIBC , getWorkTime() - busyStart );
+  }
+
+  addSweepTime( WT_SIBC , getWorkTime() - start , sibcPartition.numCells );
+
+  return;
+
+}
+
+/* Zero tangential electric field on mesh. These should be unnecessary. */
+static void zeroSibcSurfacesEfield( void )
+{
+
+  int i , j , k;
+
+  for( SurfaceIndex surface = 0 ; surface < numSibcSurface ; surface++ )
+  {
+    for( i = sibcArray[surface].gbbox[XLO] ; i < sibcArray[surface].gbbox[XHI] ; i++ )
+      for( j = sibcArray[surface].gbbox[YLO] ; j < sibcArray[surface].gbbox[YHI] ; j++ )
+        for( k = sibcArray[surface].gbbox[ZLO] ; k < sibcArray[surface].gbbox[ZHI] ; k++ )
+          switch( sibcArray[surface].normal )
+          {
+          case XDIR:
             Ey[i][j][k] = 0.0;
             Ey[i][j][k+1] = 0.0;
             Ez[i][j][k] = 0.0;
             Ez[i][j+1][k] = 0.0;
-            /* Find magnetc field at face centre. */
-            Htan[0] = 0.5 * ( 1 + sibcArray[surface].isAdjA[ii][jj][kk][0] + sibcArray[surface].isAdjA[ii][jj][kk][1] ) 
-                          * ( UNSCALE_Hy( Hy[i-1][j][k] , j ) + UNSCALE_Hy( Hy[i-1][j+1][k] , j + 1 ) );
-            Htan[1] = 0.5 * ( 1 + sibcArray[surface].isAdjB[ii][jj][kk][0] + sibcArray[surface].isAdjB[ii][jj][kk][1] ) 
-                          * ( UNSCALE_Hy( Hy[i][j][k]   , j ) + UNSCALE_Hy( Hy[i][j+1][k]   , j + 1 ) );
-            Htan[2] = 0.5 * ( 1 + sibcArray[surface].isAdjA[ii][jj][kk][2] + sibcArray[surface].isAdjA[ii][jj][kk][3] ) 
-                          * ( UNSCALE_Hz( Hz[i-1][j][k] , k ) + UNSCALE_Hz( Hz[i-1][j][k+1] , k + 1 ) );
-            Htan[3] = 0.5 * ( 1 + sibcArray[surface].isAdjB[ii][jj][kk][2] + sibcArray[surface].isAdjB[ii][jj][kk][3] )
-                          * ( UNSCALE_Hz( Hz[i][j][k]   , k ) + UNSCALE_Hz( Hz[i][j][k+1]   , k + 1 ) );
-            /* Transform magnetic field vectors from mesh to principal axes. */
-            matMulVector( Hin , A , Htan );
-
-            /* Apply SIBC. */
-            for( p = 0 ; p < 4 ; p++ )
-            {
-              Eout[p] = 0.0;
-              for( q = 0 ; q < 4 ; q++ )
-                Eout[p] = Eout[p] + yfRecConvStep( sibcArray[surface].boundary->rcm.rc[p][q] , &sibcArray[surface].rcm_s[ii][jj][kk].rc_s[p][q] , Hin[q] );
-            } 
-            /* Transform output electric field from principal to mesh axes and store in surface. */ 
-            matMulVector( sibcArray[surface].Etan[ii][jj][kk] , B , Eout );            
-          }
-      break;
-    case YDIR:
-      for( i = sibcArray[surface].gbbox[XLO] , ii = 0 ; i < sibcArray[surface].gbbox[XHI] ; i++ , ii++ )
-        for( j = sibcArray[surface].gbbox[YLO] , jj = 0 ; j < sibcArray[surface].gbbox[YHI] ; j++ , jj++ )
-          for( k = sibcArray[surface].gbbox[ZLO] , kk = 0 ; k < sibcArray[surface].gbbox[ZHI] ; k++ , kk++ )
-          {
-            /* Zero tangential electric field on mesh. These should be unnecessary. */
+            break;
+          case YDIR:
             Ez[i][j][k] = 0.0;
             Ez[i+1][j][k] = 0.0;
             Ex[i][j][k] = 0.0;
             Ex[i][j][k+1] = 0.0;
-            /* Find magnetc field at face centre. */
-            Htan[0] = 0.5 * ( 1 + sibcArray[surface].isAdjA[ii][jj][kk][0] + sibcArray[surface].isAdjA[ii][jj][kk][1] ) 
-                          * ( UNSCALE_Hz( Hz[i][j-1][k] , k ) + UNSCALE_Hz( Hz[i][j-1][k+1] , k + 1 ) );
-            Htan[1] = 0.5 * ( 1 + sibcArray[surface].isAdjB[ii][jj][kk][0] + sibcArray[surface].isAdjB[ii][jj][kk][1] )
-                          * ( UNSCALE_Hz( Hz[i][j][k]   , k ) + UNSCALE_Hz( Hz[i][j][k+1]   , k + 1 ) );
-            Htan[2] = 0.5 * ( 1 + sibcArray[surface].isAdjA[ii][jj][kk][2] + sibcArray[surface].isAdjA[ii][jj][kk][3] ) 
-                          * ( UNSCALE_Hx( Hx[i][j-1][k] , i ) + UNSCALE_Hx( Hx[i+1][j-1][k] , i + 1 ) );
-            Htan[3] = 0.5 * ( 1 + sibcArray[surface].isAdjB[ii][jj][kk][2] + sibcArray[surface].isAdjB[ii][jj][kk][3] )
-                          * ( UNSCALE_Hx( Hx[i][j][k]   , i ) + UNSCALE_Hx( Hx[i+1][j][k]   , i + 1 ) );
-            /* Transform magnetic field vectors from mesh to principal axes. */
-            matMulVector( Hin , A , Htan );   
-            /* Apply SIBC. */       
-            for( p = 0 ; p < 4 ; p++ )
-            {
-              Eout[p] = 0.0;
-              for( q = 0 ; q < 4 ; q++ )
-                Eout[p] = Eout[p] + yfRecConvStep( sibcArray[surface].boundary->rcm.rc[p][q] , &sibcArray[surface].rcm_s[ii][jj][kk].rc_s[p][q] , Hin[q] );
-            }
-            /* Transform output electric field from principal to mesh axes and store in surface. */ 
-            matMulVector( sibcArray[surface].Etan[ii][jj][kk] , B , Eout );
-          }
-      break;
-    case ZDIR:
-      for( i = sibcArray[surface].gbbox[XLO] , ii = 0 ; i < sibcArray[surface].gbbox[XHI] ; i++ , ii++ )
-        for( j = sibcArray[surface].gbbox[YLO] , jj = 0 ; j < sibcArray[surface].gbbox[YHI] ; j++ , jj++ )
-          for( k = sibcArray[surface].gbbox[ZLO] , kk = 0 ; k < sibcArray[surface].gbbox[ZHI] ; k++ , kk++ )
-          {
-            /* Zero tangential electric field on mesh. These should be unnecessary. */
+            break;
+          case ZDIR:
             Ex[i][j][k] = 0.0;
             Ex[i][j+1][k] = 0.0;
             Ey[i][j][k] = 0.0;
             Ey[i+1][j][k] = 0.0;
-            /* Find magnetc field at face centre. */
-            Htan[0] = 0.5 * ( 1 + sibcArray[surface].isAdjA[ii][jj][kk][0] + sibcArray[surface].isAdjA[ii][jj][kk][1] )
-                          * ( UNSCALE_Hx( Hx[i][j][k-1] , i ) + UNSCALE_Hx( Hx[i+1][j][k-1] , i + 1 ) );
-            Htan[1] = 0.5 * ( 1 + sibcArray[surface].isAdjB[ii][jj][kk][0] + sibcArray[surface].isAdjB[ii][jj][kk][1] )
-                          * ( UNSCALE_Hx( Hx[i][j][k]   , i ) + UNSCALE_Hx( Hx[i+1][j][k]   , i + 1 ) );
-            Htan[2] = 0.5 * ( 1 + sibcArray[surface].isAdjA[ii][jj][kk][2] + sibcArray[surface].isAdjA[ii][jj][kk][3] )
-                          * ( UNSCALE_Hy( Hy[i][j][k-1] , j ) + UNSCALE_Hy( Hy[i][j+1][k-1] , j + 1 ) );
-            Htan[3] = 0.5 * ( 1 + sibcArray[surface].isAdjB[ii][jj][kk][2] + sibcArray[surface].isAdjB[ii][jj][kk][3] )
-                          * ( UNSCALE_Hy( Hy[i][j][k]   , j ) + UNSCALE_Hy( Hy[i][j+1][k]   , j + 1 ) );
-            /* Transform magnetic field vectors from mesh to principal axes. */
-            matMulVector( Hin , A , Htan );
-            /* Apply SIBC. */
-            for( p = 0 ; p < 4 ; p++ )
-            {
-              Eout[p] = 0.0;
-              for( q = 0 ; q < 4 ; q++ )
-                Eout[p] = Eout[p] + yfRecConvStep( sibcArray[surface].boundary->rcm.rc[p][q] , &sibcArray[surface].rcm_s[ii][jj][kk].rc_s[p][q] , Hin[q] );
-            }
-            /* Transform output electric field from principal to mesh axes and store in surface. */ 
-            matMulVector( sibcArray[surface].Etan[ii][jj][kk] , B , Eout );
-          }         
-      break;
-    default:
-      assert( 0 );
-      break;
-    } /* switch */
+            break;
+          default:
+            assert( 0 );
+            break;
+          }
+  }
 
-  } /* for */
+  return;
+
+}
+
+/* SIBC E field update over the faces of a task. */
+static void updateSibcTaskEfield( SibcTask *task )
+{
+
+  int i , j , k , p , q;
+  int ii , jj , kk;
+  real Eout[4];
+  real Htan[4];
+  real Hin[4];
+  real A[4][4] = { { 0.0 } };
+  real B[4][4] = { { 0.0 } };
+
+  SurfaceIndex surface = task->surface;
+  int *lim = task->lim;
+
+  /* Find orientation and polarisation matrices for surface. 
+   * This could be done at init phase and saved but could be a huge memory
+     hog if there are many one face TBs in the mesh.
+   */ 
+  switch( sibcArray[surface].orientation )
+  {
+  case 1:
+    matLinearComb( A , sibcArray[surface].cosa , Acp , sibcArray[surface].sina , Asp );
+    matLinearComb( B , sibcArray[surface].cosa , Bcp , sibcArray[surface].sina , Bsp );
+    break;
+  case -1:
+    matLinearComb( A , sibcArray[surface].cosa , Acm , sibcArray[surface].sina , Asm );
+    matLinearComb( B , sibcArray[surface].cosa , Bcm , sibcArray[surface].sina , Bsm );
+    break;
+  default:
+    assert( 0 );
+    break;
+  }
+
+  switch( sibcArray[surface].normal )
+  {
+  case XDIR:
+    for( i = lim[XLO] , ii = lim[XLO] - sibcArray[surface].gbbox[XLO] ; i < lim[XHI] ; i++ , ii++ )
+      for( j = lim[YLO] , jj = lim[YLO] - sibcArray[surface].gbbox[YLO] ; j < lim[YHI] ; j++ , jj++ )
+        for( k = lim[ZLO] , kk = lim[ZLO] - sibcArray[surface].gbbox[ZLO] ; k < lim[ZHI] ; k++ , kk++ )
+        { 
+          /* Find magnetc field at face centre. */
+          Htan[0] = 0.5 * ( 1 + sibcArray[surface].isAdjA[ii][jj][kk][0] + sibcArray[surface].isAdjA[ii][jj][kk][1] ) 
+                        * ( UNSCALE_Hy( Hy[i-1][j][k] , j ) + UNSCALE_Hy( Hy[i-1][j+1][k] , j + 1 ) );
+          Htan[1] = 0.5 * ( 1 + sibcArray[surface].isAdjB[ii][jj][kk][0] + sibcArray[surface].isAdjB[ii][jj][kk][1] ) 
+                        * ( UNSCALE_Hy( Hy[i][j][k]   , j ) + UNSCALE_Hy( Hy[i][j+1][k]   , j + 1 ) );
+          Htan[2] = 0.5 * ( 1 + sibcArray[surface].isAdjA[ii][jj][kk][2] + sibcArray[surface].isAdjA[ii][jj][kk][3] ) 
+                        * ( UNSCALE_Hz( Hz[i-1][j][k] , k ) + UNSCALE_Hz( Hz[i-1][j][k+1] , k + 1 ) );
+          Htan[3] = 0.5 * ( 1 + sibcArray[surface].isAdjB[ii][jj][kk][2] + sibcArray[surface].isAdjB[ii][jj][kk][3] )
+                        * ( UNSCALE_Hz( Hz[i][j][k]   , k ) + UNSCALE_Hz( Hz[i][j][k+1]   , k + 1 ) );
+          /* Transform magnetic field vectors from mesh to principal axes. */
+          matMulVector( Hin , A , Htan );
+
+          /* Apply SIBC. */
+          for( p = 0 ; p < 4 ; p++ )
+          {
+            Eout[p] = 0.0;
+            for( q = 0 ; q < 4 ; q++ )
+              Eout[p] = Eout[p] + yfRecConvStep( sibcArray[surface].boundary->rcm.rc[p][q] , &sibcArray[surface].rcm_s[ii][jj][kk].rc_s[p][q] , Hin[q] );
+          } 
+          /* Transform output electric field from principal to mesh axes and store in surface. */ 
+          matMulVector( sibcArray[surface].Etan[ii][jj][kk] , B , Eout );            
+        }
+    break;
+  case YDIR:
+    for( i = lim[XLO] , ii = lim[XLO] - sibcArray[surface].gbbox[XLO] ; i < lim[XHI] ; i++ , ii++ )
+      for( j = lim[YLO] , jj = lim[YLO] - sibcArray[surface].gbbox[YLO] ; j < lim[YHI] ; j++ , jj++ )
+        for( k = lim[ZLO] , kk = lim[ZLO] - sibcArray[surface].gbbox[ZLO] ; k < lim[ZHI] ; k++ , kk++ )
+        {
+          /* Find magnetc field at face centre. */
+          Htan[0] = 0.5 * ( 1 + sibcArray[surface].isAdjA[ii][jj][kk][0] + sibcArray[surface].isAdjA[ii][jj][kk][1] ) 
+                        * ( UNSCALE_Hz( Hz[i][j-1][k] , k ) + UNSCALE_Hz( Hz[i][j-1][k+1] , k + 1 ) );
+          Htan[1] = 0.5 * ( 1 + sibcArray[surface].isAdjB[ii][jj][kk][0] + sibcArray[surface].isAdjB[ii][jj][kk][1] )
+                        * ( UNSCALE_Hz( Hz[i][j][k]   , k ) + UNSCALE_Hz( Hz[i][j][k+1]   , k + 1 ) );
+          Htan[2] = 0.5 * ( 1 + sibcArray[surface].isAdjA[ii][jj][kk][2] + sibcArray[surface].isAdjA[ii][jj][kk][3] ) 
+                        * ( UNSCALE_Hx( Hx[i][j-1][k] , i ) + UNSCALE_Hx( Hx[i+1][j-1][k] , i + 1 ) );
+          Htan[3] = 0.5 * ( 1 + sibcArray[surface].isAdjB[ii][jj][kk][2] + sibcArray[surface].isAdjB[ii][jj][kk][3] )
+                        * ( UNSCALE_Hx( Hx[i][j][k]   , i ) + UNSCALE_Hx( Hx[i+1][j][k]   , i + 1 ) );
+          /* Transform magnetic field vectors from mesh to principal axes. */
+          matMulVector( Hin , A , Htan );   
+          /* Apply SIBC. */       
+          for( p = 0 ; p < 4 ; p++ )
+          {
+            Eout[p] = 0.0;
+            for( q = 0 ; q < 4 ; q++ )
+              Eout[p] = Eout[p] + yfRecConvStep( sibcArray[surface].boundary->rcm.rc[p][q] , &sibcArray[surface].rcm_s[ii][jj][kk].rc_s[p][q] , Hin[q] );
+          }
+          /* Transform output electric field from principal to mesh axes and store in surface. */ 
+          matMulVector( sibcArray[surface].Etan[ii][jj][kk] , B , Eout );
+        }
+    break;
+  case ZDIR:
+    for( i = lim[XLO] , ii = lim[XLO] - sibcArray[surface].gbbox[XLO] ; i < lim[XHI] ; i++ , ii++ )
+      for( j = lim[YLO] , jj = lim[YLO] - sibcArray[surface].gbbox[YLO] ; j < lim[YHI] ; j++ , jj++ )
+        for( k = lim[ZLO] , kk = lim[ZLO] - sibcArray[surface].gbbox[ZLO] ; k < lim[ZHI] ; k++ , kk++ )
+        {
+          /* Find magnetc field at face centre. */
+          Htan[0] = 0.5 * ( 1 + sibcArray[surface].isAdjA[ii][jj][kk][0] + sibcArray[surface].isAdjA[ii][jj][kk][1] )
+                        * ( UNSCALE_Hx( Hx[i][j][k-1] , i ) + UNSCALE_Hx( Hx[i+1][j][k-1] , i + 1 ) );
+          Htan[1] = 0.5 * ( 1 + sibcArray[surface].isAdjB[ii][jj][kk][0] + sibcArray[surface].isAdjB[ii][jj][kk][1] )
+                        * ( UNSCALE_Hx( Hx[i][j][k]   , i ) + UNSCALE_Hx( Hx[i+1][j][k]   , i + 1 ) );
+          Htan[2] = 0.5 * ( 1 + sibcArray[surface].isAdjA[ii][jj][kk][2] + sibcArray[surface].isAdjA[ii][jj][kk][3] )
+                        * ( UNSCALE_Hy( Hy[i][j][k-1] , j ) + UNSCALE_Hy( Hy[i][j+1][k-1] , j + 1 ) );
+          Htan[3] = 0.5 * ( 1 + sibcArray[surface].isAdjB[ii][jj][kk][2] + sibcArray[surface].isAdjB[ii][jj][kk][3] )
+                        * ( UNSCALE_Hy( Hy[i][j][k]   , j ) + UNSCALE_Hy( Hy[i][j+1][k]   , j + 1 ) );
+          /* Transform magnetic field vectors from mesh to principal axes. */
+          matMulVector( Hin , A , Htan );
+          /* Apply SIBC. */
+          for( p = 0 ; p < 4 ; p++ )
+          {
+            Eout[p] = 0.0;
+            for( q = 0 ; q < 4 ; q++ )
+              Eout[p] = Eout[p] + yfRecConvStep( sibcArray[surface].boundary->rcm.rc[p][q] , &sibcArray[surface].rcm_s[ii][jj][kk].rc_s[p][q] , Hin[q] );
+          }
+          /* Transform output electric field from principal to mesh axes and store in surface. */ 
+          matMulVector( sibcArray[surface].Etan[ii][jj][kk] , B , Eout );
+        }         
+    break;
+  default:
+    assert( 0 );
+    break;
+  } /* switch */
 
   return;
 
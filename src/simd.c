@@ -0,0 +1,156 @@
+/* 
+ * This file is part of Vulture.
+ *
+ * Vulture finite-difference time-domain electromagnetic solver.
+ * Copyright (C) 2011-2016 Ian David Flintoft
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ *
+ * Author: Ian Flintoft <ian.flintoft@googlemail.com>
+ *
+ */
+
+#include <string.h>
+
+#include "simd.h"
+#include "message.h"
+
+/*
+ * Generic kernels.
+ */
+
+#define SIMD_SUFFIX generic
+#define SIMD_TABLE simdKernelsGeneric
+#define V_T real
+#define V_LEN 1
+#define V_LOAD( p ) ( *(p) )
+#define V_STORE( p , v ) ( *(p) = (v) )
+#define V_SET1( s ) ( s )
+#define V_ADD( a , b ) ( (a) + (b) )
+#define V_SUB( a , b ) ( (a) - (b) )
+#define V_MUL( a , b ) ( (a) * (b) )
+
+#include "simd_kernels.h"
+
+/*
+ * Global data.
+ */
+
+/* Kernels selected for this processor. */
+const SimdKernels *simdKernels = &simdKernelsGeneric;
+
+/*
+ * Private data.
+ */
+
+/* SIMD instruction set names. */
+char SIMD_LEVEL_STR[5][10] = { "GENERIC" , "SSE2" , "AVX2" , "AVX512" , "UNDEFINED" };
+
+/* Highest instruction set allowed. */
+static SimdLevel maxSimdLevel = SL_AVX512;
+
+/* Instruction set in use. */
+static SimdLevel simdLevel = SL_GENERIC;
+
+/*
+ * Private method interfaces.
+ */
+
+SimdLevel getCpuSimdLevel( void );
+
+/*
+ * Method Implementations.
+ */
+
+/* Limit the instruction set used by the kernels. */
+bool setSimdLevel( char *name )
+{
+
+  for( SimdLevel level = SL_GENERIC ; level < SL_UNDEFINED ; level++ )
+  {
+    if( strncmp( name , SIMD_LEVEL_STR[level] , TAG_SIZE ) == 0 )
+    {
+      maxSimdLevel = level;
+      return true;
+    }
+  }
+
+  return false;
+
+}
+
+/* Find the highest instruction set supported by the processor. */
+SimdLevel getCpuSimdLevel( void )
+{
+
+  __builtin_cpu_init();
+
+  if( __builtin_cpu_supports( "avx512f" ) )
+    return SL_AVX512;
+  else if( __builtin_cpu_supports( "avx2" ) )
+    return SL_AVX2;
+  else if( __builtin_cpu_supports( "sse2" ) )
+    return SL_SSE2;
+  else
+    return SL_GENERIC;
+
+}
+
+/* Select the kernels for the processor. */
+void initSimd( void )
+{
+
+  SimdLevel cpuLevel;
+
+  cpuLevel = getCpuSimdLevel();
+  simdLevel = cpuLevel < maxSimdLevel ? cpuLevel : maxSimdLevel;
+
+  switch( simdLevel )
+  {
+  case SL_AVX512:
+    simdKernels = &simdKernelsAvx512;
+    break;
+  case SL_AVX2:
+    simdKernels = &simdKernelsAvx2;
+    break;
+  case SL_SSE2:
+    simdKernels = &simdKernelsSse2;
+    break;
+  default:
+    simdKernels = &simdKernelsGeneric;
+    break;
+  }
+
+  message( MSG_DEBUG1 , 0 , "  Processor supports %s instructions\n" , SIMD_LEVEL_STR[cpuLevel] );
+
+  return;
+
+}
+
+/* Get instruction set in use. */
+SimdLevel getSimdLevel( void )
+{
+
+  return simdLevel;
+
+}
+
+/* Get name of instruction set in use. */
+char *getSimdLevelName( void )
+{
+
+  return SIMD_LEVEL_STR[simdLevel];
+
+}
@@ -0,0 +1,157 @@
+/* 
+ * This file is part of Vulture.
+ *
+ * Vulture finite-difference time-domain electromagnetic solver.
+ * Copyright (C) 2011-2016 Ian David Flintoft
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ *
+ * Author: Ian Flintoft <ian.flintoft@googlemail.com>
+ *
+ */
+
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+#include <stdbool.h>
+
+#include "fdtd_types.h"
+
+/*
+ * The SIMD kernels require contiguous update coefficients along k and
+ * cannot mark visited fields so are only used for unindexed media outside
+ * limit checking mode.
+ */
+#if defined( WITH_SIMD ) && !defined( USE_INDEXED_MEDIA ) && !defined( CHECK_LIMITS )
+  #define USE_SIMD_KERNELS
+#endif
+
+/* SIMD instruction sets. */
+typedef enum {
+
+  SL_GENERIC,
+  SL_SSE2,
+  SL_AVX2,
+  SL_AVX512,
+  SL_UNDEFINED
+
+} SimdLevel;
+
+#define NUM_SIMD_LEVELS SL_UNDEFINED
+
+/*
+ * Pencil update kernels.
+ *
+ * Each updates n consecutive cells along k. All array arguments point to the
+ * first cell of the pencil, so for example Hy_k1 points to Hy[i][j][klo-1].
+ * "SA" kernels have one curl term with a scalar inverse edge length and one
+ * with inverse edge lengths that vary along the pencil, "SS" kernels have
+ * two scalar inverse edge lengths.
+ */
+
+/* f = alpha * f + beta * ( s * ( a - b ) + v[k] * ( c - d ) ). */
+typedef void (*SimdEfieldSA)( int n , real *f , const real *alpha , const real *beta ,
+                              real s , const real *a , const real *b ,
+                              const real *v , const real *c , const real *d );
+
+/* f = alpha * f + beta * ( s * ( a - b ) + t * ( c - d ) ). */
+typedef void (*SimdEfieldSS)( int n , real *f , const real *alpha , const real *beta ,
+                              real s , const real *a , const real *b ,
+                              real t , const real *c , const real *d );
+
+/* f = f + gamma * ( s * ( a - b ) + v[k] * ( c - d ) ). */
+typedef void (*SimdHfieldSA)( int n , real *f , const real *gamma ,
+                              real s , const real *a , const real *b ,
+                              const real *v , const real *c , const real *d );
+
+/* f = f + gamma * ( s * ( a - b ) + t * ( c - d ) ). */
+typedef void (*SimdHfieldSS)( int n , real *f , const real *gamma ,
+                              real s , const real *a , const real *b ,
+                              real t , const real *c , const real *d );
+
+/* As above with alpha and beta, or gamma, uniform along the pencil. */
+typedef void (*SimdEfieldUniformSA)( int n , real *f , real alpha , real beta ,
+                                     real s , const real *a , const real *b ,
+                                     const real *v , const real *c , const real *d );
+typedef void (*SimdEfieldUniformSS)( int n , real *f , real alpha , real beta ,
+                                     real s , const real *a , const real *b ,
+                                     real t , const real *c , const real *d );
+typedef void (*SimdHfieldUniformSA)( int n , real *f , real gamma ,
+                                     real s , const real *a , const real *b ,
+                                     const real *v , const real *c , const real *d );
+typedef void (*SimdHfieldUniformSS)( int n , real *f , real gamma ,
+                                     real s , const real *a , const real *b ,
+                                     real t , const real *c , const real *d );
+
+/* UPML electric field update - see updatePmlEfield for the coefficients. */
+typedef void (*SimdPmlEx)( int n , real *Ex , real *PPx , real *Px , const real *alpha , const real *beta ,
+                           real idhy_j , const real *Hz , const real *Hz_j1 , const real *idhz , const real *Hy_k1 , const real *Hy ,
+                           real ady_j , real bdy_j , const real *adz , const real *bdz , real ibhx_i , real ahx_i );
+typedef void (*SimdPmlEy)( int n , real *Ey , real *PPy , real *Py , const real *alpha , const real *beta ,
+                           real idhx_i , const real *Hz_i1 , const real *Hz , const real *idhz , const real *Hx , const real *Hx_k1 ,
+                           const real *adz , const real *bdz , real adx_i , real bdx_i , real ibhy_j , real ahy_j );
+typedef void (*SimdPmlEz)( int n , real *Ez , real *PPz , real *Pz , const real *alpha , const real *beta ,
+                           real idhx_i , const real *Hy , const real *Hy_i1 , real idhy_j , const real *Hx_j1 , const real *Hx ,
+                           real adx_i , real bdx_i , real ady_j , real bdy_j , const real *ibhz , const real *ahz );
+
+/* UPML magnetic field update - see updatePmlHfield for the coefficients. */
+typedef void (*SimdPmlHx)( int n , real *Hx , real *Bx , const real *gamma ,
+                           real idey_j , const real *Ez , const real *Ez_j1 , const real *idez , const real *Ey_k1 , const real *Ey ,
+                           real ahy_j , real bhy_j , const real *ahz , const real *bhz , real ibdx_i , real adx_i );
+typedef void (*SimdPmlHy)( int n , real *Hy , real *By , const real *gamma ,
+                           real idex_i , const real *Ez_i1 , const real *Ez , const real *idez , const real *Ex , const real *Ex_k1 ,
+                           const real *ahz , const real *bhz , real ahx_i , real bhx_i , real ibdy_j , real ady_j );
+typedef void (*SimdPmlHz)( int n , real *Hz , real *Bz , const real *gamma ,
+                           real idey_j , const real *Ex_j1 , const real *Ex , real idex_i , const real *Ey , const real *Ey_i1 ,
+                           real ahx_i , real bhx_i , real ahy_j , real bhy_j , const real *ibdz , const real *adz );
+
+/* Kernel table for one instruction set. */
+typedef struct SimdKernels_t {
+
+  SimdEfieldSA updateEfieldSA;
+  SimdEfieldSS updateEfieldSS;
+  SimdHfieldSA updateHfieldSA;
+  SimdHfieldSS updateHfieldSS;
+  SimdEfieldUniformSA updateEfieldUniformSA;
+  SimdEfieldUniformSS updateEfieldUniformSS;
+  SimdHfieldUniformSA updateHfieldUniformSA;
+  SimdHfieldUniformSS updateHfieldUniformSS;
+  SimdPmlEx updatePmlEx;
+  SimdPmlEy updatePmlEy;
+  SimdPmlEz updatePmlEz;
+  SimdPmlHx updatePmlHx;
+  SimdPmlHy updatePmlHy;
+  SimdPmlHz updatePmlHz;
+
+} SimdKernels;
+
+/* Kernels selected for this processor. */
+extern const SimdKernels *simdKernels;
+
+/* Kernel tables for each instruction set. */
+extern const SimdKernels simdKernelsGeneric;
+extern const SimdKernels simdKernelsSse2;
+extern const SimdKernels simdKernelsAvx2;
+extern const SimdKernels simdKernelsAvx512;
+
+/* Instruction set names. */
+extern char SIMD_LEVEL_STR[5][10];
+
+bool setSimdLevel( char *name );
+void initSimd( void );
+SimdLevel getSimdLevel( void );
+char *getSimdLevelName( void );
+
+#endif
@@ -0,0 +1,464 @@
+/* 
+ * This file is part of Vulture.
+ *
+ * Vulture finite-difference time-domain electromagnetic solver.
+ * Copyright (C) 2011-2016 Ian David Flintoft
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ *
+ * Author: Ian Flintoft <ian.flintoft@googlemail.com>
+ *
+ */
+
+/*
+ * SIMD pencil update kernels.
+ *
+ * This file is included once by each instruction set specific source file
+ * after defining:
+ *
+ *   SIMD_SUFFIX      - suffix for the function and kernel table names.
+ *   SIMD_TABLE       - name of the kernel table.
+ *   V_T              - vector type.
+ *   V_LEN            - number of reals in a vector.
+ *   V_LOAD( p )      - unaligned load.
+ *   V_STORE( p , v ) - unaligned store.
+ *   V_SET1( s )      - broadcast scalar.
+ *   V_ADD, V_SUB, V_MUL - arithmetic.
+ *
+ * The vector loops handle whole vectors and the remainder of each pencil is
+ * passed to the generic kernels. The operations are performed in the same order
+ * as the scalar updates in grid.c and pml.c without fused multiply-adds so all
+ * instruction sets give identical results.
+ */
+
+#define SIMD_CAT2( name , suffix ) name ## _ ## suffix
+#define SIMD_CAT( name , suffix ) SIMD_CAT2( name , suffix )
+#define SIMD_FUNC( name ) SIMD_CAT( name , SIMD_SUFFIX )
+
+#ifdef USE_SCALED_FIELDS
+  #define SIMD_CURL( s , a , b , t , c , d ) ( (void)( s ) , (void)( t ) , V_ADD( V_SUB( a , b ) , V_SUB( c , d ) ) )
+#else
+  #define SIMD_CURL( s , a , b , t , c , d ) V_ADD( V_MUL( s , V_SUB( a , b ) ) , V_MUL( t , V_SUB( c , d ) ) )
+#endif
+
+/* Generic kernels used for the pencil remainders. */
+void updateEfieldSA_generic( int n , real *f , const real *alpha , const real *beta , real s , const real *a , const real *b , const real *v , const real *c , const real *d );
+void updateEfieldSS_generic( int n , real *f , const real *alpha , const real *beta , real s , const real *a , const real *b , real t , const real *c , const real *d );
+void updateHfieldSA_generic( int n , real *f , const real *gamma , real s , const real *a , const real *b , const real *v , const real *c , const real *d );
+void updateHfieldSS_generic( int n , real *f , const real *gamma , real s , const real *a , const real *b , real t , const real *c , const real *d );
+void updateEfieldUniformSA_generic( int n , real *f , real alpha , real beta , real s , const real *a , const real *b , const real *v , const real *c , const real *d );
+void updateEfieldUniformSS_generic( int n , real *f , real alpha , real beta , real s , const real *a , const real *b , real t , const real *c , const real *d );
+void updateHfieldUniformSA_generic( int n , real *f , real gamma , real s , const real *a , const real *b , const real *v , const real *c , const real *d );
+void updateHfieldUniformSS_generic( int n , real *f , real gamma , real s , const real *a , const real *b , real t , const real *c , const real *d );
+void updatePmlEx_generic( int n , real *Ex , real *PPx , real *Px , const real *alpha , const real *beta ,
+                          real idhy_j , const real *Hz , const real *Hz_j1 , const real *idhz , const real *Hy_k1 , const real *Hy ,
+                          real ady_j , real bdy_j , const real *adz , const real *bdz , real ibhx_i , real ahx_i );
+void updatePmlEy_generic( int n , real *Ey , real *PPy , real *Py , const real *alpha , const real *beta ,
+                          real idhx_i , const real *Hz_i1 , const real *Hz , const real *idhz , const real *Hx , const real *Hx_k1 ,
+                          const real *adz , const real *bdz , real adx_i , real bdx_i , real ibhy_j , real ahy_j );
+void updatePmlEz_generic( int n , real *Ez , real *PPz , real *Pz , const real *alpha , const real *beta ,
+                          real idhx_i , const real *Hy , const real *Hy_i1 , real idhy_j , const real *Hx_j1 , const real *Hx ,
+                          real adx_i , real bdx_i , real ady_j , real bdy_j , const real *ibhz , const real *ahz );
+void updatePmlHx_generic( int n , real *Hx , real *Bx , const real *gamma ,
+                          real idey_j , const real *Ez , const real *Ez_j1 , const real *idez , const real *Ey_k1 , const real *Ey ,
+                          real ahy_j , real bhy_j , const real *ahz , const real *bhz , real ibdx_i , real adx_i );
+void updatePmlHy_generic( int n , real *Hy , real *By , const real *gamma ,
+                          real idex_i , const real *Ez_i1 , const real *Ez , const real *idez , const real *Ex , const real *Ex_k1 ,
+                          const real *ahz , const real *bhz , real ahx_i , real bhx_i , real ibdy_j , real ady_j );
+void updatePmlHz_generic( int n , real *Hz , real *Bz , const real *gamma ,
+                          real idey_j , const real *Ex_j1 , const real *Ex , real idex_i , const real *Ey , const real *Ey_i1 ,
+                          real ahx_i , real bhx_i , real ahy_j , real bhy_j , const real *ibdz , const real *adz );
+
+/* Pass the remainder of a pencil to the generic kernel. */
+#if V_LEN > 1
+  #define SIMD_REMAINDER( name , args ) if( k < n ) name ## _generic args
+#else
+  #define SIMD_REMAINDER( name , args )
+#endif
+
+/* f = alpha * f + beta * ( s * ( a - b ) + v[k] * ( c - d ) ). */
+void SIMD_FUNC( updateEfieldSA )( int n , real *f , const real *alpha , const real *beta , real s , const real *a , const real *b , const real *v , const real *c , const real *d )
+{
+
+  int k;
+  V_T vs = V_SET1( s );
+
+  for( k = 0 ; k <= n - V_LEN ; k += V_LEN )
+  {
+    V_T curl = SIMD_CURL( vs , V_LOAD( a + k ) , V_LOAD( b + k ) , V_LOAD( v + k ) , V_LOAD( c + k ) , V_LOAD( d + k ) );
+    V_STORE( f + k , V_ADD( V_MUL( V_LOAD( alpha + k ) , V_LOAD( f + k ) ) , V_MUL( V_LOAD( beta + k ) , curl ) ) );
+  }
+
+  SIMD_REMAINDER( updateEfieldSA , ( n - k , f + k , alpha + k , beta + k , s , a + k , b + k , v + k , c + k , d + k ) );
+
+  return;
+
+}
+
+/* f = alpha * f + beta * ( s * ( a - b ) + t * ( c - d ) ). */
+void SIMD_FUNC( updateEfieldSS )( int n , real *f , const real *alpha , const real *beta , real s , const real *a , const real *b , real t , const real *c , const real *d )
+{
+
+  int k;
+  V_T vs = V_SET1( s );
+  V_T vt = V_SET1( t );
+
+  for( k = 0 ; k <= n - V_LEN ; k += V_LEN )
+  {
+    V_T curl = SIMD_CURL( vs , V_LOAD( a + k ) , V_LOAD( b + k ) , vt , V_LOAD( c + k ) , V_LOAD( d + k ) );
+    V_STORE( f + k , V_ADD( V_MUL( V_LOAD( alpha + k ) , V_LOAD( f + k ) ) , V_MUL( V_LOAD( beta + k ) , curl ) ) );
+  }
+
+  SIMD_REMAINDER( updateEfieldSS , ( n - k , f + k , alpha + k , beta + k , s , a + k , b + k , t , c + k , d + k ) );
+
+  return;
+
+}
+
+/* f = f + gamma * ( s * ( a - b ) + v[k] * ( c - d ) ). */
+void SIMD_FUNC( updateHfieldSA )( int n , real *f , const real *gamma , real s , const real *a , const real *b , const real *v , const real *c , const real *d )
+{
+
+  int k;
+  V_T vs = V_SET1( s );
+
+  for( k = 0 ; k <= n - V_LEN ; k += V_LEN )
+  {
+    V_T curl = SIMD_CURL( vs , V_LOAD( a + k ) , V_LOAD( b + k ) , V_LOAD( v + k ) , V_LOAD( c + k ) , V_LOAD( d + k ) );
+    V_STORE( f + k , V_ADD( V_LOAD( f + k ) , V_MUL( V_LOAD( gamma + k ) , curl ) ) );
+  }
+
+  SIMD_REMAINDER( updateHfieldSA , ( n - k , f + k , gamma + k , s , a + k , b + k , v + k , c + k , d + k ) );
+
+  return;
+
+}
+
+/* f = f + gamma * ( s * ( a - b ) + t * ( c - d ) ). */
+void SIMD_FUNC( updateHfieldSS )( int n , real *f , const real *gamma , real s , const real *a , const real *b , real t , const real *c , const real *d )
+{
+
+  int k;
+  V_T vs = V_SET1( s );
+  V_T vt = V_SET1( t );
+
+  for( k = 0 ; k <= n - V_LEN ; k += V_LEN )
+  {
+    V_T curl = SIMD_CURL( vs , V_LOAD( a + k ) , V_LOAD( b + k ) , vt , V_LOAD( c + k ) , V_LOAD( d + k ) );
+    V_STORE( f + k , V_ADD( V_LOAD( f + k ) , V_MUL( V_LOAD( gamma + k ) , curl ) ) );
+  }
+
+  SIMD_REMAINDER( updateHfieldSS , ( n - k , f + k , gamma + k , s , a + k , b + k , t , c + k , d + k ) );
+
+  return;
+
+}
+
+/* f = alpha * f + beta * ( s * ( a - b ) + v[k] * ( c - d ) ) with uniform alpha and beta. */
+void SIMD_FUNC( updateEfieldUniformSA )( int n , real *f , real alpha , real beta , real s , const real *a , const real *b , const real *v , const real *c , const real *d )
+{
+
+  int k;
+  V_T vs = V_SET1( s );
+  V_T valpha = V_SET1( alpha );
+  V_T vbeta = V_SET1( beta );
+
+  for( k = 0 ; k <= n - V_LEN ; k += V_LEN )
+  {
+    V_T curl = SIMD_CURL( vs , V_LOAD( a + k ) , V_LOAD( b + k ) , V_LOAD( v + k ) , V_LOAD( c + k ) , V_LOAD( d + k ) );
+    V_STORE( f + k , V_ADD( V_MUL( valpha , V_LOAD( f + k ) ) , V_MUL( vbeta , curl ) ) );
+  }
+
+  SIMD_REMAINDER( updateEfieldUniformSA , ( n - k , f + k , alpha , beta , s , a + k , b + k , v + k , c + k , d + k ) );
+
+  return;
+
+}
+
+/* f = alpha * f + beta * ( s * ( a - b ) + t * ( c - d ) ) with uniform alpha and beta. */
+void SIMD_FUNC( updateEfieldUniformSS )( int n , real *f , real alpha , real beta , real s , const real *a , const real *b , real t , const real *c , const real *d )
+{
+
+  int k;
+  V_T vs = V_SET1( s );
+  V_T vt = V_SET1( t );
+  V_T valpha = V_SET1( alpha );
+  V_T vbeta = V_SET1( beta );
+
+  for( k = 0 ; k <= n - V_LEN ; k += V_LEN )
+  {
+    V_T curl = SIMD_CURL( vs , V_LOAD( a + k ) , V_LOAD( b + k ) , vt , V_LOAD( c + k ) , V_LOAD( d + k ) );
+    V_STORE( f + k , V_ADD( V_MUL( valpha , V_LOAD( f + k ) ) , V_MUL( vbeta , curl ) ) );
+  }
+
+  SIMD_REMAINDER( updateEfieldUniformSS , ( n - k , f + k , alpha , beta , s , a + k , b + k , t , c + k , d + k ) );
+
+  return;
+
+}
+
+/* f = f + gamma * ( s * ( a - b ) + v[k] * ( c - d ) ) with uniform gamma. */
+void SIMD_FUNC( updateHfieldUniformSA )( int n , real *f , real gamma , real s , const real *a , const real *b , const real *v , const real *c , const real *d )
+{
+
+  int k;
+  V_T vs = V_SET1( s );
+  V_T vgamma = V_SET1( gamma );
+
+  for( k = 0 ; k <= n - V_LEN ; k += V_LEN )
+  {
+    V_T curl = SIMD_CURL( vs , V_LOAD( a + k ) , V_LOAD( b + k ) , V_LOAD( v + k ) , V_LOAD( c + k ) , V_LOAD( d + k ) );
+    V_STORE( f + k , V_ADD( V_LOAD( f + k ) , V_MUL( vgamma , curl ) ) );
+  }
+
+  SIMD_REMAINDER( updateHfieldUniformSA , ( n - k , f + k , gamma , s , a + k , b + k , v + k , c + k , d + k ) );
+
+  return;
+
+}
+
+/* f = f + gamma * ( s * ( a - b ) + t * ( c - d ) ) with uniform gamma. */
+void SIMD_FUNC( updateHfieldUniformSS )( int n , real *f , real gamma , real s , const real *a , const real *b , real t , const real *c , const real *d )
+{
+
+  int k;
+  V_T vs = V_SET1( s );
+  V_T vt = V_SET1( t );
+  V_T vgamma = V_SET1( gamma );
+
+  for( k = 0 ; k <= n - V_LEN ; k += V_LEN )
+  {
+    V_T curl = SIMD_CURL( vs , V_LOAD( a + k ) , V_LOAD( b + k ) , vt , V_LOAD( c + k ) , V_LOAD( d + k ) );
+    V_STORE( f + k , V_ADD( V_LOAD( f + k ) , V_MUL( vgamma , curl ) ) );
+  }
+
+  SIMD_REMAINDER( updateHfieldUniformSS , ( n - k , f + k , gamma , s , a + k , b + k , t , c + k , d + k ) );
+
+  return;
+
+}
+
+/* UPML Ex update. */
+void SIMD_FUNC( updatePmlEx )( int n , real *Ex , real *PPx , real *Px , const real *alpha , const real *beta ,
+                               real idhy_j , const real *Hz , const real *Hz_j1 , const real *idhz , const real *Hy_k1 , const real *Hy ,
+                               real ady_j , real bdy_j , const real *adz , const real *bdz , real ibhx_i , real ahx_i )
+{
+
+  int k;
+  V_T vidhy = V_SET1( idhy_j );
+  V_T vady = V_SET1( ady_j );
+  V_T vbdy = V_SET1( bdy_j );
+  V_T vibhx = V_SET1( ibhx_i );
+  V_T vahx = V_SET1( ahx_i );
+  V_T oldPP , oldP , newPP , newP;
+
+  for( k = 0 ; k <= n - V_LEN ; k += V_LEN )
+  {
+    oldPP = V_LOAD( PPx + k );
+    newPP = V_ADD( V_MUL( V_LOAD( alpha + k ) , oldPP ) , V_MUL( V_LOAD( beta + k ) ,
+            SIMD_CURL( vidhy , V_LOAD( Hz + k ) , V_LOAD( Hz_j1 + k ) , V_LOAD( idhz + k ) , V_LOAD( Hy_k1 + k ) , V_LOAD( Hy + k ) ) ) );
+    V_STORE( PPx + k , newPP );
+    oldP = V_LOAD( Px + k );
+    newP = V_ADD( V_MUL( vady , oldP ) , V_MUL( vbdy , V_SUB( newPP , oldPP ) ) );
+    V_STORE( Px + k , newP );
+    V_STORE( Ex + k , V_ADD( V_MUL( V_LOAD( adz + k ) , V_LOAD( Ex + k ) ) ,
+                             V_MUL( V_MUL( V_LOAD( bdz + k ) , vibhx ) , V_SUB( newP , V_MUL( vahx , oldP ) ) ) ) );
+  }
+
+  SIMD_REMAINDER( updatePmlEx , ( n - k , Ex + k , PPx + k , Px + k , alpha + k , beta + k , idhy_j , Hz + k , Hz_j1 + k , idhz + k , Hy_k1 + k , Hy + k ,
+                                  ady_j , bdy_j , adz + k , bdz + k , ibhx_i , ahx_i ) );
+
+  return;
+
+}
+
+/* UPML Ey update. */
+void SIMD_FUNC( updatePmlEy )( int n , real *Ey , real *PPy , real *Py , const real *alpha , const real *beta ,
+                               real idhx_i , const real *Hz_i1 , const real *Hz , const real *idhz , const real *Hx , const real *Hx_k1 ,
+                               const real *adz , const real *bdz , real adx_i , real bdx_i , real ibhy_j , real ahy_j )
+{
+
+  int k;
+  V_T vidhx = V_SET1( idhx_i );
+  V_T vadx = V_SET1( adx_i );
+  V_T vbdxibhy = V_MUL( V_SET1( bdx_i ) , V_SET1( ibhy_j ) );
+  V_T vahy = V_SET1( ahy_j );
+  V_T oldPP , oldP , newPP , newP;
+
+  for( k = 0 ; k <= n - V_LEN ; k += V_LEN )
+  {
+    oldPP = V_LOAD( PPy + k );
+    newPP = V_ADD( V_MUL( V_LOAD( alpha + k ) , oldPP ) , V_MUL( V_LOAD( beta + k ) ,
+            SIMD_CURL( vidhx , V_LOAD( Hz_i1 + k ) , V_LOAD( Hz + k ) , V_LOAD( idhz + k ) , V_LOAD( Hx + k ) , V_LOAD( Hx_k1 + k ) ) ) );
+    V_STORE( PPy + k , newPP );
+    oldP = V_LOAD( Py + k );
+    newP = V_ADD( V_MUL( V_LOAD( adz + k ) , oldP ) , V_MUL( V_LOAD( bdz + k ) , V_SUB( newPP , oldPP ) ) );
+    V_STORE( Py + k , newP );
+    V_STORE( Ey + k , V_ADD( V_MUL( vadx , V_LOAD( Ey + k ) ) , V_MUL( vbdxibhy , V_SUB( newP , V_MUL( vahy , oldP ) ) ) ) );
+  }
+
+  SIMD_REMAINDER( updatePmlEy , ( n - k , Ey + k , PPy + k , Py + k , alpha + k , beta + k , idhx_i , Hz_i1 + k , Hz + k , idhz + k , Hx + k , Hx_k1 + k ,
+                                  adz + k , bdz + k , adx_i , bdx_i , ibhy_j , ahy_j ) );
+
+  return;
+
+}
+
+/* UPML Ez update. */
+void SIMD_FUNC( updatePmlEz )( int n , real *Ez , real *PPz , real *Pz , const real *alpha , const real *beta ,
+                               real idhx_i , const real *Hy , const real *Hy_i1 , real idhy_j , const real *Hx_j1 , const real *Hx ,
+                               real adx_i , real bdx_i , real ady_j , real bdy_j , const real *ibhz , const real *ahz )
+{
+
+  int k;
+  V_T vidhx = V_SET1( idhx_i );
+  V_T vidhy = V_SET1( idhy_j );
+  V_T vadx = V_SET1( adx_i );
+  V_T vbdx = V_SET1( bdx_i );
+  V_T vady = V_SET1( ady_j );
+  V_T vbdy = V_SET1( bdy_j );
+  V_T oldPP , oldP , newPP , newP;
+
+  for( k = 0 ; k <= n - V_LEN ; k += V_LEN )
+  {
+    oldPP = V_LOAD( PPz + k );
+    newPP = V_ADD( V_MUL( V_LOAD( alpha + k ) , oldPP ) , V_MUL( V_LOAD( beta + k ) ,
+            SIMD_CURL( vidhx , V_LOAD( Hy + k ) , V_LOAD( Hy_i1 + k ) , vidhy , V_LOAD( Hx_j1 + k ) , V_LOAD( Hx + k ) ) ) );
+    V_STORE( PPz + k , newPP );
+    oldP = V_LOAD( Pz + k );
+    newP = V_ADD( V_MUL( vadx , oldP ) , V_MUL( vbdx , V_SUB( newPP , oldPP ) ) );
+    V_STORE( Pz + k , newP );
+    V_STORE( Ez + k , V_ADD( V_MUL( vady , V_LOAD( Ez + k ) ) ,
+                             V_MUL( V_MUL( vbdy , V_LOAD( ibhz + k ) ) , V_SUB( newP , V_MUL( V_LOAD( ahz + k ) , oldP ) ) ) ) );
+  }
+
+  SIMD_REMAINDER( updatePmlEz , ( n - k , Ez + k , PPz + k , Pz + k , alpha + k , beta + k , idhx_i , Hy + k , Hy_i1 + k , idhy_j , Hx_j1 + k , Hx + k ,
+                                  adx_i , bdx_i , ady_j , bdy_j , ibhz + k , ahz + k ) );
+
+  return;
+
+}
+
+/* UPML Hx update. */
+void SIMD_FUNC( updatePmlHx )( int n , real *Hx , real *Bx , const real *gamma ,
+                               real idey_j , const real *Ez , const real *Ez_j1 , const real *idez , const real *Ey_k1 , const real *Ey ,
+                               real ahy_j , real bhy_j , const real *ahz , const real *bhz , real ibdx_i , real adx_i )
+{
+
+  int k;
+  V_T videy = V_SET1( idey_j );
+  V_T vahy = V_SET1( ahy_j );
+  V_T vbhy = V_SET1( bhy_j );
+  V_T vibdx = V_SET1( ibdx_i );
+  V_T vadx = V_SET1( adx_i );
+  V_T oldB , newB;
+
+  for( k = 0 ; k <= n - V_LEN ; k += V_LEN )
+  {
+    oldB = V_LOAD( Bx + k );
+    newB = V_ADD( V_MUL( vahy , oldB ) , V_MUL( V_MUL( V_LOAD( gamma + k ) , vbhy ) ,
+           SIMD_CURL( videy , V_LOAD( Ez + k ) , V_LOAD( Ez_j1 + k ) , V_LOAD( idez + k ) , V_LOAD( Ey_k1 + k ) , V_LOAD( Ey + k ) ) ) );
+    V_STORE( Bx + k , newB );
+    V_STORE( Hx + k , V_ADD( V_MUL( V_LOAD( ahz + k ) , V_LOAD( Hx + k ) ) ,
+                             V_MUL( V_MUL( V_LOAD( bhz + k ) , vibdx ) , V_SUB( newB , V_MUL( vadx , oldB ) ) ) ) );
+  }
+
+  SIMD_REMAINDER( updatePmlHx , ( n - k , Hx + k , Bx + k , gamma + k , idey_j , Ez + k , Ez_j1 + k , idez + k , Ey_k1 + k , Ey + k ,
+                                  ahy_j , bhy_j , ahz + k , bhz + k , ibdx_i , adx_i ) );
+
+  return;
+
+}
+
+/* UPML Hy update. */
+void SIMD_FUNC( updatePmlHy )( int n , real *Hy , real *By , const real *gamma ,
+                               real idex_i , const real *Ez_i1 , const real *Ez , const real *idez , const real *Ex , const real *Ex_k1 ,
+                               const real *ahz , const real *bhz , real ahx_i , real bhx_i , real ibdy_j , real ady_j )
+{
+
+  int k;
+  V_T videx = V_SET1( idex_i );
+  V_T vahx = V_SET1( ahx_i );
+  V_T vbhxibdy = V_MUL( V_SET1( bhx_i ) , V_SET1( ibdy_j ) );
+  V_T vady = V_SET1( ady_j );
+  V_T oldB , newB;
+
+  for( k = 0 ; k <= n - V_LEN ; k += V_LEN )
+  {
+    oldB = V_LOAD( By + k );
+    newB = V_ADD( V_MUL( V_LOAD( ahz + k ) , oldB ) , V_MUL( V_MUL( V_LOAD( gamma + k ) , V_LOAD( bhz + k ) ) ,
+           SIMD_CURL( videx , V_LOAD( Ez_i1 + k ) , V_LOAD( Ez + k ) , V_LOAD( idez + k ) , V_LOAD( Ex + k ) , V_LOAD( Ex_k1 + k ) ) ) );
+    V_STORE( By + k , newB );
+    V_STORE( Hy + k , V_ADD( V_MUL( vahx , V_LOAD( Hy + k ) ) , V_MUL( vbhxibdy , V_SUB( newB , V_MUL( vady , oldB ) ) ) ) );
+  }
+
+  SIMD_REMAINDER( updatePmlHy , ( n - k , Hy + k , By + k , gamma + k , idex_i , Ez_i1 + k , Ez + k , idez + k , Ex + k , Ex_k1 + k ,
+                                  ahz + k , bhz + k , ahx_i , bhx_i , ibdy_j , ady_j ) );
+
+  return;
+
+}
+
+/* UPML Hz update. */
+void SIMD_FUNC( updatePmlHz )( int n , real *Hz , real *Bz , const real *gamma ,
+                               real idey_j , const real *Ex_j1 , const real *Ex , real idex_i , const real *Ey , const real *Ey_i1 ,
+                               real ahx_i , real bhx_i , real ahy_j , real bhy_j , const real *ibdz , const real *adz )
+{
+
+  int k;
+  V_T videy = V_SET1( idey_j );
+  V_T videx = V_SET1( idex_i );
+  V_T vahx = V_SET1( ahx_i );
+  V_T vbhx = V_SET1( bhx_i );
+  V_T vahy = V_SET1( ahy_j );
+  V_T vbhy = V_SET1( bhy_j );
+  V_T oldB , newB;
+
+  for( k = 0 ; k <= n - V_LEN ; k += V_LEN )
+  {
+    oldB = V_LOAD( Bz + k );
+    newB = V_ADD( V_MUL( vahx , oldB ) , V_MUL( V_MUL( V_LOAD( gamma + k ) , vbhx ) ,
+           SIMD_CURL( videy , V_LOAD( Ex_j1 + k ) , V_LOAD( Ex + k ) , videx , V_LOAD( Ey + k ) , V_LOAD( Ey_i1 + k ) ) ) );
+    V_STORE( Bz + k , newB );
+    V_STORE( Hz + k , V_ADD( V_MUL( vahy , V_LOAD( Hz + k ) ) ,
+                             V_MUL( V_MUL( vbhy , V_LOAD( ibdz + k ) ) , V_SUB( newB , V_MUL( V_LOAD( adz + k ) , oldB ) ) ) ) );
+  }
+
+  SIMD_REMAINDER( updatePmlHz , ( n - k , Hz + k , Bz + k , gamma + k , idey_j , Ex_j1 + k , Ex + k , idex_i , Ey + k , Ey_i1 + k ,
+                                  ahx_i , bhx_i , ahy_j , bhy_j , ibdz + k , adz + k ) );
+
+  return;
+
+}
+
+/* Kernel table. */
+const SimdKernels SIMD_TABLE = {
+
+  SIMD_FUNC( updateEfieldSA ),
+  SIMD_FUNC( updateEfieldSS ),
+  SIMD_FUNC( updateHfieldSA ),
+  SIMD_FUNC( updateHfieldSS ),
+  SIMD_FUNC( updateEfieldUniformSA ),
+  SIMD_FUNC( updateEfieldUniformSS ),
+  SIMD_FUNC( updateHfieldUniformSA ),
+  SIMD_FUNC( updateHfieldUniformSS ),
+  SIMD_FUNC( updatePmlEx ),
+  SIMD_FUNC( updatePmlEy ),
+  SIMD_FUNC( updatePmlEz ),
+  SIMD_FUNC( updatePmlHx ),
+  SIMD_FUNC( updatePmlHy ),
+  SIMD_FUNC( updatePmlHz )
+
+};
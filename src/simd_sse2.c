@@ -0,0 +1,42 @@
+/* 
+ * This file is part of Vulture.
+ *
+ * Vulture finite-difference time-domain electromagnetic solver.
+ * Copyright (C) 2011-2016 Ian David Flintoft
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ *
+ * Author: Ian Flintoft <ian.flintoft@googlemail.com>
+ *
+ */
+
+/* SSE2 kernels - this file must be compiled with SSE2 code generation enabled. */
+
+#include <immintrin.h>
+
+#include "simd.h"
+
+#define SIMD_SUFFIX sse2
+#define SIMD_TABLE simdKernelsSse2
+#define V_T __m128
+#define V_LEN 4
+#define V_LOAD( p ) _mm_loadu_ps( p )
+#define V_STORE( p , v ) _mm_storeu_ps( p , v )
+#define V_SET1( s ) _mm_set1_ps( s )
+#define V_ADD( a , b ) _mm_add_ps( a , b )
+#define V_SUB( a , b ) _mm_sub_ps( a , b )
+#define V_MUL( a , b ) _mm_mul_ps( a , b )
+
+#include "simd_kernels.h"
@@ -39,6 +39,13 @@
 #include "mur.h"  
 #include "grid.h"
 #include "timer.h"
+#include "profiler.h"
+#include "medium.h"
+#include "taskgraph.h"
+#include "domain.h"
+#ifdef WITH_SIBC
+#include "sibc.h"
+#endif
 
 /* 
  * Private data.
@@ -50,11 +57,20 @@ static unsigned long numTimeSteps;
 /* Courant stability factor. */
 static real courantNumber = -1.0;
 
+/* Maximum number of time steps advanced together by temporal blocking. */
+static int timeBlockSize = 0;
+
+/* Use the task graph scheduler. */
+static bool useTaskGraph = false;
+
 /* 
  * Private method interfaces. 
  */
 
 void setCourantNumber( real counrantNum );
+bool isTimeBlockingPossible( void );
+unsigned long getNumBlockableSteps( unsigned long timeStepNumber , real dt );
+void propagateTaskGraph( real dt );
 
 /*
  * Method Implementations.
@@ -146,15 +162,71 @@ void propagate( void )
   real timeE = 0.0;
   real timeH = 0.0;
 
+  /* Temporal blocking. */
+  bool useTimeBlocking = false;
+  unsigned long numBlockSteps = 0UL;
+  unsigned long numBlockedSteps = 0UL;
+
+  /* Overlap halo exchanges with the sub-domain interior updates. */
+  bool isDecomposed = isDomainDecomposed();
+
+  /* Start of profiled stage. */
+  uint64_t start;
+
   dt = getGridTimeStep();
+
+  if( isDecomposed )
+  {
+    if( useTaskGraph || timeBlockSize > 1 )
+      message( MSG_LOG , 0 , "  Task graph and temporal blocking are not used with domain decomposition\n" );
+  }
+  else if( useTaskGraph )
+  {
+    propagateTaskGraph( dt );
+    return;
+  }
   
+  useTimeBlocking = !isDecomposed && isTimeBlockingPossible();
+
   /* Time loop. */
   message( MSG_LOG , 0 , "\nStarting time stepping loop...\n" );
 	
   startTimer( 0 , numTimeSteps );
+  startProfile();
 
   for ( timeStepNumber = 0 ; timeStepNumber <= numTimeSteps - 1 ; timeStepNumber++ )  {
 
+    /* Advance several time steps together if nothing needs the fields in between. */
+    if( useTimeBlocking )
+    {
+      numBlockSteps = getNumBlockableSteps( timeStepNumber , dt );
+      if( numBlockSteps > 1 )
+      {
+        for( unsigned long step = timeStepNumber ; step < timeStepNumber + numBlockSteps ; step++ )
+        {
+          updateTimer( step , numTimeSteps );
+          start = getProfileTime();
+          updateObservers( step , step * dt );
+          addStageTime( PS_OBSERVERS , start );
+          start = getProfileTime();
+          updateWaveforms( step , step * dt );
+          addStageTime( PS_WAVEFORMS , start );
+        }
+        start = getProfileTime();
+        updateGridTimeBlocked( (int) numBlockSteps );
+        addStageTime( PS_GRID_TIME_BLOCKED , start );
+        start = getProfileTime();
+        updateGhostEfield();
+        addStageTime( PS_GHOST_E , start );
+        start = getProfileTime();
+        updateGhostHfield();
+        addStageTime( PS_GHOST_H , start );
+        numBlockedSteps += numBlockSteps;
+        timeStepNumber += numBlockSteps - 1;
+        continue;
+      }
+    }
+
     /* Electric field time. */
     timeE = timeStepNumber * dt;
 
@@ -164,67 +236,205 @@ void propagate( void )
     updateTimer( timeStepNumber , numTimeSteps );
 
     /* Update observers. */
+    start = getProfileTime();
     updateObservers( timeStepNumber , timeE );
+    addStageTime( PS_OBSERVERS , start );
 
     /* Update waveforms - currently a no-op. */
+    start = getProfileTime();
     updateWaveforms( timeStepNumber , timeE );
-
-    /* Update external surface E fields. */
-    updateExternalSurfacesEfield();
-
-    /* Update main grid E fields. */
-    updateGridEfield();
+    addStageTime( PS_WAVEFORMS , start );
+
+    /* External surface updates are profiled by surface type. */
+    if( isDecomposed )
+    {
+      /* Update sub-domain interior E fields while the H halo is in flight. */
+      start = getProfileTime();
+      startExchangeHfield();
+      addStageTime( PS_HALO_H , start );
+      start = getProfileTime();
+      updateGridEfieldInterior();
+      addStageTime( PS_GRID_E , start );
+      start = getProfileTime();
+      finishExchangeHfield();
+      addStageTime( PS_HALO_H , start );
+
+      /* Update external surface E fields. */
+      updateExternalSurfacesEfield();
+
+      /* Update sub-domain shell E fields, which read the H halo. */
+      start = getProfileTime();
+      updateGridEfieldShell();
+      addStageTime( PS_GRID_E , start );
+    }
+    else
+    {
+      /* Update external surface E fields. */
+      updateExternalSurfacesEfield();
+
+      /* Update main grid E fields. */
+      start = getProfileTime();
+      updateGridEfield();
+      addStageTime( PS_GRID_E , start );
+    }
     
     /* Update block E fields. */
+    start = getProfileTime();
     updateBlocksEfield(); 
+    addStageTime( PS_BLOCKS_E , start );
 
     /* Update internal surface H field. */
+    start = getProfileTime();
     updateInternalSurfacesEfield();
+    addStageTime( PS_INTERNAL_SURFACES_E , start );
 
     /* Thin wire E field update goes here. */
+    start = getProfileTime();
     updateLinesEfield();
+    addStageTime( PS_LINES_E , start );
 
 #ifndef CHECK_LIMITS
     /* Update electric field sources. */
+    start = getProfileTime();
     updateSourcesEfield( timeE );
+    addStageTime( PS_SOURCES_E , start );
 
     /* TFSF E field update. */
+    start = getProfileTime();
     updatePlaneWavesEfield( timeE );    
+    addStageTime( PS_PLANE_WAVES_E , start );
 #endif
 
+    start = getProfileTime();
     updateGhostEfield();
+    addStageTime( PS_GHOST_E , start );
     
-    /* Update external surface H fields. */
-    updateExternalSurfacesHfield();
+    if( isDecomposed )
+    {
+      /* Update sub-domain interior H fields while the E halo is in flight. */
+      start = getProfileTime();
+      startExchangeEfield();
+      addStageTime( PS_HALO_E , start );
+      start = getProfileTime();
+      updateGridHfieldInterior();
+      addStageTime( PS_GRID_H , start );
+      start = getProfileTime();
+      finishExchangeEfield();
+      addStageTime( PS_HALO_E , start );
+
+      /* Update external surface H fields. */
+      updateExternalSurfacesHfield();
+
+      /* Update sub-domain shell H fields, which read the E halo. */
+      start = getProfileTime();
+      updateGridHfieldShell();
+      addStageTime( PS_GRID_H , start );
+    }
+    else
+    {
+      /* Update external surface H fields. */
+      updateExternalSurfacesHfield();
     
-    /* Update main grid H fields. */
-    updateGridHfield();
+      /* Update main grid H fields. */
+      start = getProfileTime();
+      updateGridHfield();
+      addStageTime( PS_GRID_H , start );
+    }
 
     /* Update block H fields. */
+    start = getProfileTime();
     updateBlocksHfield();
+    addStageTime( PS_BLOCKS_H , start );
     
     /* Update internal surface H field. */
+    start = getProfileTime();
     updateInternalSurfacesHfield();
+    addStageTime( PS_INTERNAL_SURFACES_H , start );
 
     /* Thin wire H field update goes here. */
+    start = getProfileTime();
     updateLinesHfield();
+    addStageTime( PS_LINES_H , start );
 
 #ifndef CHECK_LIMITS    
     /* Update magnetic field sources. */
+    start = getProfileTime();
     updateSourcesHfield( timeH );
+    addStageTime( PS_SOURCES_H , start );
 
     /* TFSF H field update. */
+    start = getProfileTime();
     updatePlaneWavesHfield( timeH );    
+    addStageTime( PS_PLANE_WAVES_H , start );
 #endif
     
+    start = getProfileTime();
     updateGhostHfield();
+    addStageTime( PS_GHOST_H , start );
     
   } /* for */
   
+  stopProfile();
+  stopTimer( numTimeSteps , numTimeSteps );
+
+  if( useTimeBlocking )
+    message( MSG_LOG , 0 , "\n  %lu of %lu time steps advanced using temporal blocking\n" , numBlockedSteps , numTimeSteps );
+
+  message( MSG_LOG , 0 , "\nCompleted time stepping loop.\n\n" );
+
+  return;
+
+}
+
+/* Propagate fields using the task graph scheduler. */
+/* A single thread steps the observers and issues the tasks for each time step. */
+void propagateTaskGraph( real dt )
+{
+
+  unsigned long timeStepNumber = 0UL;
+  real timeE = 0.0;
+  real timeH = 0.0;
+  uint64_t start;
+
+  initTaskGraph();
+
+  if( timeBlockSize > 1 )
+    message( MSG_LOG , 0 , "  Temporal blocking is not used with the task graph scheduler\n" );
+
+  message( MSG_LOG , 0 , "\nStarting time stepping loop...\n" );
+	
+  startTimer( 0 , numTimeSteps );
+  startProfile();
+
+  #ifdef WITH_OPENMP
+    #pragma omp parallel private( timeStepNumber , timeE , timeH , start )
+    #pragma omp single
+  #endif
+  {
+    for ( timeStepNumber = 0 ; timeStepNumber <= numTimeSteps - 1 ; timeStepNumber++ )  {
+
+      timeE = timeStepNumber * dt;
+      timeH = ( timeStepNumber + 0.5 ) * dt;
+    
+      updateTimer( timeStepNumber , numTimeSteps );
+      start = getProfileTime();
+      updateObservers( timeStepNumber , timeE );
+      addStageTime( PS_OBSERVERS , start );
+      start = getProfileTime();
+      updateWaveforms( timeStepNumber , timeE );
+      addStageTime( PS_WAVEFORMS , start );
+      updateTaskGraph( timeE , timeH );
+
+    } /* for */
+  }
+
+  stopProfile();
   stopTimer( numTimeSteps , numTimeSteps );
 
   message( MSG_LOG , 0 , "\nCompleted time stepping loop.\n\n" );
 
+  deallocTaskGraph();
+
   return;
 
 }
@@ -274,3 +484,97 @@ void setNumTimeSteps( unsigned long numSteps )
   return;
 
 }
+
+/* Set maximum number of time steps advanced together by temporal blocking. */
+void setTimeBlockSize( int numSteps )
+{
+
+  timeBlockSize = numSteps;
+
+  return;
+
+}
+
+/* Enable or disable the task graph scheduler. */
+void setTaskGraph( bool isEnabled )
+{
+
+  useTaskGraph = isEnabled;
+
+  return;
+
+}
+
+/* Determine if temporal blocking can be used at all. */
+/* All the external boundaries must be PEC and there must be no plane waves, */
+/* hard sources, Debye blocks or SIBC surfaces since these update fields every time step. */
+bool isTimeBlockingPossible( void )
+{
+
+  BoundaryType type;
+
+  if( timeBlockSize < 2 )
+    return false;
+
+#ifdef CHECK_LIMITS
+  message( MSG_LOG , 0 , "  Temporal blocking disabled in limit checking mode\n" );
+  return false;
+#endif
+
+  for( MeshFace face = XLO ; face <= ZHI ; face++ )
+  {
+    type = outerSurfaceType( face );
+    if( type != BT_PEC )
+    {
+      message( MSG_LOG , 0 , "  Temporal blocking disabled: %s boundary is %s, not PEC\n" , FACE[face] , 
+               type < BT_UNDEFINED ? BOUNDARY_TYPE_STR[type] : "undefined" );
+      return false;
+    }
+  }
+
+  if( thereArePlaneWaves() )
+  {
+    message( MSG_LOG , 0 , "  Temporal blocking disabled: plane waves present\n" );
+    return false;
+  }
+
+  if( thereAreHardSources() )
+  {
+    message( MSG_LOG , 0 , "  Temporal blocking disabled: hard sources present\n" );
+    return false;
+  }
+
+  if( thereAreBlocks( MT_DEBYE ) )
+  {
+    message( MSG_LOG , 0 , "  Temporal blocking disabled: Debye blocks present\n" );
+    return false;
+  }
+
+#ifdef WITH_SIBC
+  if( thereAreSibcSurfaces() )
+  {
+    message( MSG_LOG , 0 , "  Temporal blocking disabled: SIBC surfaces present\n" );
+    return false;
+  }
+#endif
+
+  message( MSG_LOG , 0 , "  Temporal blocking of up to %d time steps enabled\n" , timeBlockSize );
+
+  return true;
+
+}
+
+/* Find the number of time steps from timeStepNumber that can be advanced together. */
+/* Stops at the first time step where sources are active or observers need the fields. */
+unsigned long getNumBlockableSteps( unsigned long timeStepNumber , real dt )
+{
+
+  unsigned long step;
+
+  for( step = timeStepNumber ; step < timeStepNumber + timeBlockSize && step < numTimeSteps ; step++ )
+    if( observersNeedFields( step ) || sourcesAreActive( step * dt , ( step + 0.5 ) * dt ) )
+      break;
+
+  return step - timeStepNumber;
+
+}
@@ -43,5 +43,7 @@ void deallocSimulation( void );
 unsigned long getNumTimeSteps( void );
 void setNumTimeSteps( unsigned long numSteps );
 real getCourantNumber( void );
+void setTimeBlockSize( int numSteps );
+void setTaskGraph( bool isEnabled );
 
 #endif
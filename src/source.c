@@ -37,6 +37,7 @@
 #include "grid.h"
 #include "medium.h"
 #include "physical.h"
+#include "domain.h"
 
 /* 
  * Source class. 
@@ -487,6 +488,7 @@ void initSources( void )
     
     offsetBoundingBox( item->gbbox , item->mbbox , gibox );
     setFieldLimits( item->gbbox , item->flim , includeBoundary );
+    clipFieldLimitsToDomain( item->flim );
 
     switch( item->type )
     {      
@@ -675,6 +677,26 @@ void updateSourcesEfield( real timeE )
 
 }
 
+/* Return true if any source modifies the fields at the given E and H field times. */
+/* Hard sources always modify the fields; soft sources only if their waveform is active. */
+bool sourcesAreActive( real timeE , real timeH )
+{
+
+  SourceItem *item;
+
+  DL_FOREACH( sourceList , item ) 
+  {
+    if( !item->isSoft )
+      return true;
+    if( isWaveformActive( timeE , item->waveformNumber , item->delay ) || 
+        isWaveformActive( timeH , item->waveformNumber , item->delay ) )
+      return true;
+  }
+
+  return false;
+
+}
+
 /* Update magnetic field sources. */
 void updateSourcesHfield( real timeH )
 {
@@ -782,6 +804,20 @@ bool thereAreSources( SourceType type )
 
 }
 
+/* Return true if there are hard sources, which set their fields every time step. */
+bool thereAreHardSources( void )
+{
+
+  SourceItem *item;
+
+  DL_FOREACH( sourceList , item ) 
+    if( !item->isSoft )
+      return true;
+
+  return false;
+
+}
+
 /* Deallocate sources. */
 void deallocSources( void )
 {
@@ -72,5 +72,7 @@ void deallocSources( void );
 void gnuplotSources( void );
 void gmshSources( void );
 bool thereAreSources( SourceType );
+bool thereAreHardSources( void );
+bool sourcesAreActive( real timeE , real timeH );
 
 #endif
@@ -38,6 +38,8 @@
 #include "gnuplot.h"
 #include "gmsh.h"
 #include "memory.h"
+#include "domain.h"
+#include "profiler.h"
 
 #include "mur.c"
 
@@ -162,7 +164,7 @@ bool parseBR( char *line )
       break;
     }  
 
-    addBoundary( FACE[boundary] , type , numLayers , order , n_eff , refCoeff , kmax , fileName , NULL , NULL );
+    addBoundary( FACE[boundary] , type , numLayers , order , n_eff , refCoeff , kmax , 0.0 , NULL , fileName , NULL , NULL );
 
   }
 
@@ -259,15 +261,33 @@ void initExternalSurfaceParameters( void )
       real refCoeff;
       real kmax;
       setPmlDefaults( &numLayers , &order , &n_eff , &refCoeff , &kmax );
-      addBoundary( FACE[boundary] , BT_PML , numLayers , order , n_eff , refCoeff , kmax , "" , NULL , NULL );
+      addBoundary( FACE[boundary] , BT_PML , numLayers , order , n_eff , refCoeff , kmax , 0.0 , NULL , "" , NULL , NULL );
       if( !isBoundary( FACE[boundary] , &number ) ) assert( 0 );
     }
     
     addExternalSurface( boundary , FACE[boundary] , number , 1 , 0.0 );
   }
  
- 
- 
+  /* Select the depth and grading of PMLs given with no layers. */
+  for( int surface = XLO ; surface <= ZHI ; surface++ )
+  {
+    int order;
+    real n_eff;
+    real refCoeff;
+    real kmax;
+    real amax;
+
+    number = externalSurfaceList[surface].boundaryNumber;
+    type = getBoundaryType( number );
+    if( ( type == BT_PML || type == BT_CPML ) && getBoundaryNumLayers( number ) == 0 )
+    {
+      getExternalBoundaryParams( number , &order , &n_eff , &refCoeff , &kmax , &amax );
+      selectPmlParameters( surface , type == BT_CPML , &numLayers , &order , n_eff , &refCoeff , &kmax , amax );
+      setBoundaryNumLayers( number , numLayers );
+      setExternalBoundaryParams( number , order , n_eff , refCoeff , kmax , amax );
+    }
+  }
+
   /* Validate external surface type consistency. */
   for( int surface = XLO ; surface <= ZHI ; surface++ )
   {
@@ -305,13 +325,17 @@ void initExternalSurfaceParameters( void )
         message( MSG_ERROR , 0 , "*** PERIODIC boundary on %s surface doesn't match that on surface %s\n" , FACE[surface] , FACE[oppositeSurface] );
       break;
     case BT_PML:
+    case BT_CPML:
       if( numLayers < 1 )
-        message( MSG_ERROR , 0 , "*** Warning: PML on %s surface has less than one (%d) layers\n" , FACE[surface] , numLayers );
+        message( MSG_ERROR , 0 , "*** Warning: %s on %s surface has less than one (%d) layers\n" , 
+                 BOUNDARY_TYPE_STR[type] , FACE[surface] , numLayers );
       break;
     case BT_MUR: 
+    case BT_HIGDON: 
       if( numLayers != 0 ) 
       {
-        message( MSG_WARN , 0 , "*** Warning: MUR on %s surface has %d PML layers - reset to zero\n" , FACE[surface] , numLayers );
+        message( MSG_WARN , 0 , "*** Warning: %s on %s surface has %d PML layers - reset to zero\n" , 
+                 BOUNDARY_TYPE_STR[type] , FACE[surface] , numLayers );
         setBoundaryNumLayers( externalSurfaceList[surface].boundaryNumber , 0 );
       }       
       break;
@@ -511,14 +535,20 @@ bool thereAreExternalSurfaces( BoundaryType type )
 void updateExternalSurfacesEfield( void )
 {
 
+  uint64_t start;
+
   /* Update E field in PML regions. */
+  start = getProfileTime();
   updatePmlEfield();
+  addStageTime( PS_PML_E , start );
   
   /* Update E field in ghost regions. */
   //updateGhostEfield();
   
   /* Update E field on Mur boundaries. */
+  start = getProfileTime();
   updateMurEfield();
+  addStageTime( PS_MUR_E , start );
   
   return;
 }
@@ -527,14 +557,20 @@ void updateExternalSurfacesEfield( void )
 void updateExternalSurfacesHfield( void )
 {
 
+  uint64_t start;
+
   /* Update H field in PML regions. */
+  start = getProfileTime();
   updatePmlHfield();
+  addStageTime( PS_PML_H , start );
   
   /* Update H field in ghost regions. */
   //updateGhostHfield();
 
   /* Update H field on Mur boundaries. */
+  start = getProfileTime();
   updateMurHfield();
+  addStageTime( PS_MUR_H , start );
   
   return;
 
@@ -570,89 +606,98 @@ void updateGhostEfield( void )
 {
 
   int i , j , k;
+  int lim[6];
+
+  /* Ghost cells owned by the domain. */
+  for( int face = XLO ; face <= ZHI ; face += 2 )
+  {
+    lim[face] = gobox[face] - 1;
+    lim[face+1] = gobox[face+1];
+  }
+  clipToDomain( lim );
 
   /* XLO boundary. */
-  if( outerSurfaceType( XLO ) == BT_PEC )
-    for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  if( isOuterDomainFace( XLO ) && outerSurfaceType( XLO ) == BT_PEC )
+    for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
         Ex[gobox[XLO]-1][j][k] = Ex[gobox[XLO]][j][k];
-  else if( outerSurfaceType( XLO ) == BT_PMC )
-    for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  else if( isOuterDomainFace( XLO ) && outerSurfaceType( XLO ) == BT_PMC )
+    for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
         Ex[gobox[XLO]-1][j][k] = -Ex[gobox[XLO]][j][k];
-  else if( outerSurfaceType( XLO ) == BT_PERIODIC )
-    for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  else if( isOuterDomainFace( XLO ) && outerSurfaceType( XLO ) == BT_PERIODIC )
+    for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
         Ex[gobox[XLO]-1][j][k] = Ex[gobox[XHI]-1][j][k];
  
   /* XHI boundary. */
-  if( outerSurfaceType( XHI ) == BT_PEC )
-    for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  if( isOuterDomainFace( XHI ) && outerSurfaceType( XHI ) == BT_PEC )
+    for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
         Ex[gobox[XHI]][j][k] = Ex[gobox[XHI]-1][j][k];
-  else if( outerSurfaceType( XHI ) == BT_PMC )
-    for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  else if( isOuterDomainFace( XHI ) && outerSurfaceType( XHI ) == BT_PMC )
+    for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
        Ex[gobox[XHI]][j][k] = -Ex[gobox[XHI]-1][j][k];
-  else if( outerSurfaceType( XHI ) == BT_PERIODIC )
-    for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  else if( isOuterDomainFace( XHI ) && outerSurfaceType( XHI ) == BT_PERIODIC )
+    for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
        Ex[gobox[XHI]][j][k] = Ex[gobox[XLO]][j][k];
         
   /* YLO boundary. */
-  if( outerSurfaceType( YLO ) == BT_PEC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  if( isOuterDomainFace( YLO ) && outerSurfaceType( YLO ) == BT_PEC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
         Ey[i][gobox[YLO]-1][k] = Ey[i][gobox[YLO]][k];
-  else if( outerSurfaceType( YLO ) == BT_PMC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  else if( isOuterDomainFace( YLO ) && outerSurfaceType( YLO ) == BT_PMC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
         Ey[i][gobox[YLO]-1][k] = -Ey[i][gobox[YLO]][k];
-  else if( outerSurfaceType( YLO ) == BT_PERIODIC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  else if( isOuterDomainFace( YLO ) && outerSurfaceType( YLO ) == BT_PERIODIC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
         Ey[i][gobox[YLO]-1][k] = Ey[i][gobox[YHI]-1][k];
 
   /* YHI boundary. */
-  if( outerSurfaceType( YHI ) == BT_PEC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  if( isOuterDomainFace( YHI ) && outerSurfaceType( YHI ) == BT_PEC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
         Ey[i][gobox[YHI]][k] = Ey[i][gobox[YHI]-1][k];
-  else if( outerSurfaceType( YHI ) == BT_PMC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  else if( isOuterDomainFace( YHI ) && outerSurfaceType( YHI ) == BT_PMC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
         Ey[i][gobox[YHI]][k] = -Ey[i][gobox[YHI]-1][k];
-  else if( outerSurfaceType( YHI ) == BT_PERIODIC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  else if( isOuterDomainFace( YHI ) && outerSurfaceType( YHI ) == BT_PERIODIC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
         Ey[i][gobox[YHI]][k] = Ey[i][gobox[YLO]][k];
       
   /* ZLO boundary. */
-  if( outerSurfaceType( ZLO ) == BT_PEC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
+  if( isOuterDomainFace( ZLO ) && outerSurfaceType( ZLO ) == BT_PEC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
         Ez[i][j][gobox[ZLO]-1] = Ez[i][j][gobox[ZLO]];
-  else if( outerSurfaceType( ZLO ) == BT_PMC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
+  else if( isOuterDomainFace( ZLO ) && outerSurfaceType( ZLO ) == BT_PMC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
         Ez[i][j][gobox[ZLO]-1] = -Ez[i][j][gobox[ZLO]];
-  else if( outerSurfaceType( ZLO ) == BT_PERIODIC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
+  else if( isOuterDomainFace( ZLO ) && outerSurfaceType( ZLO ) == BT_PERIODIC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
         Ez[i][j][gobox[ZLO]-1] = Ez[i][j][gobox[ZHI]-1];
     
   /* ZHI boundary. */
-  if( outerSurfaceType( ZHI ) == BT_PEC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
+  if( isOuterDomainFace( ZHI ) && outerSurfaceType( ZHI ) == BT_PEC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
         Ez[i][j][gobox[ZHI]] = Ez[i][j][gobox[ZHI]-1];
-  else if( outerSurfaceType( ZHI ) == BT_PMC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
+  else if( isOuterDomainFace( ZHI ) && outerSurfaceType( ZHI ) == BT_PMC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
         Ez[i][j][gobox[ZHI]] = -Ez[i][j][gobox[ZHI]-1];
-  else if( outerSurfaceType( ZHI ) == BT_PERIODIC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
+  else if( isOuterDomainFace( ZHI ) && outerSurfaceType( ZHI ) == BT_PERIODIC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
         Ez[i][j][gobox[ZHI]] = Ez[i][j][gobox[ZLO]];
 
   return;
@@ -668,140 +713,149 @@ void updateGhostHfield( void )
 {
 
   int i , j , k;
+  int lim[6];
+
+  /* Ghost cells owned by the domain. */
+  for( int face = XLO ; face <= ZHI ; face += 2 )
+  {
+    lim[face] = gobox[face] - 1;
+    lim[face+1] = gobox[face+1];
+  }
+  clipToDomain( lim );
 
   /* XLO boundary. */
-  if( outerSurfaceType( XLO ) == BT_PMC )
-    for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  if( isOuterDomainFace( XLO ) && outerSurfaceType( XLO ) == BT_PMC )
+    for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
       {
         Hy[gobox[XLO]-1][j][k] = -Hy[gobox[XLO]][j][k];
         Hz[gobox[XLO]-1][j][k] = -Hz[gobox[XLO]][j][k];
       }
-  else if( outerSurfaceType( XLO ) == BT_PERIODIC )
-    for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  else if( isOuterDomainFace( XLO ) && outerSurfaceType( XLO ) == BT_PERIODIC )
+    for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
       {
         Hy[gobox[XLO]-1][j][k] = Hy[gobox[XHI]-1][j][k];
         Hz[gobox[XLO]-1][j][k] = Hz[gobox[XHI]-1][j][k];
       }
-  else if( outerSurfaceType( XLO ) == BT_PEC )
-    for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  else if( isOuterDomainFace( XLO ) && outerSurfaceType( XLO ) == BT_PEC )
+    for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
       {
         Hy[gobox[XLO]-1][j][k] = Hy[gobox[XLO]][j][k];
         Hz[gobox[XLO]-1][j][k] = Hz[gobox[XLO]][j][k];
       }
     
   /* XHI boundary. */
-  if( outerSurfaceType( XHI ) == BT_PMC )
-    for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  if( isOuterDomainFace( XHI ) && outerSurfaceType( XHI ) == BT_PMC )
+    for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
       {
         Hy[gobox[XHI]][j][k] = -Hy[gobox[XHI]-1][j][k];
         Hz[gobox[XHI]][j][k] = -Hz[gobox[XHI]-1][j][k];
       }
-  else if( outerSurfaceType( XHI ) == BT_PERIODIC )
-    for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  else if( isOuterDomainFace( XHI ) && outerSurfaceType( XHI ) == BT_PERIODIC )
+    for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
       {
         Hy[gobox[XHI]][j][k] = Hy[gobox[XLO]][j][k];
         Hz[gobox[XHI]][j][k] = Hz[gobox[XLO]][j][k];
       }
-  else if( outerSurfaceType( XHI ) == BT_PEC )
-    for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  else if( isOuterDomainFace( XHI ) && outerSurfaceType( XHI ) == BT_PEC )
+    for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
       {
         Hy[gobox[XHI]][j][k] = Hy[gobox[XHI]-1][j][k];
         Hz[gobox[XHI]][j][k] = Hz[gobox[XHI]-1][j][k];
       }
 
   /* YLO boundary. */
-  if( outerSurfaceType( YLO ) == BT_PMC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  if( isOuterDomainFace( YLO ) && outerSurfaceType( YLO ) == BT_PMC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
       {
         Hz[i][gobox[YLO]-1][k] = -Hz[i][gobox[YLO]][k];
         Hx[i][gobox[YLO]-1][k] = -Hx[i][gobox[YLO]][k];
       }
-  else if( outerSurfaceType( YLO ) == BT_PERIODIC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  else if( isOuterDomainFace( YLO ) && outerSurfaceType( YLO ) == BT_PERIODIC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
       {
         Hz[i][gobox[YLO]-1][k] = Hz[i][gobox[YHI]-1][k];
         Hx[i][gobox[YLO]-1][k] = Hx[i][gobox[YHI]-1][k];
       }
-  else if( outerSurfaceType( YLO ) == BT_PEC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  else if( isOuterDomainFace( YLO ) && outerSurfaceType( YLO ) == BT_PEC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
       {
         Hz[i][gobox[YLO]-1][k] = Hz[i][gobox[YLO]][k];
         Hx[i][gobox[YLO]-1][k] = Hx[i][gobox[YLO]][k];
       }
 
   /* YHI boundary. */
-  if( outerSurfaceType( YHI ) == BT_PMC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  if( isOuterDomainFace( YHI ) && outerSurfaceType( YHI ) == BT_PMC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
       {
         Hz[i][gobox[YHI]][k] = -Hz[i][gobox[YHI]-1][k];
         Hx[i][gobox[YHI]][k] = -Hx[i][gobox[YHI]-1][k];
       }
-  else if( outerSurfaceType( YHI ) == BT_PERIODIC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  else if( isOuterDomainFace( YHI ) && outerSurfaceType( YHI ) == BT_PERIODIC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
       {
         Hz[i][gobox[YHI]][k] = Hz[i][gobox[YLO]][k];
         Hx[i][gobox[YHI]][k] = Hx[i][gobox[YLO]][k];
       }
-  else if( outerSurfaceType( YHI ) == BT_PEC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( k = gobox[ZLO] - 1 ; k <= gobox[ZHI] ; k++ )
+  else if( isOuterDomainFace( YHI ) && outerSurfaceType( YHI ) == BT_PEC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( k = lim[ZLO] ; k <= lim[ZHI] ; k++ )
       {
         Hz[i][gobox[YHI]][k] = Hz[i][gobox[YHI]-1][k];
         Hx[i][gobox[YHI]][k] = Hx[i][gobox[YHI]-1][k];
       }
 
   /* ZLO boundary. */
-  if( outerSurfaceType( ZLO ) == BT_PMC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
+  if( isOuterDomainFace( ZLO ) && outerSurfaceType( ZLO ) == BT_PMC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
       {
         Hx[i][j][gobox[ZLO]-1] = -Hx[i][j][gobox[ZLO]];
         Hy[i][j][gobox[ZLO]-1] = -Hy[i][j][gobox[ZLO]];
       }
-  else if( outerSurfaceType( ZLO ) == BT_PERIODIC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
+  else if( isOuterDomainFace( ZLO ) && outerSurfaceType( ZLO ) == BT_PERIODIC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
       {
         Hx[i][j][gobox[ZLO]-1] = Hx[i][j][gobox[ZHI]-1];
         Hy[i][j][gobox[ZLO]-1] = Hy[i][j][gobox[ZHI]-1];
       }
-  else if( outerSurfaceType( ZLO ) == BT_PEC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
+  else if( isOuterDomainFace( ZLO ) && outerSurfaceType( ZLO ) == BT_PEC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
       {
         Hx[i][j][gobox[ZLO]-1] = Hx[i][j][gobox[ZLO]];
         Hy[i][j][gobox[ZLO]-1] = Hy[i][j][gobox[ZLO]];
       }
 
   /* ZHI boundary. */
-  if( outerSurfaceType( ZHI ) == BT_PMC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
+  if( isOuterDomainFace( ZHI ) && outerSurfaceType( ZHI ) == BT_PMC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
       {
         Hx[i][j][gobox[ZHI]] = -Hx[i][j][gobox[ZHI]-1];
         Hy[i][j][gobox[ZHI]] = -Hy[i][j][gobox[ZHI]-1];
       }
-  else if( outerSurfaceType( ZHI ) == BT_PERIODIC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
+  else if( isOuterDomainFace( ZHI ) && outerSurfaceType( ZHI ) == BT_PERIODIC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
       {
         Hx[i][j][gobox[ZHI]] = Hx[i][j][gobox[ZLO]];
         Hy[i][j][gobox[ZHI]] = Hy[i][j][gobox[ZLO]];
       }
-  else if( outerSurfaceType( ZHI ) == BT_PEC )
-    for( i = gobox[XLO] - 1 ; i <= gobox[XHI] ; i++ )
-      for( j = gobox[YLO] - 1 ; j <= gobox[YHI] ; j++ )
+  else if( isOuterDomainFace( ZHI ) && outerSurfaceType( ZHI ) == BT_PEC )
+    for( i = lim[XLO] ; i <= lim[XHI] ; i++ )
+      for( j = lim[YLO] ; j <= lim[YHI] ; j++ )
       {
         Hx[i][j][gobox[ZHI]] = Hx[i][j][gobox[ZHI]-1];
         Hy[i][j][gobox[ZHI]] = Hy[i][j][gobox[ZHI]-1];
@@ -978,10 +1032,12 @@ void checkExternalSurfaces( void )
     {
     case BT_PEC:
     case BT_PML:
+    case BT_CPML:
       /* PEC and PML backing should still be PEC. */
       checkMediumOnGrid( obbox , MT_PEC );
       break;
     case BT_MUR:
+    case BT_HIGDON:
       /* Mur only valid with free-soace at the moment. */ 
       checkMediumOnGrid( ibbox , MT_FREE_SPACE );
       break;
@@ -1016,10 +1072,18 @@ real outerSurfaceReflectCoeff( MeshFace face )
   return getBoundaryRefCoeff( externalSurfaceList[face].boundaryNumber );
 }
 
-void getOuterSurfaceParams( MeshFace face , int *order , real *n_eff , real *refCoeff , real *kmax )
+void getOuterSurfaceParams( MeshFace face , int *order , real *n_eff , real *refCoeff , real *kmax , real *amax )
+{
+ 
+  getExternalBoundaryParams( externalSurfaceList[face].boundaryNumber , order , n_eff , refCoeff , kmax , amax );
+
+  return;
+}
+
+void getOuterSurfaceAngles( MeshFace face , real angles[MAX_HIGDON_ORDER] )
 {
  
-  getExternalBoundaryParams( externalSurfaceList[face].boundaryNumber , order , n_eff , refCoeff , kmax );
+  getBoundaryAngles( externalSurfaceList[face].boundaryNumber , angles );
 
   return;
 }
@@ -81,7 +81,8 @@ void checkExternalSurfaces( void );
 BoundaryType outerSurfaceType( MeshFace face );
 int outerSurfaceNumLayers( MeshFace face );
 real outerSurfaceReflectCoeff( MeshFace face );
-void getOuterSurfaceParams( MeshFace face , int *order , real *n_eff , real *refCoeff , real *kmax );
+void getOuterSurfaceParams( MeshFace face , int *order , real *n_eff , real *refCoeff , real *kmax , real *amax );
+void getOuterSurfaceAngles( MeshFace face , real angles[MAX_HIGDON_ORDER] );
 void initExternalPecPmcSurfaces( void );
 bool thereAreInternalSurfaces( BoundaryType type );
 bool thereAreExternaSurfaces( BoundaryType type );
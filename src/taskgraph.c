@@ -0,0 +1,577 @@
+/* 
+ * This file is part of Vulture.
+ *
+ * Vulture finite-difference time-domain electromagnetic solver.
+ * Copyright (C) 2011-2016 Ian David Flintoft
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ *
+ * Author: Ian Flintoft <ian.flintoft@googlemail.com>
+ *
+ */
+
+/*
+ * Task graph scheduler.
+ *
+ * The updates making up a time step are divided into stages, each consisting
+ * of a number of independent work items. A stage is released when all of its
+ * predecessors have completed and its items are then run as OpenMP tasks, so
+ * that small stages such as the PML regions, Mur faces and plane wave
+ * corrections overlap with the main grid update instead of each being
+ * followed by a barrier. Without OpenMP the stages are run in order by the
+ * calling thread.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#ifdef WITH_OPENMP
+  #include <omp.h>
+#endif
+
+#include "taskgraph.h"
+#include "grid.h"
+#include "pml.h"
+#include "mur.h"
+#include "block.h"
+#include "surface.h"
+#include "line.h"
+#include "source.h"
+#include "planewave.h"
+#include "message.h"
+#include "profiler.h"
+
+/* 
+ * Private data.
+ */
+
+/* Stages of the time step. */
+typedef enum {
+
+  TS_PML_E,
+  TS_MUR_E,
+  TS_PLANE_WAVE_AUX_E,
+  TS_GRID_E,
+  TS_BLOCKS_E,
+  TS_INTERNAL_SURFACES_E,
+  TS_LINES_E,
+  TS_SOURCES_E,
+  TS_PLANE_WAVES_E,
+  TS_GHOST_E,
+  TS_PML_H,
+  TS_MUR_H,
+  TS_PLANE_WAVE_AUX_H,
+  TS_GRID_H,
+  TS_BLOCKS_H,
+  TS_INTERNAL_SURFACES_H,
+  TS_LINES_H,
+  TS_SOURCES_H,
+  TS_PLANE_WAVES_H,
+  TS_GHOST_H,
+  TS_UNDEFINED
+
+} TaskStage;
+
+#define NUM_TASK_STAGES TS_UNDEFINED
+
+/* Maximum number of successors of a stage. */
+#define MAX_STAGE_SUCCESSORS 4
+
+/* Stage work item update function. */
+typedef void (*StageUpdate)( int item , real time );
+
+/* Stage of the task graph. */
+typedef struct TaskStageItem_t {
+
+  char *name;                               // Stage name.
+  StageUpdate update;                       // Work item update function.
+  bool isMagnetic;                          // True if stage is advanced at the magnetic field time.
+  int numItems;                             // Number of work items.
+  int numPred;                              // Number of predecessors.
+  int numSucc;                              // Number of successors.
+  TaskStage succ[MAX_STAGE_SUCCESSORS];     // Successors.
+
+  /* Run time counters. */
+  int pending;                              // Predecessors not yet complete.
+  int remaining;                            // Work items not yet complete.
+
+} TaskStageItem;
+
+/* Task graph. */
+static TaskStageItem stages[NUM_TASK_STAGES];
+
+/* Profiler stage each task stage is charged to. */
+static ProfileStage profileStage[NUM_TASK_STAGES] = { 
+  PS_PML_E , PS_MUR_E , PS_PLANE_WAVES_E , PS_GRID_E , PS_BLOCKS_E , PS_INTERNAL_SURFACES_E , PS_LINES_E , PS_SOURCES_E , PS_PLANE_WAVES_E , PS_GHOST_E ,
+  PS_PML_H , PS_MUR_H , PS_PLANE_WAVES_H , PS_GRID_H , PS_BLOCKS_H , PS_INTERNAL_SURFACES_H , PS_LINES_H , PS_SOURCES_H , PS_PLANE_WAVES_H , PS_GHOST_H };
+
+/* External faces with Mur boundaries. */
+static MeshFace murFaces[6];
+static int numMurFaces = 0;
+
+/* 
+ * Private method interfaces. 
+ */
+
+void addStage( TaskStage stage , char *name , StageUpdate update , bool isMagnetic , int numItems );
+void addStageDependency( TaskStage pred , TaskStage succ );
+void releaseStage( TaskStage stage , real timeE , real timeH );
+void runStageItem( TaskStage stage , int item , real timeE , real timeH );
+void completeStage( TaskStage stage , real timeE , real timeH );
+void updatePmlEfieldStage( int item , real time );
+void updateMurEfieldStage( int item , real time );
+void updatePlaneWaveAuxEfieldStage( int item , real time );
+void updateGridEfieldStage( int item , real time );
+void updateBlocksEfieldStage( int item , real time );
+void updateInternalSurfacesEfieldStage( int item , real time );
+void updateLinesEfieldStage( int item , real time );
+void updateSourcesEfieldStage( int item , real time );
+void updatePlaneWavesEfieldStage( int item , real time );
+void updateGhostEfieldStage( int item , real time );
+void updatePmlHfieldStage( int item , real time );
+void updateMurHfieldStage( int item , real time );
+void updatePlaneWaveAuxHfieldStage( int item , real time );
+void updateGridHfieldStage( int item , real time );
+void updateBlocksHfieldStage( int item , real time );
+void updateInternalSurfacesHfieldStage( int item , real time );
+void updateLinesHfieldStage( int item , real time );
+void updateSourcesHfieldStage( int item , real time );
+void updatePlaneWavesHfieldStage( int item , real time );
+void updateGhostHfieldStage( int item , real time );
+
+/*
+ * Method Implementations.
+ */
+
+/* Initialise task graph - must be called after the number of threads is set. */
+void initTaskGraph( void )
+{
+
+  int numThreads = 1;
+  
+  message( MSG_LOG , 0 , "\nInitialising task graph...\n\n" );
+
+#ifdef WITH_OPENMP
+  numThreads = omp_get_max_threads();
+#endif
+
+  initGridTasks( numThreads );
+  initPmlTasks( numThreads );
+
+  numMurFaces = 0;
+  for( MeshFace face = XLO ; face <= ZHI ; face++ )
+    if( isMurFace( face ) )
+      murFaces[numMurFaces++] = face;
+
+  /* Electric field stages. */
+  addStage( TS_PML_E               , "PML E"               , updatePmlEfieldStage              , false , getPmlNumEfieldTasks() );
+  addStage( TS_MUR_E               , "Mur E"               , updateMurEfieldStage              , false , numMurFaces );
+  addStage( TS_PLANE_WAVE_AUX_E    , "plane wave aux E"    , updatePlaneWaveAuxEfieldStage     , false , 1 );
+  addStage( TS_GRID_E              , "grid E"              , updateGridEfieldStage             , false , getGridNumEfieldTasks() );
+  addStage( TS_BLOCKS_E            , "blocks E"            , updateBlocksEfieldStage           , false , 3 );
+  addStage( TS_INTERNAL_SURFACES_E , "internal surfaces E" , updateInternalSurfacesEfieldStage , false , 1 );
+  addStage( TS_LINES_E             , "lines E"             , updateLinesEfieldStage            , false , 1 );
+  addStage( TS_SOURCES_E           , "sources E"           , updateSourcesEfieldStage          , false , 1 );
+  addStage( TS_PLANE_WAVES_E       , "plane waves E"       , updatePlaneWavesEfieldStage       , false , 3 );
+  addStage( TS_GHOST_E             , "ghost E"             , updateGhostEfieldStage            , false , 1 );
+
+  /* Magnetic field stages. */
+  addStage( TS_PML_H               , "PML H"               , updatePmlHfieldStage              , true  , getPmlNumHfieldTasks() );
+  addStage( TS_MUR_H               , "Mur H"               , updateMurHfieldStage              , true  , numMurFaces > 0 ? 1 : 0 );
+  addStage( TS_PLANE_WAVE_AUX_H    , "plane wave aux H"    , updatePlaneWaveAuxHfieldStage     , true  , 1 );
+  addStage( TS_GRID_H              , "grid H"              , updateGridHfieldStage             , true  , getGridNumHfieldTasks() );
+  addStage( TS_BLOCKS_H            , "blocks H"            , updateBlocksHfieldStage           , true  , 1 );
+  addStage( TS_INTERNAL_SURFACES_H , "internal surfaces H" , updateInternalSurfacesHfieldStage , true  , 1 );
+  addStage( TS_LINES_H             , "lines H"             , updateLinesHfieldStage            , true  , 1 );
+  addStage( TS_SOURCES_H           , "sources H"           , updateSourcesHfieldStage          , true  , 1 );
+  addStage( TS_PLANE_WAVES_H       , "plane waves H"       , updatePlaneWavesHfieldStage       , true  , 3 );
+  addStage( TS_GHOST_H             , "ghost H"             , updateGhostHfieldStage            , true  , 1 );
+
+  /* 
+   * The Mur update uses the interior fields before the grid update, and any 
+   * PML fields it touches after the PML update. Blocks, surfaces, lines, sources 
+   * and plane waves can overwrite any field so are applied in their original 
+   * order after the bulk updates. The auxiliary plane wave grids are independent 
+   * of the main grid.
+   */
+  if( numMurFaces > 0 && getPmlNumEfieldTasks() > 0 )
+    addStageDependency( TS_PML_E , TS_MUR_E );
+  addStageDependency( TS_MUR_E               , TS_GRID_E );
+  addStageDependency( TS_GRID_E              , TS_BLOCKS_E );
+  addStageDependency( TS_PML_E               , TS_BLOCKS_E );
+  addStageDependency( TS_BLOCKS_E            , TS_INTERNAL_SURFACES_E );
+  addStageDependency( TS_INTERNAL_SURFACES_E , TS_LINES_E );
+  addStageDependency( TS_LINES_E             , TS_SOURCES_E );
+  addStageDependency( TS_SOURCES_E           , TS_PLANE_WAVES_E );
+  addStageDependency( TS_PLANE_WAVE_AUX_E    , TS_PLANE_WAVES_E );
+  addStageDependency( TS_PLANE_WAVES_E       , TS_GHOST_E );
+
+  /* The magnetic field stages all need the complete electric field. */
+  addStageDependency( TS_GHOST_E             , TS_PML_H );
+  addStageDependency( TS_GHOST_E             , TS_MUR_H );
+  addStageDependency( TS_GHOST_E             , TS_PLANE_WAVE_AUX_H );
+  addStageDependency( TS_GHOST_E             , TS_GRID_H );
+  addStageDependency( TS_GRID_H              , TS_BLOCKS_H );
+  addStageDependency( TS_PML_H               , TS_BLOCKS_H );
+  addStageDependency( TS_MUR_H               , TS_BLOCKS_H );
+  addStageDependency( TS_BLOCKS_H            , TS_INTERNAL_SURFACES_H );
+  addStageDependency( TS_INTERNAL_SURFACES_H , TS_LINES_H );
+  addStageDependency( TS_LINES_H             , TS_SOURCES_H );
+  addStageDependency( TS_SOURCES_H           , TS_PLANE_WAVES_H );
+  addStageDependency( TS_PLANE_WAVE_AUX_H    , TS_PLANE_WAVES_H );
+  addStageDependency( TS_PLANE_WAVES_H       , TS_GHOST_H );
+
+  message( MSG_LOG , 0 , "  Task graph scheduler using %d threads\n" , numThreads );
+  message( MSG_LOG , 0 , "  Grid tasks: %d E, %d H\n" , getGridNumEfieldTasks() , getGridNumHfieldTasks() );
+  message( MSG_LOG , 0 , "  PML tasks: %d E, %d H\n" , getPmlNumEfieldTasks() , getPmlNumHfieldTasks() );
+
+  for( TaskStage stage = 0 ; stage < NUM_TASK_STAGES ; stage++ )
+    message( MSG_DEBUG1 , 0 , "  Stage %-20s: %d items, %d predecessors, %d successors\n" , 
+             stages[stage].name , stages[stage].numItems , stages[stage].numPred , stages[stage].numSucc );
+
+  return;
+
+}
+
+/* Add a stage to the task graph. */
+void addStage( TaskStage stage , char *name , StageUpdate update , bool isMagnetic , int numItems )
+{
+
+  stages[stage].name = name;
+  stages[stage].update = update;
+  stages[stage].isMagnetic = isMagnetic;
+  stages[stage].numItems = numItems;
+  stages[stage].numPred = 0;
+  stages[stage].numSucc = 0;
+
+  return;
+
+}
+
+/* Make stage succ depend on stage pred. */
+void addStageDependency( TaskStage pred , TaskStage succ )
+{
+
+  if( stages[pred].numSucc >= MAX_STAGE_SUCCESSORS )
+    message( MSG_ERROR , 0 , "*** Error: Too many successors for task graph stage %s\n" , stages[pred].name );
+
+  stages[pred].succ[stages[pred].numSucc++] = succ;
+  stages[succ].numPred++;
+
+  return;
+
+}
+
+/* Advance the fields by one time step using the task graph. */
+/* With OpenMP this must be called by a single thread of a parallel region. */
+void updateTaskGraph( real timeE , real timeH )
+{
+
+  for( TaskStage stage = 0 ; stage < NUM_TASK_STAGES ; stage++ )
+  {
+    stages[stage].pending = stages[stage].numPred;
+    stages[stage].remaining = stages[stage].numItems;
+  }
+
+  #ifdef WITH_OPENMP
+    #pragma omp taskgroup
+  #endif
+  {
+    for( TaskStage stage = 0 ; stage < NUM_TASK_STAGES ; stage++ )
+      if( stages[stage].numPred == 0 )
+        releaseStage( stage , timeE , timeH );
+  }
+
+  return;
+
+}
+
+/* Start the work items of a stage whose predecessors have all completed. */
+void releaseStage( TaskStage stage , real timeE , real timeH )
+{
+
+  if( stages[stage].numItems == 0 )
+  {
+    completeStage( stage , timeE , timeH );
+    return;
+  }
+
+  for( int item = 0 ; item < stages[stage].numItems ; item++ )
+  {
+    #ifdef WITH_OPENMP
+      #pragma omp task firstprivate( stage , item , timeE , timeH )
+    #endif
+    runStageItem( stage , item , timeE , timeH );
+  }
+
+  return;
+
+}
+
+/* Run a work item and release the stage's successors if it is the last one. */
+void runStageItem( TaskStage stage , int item , real timeE , real timeH )
+{
+
+  int remaining;
+  uint64_t start;
+
+  start = getProfileTime();
+  stages[stage].update( item , stages[stage].isMagnetic ? timeH : timeE );
+  addStageTime( profileStage[stage] , start );
+
+  #ifdef WITH_OPENMP
+    #pragma omp atomic capture seq_cst
+  #endif
+  remaining = --stages[stage].remaining;
+
+  if( remaining == 0 )
+    completeStage( stage , timeE , timeH );
+
+  return;
+
+}
+
+/* Release any successors of a completed stage that are now ready. */
+void completeStage( TaskStage stage , real timeE , real timeH )
+{
+
+  int pending;
+  TaskStage succ;
+
+  for( int i = 0 ; i < stages[stage].numSucc ; i++ )
+  {
+    succ = stages[stage].succ[i];
+    #ifdef WITH_OPENMP
+      #pragma omp atomic capture seq_cst
+    #endif
+    pending = --stages[succ].pending;
+    if( pending == 0 )
+      releaseStage( succ , timeE , timeH );
+  }
+
+  return;
+
+}
+
+/* Deallocate task graph. */
+void deallocTaskGraph( void )
+{
+
+  message( MSG_DEBUG1 , 0 , "Deallocating task graph...\n" );
+
+  numMurFaces = 0;
+
+  return;
+
+}
+
+/* 
+ * Stage work items.
+ */
+
+void updatePmlEfieldStage( int item , real time )
+{
+
+  updatePmlEfieldTask( item );
+
+  return;
+
+}
+
+void updateMurEfieldStage( int item , real time )
+{
+
+  updateMurEfieldFace( murFaces[item] );
+
+  return;
+
+}
+
+void updatePlaneWaveAuxEfieldStage( int item , real time )
+{
+
+#ifndef CHECK_LIMITS
+  updatePlaneWavesAuxEfield( time );
+#endif
+
+  return;
+
+}
+
+void updateGridEfieldStage( int item , real time )
+{
+
+  updateGridEfieldTask( item );
+
+  return;
+
+}
+
+/* Block updates are independent for each field component. */
+void updateBlocksEfieldStage( int item , real time )
+{
+
+  updateBlocksEfieldComponent( EX + item );
+
+  return;
+
+}
+
+/* Surfaces can share edges so are updated by a single item. */
+void updateInternalSurfacesEfieldStage( int item , real time )
+{
+
+  updateInternalSurfacesEfield();
+
+  return;
+
+}
+
+void updateLinesEfieldStage( int item , real time )
+{
+
+  updateLinesEfield();
+
+  return;
+
+}
+
+void updateSourcesEfieldStage( int item , real time )
+{
+
+#ifndef CHECK_LIMITS
+  updateSourcesEfield( time );
+#endif
+
+  return;
+
+}
+
+/* Plane wave corrections are grouped by field component since corner edges lie on two faces. */
+void updatePlaneWavesEfieldStage( int item , real time )
+{
+
+#ifndef CHECK_LIMITS
+  updatePlaneWavesEfieldComponent( EX + item , time );
+#endif
+
+  return;
+
+}
+
+void updateGhostEfieldStage( int item , real time )
+{
+
+  updateGhostEfield();
+
+  return;
+
+}
+
+void updatePmlHfieldStage( int item , real time )
+{
+
+  updatePmlHfieldTask( item );
+
+  return;
+
+}
+
+void updateMurHfieldStage( int item , real time )
+{
+
+  updateMurHfield();
+
+  return;
+
+}
+
+void updatePlaneWaveAuxHfieldStage( int item , real time )
+{
+
+#ifndef CHECK_LIMITS
+  updatePlaneWavesAuxHfield( time );
+#endif
+
+  return;
+
+}
+
+void updateGridHfieldStage( int item , real time )
+{
+
+  updateGridHfieldTask( item );
+
+  return;
+
+}
+
+void updateBlocksHfieldStage( int item , real time )
+{
+
+  updateBlocksHfield();
+
+  return;
+
+}
+
+void updateInternalSurfacesHfieldStage( int item , real time )
+{
+
+  updateInternalSurfacesHfield();
+
+  return;
+
+}
+
+void updateLinesHfieldStage( int item , real time )
+{
+
+  updateLinesHfield();
+
+  return;
+
+}
+
+void updateSourcesHfieldStage( int item , real time )
+{
+
+#ifndef CHECK_LIMITS
+  updateSourcesHfield( time );
+#endif
+
+  return;
+
+}
+
+void updatePlaneWavesHfieldStage( int item , real time )
+{
+
+#ifndef CHECK_LIMITS
+  updatePlaneWavesHfieldComponent( HX + item , time );
+#endif
+
+  return;
+
+}
+
+void updateGhostHfieldStage( int item , real time )
+{
+
+  updateGhostHfield();
+
+  return;
+
+}
@@ -30,6 +30,9 @@
  *
  */
 
+/* For clock_gettime. */
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdio.h>
 #include <time.h>
 #include <math.h>
@@ -56,6 +59,7 @@ static double timePerIteration;     // Current time-per-iteration.
 static double lastTimePerIteration; // Last time-per-iteration.
 static unsigned long lastTimeStep;  // Last time-step number.
 static unsigned long numSamples;    // Number of samples taken.
+static struct timespec startClock;  // Start time from monotonic clock.
 
 /* Private functions.*/
 double timeFilter( double coeff , double timePerIteration , double timeDiff , unsigned long numStep );
@@ -69,6 +73,8 @@ void startTimer( unsigned long timeStep , unsigned long numTimeSteps )
 
   startTime = nowTime = lastTime = lastEstEndTime = time( NULL );
 
+  clock_gettime( CLOCK_MONOTONIC , &startClock );
+
   numSamples = lastTimeStep = 0;
 
   message( MSG_LOG , 0 , "\n  %lu Iterations - Start time: %s" , numTimeSteps , ctime ( &startTime ) );
@@ -82,13 +88,18 @@ void stopTimer( unsigned long timeStep , unsigned long numTimeSteps )
 {
 
   double averageTimePerIteration;
+  double elapsedTime;
   unsigned long numCells;
   int innerBox[6];
   int outerBox[6];
+  struct timespec stopClock;
 
   nowTime = time( NULL );
 
-  averageTimePerIteration = difftime( nowTime , startTime ) / (double) numTimeSteps;
+  clock_gettime( CLOCK_MONOTONIC , &stopClock );
+  elapsedTime = (double)( stopClock.tv_sec - startClock.tv_sec ) + 1e-9 * (double)( stopClock.tv_nsec - startClock.tv_nsec );
+
+  averageTimePerIteration = elapsedTime / (double) numTimeSteps;
 
   getGridBoundingBox( innerBox , outerBox );
 
@@ -96,7 +107,13 @@ void stopTimer( unsigned long timeStep , unsigned long numTimeSteps )
 
   message( MSG_LOG , 0 , "\n  %lu/%lu Iterations - Completed: %s" , timeStep , numTimeSteps , ctime( &nowTime ) );
 
-  message( MSG_LOG , 0 , "\n  Average spi %g, average spi/cell %g ns\n" , averageTimePerIteration , averageTimePerIteration / (double) numCells / 1e-9 );
+  message( MSG_LOG , 0 , "\n  Elapsed time %g s\n" , elapsedTime );
+
+  message( MSG_LOG , 0 , "  Average spi %g, average spi/cell %g ns\n" , averageTimePerIteration , averageTimePerIteration / (double) numCells / 1e-9 );
+
+  if( elapsedTime > 0.0 )
+    message( MSG_LOG , 0 , "  Average cell updates per second %g (%g Mcells/s)\n" , (double) numCells * numTimeSteps / elapsedTime , 
+             (double) numCells * numTimeSteps / elapsedTime / 1e6 );
 
   return;
 
@@ -22,6 +22,8 @@
  *
  */
 
+#include <stdio.h>
+#include <string.h>
 #include <math.h>
 
 #include "util.h"
@@ -47,3 +49,86 @@ real radians2degrees( real angle )
 {
   return 180.0 / pi * angle;
 }
+
+/* Return size in bytes of the data cache at the given level, or zero if unknown. */
+/* Only available on Linux using the sysfs cache description of the first CPU. */
+unsigned long getCacheSize( int level )
+{
+
+  char fileName[PATH_SIZE];
+  char type[TAG_SIZE];
+  char unit = ' ';
+  int cacheLevel;
+  unsigned long size;
+  FILE *fp;
+
+  for( int index = 0 ; index < MAX_CACHE_INDEX ; index++ )
+  {
+    snprintf( fileName , PATH_SIZE , "/sys/devices/system/cpu/cpu0/cache/index%d/level" , index );
+    fp = fopen( fileName , "r" );
+    if( !fp ) break;
+    if( fscanf( fp , "%d" , &cacheLevel ) != 1 ) cacheLevel = -1;
+    fclose( fp );
+    if( cacheLevel != level ) continue;
+
+    snprintf( fileName , PATH_SIZE , "/sys/devices/system/cpu/cpu0/cache/index%d/type" , index );
+    fp = fopen( fileName , "r" );
+    if( !fp ) continue;
+    if( fscanf( fp , "%31s" , type ) != 1 ) type[0] = '\0';
+    fclose( fp );
+    if( type[0] == 'I' ) continue;
+
+    snprintf( fileName , PATH_SIZE , "/sys/devices/system/cpu/cpu0/cache/index%d/size" , index );
+    fp = fopen( fileName , "r" );
+    if( !fp ) continue;
+    if( fscanf( fp , "%lu%c" , &size , &unit ) < 1 ) size = 0;
+    fclose( fp );
+    
+    switch( unit )
+    {
+    case 'K':
+      return 1024 * size;
+    case 'M':
+      return 1024 * 1024 * size;
+    default:
+      return size;
+    }
+  }
+
+  return 0;
+
+}
+
+/* Get the processor model name, or "unknown" if it cannot be found. */
+/* Only available on Linux using the first model name in /proc/cpuinfo. */
+void getCpuModel( char model[] , int size )
+{
+
+  char line[PATH_SIZE];
+  char *value;
+  FILE *fp;
+
+  strncpy( model , "unknown" , size );
+  model[size-1] = '\0';
+
+  fp = fopen( "/proc/cpuinfo" , "r" );
+  if( !fp ) return;
+
+  while( fgets( line , PATH_SIZE , fp ) )
+  {
+    if( strncmp( line , "model name" , 10 ) != 0 ) continue;
+    value = strchr( line , ':' );
+    if( !value ) continue;
+    value++;
+    while( *value == ' ' || *value == '\t' ) value++;
+    value[strcspn( value , "\r\n" )] = '\0';
+    strncpy( model , value , size );
+    model[size-1] = '\0';
+    break;
+  }
+
+  fclose( fp );
+
+  return;
+
+}
@@ -29,8 +29,13 @@
 
 #include "fdtd_types.h"
 
+/* Maximum number of cache descriptions examined by getCacheSize. */
+#define MAX_CACHE_INDEX 8
+
 bool isEqualRel( real x , real y , real rtol );
 real degrees2radians( real angle );
 real radians2degrees( real angle );
+unsigned long getCacheSize( int level );
+void getCpuModel( char model[] , int size );
 
 #endif
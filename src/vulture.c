@@ -47,6 +47,13 @@
 #include "line.h"
 #include "grid.h"
 #include "memory.h"
+#include "simd.h"
+#include "affinity.h"
+#include "domain.h"
+#include "balance.h"
+#include "autotune.h"
+#include "profiler.h"
+#include "perfcounter.h"
 
 
 /* Vulture version. */
@@ -80,11 +87,33 @@ int main ( int argc , char **argv )
   /* Mesh file name */
   char meshFileName[PATH_SIZE] = "";
 
+  /* Log file name. */
+  char logFileName[PATH_SIZE] = "vulture.log";
+
   /* Parse options. */
   parseOption( argc , argv , meshFileName );
 
+  /* Start the domain decomposition run-time. */
+  initDomain( &argc , &argv );
+
+  /* Each non-root domain keeps its own log. */
+  if( !isRootDomain() )
+    snprintf( logFileName , PATH_SIZE , "vulture.%d.log" , getDomainRank() );
+
   /* Start logging. */
-  startMessaging( "vulture.log" , options.logLevel , "Vulture" , solverVersion[0] , solverVersion[1]  , solverVersion[2] );
+  startMessaging( logFileName , options.logLevel , "Vulture" , solverVersion[0] , solverVersion[1]  , solverVersion[2] );
+
+  /* Set number of threads if given - must be done before the grid arrays are first touched.*/
+#ifdef WITH_OPENMP
+  if( options.numThread > 0 )  
+    omp_set_num_threads( options.numThread ); 
+#endif
+
+  /* Bind threads to processors. */
+  initThreadAffinity();
+
+  /* Set up the work balance between the threads. */
+  initBalance();
 
   /* Define physical constants. */
   physicalConstants();
@@ -97,7 +126,11 @@ int main ( int argc , char **argv )
 
   /* Read in the mesh. */
   readMesh( meshFileName );
-  if( options.readOnly ) exit( 0 );
+  if( options.readOnly )
+  {
+    deallocDomain();
+    exit( 0 );
+  }
 
   /* Initialise the grid. */
   initGrid();
@@ -137,6 +170,9 @@ int main ( int argc , char **argv )
   /* Initialise the observers. */
   initObservers();
 
+  /* Find uniform coefficient runs on the grid - must be done after all media are set. */
+  initPencilRuns();
+
   /* Free the mesh. */
   deallocMesh();
  
@@ -162,15 +198,14 @@ int main ( int argc , char **argv )
     dumpMediaOnGrid( HZ );
   }
 
-  /* Set number of threads if given.*/
-#ifdef WITH_OPENMP
-  if( options.numThread > 0 )  
-    omp_set_num_threads( options.numThread ); 
-#endif
-  
   /* Step the fields. */
   if( !options.preprocessOnly )
+  {
+    autotune();
     propagate();
+    reportBalance();
+    reportProfile();
+  }
 
 #ifdef CHECK_LIMITS
   checkGrid();
@@ -190,7 +225,10 @@ int main ( int argc , char **argv )
   deallocMedia();
   deallocGridArrays();
   deallocSimulation();
+  deallocProfiler();
+  deallocBalance();
   stopMessaging();
+  deallocDomain();
 
   return 0;
 
@@ -201,6 +239,8 @@ void parseOption( int argc , char *argv[] , char meshFileName[] )
 {
 
   char *ptr;
+  int tileSize[2];
+  int timeBlockSize;
   
   while ( ( argc > 1 ) && ( argv[1][0] == '-' ) )
   {
@@ -245,10 +285,169 @@ void parseOption( int argc , char *argv[] , char meshFileName[] )
       }
 
     }
+    else if( strncmp( argv[1] , "-a" , 2 ) == 0  || strncmp( argv[1] , "--affinity" , 10 ) == 0 )
+    {
+      if( argc > 2 )
+      {
+        if( !setThreadAffinity( argv[2] ) )
+        {
+          printf( "\n*** Error: invalid value %s for option %s\n" , argv[2] , argv[1] );
+          printUsage();
+          exit( 1 );         
+        }
+        ++argv;
+        --argc;
+      }
+      else
+      {
+        printf( "\n*** Error: no value for option %s\n" , argv[1] );
+        printUsage();
+        exit( 1 );
+      }
+    }
+    else if( strncmp( argv[1] , "-k" , 2 ) == 0  || strncmp( argv[1] , "--kernel" , 8 ) == 0 )
+    {
+      if( argc > 2 )
+      {
+        if( !setGridKernel( argv[2] ) )
+        {
+          printf( "\n*** Error: invalid value %s for option %s\n" , argv[2] , argv[1] );
+          printUsage();
+          exit( 1 );         
+        }
+        ++argv;
+        --argc;
+      }
+      else
+      {
+        printf( "\n*** Error: no value for option %s\n" , argv[1] );
+        printUsage();
+        exit( 1 );
+      }
+    }
+    else if( strncmp( argv[1] , "-s" , 2 ) == 0  || strncmp( argv[1] , "--simd" , 6 ) == 0 )
+    {
+      if( argc > 2 )
+      {
+#ifdef WITH_SIMD
+        if( !setSimdLevel( argv[2] ) )
+        {
+          printf( "\n*** Error: invalid value %s for option %s\n" , argv[2] , argv[1] );
+          printUsage();
+          exit( 1 );         
+        }
+#else
+        printf( "\n*** Warning: SIMD kernels not available - option %s ignored\n" , argv[1] );
+#endif
+        ++argv;
+        --argc;
+      }
+      else
+      {
+        printf( "\n*** Error: no value for option %s\n" , argv[1] );
+        printUsage();
+        exit( 1 );
+      }
+    }
+    else if( strncmp( argv[1] , "-t" , 2 ) == 0  || strncmp( argv[1] , "--tile" , 6 ) == 0 )
+    {
+      if( argc > 2 )
+      {
+        if( sscanf( argv[2] , "%d,%d" , &tileSize[0] , &tileSize[1] ) != 2 || tileSize[0] < 1 || tileSize[1] < 1 )
+        {
+          printf( "\n*** Error: invalid value %s for option %s\n" , argv[2] , argv[1] );
+          printUsage();
+          exit( 1 );         
+        }
+        setGridTileSize( tileSize );
+        ++argv;
+        --argc;
+      }
+      else
+      {
+        printf( "\n*** Error: no value for option %s\n" , argv[1] );
+        printUsage();
+        exit( 1 );
+      }
+    }
     else if( strncmp( argv[1] , "-p" , 2 ) == 0  || strncmp( argv[1] , "--preprocess" , 12 ) == 0 )
     {
       options.preprocessOnly = true;
     }
+    else if( strncmp( argv[1] , "-b" , 2 ) == 0  || strncmp( argv[1] , "--time-block" , 12 ) == 0 )
+    {
+      if( argc > 2 )
+      {
+        timeBlockSize = strtol( argv[2] , &ptr , 10 );
+        if( *ptr != '\0' || timeBlockSize < 1 )
+        {
+          printf( "\n*** Error: invalid value %s for option %s\n" , argv[2] , argv[1] );
+          printUsage();
+          exit( 1 );         
+        }
+        setTimeBlockSize( timeBlockSize );
+        ++argv;
+        --argc;
+      }
+      else
+      {
+        printf( "\n*** Error: no value for option %s\n" , argv[1] );
+        printUsage();
+        exit( 1 );
+      }
+    }
+    else if( strncmp( argv[1] , "-T" , 2 ) == 0  || strncmp( argv[1] , "--task-graph" , 12 ) == 0 )
+    {
+      setTaskGraph( true );
+    }
+    else if( strncmp( argv[1] , "-P" , 2 ) == 0  || strncmp( argv[1] , "--profile" , 9 ) == 0 )
+    {
+      setProfiling( true );
+    }
+    else if( strncmp( argv[1] , "-H" , 2 ) == 0  || strncmp( argv[1] , "--hw-counters" , 13 ) == 0 )
+    {
+      setProfiling( true );
+      setHardwareCounters( true );
+    }
+    else if( strncmp( argv[1] , "-A" , 2 ) == 0  || strncmp( argv[1] , "--autotune" , 10 ) == 0 )
+    {
+      setAutotune( true );
+    }
+    else if( strncmp( argv[1] , "-W" , 2 ) == 0  || strncmp( argv[1] , "--wisdom" , 8 ) == 0 )
+    {
+      if( argc > 2 )
+      {
+        setWisdomFileName( argv[2] );
+        ++argv;
+        --argc;
+      }
+      else
+      {
+        printf( "\n*** Error: no value for option %s\n" , argv[1] );
+        printUsage();
+        exit( 1 );
+      }
+    }
+    else if( strncmp( argv[1] , "-w" , 2 ) == 0  || strncmp( argv[1] , "--cost-weights" , 14 ) == 0 )
+    {
+      if( argc > 2 )
+      {
+        if( !setCostWeights( argv[2] ) )
+        {
+          printf( "\n*** Error: invalid value %s for option %s\n" , argv[2] , argv[1] );
+          printUsage();
+          exit( 1 );         
+        }
+        ++argv;
+        --argc;
+      }
+      else
+      {
+        printf( "\n*** Error: no value for option %s\n" , argv[1] );
+        printUsage();
+        exit( 1 );
+      }
+    }
     else if( strncmp( argv[1] , "-g" , 2 ) == 0  || strncmp( argv[1] , "--dump-grid" , 11 ) == 0 )
     {
       options.dumpGrid = true;
@@ -288,11 +487,22 @@ void printUsage( void )
   printf( "vulture -V | --version\n" );
   printf( "vulture [ option ] <meshFile>\n\n" );
   printf( "Valid options are:\n\n" );
+  printf( "-a <policy>, --affinity <policy>\tBind threads to CPUs: NONE, COMPACT or SCATTER\n" );
+  printf( "-A, --autotune\t\t\tTune kernel, tile size, SIMD level and threads, overriding -k, -t, -s and -n\n" );
+  printf( "-b <int>, --time-block <int>\tAdvance up to <int> time steps together in closed PEC cavities\n" );
   printf( "-g, --dump-grid\t\t\tWrite out grid in ASCII format\n" );
+  printf( "-H, --hw-counters\t\tProfile with hardware performance counters and report roofline data\n" );
+  printf( "-k <kernel>, --kernel <kernel>\tSet grid update kernel: STANDARD, FUSED or TILED\n" );
   printf( "-m, --readmesh\t\t\tRead the mesh only and stop\n" );
   printf( "-n <int>, --numproc <int> \tSet number of threads\n" );
   printf( "-p, --preprocess\t\tPreprocess the mesh only and stop\n" );
-  printf( "-v, --verbose\t\t\tProduce verbose logging information\n\n" );
+  printf( "-P, --profile\t\t\tReport the time spent in each stage of the time step\n" );
+  printf( "-s <isa>, --simd <isa>\t\tLimit SIMD kernels to GENERIC, SSE2, AVX2 or AVX512\n" );
+  printf( "-t <int>,<int>, --tile <int>,<int>\tSet j,k tile size for TILED kernel\n" );
+  printf( "-T, --task-graph\t\tSchedule each time step as a graph of concurrent tasks\n" );
+  printf( "-v, --verbose\t\t\tProduce verbose logging information\n" );
+  printf( "-w <type>=<real>,..., --cost-weights <type>=<real>,...\tSet relative cost of GRID, PML, DEBYE (per pole) and SIBC updates\n" );
+  printf( "-W <file>, --wisdom <file>\tRead and save tuned configurations in <file> (default %s)\n\n" , DEFAULT_WISDOM_FILE );
 
   return;
 
@@ -313,6 +523,12 @@ void printVersion( void )
 #ifdef WITH_OPENMP
   printf( "  Built with OpenMP parallelisation support.\n" );
 #endif
+#ifdef WITH_SIMD
+  printf( "  Built with SIMD kernels.\n" );
+#endif
+#ifdef WITH_MPI
+  printf( "  Built with MPI domain decomposition support.\n" );
+#endif
 #ifdef USE_SCALED_FIELDS
   printf( "  Using scaled fields.\n" );
 #else
@@ -321,7 +537,7 @@ void printVersion( void )
   printf( "  Field arrays are %d-bytes.\n" , (int) sizeof( real ) );
 #ifdef USE_INDEXED_MEDIA
   printf( "  Using indexed media.\n" );
-  printf( "  Medium index is %d-bytes.\n" , (int) sizeof( MediumIndex ) );
+  printf( "  Medium index is 1, 2 or 4-bytes, chosen at run-time.\n" );
 #else
   printf( "  Using unindexed media.\n" );
   printf( "  Media arrays are %d-bytes.\n" , (int) sizeof( real ) );
@@ -28,12 +28,12 @@
 // These are now passed as compiler options by cmake.
 
 /* If defined, all the fields are scaled by their respectivew edge lengths. */
-//#define USE_SCALE_FIELDS
+//#define USE_SCALED_FIELDS
 
 /* If defined, media at interfaces are averaged. */
 //#define USE_AVERAGED_MEDIA
 
-/* If defined indexed media are used. Incompatible with scaled fields and averaged media! */
+/* If defined indexed media are used. Incompatible with averaged media! */
 //#define USE_INDEXED_MEDIA
 
 #endif
@@ -0,0 +1,631 @@
+/* 
+ * This file is part of Vulture.
+ *
+ * Vulture finite-difference time-domain electromagnetic solver.
+ * Copyright (C) 2011-2016 Ian David Flintoft
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ *
+ * Author: Ian Flintoft <ian.flintoft@googlemail.com>
+ *
+ */
+
+
+/*
+ * Kernel benchmark. Synthesises a mesh with the requested size and media mix,
+ * initialises it as the solver does and times each update subsystem in
+ * isolation for each thread count.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <complex.h>
+
+#ifdef WITH_OPENMP
+  #include <omp.h> 
+#endif
+
+#include "fdtd_types.h"
+#include "physical.h"
+#include "message.h"
+#include "mesh.h"
+#include "simulation.h"
+#include "medium.h"
+#include "boundary.h"
+#include "surface.h"
+#include "block.h"
+#include "line.h"
+#include "grid.h"
+#include "pml.h"
+#include "mur.h"
+#include "debye.h"
+#include "waveform.h"
+#include "source.h"
+#include "planewave.h"
+#include "observer.h"
+#include "balance.h"
+#include "domain.h"
+#ifdef WITH_SIBC
+  #include "sibc.h"
+#endif
+
+/* Vulture version. */
+static int solverVersion[3] = { 0 , 7 , 1 };
+
+/* Synthesised mesh file name. */
+#define BENCH_MESH_FILE "vulture-bench.mesh"
+
+/* Log file name. */
+#define BENCH_LOG_FILE "vulture-bench.log"
+
+/* Default CSV file name. */
+#define BENCH_CSV_FILE "vulture-bench.csv"
+
+/* Maximum number of thread counts. */
+#define MAX_THREAD_COUNTS 32
+
+/* Number of time steps in the mesh - sets the number of DFT frequencies of the observers. */
+#define BENCH_NUM_STEPS 500
+
+/* Cells between the regions of the mesh and the boundaries. */
+#define BENCH_MARGIN 2
+
+/* 
+ * Estimated memory traffic per field element update in bytes, assuming neighbouring
+ * values are reused from cache. Zero for kernels limited by arithmetic rather than 
+ * memory, for which no bandwidth is reported.
+ *
+ * GRID: field read and write, two new curl terms and two coefficients.
+ * PML:  as GRID plus reads and writes of two auxiliary fields.
+ * MUR:  field read and write, an interior field and two saved values.
+ * DEBYE: per pole update, read and write of the complex polarisation current plus
+ *        the field, last field and coefficient amortised over the poles. 
+ * PLANEWAVE: field read and write, incident field and coefficient.
+ */
+#define BYTES_GRID      ( 6 * sizeof( real ) )
+#define BYTES_PML       ( 10 * sizeof( real ) )
+#define BYTES_MUR       ( 6 * sizeof( real ) )
+#define BYTES_DEBYE     ( 2 * sizeof( double complex ) + 5 * sizeof( real ) / BENCH_DEBYE_POLES )
+#define BYTES_PLANEWAVE ( 4 * sizeof( real ) )
+
+/* Number of poles of the Debye medium. */
+#define BENCH_DEBYE_POLES 2
+
+/* Benchmarked kernel. */
+typedef struct BenchKernel_t {
+
+  char name[TAG_SIZE];             // Name in reports.
+  void (*update)( void );          // Update function.
+  int workType;                    // Load balance statistics used to count element updates, or -1.
+  double bytesPerCell;             // Estimated memory traffic per element update.
+  double numCells;                 // Element updates per call, if not counted by the load balancer.
+  double baseTime;                 // Time per call with the first thread count.
+
+} BenchKernel;
+
+/* Options. */
+struct Options_t {
+
+  int numCells[3];
+  double debyeFraction;
+  int numSibcPlates;
+  int numObservers;
+  int numRepeats;
+  int numThreadCounts;
+  int threadCounts[MAX_THREAD_COUNTS];
+  char csvFileName[PATH_SIZE];
+
+#ifdef WITH_SIBC
+} options = { { 64 , 64 , 64 } , 0.25 , 1 , 16 , 10 , 0 , { 0 } , BENCH_CSV_FILE };
+#else
+} options = { { 64 , 64 , 64 } , 0.25 , 0 , 16 , 10 , 0 , { 0 } , BENCH_CSV_FILE };
+#endif
+
+/* Time step number and time step used by the time dependent updates. */
+static unsigned long benchStep = 0;
+static real benchTimeStep = 0.0;
+
+/* Private functions. */
+void parseOption( int argc , char *argv[] );
+bool parseThreadCounts( char *list );
+void printUsage( void );
+void writeBenchMesh( char *fileName , int planeWaveBox[6] );
+void initBench( void );
+void runBench( BenchKernel *kernels , int numKernels );
+double timeKernel( BenchKernel *kernel , double *numCells );
+void updatePlaneWavesEfieldBench( void );
+void updateObserversBench( void );
+
+/* Main. */
+int main ( int argc , char **argv )
+{
+
+  int planeWaveBox[6];
+  int numFaces[3];
+
+  BenchKernel kernels[] = {
+    { "GRID_E"      , updateGridEfield            , WT_GRID  , BYTES_GRID      , 0.0 , 0.0 } ,
+    { "GRID_H"      , updateGridHfield            , WT_GRID  , BYTES_GRID      , 0.0 , 0.0 } ,
+    { "PML_E"       , updatePmlEfield             , WT_PML   , BYTES_PML       , 0.0 , 0.0 } ,
+    { "PML_H"       , updatePmlHfield             , WT_PML   , BYTES_PML       , 0.0 , 0.0 } ,
+    { "MUR_E"       , updateMurEfield             , -1       , BYTES_MUR       , 0.0 , 0.0 } ,
+    { "DEBYE_E"     , updateDebyeBlocksEfield     , WT_DEBYE , BYTES_DEBYE     , 0.0 , 0.0 } ,
+#ifdef WITH_SIBC
+    { "SIBC_E"      , updateSibcSurfacesEfield    , WT_SIBC  , 0.0             , 0.0 , 0.0 } ,
+#endif
+    { "PLANEWAVE_E" , updatePlaneWavesEfieldBench , -1       , BYTES_PLANEWAVE , 0.0 , 0.0 } ,
+    { "OBSERVERS"   , updateObserversBench        , -1       , 0.0             , 0.0 , 0.0 } ,
+  };
+  int numKernels = sizeof( kernels ) / sizeof( BenchKernel );
+
+  /* Parse options. */
+  parseOption( argc , argv );
+
+  /* Start the domain decomposition run-time - the benchmark uses one domain. */
+  initDomain( &argc , &argv );
+
+  /* Start logging. */
+  startMessaging( BENCH_LOG_FILE , MSG_LOG , "vulture-bench" , solverVersion[0] , solverVersion[1]  , solverVersion[2] );
+
+  /* Synthesise and initialise the mesh. */
+  writeBenchMesh( BENCH_MESH_FILE , planeWaveBox );
+  initBench();
+
+  /* Element updates of the kernels not counted by the load balancer. */
+  for( int kernel = 0 ; kernel < numKernels ; kernel++ )
+  {
+    if( kernels[kernel].update == updateMurEfield )
+      /* Two tangential components on the YLO and YHI faces. */
+      kernels[kernel].numCells = 2.0 * 2.0 * options.numCells[XDIR] * options.numCells[ZDIR];
+    else if( kernels[kernel].update == updatePlaneWavesEfieldBench )
+    {
+      /* Two tangential components on each face of the total-field/scattered-field box. */
+      for( CoordAxis axis = XDIR ; axis <= ZDIR ; axis++ )
+        numFaces[axis] = planeWaveBox[2*axis+1] - planeWaveBox[2*axis];
+      kernels[kernel].numCells = 2.0 * 2.0 * ( numFaces[XDIR] * numFaces[YDIR] + numFaces[YDIR] * numFaces[ZDIR] + numFaces[ZDIR] * numFaces[XDIR] );
+    }
+    else if( kernels[kernel].update == updateObserversBench )
+      kernels[kernel].numCells = options.numObservers;
+  }
+
+  runBench( kernels , numKernels );
+
+  /* Tidy up. */
+  deallocObservers();
+  deallocPlaneWaves();
+  deallocSources();
+  deallocWaveforms();
+  deallocExternalSurfaces();
+  deallocInternalSurfaces();
+  deallocBoundaries();
+  deallocLines();
+  deallocBlocks();
+  deallocMedia();
+  deallocGridArrays();
+  deallocSimulation();
+  deallocBalance();
+  stopMessaging();
+  deallocDomain();
+
+  return 0;
+
+}
+
+/* Parse command line options. */
+void parseOption( int argc , char *argv[] )
+{
+
+  char *ptr;
+  int maxThreads = 1;
+
+  while ( ( argc > 1 ) && ( argv[1][0] == '-' ) )
+  {
+
+    if( strncmp( argv[1] , "-h" , 2 ) == 0  || strncmp( argv[1] , "--help" , 6 ) == 0 )
+    {
+      printUsage();
+      exit( 0 );
+    }
+    else if( argc < 3 )
+    {
+      printf( "\n*** Error: no value for option %s\n" , argv[1] );
+      printUsage();
+      exit( 1 );
+    }
+    else if( strncmp( argv[1] , "-c" , 2 ) == 0  || strncmp( argv[1] , "--cells" , 7 ) == 0 )
+    {
+      if( sscanf( argv[2] , "%d,%d,%d" , &options.numCells[XDIR] , &options.numCells[YDIR] , &options.numCells[ZDIR] ) != 3 ||
+          options.numCells[XDIR] < 24 || options.numCells[YDIR] < 8 || options.numCells[ZDIR] < 8 )
+      {
+        printf( "\n*** Error: invalid value %s for option %s\n" , argv[2] , argv[1] );
+        printUsage();
+        exit( 1 );
+      }
+    }
+    else if( strncmp( argv[1] , "-d" , 2 ) == 0  || strncmp( argv[1] , "--debye" , 7 ) == 0 )
+    {
+      options.debyeFraction = strtod( argv[2] , &ptr );
+      if( *ptr != '\0' || options.debyeFraction < 0.0 || options.debyeFraction > 0.3 )
+      {
+        printf( "\n*** Error: invalid value %s for option %s\n" , argv[2] , argv[1] );
+        printUsage();
+        exit( 1 );
+      }
+    }
+    else if( strncmp( argv[1] , "-s" , 2 ) == 0  || strncmp( argv[1] , "--sibc" , 6 ) == 0 )
+    {
+      options.numSibcPlates = strtol( argv[2] , &ptr , 10 );
+      if( *ptr != '\0' || options.numSibcPlates < 0 )
+      {
+        printf( "\n*** Error: invalid value %s for option %s\n" , argv[2] , argv[1] );
+        printUsage();
+        exit( 1 );
+      }
+#ifndef WITH_SIBC
+      if( options.numSibcPlates > 0 )
+      {
+        printf( "\n*** Warning: SIBC not available - option %s ignored\n" , argv[1] );
+        options.numSibcPlates = 0;
+      }
+#endif
+    }
+    else if( strncmp( argv[1] , "-o" , 2 ) == 0  || strncmp( argv[1] , "--observers" , 11 ) == 0 )
+    {
+      options.numObservers = strtol( argv[2] , &ptr , 10 );
+      if( *ptr != '\0' || options.numObservers < 0 )
+      {
+        printf( "\n*** Error: invalid value %s for option %s\n" , argv[2] , argv[1] );
+        printUsage();
+        exit( 1 );
+      }
+    }
+    else if( strncmp( argv[1] , "-r" , 2 ) == 0  || strncmp( argv[1] , "--repeats" , 9 ) == 0 )
+    {
+      options.numRepeats = strtol( argv[2] , &ptr , 10 );
+      if( *ptr != '\0' || options.numRepeats < 1 )
+      {
+        printf( "\n*** Error: invalid value %s for option %s\n" , argv[2] , argv[1] );
+        printUsage();
+        exit( 1 );
+      }
+    }
+    else if( strncmp( argv[1] , "-n" , 2 ) == 0  || strncmp( argv[1] , "--threads" , 9 ) == 0 )
+    {
+      if( !parseThreadCounts( argv[2] ) )
+      {
+        printf( "\n*** Error: invalid value %s for option %s\n" , argv[2] , argv[1] );
+        printUsage();
+        exit( 1 );
+      }
+    }
+    else if( strncmp( argv[1] , "-f" , 2 ) == 0  || strncmp( argv[1] , "--csv" , 5 ) == 0 )
+    {
+      strncpy( options.csvFileName , argv[2] , PATH_SIZE - 1 );
+    }
+    else
+    {
+      printf( "\n*** Error: invalid option %s\n" , argv[1] );
+      printUsage();
+      exit( 1 );
+    }
+
+    argv += 2;
+    argc -= 2;
+
+  } /* while */
+
+  if( argc != 1 )
+  {
+    printUsage();
+    exit( 1 );
+  }
+
+  /* Default thread counts are the powers of two up to the maximum, and the maximum. */
+  if( options.numThreadCounts == 0 )
+  {
+#ifdef WITH_OPENMP
+    maxThreads = omp_get_max_threads();
+#endif
+    for( int numThreads = 1 ; numThreads < maxThreads && options.numThreadCounts < MAX_THREAD_COUNTS - 1 ; numThreads *= 2 )
+      options.threadCounts[options.numThreadCounts++] = numThreads;
+    options.threadCounts[options.numThreadCounts++] = maxThreads;
+  }
+
+  return;
+
+}
+
+/* Parse comma separated list of thread counts - returns false if invalid. */
+bool parseThreadCounts( char *list )
+{
+
+  char *ptr = list;
+  int numThreads;
+
+  options.numThreadCounts = 0;
+
+  while( *ptr != '\0' )
+  {
+    numThreads = strtol( ptr , &ptr , 10 );
+    if( numThreads < 1 || options.numThreadCounts == MAX_THREAD_COUNTS || ( *ptr != ',' && *ptr != '\0' ) )
+      return false;
+#ifndef WITH_OPENMP
+    if( numThreads > 1 )
+      return false;
+#endif
+    options.threadCounts[options.numThreadCounts++] = numThreads;
+    if( *ptr == ',' ) ptr++;
+  }
+
+  return options.numThreadCounts > 0;
+
+}
+
+/* Print usage information to standard output. */
+void printUsage( void )
+{
+
+  printf( "\nUsage:\n\n" );
+  printf( "vulture-bench -h | --help\n" );
+  printf( "vulture-bench [ option ]\n\n" );
+  printf( "Valid options are:\n\n" );
+  printf( "-c <int>,<int>,<int>, --cells <int>,<int>,<int>\tNumber of cells in mesh (default 64,64,64)\n" );
+  printf( "-d <real>, --debye <real>\tFraction of mesh filled with Debye medium, up to 0.3 (default 0.25)\n" );
+  printf( "-f <file>, --csv <file>\t\tWrite CSV results to <file> (default %s)\n" , BENCH_CSV_FILE );
+  printf( "-n <int>,..., --threads <int>,...\tThread counts (default powers of two up to maximum)\n" );
+  printf( "-o <int>, --observers <int>\tNumber of frequency domain point observers (default 16)\n" );
+  printf( "-r <int>, --repeats <int>\tNumber of timed calls of each kernel (default 10)\n" );
+  printf( "-s <int>, --sibc <int>\t\tNumber of SIBC plates (default 1 if SIBC is available)\n\n" );
+
+  return;
+
+}
+
+/*
+ * Write the benchmark mesh. Along x it has a total-field/scattered-field box in
+ * the first third, SIBC plates in the second third and a Debye block in the last
+ * third. The x faces are PML, the y faces Mur and the z faces PEC. Observers are
+ * spread along the axis of the mesh.
+ */
+void writeBenchMesh( char *fileName , int planeWaveBox[6] )
+{
+
+  FILE *fp;
+  int *n = options.numCells;
+  int third = n[XDIR] / 3;
+  int debyeCells;
+  int x;
+
+  fp = fopen( fileName , "w" );
+  if( !fp )
+    message( MSG_ERROR , 0 , "*** Error: Failed to open benchmark mesh file %s\n" , fileName );
+
+  fprintf( fp , "VM 1.0.0\n" );
+  fprintf( fp , "CE Vulture kernel benchmark\n" );
+  fprintf( fp , "DM %d %d %d\n" , n[XDIR] , n[YDIR] , n[ZDIR] );
+  fprintf( fp , "GS\n" );
+  fprintf( fp , "BT XLO PML\nBT XHI PML\nBT YLO MUR\nBT YHI MUR\nBT ZLO PEC\nBT ZHI PEC\n" );
+
+  /* Debye block, clear of the Mur boundaries. */
+  debyeCells = (int)( options.debyeFraction * n[XDIR] + 0.5 );
+  if( debyeCells > 0 )
+  {
+    fprintf( fp , "MT debye DEBYE 2.0 0.01 1.0 1e9 -1e9 5e8 -2e9\n" );
+    fprintf( fp , "MB %d %d %d %d %d %d debye\n" , n[XDIR] - BENCH_MARGIN - debyeCells , n[XDIR] - BENCH_MARGIN , 
+             BENCH_MARGIN , n[YDIR] - BENCH_MARGIN , BENCH_MARGIN , n[ZDIR] - BENCH_MARGIN );
+  }
+
+  /* SIBC plates. */
+  if( options.numSibcPlates > 0 )
+  {
+    fprintf( fp , "BT sibc SIBC -0.5 0.25 0.25 -0.5\n" );
+    for( int plate = 0 ; plate < options.numSibcPlates ; plate++ )
+    {
+      x = third + ( plate + 1 ) * third / ( options.numSibcPlates + 1 );
+      fprintf( fp , "TB %d %d %d %d %d %d sibc\n" , x , x , BENCH_MARGIN , n[YDIR] - BENCH_MARGIN , BENCH_MARGIN , n[ZDIR] - BENCH_MARGIN );
+    }
+  }
+
+  /* Plane wave. */
+  planeWaveBox[XLO] = BENCH_MARGIN;
+  planeWaveBox[XHI] = third - BENCH_MARGIN;
+  planeWaveBox[YLO] = BENCH_MARGIN;
+  planeWaveBox[YHI] = n[YDIR] - BENCH_MARGIN;
+  planeWaveBox[ZLO] = BENCH_MARGIN;
+  planeWaveBox[ZHI] = n[ZDIR] - BENCH_MARGIN;
+  fprintf( fp , "WF wf1 GAUSSIAN_PULSE 1.0\n" );
+  fprintf( fp , "PW %d %d %d %d %d %d pw1 wf1 90 0 90 111111 1.0 0.0\n" , planeWaveBox[XLO] , planeWaveBox[XHI] , 
+           planeWaveBox[YLO] , planeWaveBox[YHI] , planeWaveBox[ZLO] , planeWaveBox[ZHI] );
+
+  /* Observers. */
+  for( int observer = 0 ; observer < options.numObservers ; observer++ )
+  {
+    x = ( observer + 1 ) * n[XDIR] / ( options.numObservers + 1 );
+    fprintf( fp , "OP %d %d %d %d %d %d op%d FDOM_ASCII\n" , x , x , n[YDIR] / 2 , n[YDIR] / 2 , n[ZDIR] / 2 , n[ZDIR] / 2 , observer );
+  }
+
+  fprintf( fp , "GE\n" );
+  fprintf( fp , "NT %d\n" , BENCH_NUM_STEPS );
+  fprintf( fp , "MS 0.01\n" );
+  fprintf( fp , "EN\n" );
+
+  fclose( fp );
+
+  return;
+
+}
+
+/* Initialise the mesh in the same order as the solver. */
+void initBench( void )
+{
+
+  initBalance();
+  physicalConstants();
+  initSimulation();
+  initMesh();
+  readMesh( BENCH_MESH_FILE );
+  initGrid();
+  initBoundaries();
+  initMedia();
+  initMediaArrays();
+  initBlocks();
+  initLines();
+  initInternalSurfaces();
+  initExternalSurfaces();
+  initWaveforms();
+  initSources();
+  initPlaneWaves();
+  initObservers();
+  initPencilRuns();
+  deallocMesh();
+  reportGrid();
+
+  benchTimeStep = getGridTimeStep();
+
+  return;
+
+}
+
+/* Time the kernels for each thread count and report the results. */
+void runBench( BenchKernel *kernels , int numKernels )
+{
+
+  FILE *fp;
+  double time;
+  double numCells;
+  double nsPerCell;
+  double gbPerSec;
+  double speedup;
+  char bandwidth[TAG_SIZE];
+  char csvBandwidth[TAG_SIZE];
+
+  fp = fopen( options.csvFileName , "w" );
+  if( !fp )
+    message( MSG_ERROR , 0 , "*** Error: Failed to open CSV file %s\n" , options.csvFileName );
+
+  fprintf( fp , "kernel,threads,cells,repeats,seconds_per_call,ns_per_cell,gb_per_s,speedup\n" );
+
+  printf( "\nVulture kernel benchmark: %d x %d x %d cells, Debye fraction %g, %d SIBC plate(s), %d observer(s)\n\n" ,
+          options.numCells[XDIR] , options.numCells[YDIR] , options.numCells[ZDIR] , options.debyeFraction , 
+          options.numSibcPlates , options.numObservers );
+  printf( "  %-12s %7s %12s %12s %10s %9s\n" , "Kernel" , "Threads" , "Cells" , "ns/cell" , "GB/s" , "Speedup" );
+
+  for( int count = 0 ; count < options.numThreadCounts ; count++ )
+  {
+#ifdef WITH_OPENMP
+    omp_set_num_threads( options.threadCounts[count] );
+#endif
+
+    for( int kernel = 0 ; kernel < numKernels ; kernel++ )
+    {
+      time = timeKernel( &kernels[kernel] , &numCells );
+      if( count == 0 ) 
+        kernels[kernel].baseTime = time;
+
+      nsPerCell = numCells > 0.0 ? 1e9 * time / numCells : 0.0;
+      gbPerSec = time > 0.0 ? 1e-9 * kernels[kernel].bytesPerCell * numCells / time : 0.0;
+      speedup = time > 0.0 ? kernels[kernel].baseTime / time : 0.0;
+
+      if( kernels[kernel].bytesPerCell > 0.0 )
+      {
+        snprintf( bandwidth , TAG_SIZE , "%10.2f" , gbPerSec );
+        snprintf( csvBandwidth , TAG_SIZE , "%e" , gbPerSec );
+      }
+      else
+      {
+        snprintf( bandwidth , TAG_SIZE , "%10s" , "-" );
+        csvBandwidth[0] = '\0';
+      }
+
+      printf( "  %-12s %7d %12.0f %12.3f %s %9.2f\n" , kernels[kernel].name , options.threadCounts[count] , numCells , 
+              nsPerCell , bandwidth , speedup );
+      fprintf( fp , "%s,%d,%.0f,%d,%e,%e,%s,%e\n" , kernels[kernel].name , options.threadCounts[count] , numCells , 
+               options.numRepeats , time , nsPerCell , csvBandwidth , speedup );
+    }
+
+    printf( "\n" );
+  }
+
+  fclose( fp );
+
+  printf( "  Bandwidth is estimated from the memory traffic of each element update assuming cache reuse.\n" );
+  printf( "  Results written to %s\n\n" , options.csvFileName );
+
+  return;
+
+}
+
+/* 
+ * Time a kernel, returning the fastest time of a call and the number of element
+ * updates in a call. 
+ */
+double timeKernel( BenchKernel *kernel , double *numCells )
+{
+
+  double start;
+  double time;
+  double best = -1.0;
+  unsigned long sweeps;
+  double cellUpdates;
+  double elapsed;
+
+  /* Warm up, counting the element updates of a call. */
+  resetBalanceTimes();
+  kernel->update();
+
+  if( kernel->workType >= 0 )
+  {
+    getSweepStats( kernel->workType , &sweeps , &cellUpdates , &elapsed );
+    *numCells = cellUpdates;
+  }
+  else
+  {
+    *numCells = kernel->numCells;
+  }
+
+  for( int repeat = 0 ; repeat < options.numRepeats ; repeat++ )
+  {
+    start = getWorkTime();
+    kernel->update();
+    time = getWorkTime() - start;
+    if( best < 0.0 || time < best )
+      best = time;
+  }
+
+  return best;
+
+}
+
+/* Plane wave update at the current time step. */
+void updatePlaneWavesEfieldBench( void )
+{
+
+  updatePlaneWavesEfield( benchStep * benchTimeStep );
+
+  return;
+
+}
+
+/* Observer update, cycling through the time steps of the mesh. */
+void updateObserversBench( void )
+{
+
+  updateObservers( benchStep , benchStep * benchTimeStep );
+  benchStep = ( benchStep + 1 ) % BENCH_NUM_STEPS;
+
+  return;
+
+}
@@ -103,6 +103,7 @@ static WaveformItem *waveformNumberHash = NULL;
  */
 
 void addWaveform( char *name , WaveformType type , real size , real width , real delay , real frequency , char *fileName );
+void setWaveformDefaults( WaveformItem *item , real del_t );
 real gaussianPulse( real time , real width );
 real differentiatedGaussianPulse( real time , real width );
 real rickerWavelet( real time , real width );
@@ -251,6 +252,76 @@ bool parseWF( char *line )
 
 }
 
+/* Set the default parameters of a waveform for time step del_t. */
+void setWaveformDefaults( WaveformItem *item , real del_t )
+{
+
+  if( item->size < 0 )
+     item->size = 1.0;
+  
+  switch( item->type )
+  {
+  case WT_GAUSSIAN_PULSE:
+  case WT_DIFFERENTIATED_GAUSSIAN_PULSE:
+  case WT_RICKER_WAVELET:
+    if( item->width < 0 )
+       item->width = 5.0 * sqrt( 2.0 ) * del_t;
+    if( item->delay < 0 )
+       item->delay = 40.0 * del_t;
+    item->frequency = 0.0;
+    break;
+  case WT_NARROW_GAUSSIAN_PULSE:
+    if( item->width < 0 )
+       item->width = 8.0 * del_t;
+    if( item->delay < 0 )
+       item->delay = 12.0 * del_t;
+    item->frequency = 0.0;
+    break;
+  case WT_MODULATED_GAUSSIAN_PULSE:
+    if( item->width < 0 )
+       item->width = 20.0 * sqrt( 2.0 ) * del_t;
+    if( item->delay < 0 )
+       item->delay = 120.0 * del_t;
+    if( item->frequency < 0 )
+       item->frequency = 0.05 / del_t;
+    break;
+  case WT_COMPACT_PULSE:
+  case WT_DIFFERENTIATED_COMPACT_PULSE:
+    if( item->width < 0 )
+       item->width = 20.0 * del_t; 
+    if( item->delay < 0 )
+       item->delay = 0.0; 
+    item->frequency = 0.0;
+    break;
+  case WT_MODULATED_COMPACT_PULSE:
+    if( item->width < 0 )
+       item->width = 80.0 * del_t;   
+    if( item->delay < 0 )
+       item->delay = 0.0;
+    if( item->frequency < 0 )
+       item->frequency = 0.05 / del_t;
+    break;
+  case WT_RAMPED_SINUSOID:
+    if( item->width < 0 )
+       item->width = 20.0 * del_t;   
+    if( item->delay < 0 )
+       item->delay = 0.0;
+    if( item->frequency < 0 )
+       item->frequency = 0.05 / del_t;
+    break;
+  case WT_EXTERNAL:
+    if( item->delay < 0 )
+       item->delay = 0.0;
+    break;
+  default:
+    assert( 0 );
+    break;
+  }
+
+  return;
+
+}
+
 /* Initialise waveforms. */
 /* Depends: initGrid */
 void initWaveforms( void )
@@ -268,81 +339,90 @@ void initWaveforms( void )
   DL_FOREACH( waveformList , item ) 
   {
     
-    /* Set default parameters. */
-    if( item->size < 0 )
-       item->size = 1.0;
+    setWaveformDefaults( item , del_t );
 
     item->table = NULL;
-    
-    switch( item->type )
+
+    if( item->type == WT_EXTERNAL )
+    {
+      item->tableSize = loadExternalWaveform( item->fileName , &(item->table) );
+      item->lastIdx = 0UL;
+      message( MSG_LOG , 0 , "  Read %ld entries from external waveform table in file %s\n" , item->tableSize , item->fileName );
+      createSplines( item->fileName , item->table , item->tableSize , 0.0 , 0.0 , del_t );
+    }
+
+    message( MSG_DEBUG3 , 0 , "  Setting %s waveform: size=%g, delay=%g, width=%g, freq=%g\n" , WAVEFORM_TYPE_STR[item->type] ,
+             item->size , item->delay , item->width , item->frequency );
+	       
+  }
+
+  return;
+
+}
+
+/* 
+ * Get the frequency band containing the significant spectral content of the waveforms,
+ * to about 40 dB below the peak, using the default parameters for time step del_t. 
+ * External waveforms are not included. Returns false if there are no other waveforms.
+ */
+bool getWaveformBand( real del_t , real *lowFreq , real *highFreq )
+{
+
+  WaveformItem *item;
+  WaveformItem defaults;
+  real centre;
+  real halfBand;
+  bool found = false;
+
+  DL_FOREACH( waveformList , item ) 
+  {
+    defaults = *item;
+    setWaveformDefaults( &defaults , del_t );
+
+    switch( defaults.type )
     {
     case WT_GAUSSIAN_PULSE:
+    case WT_NARROW_GAUSSIAN_PULSE:
     case WT_DIFFERENTIATED_GAUSSIAN_PULSE:
     case WT_RICKER_WAVELET:
-      if( item->width < 0 )
-         item->width = 5.0 * sqrt( 2.0 ) * del_t;
-      if( item->delay < 0 )
-         item->delay = 40.0 * del_t;
-      item->frequency = 0.0;
-      break;
-    case WT_NARROW_GAUSSIAN_PULSE:
-      if( item->width < 0 )
-         item->width = 8.0 * del_t;
-      if( item->delay < 0 )
-         item->delay = 12.0 * del_t;
-      item->frequency = 0.0;
+      centre = 0.0;
+      halfBand = 0.6 / defaults.width;
       break;
     case WT_MODULATED_GAUSSIAN_PULSE:
-      if( item->width < 0 )
-         item->width = 20.0 * sqrt( 2.0 ) * del_t;
-      if( item->delay < 0 )
-         item->delay = 120.0 * del_t;
-      if( item->frequency < 0 )
-         item->frequency = 0.05 / del_t;
+      centre = defaults.frequency;
+      halfBand = 0.6 / defaults.width;
       break;
     case WT_COMPACT_PULSE:
     case WT_DIFFERENTIATED_COMPACT_PULSE:
-      if( item->width < 0 )
-         item->width = 20.0 * del_t; 
-      if( item->delay < 0 )
-         item->delay = 0.0; 
-      item->frequency = 0.0;
+      centre = 0.0;
+      halfBand = 1.5 / defaults.width;
       break;
     case WT_MODULATED_COMPACT_PULSE:
-      if( item->width < 0 )
-         item->width = 80.0 * del_t;   
-      if( item->delay < 0 )
-         item->delay = 0.0;
-      if( item->frequency < 0 )
-         item->frequency = 0.05 / del_t;
+      centre = defaults.frequency;
+      halfBand = 1.5 / defaults.width;
       break;
     case WT_RAMPED_SINUSOID:
-      if( item->width < 0 )
-         item->width = 20.0 * del_t;   
-      if( item->delay < 0 )
-         item->delay = 0.0;
-      if( item->frequency < 0 )
-         item->frequency = 0.05 / del_t;
+      centre = defaults.frequency;
+      halfBand = 0.0;
       break;
-    case WT_EXTERNAL:
-      if( item->delay < 0 )
-         item->delay = 0.0;
-      item->tableSize = loadExternalWaveform( item->fileName , &(item->table) );
-      item->lastIdx = 0UL;
-      message( MSG_LOG , 0 , "  Read %ld entries from external waveform table in file %s\n" , item->tableSize , item->fileName );
-      createSplines( item->fileName , item->table , item->tableSize , 0.0 , 0.0 , del_t );
-     break;
     default:
-        assert( 0 );
-      break;
+      continue;
     }
 
-    message( MSG_DEBUG3 , 0 , "  Setting %s waveform: size=%g, delay=%g, width=%g, freq=%g\n" , WAVEFORM_TYPE_STR[item->type] ,
-             item->size , item->delay , item->width , item->frequency );
-	       
+    if( !found )
+    {
+      *lowFreq = fmax( centre - halfBand , 0.0 );
+      *highFreq = centre + halfBand;
+      found = true;
+    }
+    else
+    {
+      *lowFreq = fmin( *lowFreq , fmax( centre - halfBand , 0.0 ) );
+      *highFreq = fmax( *highFreq , centre + halfBand );
+    }
   }
 
-  return;
+  return found;
 
 }
 
@@ -638,6 +718,35 @@ real getWaveformValue( real t , WaveformIndex waveformNumber , real delay )
 }
 
 
+/* Return false if waveform value is identically zero at time t. */
+/* Only waveforms with compact support can be inactive. */
+bool isWaveformActive( real t , WaveformIndex waveformNumber , real delay )
+{
+
+  WaveformItem *item;
+  real time;
+
+  /* Get waveform by number. */
+  HASH_FIND( hhint , waveformNumberHash , &waveformNumber , sizeof( waveformNumber ) , item );
+  if( !item )
+    assert( 0 ); /* Parser has failed if this happens. */
+
+  time = t - delay - item->delay;
+
+  switch( item->type )
+  {
+  case WT_COMPACT_PULSE:
+  case WT_DIFFERENTIATED_COMPACT_PULSE:
+  case WT_MODULATED_COMPACT_PULSE:
+    return ( time > 0.0 && time < 2.0 * item->width );
+  case WT_RAMPED_SINUSOID:
+    return ( time > 0.0 );
+  default:
+    return true;
+  }
+
+}
+
 /* Get pointer to name of waveform by number. */
 char *getWaveformName( WaveformIndex waveformNumber )
 {
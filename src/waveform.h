@@ -65,6 +65,7 @@ typedef enum {
 
 bool parseWF( char *line );
 void initWaveforms( void );
+bool getWaveformBand( real del_t , real *lowFreq , real *highFreq );
 void reportWaveforms( void );
 void updateWaveforms( unsigned long tstepNum , real t );
 void deallocWaveforms( void );
@@ -73,5 +74,6 @@ WaveformIndex getNumberOfWaveforms( void );
 bool isWaveform( char *name , WaveformIndex *number );
 bool thereAreWaveforms( WaveformType );
 char *getWaveformName( WaveformIndex waveformNumber );
+bool isWaveformActive( real t , WaveformIndex waveformNumber , real delay );
 
 #endif
@@ -0,0 +1,3 @@
+
+execute_process( COMMAND @XTRANSALL_EXECUTABLE@ phase )
+
@@ -0,0 +1,3 @@
+
+addpath( '@VULTURE_SOURCE_DIR@/m' );
+
@@ -0,0 +1,7 @@
+set terminal post eps enhanced color "Helvetica" 18
+set output "planewave_empty_oblique_td.eps"
+set title "Vulture Test Case: Oblique plane-wave in free-space on a uniform grid"
+set xlabel "Time (ns)"
+set ylabel "Electric field, E_y(10,11,12) (V/m)"
+plot "eh_op1_td.asc"                                                us ($2/1e-9):4 ti "Test"       w l ls 1, \
+     "@VULTURE_SOURCE_DIR@/tests/planewave_empty_oblique/eh_op1_td.asc" us ($2/1e-9):4 ti "Validation" w l ls 2
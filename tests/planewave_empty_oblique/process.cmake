@@ -0,0 +1,5 @@
+
+execute_process( COMMAND @XTIME_EXECUTABLE@ )
+execute_process( COMMAND @XTRANSALL_EXECUTABLE@ phase )
+execute_process( COMMAND @XFREQ_EXECUTABLE@ phase )
+
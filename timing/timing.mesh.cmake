@@ -0,0 +1,23 @@
+VM 1.0.0
+CE Vulture Timing Benchmark: Empty @EXTENT@ x @EXTENT@ x @EXTENT@ grid
+DM @EXTENT@ @EXTENT@ @EXTENT@
+GS
+# Mur ABC on all faces.
+BT XLO MUR
+BT XHI MUR
+BT YLO MUR
+BT YHI MUR
+BT ZLO MUR
+BT ZHI MUR
+# Waveform is a Gaussian pulse with default parameters.
+WF wf1 GAUSSIAN_PULSE
+# Hertzian dipole at the centre of the grid exciting all polarisations.
+EX @CENTRE@ @CENTRE1@ @CENTRE@ @CENTRE@ @CENTRE@ @CENTRE@ sourcex IDX wf1 1.0
+EX @CENTRE@ @CENTRE@ @CENTRE@ @CENTRE1@ @CENTRE@ @CENTRE@ sourcey IDY wf1 1.0
+EX @CENTRE@ @CENTRE@ @CENTRE@ @CENTRE@ @CENTRE@ @CENTRE1@ sourcez IDZ wf1 1.0
+# Single point observer.
+OP @OBSERVER@ @OBSERVER@ @OBSERVER@ @OBSERVER@ @OBSERVER@ @OBSERVER@ op1 TDOM_ASCII
+GE
+NT @NUM_STEPS@
+MS 0.01
+EN
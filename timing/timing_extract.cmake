@@ -0,0 +1,45 @@
+# 
+# This file is part of Vulture.
+#
+# Vulture finite-difference time-domain electromagnetic solver.
+# Copyright (C) 2011-2016 Ian David Flintoft
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software Foundation,
+# Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+#
+# Author: Ian Flintoft <ian.flintoft@googlemail.com>
+#
+
+# Extract the time per iteration from a solver log and append it to the timing
+# benchmark results file.
+#
+# Usage: cmake -D LOG_FILE=<file> -D RESULTS_FILE=<file> -D EXTENT=<int> 
+#              -D NUM_THREADS=<int> -D NUM_STEPS=<int> -P timing_extract.cmake
+#
+
+file( STRINGS ${LOG_FILE} elapsedLine REGEX "Elapsed time " )
+file( STRINGS ${LOG_FILE} spiLine REGEX "Average spi " )
+
+if( NOT elapsedLine MATCHES "Elapsed time ([^ ]+) s" )
+  message( FATAL_ERROR "No elapsed time found in ${LOG_FILE}" )
+endif()
+set( elapsed ${CMAKE_MATCH_1} )
+
+if( NOT spiLine MATCHES "Average spi ([^,]+), average spi/cell ([^ ]+) ns" )
+  message( FATAL_ERROR "No time per iteration found in ${LOG_FILE}" )
+endif()
+set( spi ${CMAKE_MATCH_1} )
+set( spiPerCell ${CMAKE_MATCH_2} )
+
+file( APPEND ${RESULTS_FILE} "${EXTENT}\t${NUM_THREADS}\t${NUM_STEPS}\t${elapsed}\t${spi}\t${spiPerCell}\n" )